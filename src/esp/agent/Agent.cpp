@@ -50,6 +50,54 @@ bool Agent::act(const std::string& actionName) {
   }
 }
 
+bool Agent::act(const int actionId) {
+  if (!isValidActionId(actionId)) {
+    return false;
+  }
+
+  const ResolvedAction& action = resolvedActions_[actionId];
+  if (action.isBodyAction) {
+    controls_->action(object(), action.controlId, action.amount,
+                      /*applyFilter=*/true);
+  } else {
+    for (const auto& p : node().getNodeSensors()) {
+      controls_->action(p.second.get().object(), action.controlId,
+                        action.amount,
+                        /*applyFilter=*/false);
+    }
+  }
+  return true;
+}
+
+int Agent::getActionId(const std::string& actionName) {
+  auto actionIter = configuration_.actionSpace.find(actionName);
+  if (actionIter == configuration_.actionSpace.end()) {
+    return ID_UNDEFINED;
+  }
+
+  const ActionSpec& actionSpec = *actionIter->second;
+  ResolvedAction action{
+      actionName, controls_->getActionId(actionSpec.name),
+      actionSpec.actuation.at("amount"),
+      BodyActions.find(actionSpec.name) != BodyActions.end()};
+
+  // Reuse the handle if the action didn't change since it was resolved
+  for (size_t i = 0; i < resolvedActions_.size(); ++i) {
+    const ResolvedAction& resolved = resolvedActions_[i];
+    if (resolved.name == action.name &&
+        resolved.controlId == action.controlId &&
+        resolved.amount == action.amount) {
+      return int(i);
+    }
+  }
+  resolvedActions_.push_back(std::move(action));
+  return int(resolvedActions_.size()) - 1;
+}
+
+bool Agent::isValidActionId(const int actionId) const {
+  return 0 <= actionId && actionId < int(resolvedActions_.size());
+}
+
 bool Agent::hasAction(const std::string& actionName) const {
   auto actionSpace = configuration_.actionSpace;
   return !(actionSpace.find(actionName) == actionSpace.end());
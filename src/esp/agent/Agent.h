@@ -101,8 +101,34 @@ class Agent : public Magnum::SceneGraph::AbstractFeature3D {
 
   bool act(const std::string& actionName);
 
+  /**
+   * @brief Take the action with handle @p actionId, see @ref getActionId.
+   * Skips the name lookups of @ref act(const std::string&).
+   *
+   * @return Whether @p actionId is a valid handle.
+   */
+  bool act(int actionId);
+
   bool hasAction(const std::string& actionName) const;
 
+  /**
+   * @brief Resolve an action of the action space to an integer handle for
+   * @ref act(int).
+   *
+   * The handle captures the action's spec at the time of the call. Resolve it
+   * again after changing the action space.
+   *
+   * @return The handle, or @ref ID_UNDEFINED if the action space has no action
+   * named @p actionName.
+   */
+  int getActionId(const std::string& actionName);
+
+  /**
+   * @brief Whether @p actionId is a handle returned by @ref getActionId, so
+   * @ref act(int) would take it.
+   */
+  bool isValidActionId(int actionId) const;
+
   void reset();
 
   void getState(const AgentState::ptr& state) const;
@@ -146,9 +172,19 @@ class Agent : public Magnum::SceneGraph::AbstractFeature3D {
   static const std::set<std::string> BodyActions;
 
  private:
+  //! An action of the action space resolved by @ref getActionId.
+  struct ResolvedAction {
+    std::string name;
+    //! ID of the move in @ref controls_
+    int controlId;
+    float amount;
+    bool isBodyAction;
+  };
+
   AgentConfiguration configuration_;
   std::shared_ptr<scene::ObjectControls> controls_;
   AgentState initialState_;
+  std::vector<ResolvedAction> resolvedActions_;
 
   ESP_SMART_POINTERS(Agent)
 };
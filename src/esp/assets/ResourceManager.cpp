@@ -1855,24 +1855,27 @@ int ResourceManager::loadNavMeshVisualization(esp::nav::PathFinder& pathFinder,
   std::vector<Mn::UnsignedInt> indices;
   std::vector<Mn::Vector3> positions;
 
-  const MeshData::ptr navMeshData = pathFinder.getNavMeshData();
+  // shared vertices, so the buffers scale with the unique navmesh geometry
+  const std::shared_ptr<const nav::NavMeshGeometry> navMeshGeometry =
+      pathFinder.getNavMeshGeometry();
+  const std::vector<uint32_t>& triangleIndices = navMeshGeometry->indices;
 
   // add the vertices
-  positions.resize(navMeshData->vbo.size());
-  for (size_t vix = 0; vix < navMeshData->vbo.size(); ++vix) {
-    positions[vix] = Mn::Vector3{navMeshData->vbo[vix]};
+  positions.resize(navMeshGeometry->vertices.size());
+  for (size_t vix = 0; vix < navMeshGeometry->vertices.size(); ++vix) {
+    positions[vix] = Mn::Vector3{navMeshGeometry->vertices[vix]};
   }
 
-  indices.resize(navMeshData->ibo.size() * 2);
-  for (size_t ix = 0; ix < navMeshData->ibo.size();
+  indices.resize(triangleIndices.size() * 2);
+  for (size_t ix = 0; ix < triangleIndices.size();
        ix += 3) {  // for each triangle, create lines
     size_t nix = ix * 2;
-    indices[nix] = navMeshData->ibo[ix];
-    indices[nix + 1] = navMeshData->ibo[ix + 1];
-    indices[nix + 2] = navMeshData->ibo[ix + 1];
-    indices[nix + 3] = navMeshData->ibo[ix + 2];
-    indices[nix + 4] = navMeshData->ibo[ix + 2];
-    indices[nix + 5] = navMeshData->ibo[ix];
+    indices[nix] = triangleIndices[ix];
+    indices[nix + 1] = triangleIndices[ix + 1];
+    indices[nix + 2] = triangleIndices[ix + 1];
+    indices[nix + 3] = triangleIndices[ix + 2];
+    indices[nix + 4] = triangleIndices[ix + 2];
+    indices[nix + 5] = triangleIndices[ix];
   }
 
   // create a temporary mesh object referencing the above data
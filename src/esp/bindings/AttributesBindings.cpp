@@ -335,6 +335,20 @@ void initAttributesBindings(py::module& m) {
           &ObjectAttributes::setJoinCollisionMeshes,
           R"(Whether collision meshes for objects constructed from this
           template should be joined into a convex hull or kept separate.)")
+      .def_property(
+          "collision_hull_max_vertices",
+          &ObjectAttributes::getCollisionHullMaxVertices,
+          &ObjectAttributes::setCollisionHullMaxVertices,
+          R"(If > 0, convex collision hulls of objects constructed from this
+          template are simplified to at most this many vertices. Processed hulls
+          are cached next to the collision asset.)")
+      .def_property(
+          "collision_convex_decomposition",
+          &ObjectAttributes::getCollisionConvexDecomposition,
+          &ObjectAttributes::setCollisionConvexDecomposition,
+          R"(Whether each collision mesh of objects constructed from this
+          template is approximated by several convex hulls instead of one.
+          Ignored if collision meshes are joined.)")
       .def_property(
           "is_visibile", &ObjectAttributes::getIsVisible,
           &ObjectAttributes::setIsVisible,
@@ -463,7 +477,14 @@ void initAttributesBindings(py::module& m) {
           &PhysicsManagerAttributes::getRestitutionCoefficient,
           &PhysicsManagerAttributes::setRestitutionCoefficient,
           R"(Default restitution coefficient for contact modeling.  Can be overridden by
-          stage and object values.)");
+          stage and object values.)")
+      .def_property(
+          "bvh_cache_directory",
+          &PhysicsManagerAttributes::getBvhCacheDirectory,
+          &PhysicsManagerAttributes::setBvhCacheDirectory,
+          R"(Directory caching the BVHs of static stage collision meshes, so that
+          later loads of the same stage memory-map them instead of rebuilding.
+          Empty disables the cache.)");
 
   // ==== AbstractPrimitiveAttributes ====
   py::class_<AbstractPrimitiveAttributes, AbstractAttributes,
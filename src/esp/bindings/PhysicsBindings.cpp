@@ -5,6 +5,7 @@
 #include "esp/bindings/Bindings.h"
 #include "esp/bindings/EnumOperators.h"
 #include "esp/physics/PhysicsManager.h"
+#include "esp/physics/PhysicsWorldPool.h"
 
 namespace py = pybind11;
 using py::literals::operator""_a;
@@ -252,6 +253,19 @@ void initPhysicsBindings(py::module& m) {
       .def_static("get_all_group_names",
                   &CollisionGroupHelper::getAllGroupNames,
                   R"(Get a list of all configured collision group names.)");
+
+  // ==== class object PhysicsWorldPool ====
+  py::class_<PhysicsWorldPool, PhysicsWorldPool::ptr>(
+      m, "PhysicsWorldPool",
+      R"(Threads stepping the physical worlds of many Simulators in parallel. See Simulator.step_worlds.)")
+      .def(py::init([](int numThreads) {
+             return PhysicsWorldPool::create(numThreads);
+           }),
+           "num_threads"_a = 0,
+           R"(Create a pool with the given total number of threads, including the calling thread. Values <= 0 use one thread per hardware thread.)")
+      .def_property_readonly(
+          "num_threads", &PhysicsWorldPool::getNumThreads,
+          R"(The total number of threads stepping worlds, including the calling thread.)");
 }
 
 }  // namespace physics
@@ -4,6 +4,8 @@
 
 #include "esp/bindings/Bindings.h"
 
+#include <pybind11/numpy.h>
+
 #include "esp/physics/bullet/objectWrappers/ManagedBulletArticulatedObject.h"
 #include "esp/physics/bullet/objectWrappers/ManagedBulletRigidObject.h"
 #include "esp/physics/objectManagers/ArticulatedObjectManager.h"
@@ -26,6 +28,29 @@ using PhysWraps::RigidObjectManager;
 
 namespace esp {
 namespace physics {
+
+namespace {
+/**
+ * @brief Float arrays accepted by the batched state setters. Other dtypes and
+ * non-contiguous arrays are converted on the way in.
+ */
+typedef py::array_t<float, py::array::c_style | py::array::forcecast>
+    FloatArrayIn;
+
+/**
+ * @brief Hand the storage of @p values over to a numpy array without copying
+ * it.
+ */
+py::array_t<float> toNumpy(std::vector<float>&& values) {
+  auto* storage = new std::vector<float>(std::move(values));
+  py::capsule owner(storage, [](void* ptr) {
+    delete reinterpret_cast<std::vector<float>*>(ptr);
+  });
+  return py::array_t<float>(py::ssize_t(storage->size()), storage->data(),
+                            owner);
+}
+}  // namespace
+
 /**
  * @brief instance class template base classes for object wrapper managers.
  * @tparam The type used to specialize class template for each object wrapper
@@ -256,7 +281,51 @@ void initPhysicsWrapperManagerBindings(pybind11::module& m) {
           &RigidObjectManager::removePhysObjectByHandle, "handle"_a,
           "delete_object_node"_a = true, "delete_visual_node"_a = true,
           R"(This removes the RigidObject referenced by the passed handle from the library, while allowing "
-          "for the optional retention of the object's scene node and/or the visual node)");
+          "for the optional retention of the object's scene node and/or the visual node)")
+      .def(
+          "get_poses",
+          [](const RigidObjectManager& self,
+             const std::vector<int>& objectIds) {
+            py::array_t<float> poses({objectIds.size(), std::size_t{7}});
+            self.getPoses(objectIds, {poses.mutable_data(),
+                                      std::size_t(poses.size())});
+            return poses;
+          },
+          "object_ids"_a,
+          R"(Get the poses of the RigidObjects with the given ids in a single call, as
+          an (N, 7) float32 array of rows [x, y, z, qx, qy, qz, qw].)")
+      .def(
+          "set_poses",
+          [](RigidObjectManager& self, const std::vector<int>& objectIds,
+             const FloatArrayIn& poses) {
+            self.setPoses(objectIds,
+                          {poses.data(), std::size_t(poses.size())});
+          },
+          "object_ids"_a, "poses"_a,
+          R"(Set the poses of the RigidObjects with the given ids in a single call, from
+          an (N, 7) array of rows [x, y, z, qx, qy, qz, qw].)")
+      .def(
+          "get_velocities",
+          [](const RigidObjectManager& self,
+             const std::vector<int>& objectIds) {
+            py::array_t<float> velocities({objectIds.size(), std::size_t{6}});
+            self.getVelocities(objectIds, {velocities.mutable_data(),
+                                           std::size_t(velocities.size())});
+            return velocities;
+          },
+          "object_ids"_a,
+          R"(Get the velocities of the RigidObjects with the given ids in a single call,
+          as an (N, 6) float32 array of rows [linear xyz, angular xyz].)")
+      .def(
+          "set_velocities",
+          [](RigidObjectManager& self, const std::vector<int>& objectIds,
+             const FloatArrayIn& velocities) {
+            self.setVelocities(objectIds, {velocities.data(),
+                                           std::size_t(velocities.size())});
+          },
+          "object_ids"_a, "velocities"_a,
+          R"(Set the velocities of the RigidObjects with the given ids in a single call,
+          from an (N, 6) array of rows [linear xyz, angular xyz].)");
 
   // initialize bindings for articulated objects
 
@@ -290,7 +359,46 @@ void initPhysicsWrapperManagerBindings(pybind11::module& m) {
           "light_setup_key"_a = DEFAULT_LIGHTING_KEY,
           R"(Load and parse a URDF file using the given 'filepath' into a model,
           then use this model to instantiate an Articulated Object in the world.
-          Returns a reference to the created object.)");
+          Returns a reference to the created object.)")
+      .def(
+          "get_joint_positions",
+          [](const ArticulatedObjectManager& self,
+             const std::vector<int>& objectIds) {
+            return toNumpy(self.getJointPositions(objectIds));
+          },
+          "object_ids"_a,
+          R"(Get the joint positions of the ArticulatedObjects with the given ids in a
+          single call, concatenated in the order of the ids into a float32 array.)")
+      .def(
+          "set_joint_positions",
+          [](ArticulatedObjectManager& self, const std::vector<int>& objectIds,
+             const FloatArrayIn& positions) {
+            self.setJointPositions(objectIds, {positions.data(),
+                                               std::size_t(positions.size())});
+          },
+          "object_ids"_a, "positions"_a,
+          R"(Set the joint positions of the ArticulatedObjects with the given ids in a
+          single call, from values concatenated in the order of the ids.)")
+      .def(
+          "get_joint_velocities",
+          [](const ArticulatedObjectManager& self,
+             const std::vector<int>& objectIds) {
+            return toNumpy(self.getJointVelocities(objectIds));
+          },
+          "object_ids"_a,
+          R"(Get the joint velocities of the ArticulatedObjects with the given ids in a
+          single call, concatenated in the order of the ids into a float32 array.)")
+      .def(
+          "set_joint_velocities",
+          [](ArticulatedObjectManager& self, const std::vector<int>& objectIds,
+             const FloatArrayIn& velocities) {
+            self.setJointVelocities(
+                objectIds,
+                {velocities.data(), std::size_t(velocities.size())});
+          },
+          "object_ids"_a, "velocities"_a,
+          R"(Set the joint velocities of the ArticulatedObjects with the given ids in a
+          single call, from values concatenated in the order of the ids.)");
 }  // initPhysicsWrapperManagerBindings
 
 }  // namespace physics
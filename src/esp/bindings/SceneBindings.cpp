@@ -212,10 +212,24 @@ void initSceneBindings(py::module& m) {
   // ==== ObjectControls ====
   py::class_<ObjectControls, ObjectControls::ptr>(m, "ObjectControls")
       .def(py::init(&ObjectControls::create<>))
-      .def("action", &ObjectControls::action, R"(
+      .def("action",
+           py::overload_cast<SceneNode&, const std::string&, float, bool>(
+               &ObjectControls::action),
+           R"(
         Take action using this :py:class:`ObjectControls`.
       )",
-           "object"_a, "name"_a, "amount"_a, "apply_filter"_a = true);
+           "object"_a, "name"_a, "amount"_a, "apply_filter"_a = true)
+      .def("action",
+           py::overload_cast<SceneNode&, int, float, bool>(
+               &ObjectControls::action),
+           R"(
+        Take the action with the ID returned by :ref:`get_action_id`.
+      )",
+           "object"_a, "action_id"_a, "amount"_a, "apply_filter"_a = true)
+      .def("get_action_id", &ObjectControls::getActionId, R"(
+        Resolve an action name to an integer ID, or -1 if it doesn't exist.
+      )",
+           "name"_a);
 }
 
 }  // namespace scene
@@ -50,7 +50,10 @@ void initShortestPathBindings(py::module& m) {
           R"(A list of points that specify the shortest path on the navigation mesh between requestedStart and requestedEnd. Will be empty if no path exists.)")
       .def_readwrite(
           "geodesic_distance", &ShortestPath::geodesicDistance,
-          R"(The geodesic distance between requestedStart and requestedEnd. Will be inf if no path exists.)");
+          R"(The geodesic distance between requestedStart and requestedEnd. Will be inf if no path exists.)")
+      .def_readwrite(
+          "use_path_hierarchy", &ShortestPath::usePathHierarchy,
+          R"(Fall back to the path hierarchy, see PathFinder.build_path_hierarchy(), if the Detour search gives up before reaching the end. Paths the Detour search finds are unchanged. This rescues paths too long for Detour, it doesn't make queries faster.)");
 
   py::class_<MultiGoalShortestPath, MultiGoalShortestPath::ptr>(
       m, "MultiGoalShortestPath",
@@ -70,7 +73,91 @@ void initShortestPathBindings(py::module& m) {
       .def_readwrite(
           "closest_end_point_index",
           &MultiGoalShortestPath::closestEndPointIndex,
-          R"(The index of the closest end point corresponding to end of the shortest path. Will be -1 if no path exists.)");
+          R"(The index of the closest end point corresponding to end of the shortest path. Will be -1 if no path exists.)")
+      .def_readwrite(
+          "use_distance_field", &MultiGoalShortestPath::useDistanceField,
+          R"(Answer queries from a single search from all requested ends, computed on the first query and kept while the ends, the navmesh and distance_field_spacing are unchanged, instead of a search per end. For static goals queried from many starts.)")
+      .def_readwrite(
+          "distance_field_spacing",
+          &MultiGoalShortestPath::distanceFieldSpacing,
+          R"(The portal sample spacing of the search used with use_distance_field, see PathFinder.compute_distance_field().)")
+      .def_readwrite(
+          "use_path_hierarchy", &MultiGoalShortestPath::usePathHierarchy,
+          R"(Fall back to the path hierarchy, see PathFinder.build_path_hierarchy(), if the Detour search gives up before reaching an end. Paths the Detour search finds are unchanged. This rescues paths too long for Detour, it doesn't make queries faster. Not used with use_distance_field.)");
+
+  py::class_<GeodesicDistanceField, GeodesicDistanceField::ptr>(
+      m, "GeodesicDistanceField",
+      R"(Precomputed geodesic distances from a fixed set of goal points to every point on the navigation mesh. Created with PathFinder.compute_distance_field().)")
+      .def_property_readonly("goals", &GeodesicDistanceField::getGoals,
+                             R"(The goal points this field was computed for.)")
+      .def(
+          "distance_to", &GeodesicDistanceField::distanceTo, "pt"_a,
+          R"(Returns the geodesic distance from a point to the closest goal, or inf if the point can't be snapped to the navmesh or no goal is reachable.)")
+      .def(
+          "distances_to", &GeodesicDistanceField::distancesTo, "points"_a,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Returns the geodesic distance from each point to the closest goal. See distance_to().)");
+
+  py::class_<PathFinderQueryContext, PathFinderQueryContext::ptr>(
+      m, "PathFinderQueryContext",
+      R"(Per-thread query state for a PathFinder, created with PathFinder.create_query_context(). Shares the navmesh read-only so several threads, each with its own context, can query it concurrently. Keeps querying the navmesh it was created on if the PathFinder is rebuilt or reloaded. Queries release the GIL.)")
+      .def_property_readonly(
+          "is_loaded", &PathFinderQueryContext::isLoaded,
+          R"(Whether the context has a navmesh to query.)")
+      .def(
+          "seed", &PathFinderQueryContext::seed, "new_seed"_a,
+          R"(Seed the random state of this context. Contexts are seeded from the PathFinder when created.)")
+      .def("find_path",
+           py::overload_cast<ShortestPath&>(&PathFinderQueryContext::findPath),
+           "path"_a, py::call_guard<py::gil_scoped_release>(),
+           R"(See PathFinder.find_path().)")
+      .def("find_path",
+           py::overload_cast<MultiGoalShortestPath&>(
+               &PathFinderQueryContext::findPath),
+           "path"_a, py::call_guard<py::gil_scoped_release>(),
+           R"(See PathFinder.find_path().)")
+      .def("try_step",
+           py::overload_cast<const Magnum::Vector3&, const Magnum::Vector3&>(
+               &PathFinderQueryContext::tryStep<Magnum::Vector3>),
+           "start"_a, "end"_a, py::call_guard<py::gil_scoped_release>())
+      .def("try_step",
+           py::overload_cast<const vec3f&, const vec3f&>(
+               &PathFinderQueryContext::tryStep<vec3f>),
+           "start"_a, "end"_a, py::call_guard<py::gil_scoped_release>())
+      .def("try_step_no_sliding",
+           &PathFinderQueryContext::tryStepNoSliding<Magnum::Vector3>,
+           "start"_a, "end"_a, py::call_guard<py::gil_scoped_release>())
+      .def("try_step_no_sliding",
+           &PathFinderQueryContext::tryStepNoSliding<vec3f>, "start"_a,
+           "end"_a, py::call_guard<py::gil_scoped_release>())
+      .def("snap_point", &PathFinderQueryContext::snapPoint<Magnum::Vector3>,
+           "point"_a, "island_index"_a = ID_UNDEFINED,
+           py::call_guard<py::gil_scoped_release>())
+      .def("snap_point", &PathFinderQueryContext::snapPoint<vec3f>, "point"_a,
+           "island_index"_a = ID_UNDEFINED,
+           py::call_guard<py::gil_scoped_release>())
+      .def("get_island", &PathFinderQueryContext::getIsland<Magnum::Vector3>,
+           "point"_a, py::call_guard<py::gil_scoped_release>())
+      .def("get_island", &PathFinderQueryContext::getIsland<vec3f>, "point"_a,
+           py::call_guard<py::gil_scoped_release>())
+      .def("is_navigable", &PathFinderQueryContext::isNavigable, "pt"_a,
+           "max_y_delta"_a = 0.5, py::call_guard<py::gil_scoped_release>())
+      .def("distance_to_closest_obstacle",
+           &PathFinderQueryContext::distanceToClosestObstacle, "pt"_a,
+           "max_search_radius"_a = 2.0,
+           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "get_random_navigable_point",
+          &PathFinderQueryContext::getRandomNavigablePoint,
+          "island_index"_a = ID_UNDEFINED,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Returns a random navigable point uniformly distributed over the navigable area of the navmesh, or of the specified island, drawn from the context's random state.)")
+      .def("get_random_navigable_point_near",
+           &PathFinderQueryContext::getRandomNavigablePointAroundSphere,
+           "circle_center"_a, "radius"_a, "max_tries"_a = 100,
+           "island_index"_a = ID_UNDEFINED,
+           py::call_guard<py::gil_scoped_release>(),
+           R"(See PathFinder.get_random_navigable_point_near().)");
 
   py::class_<NavMeshSettings, NavMeshSettings::ptr>(
       m, "NavMeshSettings",
@@ -128,6 +215,9 @@ void initShortestPathBindings(py::module& m) {
       .def_readwrite(
           "include_static_objects", &NavMeshSettings::includeStaticObjects,
           R"(Whether or not to include STATIC RigidObjects as NavMesh constraints. Note: Used in Simulator recomputeNavMesh pre-process. Default False.)")
+      .def_readwrite(
+          "tile_size", &NavMeshSettings::tileSize,
+          R"(Width and depth of a navmesh tile in voxels. 0 builds a single tile, otherwise tiles can be rebuilt individually, see Simulator.update_navmesh_for_object. Default 0.)")
       .def("set_defaults", &NavMeshSettings::setDefaults)
       .def("read_from_json", &NavMeshSettings::readFromJSON,
            R"(Overwrite these settings with values from a JSON file.)")
@@ -147,7 +237,7 @@ void initShortestPathBindings(py::module& m) {
           R"(Get the axis aligned bounding box containing the navigation mesh.)")
       .def(
           "seed", &PathFinder::seed,
-          R"(Seed the pathfinder.  Useful for get_random_navigable_point(). Seeds the global c rand function.)")
+          R"(Seed the pathfinder.  Useful for get_random_navigable_point(). Seeds the global c rand function and the random state of island-restricted sampling.)")
       .def(
           "get_topdown_view", &PathFinder::getTopDownView,
           R"(Returns the topdown view of the PathFinder's navmesh at a given vertical slice with eps slack.)",
@@ -173,13 +263,88 @@ void initShortestPathBindings(py::module& m) {
           py::overload_cast<MultiGoalShortestPath&>(&PathFinder::findPath),
           "path"_a,
           R"(Finds the shortest path between a start point and the closest of a set of end points (in geodesic distance) on the navigation mesh using MultiGoalShortestPath module. Path variable is filled if successful. Returns boolean success.)")
-      .def("try_step", &PathFinder::tryStep<Magnum::Vector3>, "start"_a,
-           "end"_a)
-      .def("try_step", &PathFinder::tryStep<vec3f>, "start"_a, "end"_a)
+      .def(
+          "find_paths",
+          [](PathFinder& self, const std::vector<ShortestPath::ptr>& paths) {
+            std::vector<ShortestPath> batch;
+            batch.reserve(paths.size());
+            for (const auto& path : paths) {
+              batch.push_back(*path);
+            }
+            std::vector<bool> found;
+            {
+              py::gil_scoped_release release;
+              found = self.findPaths(batch);
+            }
+            for (size_t i = 0; i < paths.size(); ++i) {
+              *paths[i] = std::move(batch[i]);
+            }
+            return found;
+          },
+          "paths"_a,
+          R"(Finds the shortest path for each ShortestPath in a list, distributing the queries over num_threads threads. Each path variable is filled as with find_path(). Returns a list of boolean success in input order.)")
+      .def(
+          "geodesic_distances", &PathFinder::geodesicDistances, "starts"_a,
+          "ends"_a, py::call_guard<py::gil_scoped_release>(),
+          R"(Computes the geodesic distance between each pair of start and end points, distributing the queries over num_threads threads. Returns a list of distances in input order, inf where no path exists.)")
+      .def(
+          "snap_points", &PathFinder::snapPoints, "points"_a,
+          "island_index"_a = ID_UNDEFINED,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Snaps each row of an Nx3 array of points to the navmesh, distributing the queries over num_threads threads. Optionally restrict to an island. Returns an Nx3 array with NaN rows for points that couldn't be snapped.)")
+      .def(
+          "get_islands", &PathFinder::getIslands, "points"_a,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Queries the island of each row of an Nx3 array of points, distributing the queries over num_threads threads. Returns an array of island indices, -1 for points that couldn't be snapped.)")
+      .def(
+          "is_navigable_batch", &PathFinder::isNavigableBatch, "points"_a,
+          "max_y_delta"_a = 0.5, py::call_guard<py::gil_scoped_release>(),
+          R"(Checks whether the agent can stand at each row of an Nx3 array of points, distributing the queries over num_threads threads. Returns a boolean array.)")
+      .def(
+          "try_step_batch", &PathFinder::tryStepBatch, "starts"_a, "ends"_a,
+          "poly_refs"_a.noconvert(), "allow_sliding"_a = true,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Takes a step for each row of Nx3 arrays of starts and ends, distributing the queries over num_threads threads. poly_refs is a uint64 array of the cached polygon of each start, or 0 if unknown, and is updated in place like try_step_from_poly(). Returns an Nx3 array of end locations.)")
+      .def(
+          "sample_navigable_points", &PathFinder::sampleNavigablePoints,
+          "num_points"_a, "island_index"_a = ID_UNDEFINED,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Samples num_points random navigable points uniformly by area over the navmesh, or the specified island, using num_threads threads. Given the same seed the result doesn't depend on num_threads. Returns an Nx3 array.)")
+      .def(
+          "compute_distance_field", &PathFinder::computeDistanceField,
+          "goals"_a, "portal_sample_spacing"_a = 0.25,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Precomputes geodesic distances from a set of goal points to the whole navigation mesh with a single multi-source Dijkstra search. Returns a GeodesicDistanceField for cheap repeated distance queries to the same goals.)")
+      .def(
+          "create_query_context", &PathFinder::createQueryContext,
+          R"(Creates a PathFinderQueryContext for querying the current navmesh from another thread. Cheap, the navmesh is shared and not copied. Returns None if no navmesh is loaded.)")
+      .def_property(
+          "num_threads", &PathFinder::getNumThreads,
+          &PathFinder::setNumThreads,
+          R"(The number of threads used by the batched query methods such as find_paths() and geodesic_distances(), and to build tiled navmeshes. Set <= 0 to use the hardware concurrency.)")
+      .def("try_step",
+           py::overload_cast<const Magnum::Vector3&, const Magnum::Vector3&>(
+               &PathFinder::tryStep<Magnum::Vector3>),
+           "start"_a, "end"_a)
+      .def("try_step",
+           py::overload_cast<const vec3f&, const vec3f&>(
+               &PathFinder::tryStep<vec3f>),
+           "start"_a, "end"_a)
       .def("try_step_no_sliding",
            &PathFinder::tryStepNoSliding<Magnum::Vector3>, "start"_a, "end"_a)
       .def("try_step_no_sliding", &PathFinder::tryStepNoSliding<vec3f>,
            "start"_a, "end"_a)
+      .def(
+          "try_step_from_poly",
+          [](PathFinder& self, const Magnum::Vector3& start,
+             const Magnum::Vector3& end, uint64_t polyRef, bool allowSliding) {
+            const Magnum::Vector3 stepped =
+                self.tryStep(start, end, polyRef, allowSliding);
+            return std::make_tuple(stepped, polyRef);
+          },
+          "start"_a, "end"_a, "poly_ref"_a = 0, "allow_sliding"_a = true,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Same as try_step(), or try_step_no_sliding() if allow_sliding is False, but skips finding the navmesh polygon of start if poly_ref still contains it. Returns the end location and the polygon it is on, to pass as poly_ref to the next step. Use 0 if the polygon is unknown.)")
       .def("snap_point", &PathFinder::snapPoint<Magnum::Vector3>, "point"_a,
            "island_index"_a = ID_UNDEFINED)
       .def("snap_point", &PathFinder::snapPoint<vec3f>, "point"_a,
@@ -232,15 +397,61 @@ void initShortestPathBindings(py::module& m) {
           },
           "island_index"_a = ID_UNDEFINED,
           R"(Returns an array of triangle index data for the triangulated NavMesh poly vertices returned by build_navmesh_vertices(). Optionally limit results to a specific island. Default (island_index==-1) queries all islands.)")
-      .def("load_nav_mesh", &PathFinder::loadNavMesh, "path"_a,
-           R"(Load a .navmesh file overriding this PathFinder instance.)")
+      .def(
+          "build_navmesh_geometry",
+          [](PathFinder& self) -> py::object {
+            const auto geometry = self.getNavMeshGeometry();
+            if (!geometry)
+              return py::none();
+            using Indices = Eigen::Matrix<uint32_t, Eigen::Dynamic, 1>;
+            return py::make_tuple(
+                Eigen::RowMatrixX3f{Eigen::Map<const Eigen::RowMatrixX3f>(
+                    reinterpret_cast<const float*>(geometry->vertices.data()),
+                    geometry->vertices.size(), 3)},
+                Indices{Eigen::Map<const Indices>(geometry->indices.data(),
+                                                  geometry->indices.size())},
+                Indices{Eigen::Map<const Indices>(
+                    geometry->islandIndexOffsets.data(),
+                    geometry->islandIndexOffsets.size())});
+          },
+          R"(Returns the indexed NavMesh triangle mesh as a (vertices, indices, island_index_offsets) tuple of arrays, or None if not loaded. Vertices are shared between triangles and the triangles of island i are indices[island_index_offsets[i]:island_index_offsets[i + 1]].)")
+      .def(
+          "export_navmesh_geometry", &PathFinder::exportNavMeshGeometry,
+          "path"_a, "island_index"_a = ID_UNDEFINED,
+          R"(Writes the NavMesh triangle mesh to a binary .ply or .glb file, chosen by the extension of path. Optionally limit the export to a specific island. Default (island_index==-1) exports all islands.)")
+      .def(
+          "load_nav_mesh", &PathFinder::loadNavMesh, "path"_a,
+          "memory_map"_a = false,
+          R"(Load a .navmesh file overriding this PathFinder instance. With memory_map, the file is mapped copy-on-write and its tile data used in place, sharing read-only pages between processes loading the same file.)")
       .def(
           "save_nav_mesh", &PathFinder::saveNavMesh, "path"_a,
           R"(Serialize this PathFinder instance and current NavMesh settings to a .navmesh file.)")
-      .def("distance_to_closest_obstacle",
-           &PathFinder::distanceToClosestObstacle,
-           R"(Returns the distance to the closest obstacle.)", "pt"_a,
-           "max_search_radius"_a = 2.0)
+      .def(
+          "distance_to_closest_obstacle",
+          &PathFinder::distanceToClosestObstacle,
+          R"(Returns the distance to the closest obstacle. Interpolated from the obstacle distance field where possible, see build_obstacle_distance_field().)",
+          "pt"_a, "max_search_radius"_a = 2.0)
+      .def(
+          "build_obstacle_distance_field",
+          &PathFinder::buildObstacleDistanceField, "cell_size"_a = 0.1,
+          "max_search_radius"_a = 2.0,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Precomputes obstacle distances on a grid per island so that distance_to_closest_obstacle() becomes a bilinear lookup, falling back to the exact search near walls, between navmesh levels and outside the grid. Recomputed whenever the navmesh changes until cleared.)")
+      .def("clear_obstacle_distance_field",
+           &PathFinder::clearObstacleDistanceField,
+           R"(Removes the obstacle distance field.)")
+      .def_property_readonly(
+          "has_obstacle_distance_field", &PathFinder::hasObstacleDistanceField,
+          R"(Whether an obstacle distance field is built.)")
+      .def(
+          "build_path_hierarchy", &PathFinder::buildPathHierarchy,
+          "cluster_size"_a = 64, py::call_guard<py::gil_scoped_release>(),
+          R"(Groups the navmesh polygons into clusters of at most cluster_size polygons, so that find_path() queries with use_path_hierarchy set still find long paths the Detour node pool can't. It only runs after the Detour search failed, so it doesn't speed queries up. Rebuilt whenever the navmesh changes until cleared. Saved with the navmesh and loaded with it if a hierarchy with the same cluster size is already built, loading a navmesh never builds one by itself.)")
+      .def("clear_path_hierarchy", &PathFinder::clearPathHierarchy,
+           R"(Removes the path hierarchy.)")
+      .def_property_readonly("has_path_hierarchy",
+                             &PathFinder::hasPathHierarchy,
+                             R"(Whether a path hierarchy is built.)")
       // detailed docs in docs/docs.rst
       .def("closest_obstacle_surface_point",
            &PathFinder::closestObstacleSurfacePoint,
@@ -291,6 +502,24 @@ void initShortestPathBindings(py::module& m) {
            py::overload_cast<const core::RigidState&, const Mn::Vector3&>(
                &GreedyGeodesicFollowerImpl::findPath),
            py::return_value_policy::move)
+      .def("find_paths", &GreedyGeodesicFollowerImpl::findPaths, "starts"_a,
+           "ends"_a, "allow_sliding"_a = true, "num_threads"_a = 0,
+           py::call_guard<py::gil_scoped_release>(),
+           R"(Finds the paths of many (start state, end location) pairs in
+          parallel. Moves are simulated natively with the default agent
+          controls instead of calling back into python. Paths that can't be
+          found are empty.)")
+      .def_property("lattice_enabled",
+                    &GreedyGeodesicFollowerImpl::isLatticeEnabled,
+                    &GreedyGeodesicFollowerImpl::setLatticeEnabled,
+                    R"(Whether to plan on a lazily built lattice of poses that
+          memoizes the outcome of actions and geodesic distances across
+          queries. Assumes deterministic actions.)")
+      .def_property_readonly("lattice_size",
+                             &GreedyGeodesicFollowerImpl::getLatticeSize,
+                             R"(The number of poses explored in the lattice.)")
+      .def("clear_lattice", &GreedyGeodesicFollowerImpl::clearLattice,
+           R"(Discard the lattice, e.g. after the navmesh changed.)")
       .def("reset", &GreedyGeodesicFollowerImpl::reset);
 }
 
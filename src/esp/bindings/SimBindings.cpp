@@ -99,6 +99,9 @@ void initSimBindings(py::module& m) {
       .def_readwrite(
           "navmesh_settings", &SimulatorConfiguration::navMeshSettings,
           R"(Optionally provide a pre-configured NavMeshSettings. If provided, the NavMesh will be recomputed with the provided settings if: A. no NavMesh was loaded, or B. the loaded NavMesh's settings differ from the configured settings. If not provided, no NavMesh recompute will be done automatically.)")
+      .def_readwrite(
+          "memory_map_navmesh", &SimulatorConfiguration::memoryMapNavMesh,
+          R"(Memory map the scene's navmesh instead of reading it. Pages of the navmesh are shared between all simulators loading the same scene. Defaults to False)")
       .def_readwrite(
           "pbr_image_based_lighting",
           &SimulatorConfiguration::pbrImageBasedLighting,
@@ -132,6 +135,13 @@ void initSimBindings(py::module& m) {
       .def("seed", &Simulator::seed, "new_seed"_a)
       .def("reconfigure", &Simulator::reconfigure, "configuration"_a)
       .def("reset", &Simulator::reset)
+      .def(
+          "act_many",
+          py::overload_cast<const std::vector<scene::SceneNode*>&,
+                            const std::vector<int>&, const std::vector<float>&,
+                            const std::vector<bool>&>(&Simulator::actMany),
+          "nodes"_a, "action_ids"_a, "amounts"_a, "apply_filter"_a,
+          R"(Take the ObjectControls action action_ids[i], as returned by ObjectControls.get_action_id(), by amounts[i] on each of nodes in a single call. Moves with apply_filter[i] set are filtered by the NavMesh. Returns whether each move collided.)")
       .def(
           "close", &Simulator::close, "destroy"_a = true,
           R"(Free all loaded assets and GPU contexts. Use destroy=true except where noted in tutorials/async_rendering.py.)")
@@ -226,6 +236,10 @@ void initSimBindings(py::module& m) {
       .def(
           "step_world", &Simulator::stepWorld, "dt"_a = 1.0 / 60.0,
           R"(Step the physics simulation by a desired timestep (dt). Note that resulting world time after step may not be exactly t+dt. Use get_world_time to query current simulation time.)")
+      .def_static(
+          "step_worlds", &Simulator::stepWorlds, "simulators"_a, "pool"_a,
+          "dt"_a = 1.0 / 60.0,
+          R"(Step the physics simulations of several Simulators by dt in parallel on the threads of a habitat_sim.physics.PhysicsWorldPool. Each Simulator ends up in the same state as after its own step_world call. Returns the new world time of each Simulator.)")
       .def("get_world_time", &Simulator::getWorldTime,
            R"(Query the current simulation world time.)")
       .def("get_physics_time_step", &Simulator::getPhysicsTimeStep,
@@ -274,6 +288,14 @@ void initSimBindings(py::module& m) {
           "recompute_navmesh", &Simulator::recomputeNavMesh, "pathfinder"_a,
           "navmesh_settings"_a,
           R"(Recompute the NavMesh for a given PathFinder instance using configured NavMeshSettings.)")
+      .def(
+          "compute_navmesh_variants", &Simulator::computeNavMeshVariants,
+          "navmesh_settings"_a,
+          R"(Compute a NavMesh of the current scene per entry of navmesh_settings, rasterizing the scene once for all entries with the same cell_size, cell_height, agent_max_slope and agent_max_climb. Returns a new PathFinder per entry, None where the construction failed.)")
+      .def(
+          "update_navmesh_for_object", &Simulator::updateNavMeshForObject,
+          "object_id"_a,
+          R"(Update the NavMesh of the default PathFinder after a STATIC object was added, moved or removed. Only rebuilds the affected tiles if the NavMesh was computed with a non-zero NavMeshSettings.tile_size.)")
 
       .def(
           "add_trajectory_object",
@@ -30,6 +30,8 @@ typedef Matrix<uint32_t, 4, 1> Vector4ui;
 typedef Matrix<uint64_t, 4, 1> Vector4ul;
 
 typedef Matrix<float, Dynamic, Dynamic, RowMajor> RowMatrixXf;
+//! N x 3 points, one per row. Matches the layout of a numpy (N, 3) array.
+typedef Matrix<float, Dynamic, 3, RowMajor> RowMatrixX3f;
 
 //! Eigen JSON string format specification
 static const IOFormat kJsonFormat(StreamPrecision,
@@ -0,0 +1,81 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "MappedFile.h"
+
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/MurmurHash2.h>
+#include <Corrade/Utility/Path.h>
+#include <Corrade/configure.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#ifdef CORRADE_TARGET_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace esp {
+namespace core {
+
+std::shared_ptr<MappedFile> MappedFile::map(const std::string& path) {
+#ifdef CORRADE_TARGET_UNIX
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return nullptr;
+  }
+  const std::size_t size = st.st_size;
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after closing the descriptor
+  close(fd);
+  if (data == MAP_FAILED)
+    return nullptr;
+  return std::shared_ptr<MappedFile>(new MappedFile{data, size});
+#else
+  static_cast<void>(path);
+  return nullptr;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef CORRADE_TARGET_UNIX
+  munmap(data_, size_);
+#endif
+}
+
+std::uint64_t hashBytes(const void* data, std::size_t size) {
+  const auto digest = Corrade::Utility::MurmurHash2{}(
+      static_cast<const char*>(data), size);
+  std::uint64_t hash = 0;
+  std::memcpy(&hash, digest.byteArray(),
+              std::min(sizeof(hash), sizeof(digest)));
+  return hash;
+}
+
+bool writeFileAtomically(const std::string& path,
+                         Corrade::Containers::ArrayView<const char> data) {
+  const std::string tmpFile = Corrade::Utility::formatString(
+      "{}.{}.tmp", path, std::random_device{}());
+  if (Corrade::Utility::Path::write(tmpFile, data) &&
+      std::rename(tmpFile.c_str(), path.c_str()) == 0) {
+    return true;
+  }
+  if (Corrade::Utility::Path::exists(tmpFile)) {
+    Corrade::Utility::Path::remove(tmpFile);
+  }
+  return false;
+}
+
+}  // namespace core
+}  // namespace esp
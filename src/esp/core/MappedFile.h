@@ -0,0 +1,74 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_CORE_MAPPEDFILE_H_
+#define ESP_CORE_MAPPEDFILE_H_
+
+/** @file */
+
+#include <Corrade/Containers/ArrayView.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace esp {
+namespace core {
+
+/**
+ * @brief A private, writable memory mapping of a whole file.
+ *
+ * Writes are copy-on-write and never reach the file, so pages that are only
+ * read are shared between all processes mapping the same file.
+ */
+class MappedFile {
+ public:
+  /**
+   * @brief Map @p path.
+   *
+   * @return The mapping, nullptr on failure, for an empty file or on
+   * platforms without mmap.
+   */
+  static std::shared_ptr<MappedFile> map(const std::string& path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  char* data() const { return static_cast<char*>(data_); }
+  std::size_t size() const { return size_; }
+
+ private:
+  MappedFile(void* data, std::size_t size) : data_{data}, size_{size} {}
+
+  void* data_;
+  std::size_t size_;
+};
+
+/**
+ * @brief 64-bit MurmurHash2 of @p size bytes at @p data.
+ *
+ * Used to key on-disk caches by the content they were built from.
+ */
+std::uint64_t hashBytes(const void* data, std::size_t size);
+
+/**
+ * @brief Write @p data to @p path atomically.
+ *
+ * Writes under a unique temporary name next to @p path and renames it, so
+ * that processes reading or mapping @p path concurrently never see a
+ * partially written file.
+ *
+ * @return Whether the file was written. The temporary file is removed on
+ * failure.
+ */
+bool writeFileAtomically(const std::string& path,
+                         Corrade::Containers::ArrayView<const char> data);
+
+}  // namespace core
+}  // namespace esp
+
+#endif  // ESP_CORE_MAPPEDFILE_H_
@@ -0,0 +1,115 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace esp {
+namespace core {
+
+ThreadPool::ThreadPool(int numThreads) {
+  if (numThreads <= 0) {
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  // The calling thread is worker 0, so only spawn the remaining ones.
+  workers_.reserve(numThreads - 1);
+  for (int i = 1; i < numThreads; ++i) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exiting_ = true;
+  }
+  wakeWorkers_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::parallelFor(size_t count,
+                             const std::function<void(size_t, int)>& fn) {
+  if (count == 0) {
+    return;
+  }
+  // Nothing to distribute, skip the synchronization entirely.
+  if (workers_.empty() || count == 1) {
+    for (size_t i = 0; i < count; ++i) {
+      fn(i, 0);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> submitLock(submitMutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobFn_ = &fn;
+    jobCount_ = count;
+    nextIndex_.store(0);
+    jobException_ = nullptr;
+    activeWorkers_ = static_cast<int>(workers_.size());
+    ++jobGeneration_;
+  }
+  wakeWorkers_.notify_all();
+
+  runJob(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  jobDone_.wait(lock, [this]() { return activeWorkers_ == 0; });
+  jobFn_ = nullptr;
+  if (jobException_) {
+    std::exception_ptr e = jobException_;
+    jobException_ = nullptr;
+    std::rethrow_exception(e);
+  }
+}
+
+void ThreadPool::runJob(int threadIndex) {
+  for (size_t i = nextIndex_.fetch_add(1); i < jobCount_;
+       i = nextIndex_.fetch_add(1)) {
+    try {
+      (*jobFn_)(i, threadIndex);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!jobException_) {
+        jobException_ = std::current_exception();
+      }
+      // skip all remaining indices
+      nextIndex_.store(jobCount_);
+    }
+  }
+}
+
+void ThreadPool::workerLoop(int threadIndex) {
+  size_t seenGeneration = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wakeWorkers_.wait(lock, [this, seenGeneration]() {
+        return exiting_ || jobGeneration_ != seenGeneration;
+      });
+      if (exiting_) {
+        return;
+      }
+      seenGeneration = jobGeneration_;
+    }
+
+    runJob(threadIndex);
+
+    bool lastWorker = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      lastWorker = (--activeWorkers_ == 0);
+    }
+    if (lastWorker) {
+      jobDone_.notify_one();
+    }
+  }
+}
+
+}  // namespace core
+}  // namespace esp
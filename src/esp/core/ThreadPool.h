@@ -0,0 +1,100 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_CORE_THREADPOOL_H_
+#define ESP_CORE_THREADPOOL_H_
+
+/** @file */
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "esp/core/Esp.h"
+
+namespace esp {
+namespace core {
+
+/**
+ * @brief A fixed-size pool of worker threads for data-parallel loops.
+ *
+ * Workers are created once and then sleep until a job is submitted with @ref
+ * parallelFor. Indices of a job are handed out dynamically so that uneven work
+ * per index (e.g. short and long navmesh queries) is balanced across workers.
+ *
+ * The calling thread always participates as worker 0, so a pool constructed
+ * with a single thread runs everything inline without any synchronization.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param numThreads Total number of threads used by @ref parallelFor,
+   * including the calling thread. Values <= 0 use
+   * `std::thread::hardware_concurrency()`.
+   */
+  explicit ThreadPool(int numThreads = 0);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Total number of threads which may execute a job, including the
+   * calling thread.
+   */
+  int numThreads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  /**
+   * @brief Run @p fn for each index in [0, @p count) and block until all of
+   * them have finished.
+   *
+   * @p fn is called as `fn(index, threadIndex)` where `threadIndex` is in
+   * [0, @ref numThreads()) and is unique among the threads running
+   * concurrently, so it can be used to address per-thread scratch state.
+   *
+   * If any invocation throws, the remaining indices are skipped and the first
+   * exception is rethrown on the calling thread.
+   *
+   * @note Jobs submitted concurrently from several threads are serialized.
+   * Calling @ref parallelFor from inside @p fn is not supported.
+   */
+  void parallelFor(size_t count,
+                   const std::function<void(size_t, int)>& fn);
+
+ private:
+  void workerLoop(int threadIndex);
+  void runJob(int threadIndex);
+
+  std::vector<std::thread> workers_;
+
+  //! Serializes jobs submitted from different threads.
+  std::mutex submitMutex_;
+
+  std::mutex mutex_;
+  std::condition_variable wakeWorkers_;
+  std::condition_variable jobDone_;
+  //! Incremented for each new job, workers wake up when it changes.
+  size_t jobGeneration_ = 0;
+  //! Number of workers still busy with the current job.
+  int activeWorkers_ = 0;
+  bool exiting_ = false;
+
+  const std::function<void(size_t, int)>* jobFn_ = nullptr;
+  size_t jobCount_ = 0;
+  std::atomic<size_t> nextIndex_{0};
+  std::exception_ptr jobException_;
+
+  ESP_SMART_POINTERS(ThreadPool)
+};
+
+}  // namespace core
+}  // namespace esp
+
+#endif  // ESP_CORE_THREADPOOL_H_
@@ -92,6 +92,8 @@ ObjectAttributes::ObjectAttributes(const std::string& handle)
 
   setBoundingBoxCollisions(false);
   setJoinCollisionMeshes(false);
+  setCollisionHullMaxVertices(0);
+  setCollisionConvexDecomposition(false);
   // default to use material-derived shader unless otherwise specified in config
   // or instance config
   setShaderType(getShaderTypeName(ObjectInstanceShaderType::Material));
@@ -120,6 +122,8 @@ void ObjectAttributes::writeValuesToJsonInternal(
   writeValueToJson("inertia", jsonObj, allocator);
   writeValueToJson("semantic_id", jsonObj, allocator);
   writeValueToJson("join_collision_meshes", jsonObj, allocator);
+  writeValueToJson("collision_hull_max_vertices", jsonObj, allocator);
+  writeValueToJson("collision_convex_decomposition", jsonObj, allocator);
 
 }  // ObjectAttributes::writeValuesToJsonInternal
 
@@ -363,6 +363,24 @@ class ObjectAttributes : public AbstractObjectAttributes {
     return get<bool>("join_collision_meshes");
   }
 
+  // if > 0 simplify the convex collision hulls of the object to at most this
+  // many vertices each
+  void setCollisionHullMaxVertices(int collisionHullMaxVertices) {
+    set("collision_hull_max_vertices", collisionHullMaxVertices);
+  }
+  int getCollisionHullMaxVertices() const {
+    return get<int>("collision_hull_max_vertices");
+  }
+
+  // if true approximate each collision mesh component by several convex
+  // hulls instead of one. Ignored if collision meshes are joined.
+  void setCollisionConvexDecomposition(bool collisionConvexDecomposition) {
+    set("collision_convex_decomposition", collisionConvexDecomposition);
+  }
+  bool getCollisionConvexDecomposition() const {
+    return get<bool>("collision_convex_decomposition");
+  }
+
   void setSemanticId(int semanticId) { set("semantic_id", semanticId); }
 
   uint32_t getSemanticId() const { return get<int>("semantic_id"); }
@@ -15,6 +15,7 @@ PhysicsManagerAttributes::PhysicsManagerAttributes(const std::string& handle)
   setGravity({0, -9.8, 0});
   setFrictionCoefficient(0.4);
   setRestitutionCoefficient(0.1);
+  setBvhCacheDirectory("");
 }  // PhysicsManagerAttributes ctor
 
 void PhysicsManagerAttributes::writeValuesToJson(
@@ -25,6 +26,7 @@ void PhysicsManagerAttributes::writeValuesToJson(
   writeValueToJson("gravity", jsonObj, allocator);
   writeValueToJson("friction_coefficient", jsonObj, allocator);
   writeValueToJson("restitution_coefficient", jsonObj, allocator);
+  writeValueToJson("bvh_cache_directory", jsonObj, allocator);
 }  // PhysicsManagerAttributes::writeValuesToJson
 
 }  // namespace attributes
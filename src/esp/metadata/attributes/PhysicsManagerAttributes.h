@@ -73,6 +73,21 @@ class PhysicsManagerAttributes : public AbstractAttributes {
     return get<double>("restitution_coefficient");
   }
 
+  /**
+   * @brief Set the directory caching the BVHs of static stage collision
+   * meshes between loads and processes. Empty disables the cache.
+   */
+  void setBvhCacheDirectory(const std::string& bvhCacheDirectory) {
+    set("bvh_cache_directory", bvhCacheDirectory);
+  }
+  /**
+   * @brief Get the directory caching the BVHs of static stage collision
+   * meshes between loads and processes. Empty if the cache is disabled.
+   */
+  std::string getBvhCacheDirectory() const {
+    return get<std::string>("bvh_cache_directory");
+  }
+
   /**
    * @brief Populate a json object with all the first-level values held in this
    * configuration.  Default is overridden to handle special cases for
@@ -106,6 +106,20 @@ void ObjectAttributesManager::setValsFromJSONDoc(
       [objAttributes](bool join_collision_meshes) {
         objAttributes->setJoinCollisionMeshes(join_collision_meshes);
       });
+  // Simplify collision hulls to a max vertex count if specified
+  io::jsonIntoSetter<int>(
+      jsonConfig, "collision_hull_max_vertices",
+      [objAttributes](int collision_hull_max_vertices) {
+        objAttributes->setCollisionHullMaxVertices(
+            collision_hull_max_vertices);
+      });
+  // Decompose collision meshes into convex parts if specified
+  io::jsonIntoSetter<bool>(
+      jsonConfig, "collision_convex_decomposition",
+      [objAttributes](bool collision_convex_decomposition) {
+        objAttributes->setCollisionConvexDecomposition(
+            collision_convex_decomposition);
+      });
 
   // The object's interia matrix diagonal
   io::jsonIntoConstSetter<Magnum::Vector3>(
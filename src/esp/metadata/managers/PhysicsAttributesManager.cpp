@@ -68,6 +68,13 @@ void PhysicsAttributesManager::setValsFromJSONDoc(
             restitution_coefficient);
       });
 
+  // load the stage collision BVH cache directory
+  io::jsonIntoConstSetter<std::string>(
+      jsonConfig, "bvh_cache_directory",
+      [physicsManagerAttributes](const std::string& bvh_cache_directory) {
+        physicsManagerAttributes->setBvhCacheDirectory(bvh_cache_directory);
+      });
+
   // load world gravity
   io::jsonIntoConstSetter<Magnum::Vector3>(
       jsonConfig, "gravity",
@@ -5,11 +5,18 @@
 
 #include "esp/nav/GreedyFollower.h"
 
+#include <Corrade/Utility/Assert.h>
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
 #include <Magnum/EigenIntegration/Integration.h>
 
+#include <cmath>
+#include <cstring>
+#include <memory>
+
 #include "esp/core/Esp.h"
+#include "esp/core/ThreadPool.h"
 #include "esp/geo/Geo.h"
+#include "esp/scene/ObjectControls.h"
 
 namespace Mn = Magnum;
 using Mn::EigenIntegration::cast;
@@ -17,6 +24,9 @@ using Mn::EigenIntegration::cast;
 namespace esp {
 namespace nav {
 
+constexpr float GreedyGeodesicFollowerImpl::LatticePositionResolution;
+constexpr float GreedyGeodesicFollowerImpl::LatticeRotationResolution;
+
 GreedyGeodesicFollowerImpl::GreedyGeodesicFollowerImpl(
     PathFinder::ptr& pathfinder,
     MoveFn& moveForward,
@@ -37,14 +47,65 @@ GreedyGeodesicFollowerImpl::GreedyGeodesicFollowerImpl(
       fixThrashing_{fixThrashing},
       thrashingThreshold_{thrashingThreshold} {};
 
+// One follower per findPaths thread, each with its own dummy scene, query
+// context and controls. The moves are filtered the same way as an agent's
+// controls and report a collision when the filter shortened the move, like the
+// python agent does.
+struct GreedyGeodesicFollowerImpl::FindPathsWorker {
+  PathFinderQueryContext::ptr queryContext;
+  scene::ObjectControls::ptr controls;
+  bool collided = false;
+  GreedyGeodesicFollowerImpl::ptr follower;
+};
+
+GreedyGeodesicFollowerImpl::~GreedyGeodesicFollowerImpl() = default;
+
+GreedyGeodesicFollowerImpl::PositionDistances*
+GreedyGeodesicFollowerImpl::cachedDistances(const Mn::Vector3& pt) {
+  if (!cacheDistances_)
+    return nullptr;
+
+  PositionKey key;
+  std::memcpy(key.bits, pt.data(), sizeof(key.bits));
+  return &distanceCache_[key];
+}
+
 float GreedyGeodesicFollowerImpl::geoDist(const Mn::Vector3& start,
                                           const Mn::Vector3& end) {
+  PositionDistances* cached = cachedDistances(start);
+  if (cached && !std::isnan(cached->geodesicDistance))
+    return cached->geodesicDistance;
+
   geoDistPath_.requestedStart = cast<vec3f>(start);
   geoDistPath_.requestedEnd = cast<vec3f>(end);
-  pathfinder_->findPath(geoDistPath_);
+  if (queryContext_)
+    queryContext_->findPath(geoDistPath_);
+  else
+    pathfinder_->findPath(geoDistPath_);
+
+  if (cached)
+    cached->geodesicDistance = geoDistPath_.geodesicDistance;
   return geoDistPath_.geodesicDistance;
 }
 
+float GreedyGeodesicFollowerImpl::distanceToClosestObstacle(
+    const Mn::Vector3& pt) {
+  PositionDistances* cached = cachedDistances(pt);
+  if (cached && !std::isnan(cached->distanceToClosestObstacle))
+    return cached->distanceToClosestObstacle;
+
+  const float maxSearchRadius = 1.1 * closeToObsThreshold_;
+  const float dist =
+      queryContext_ ? queryContext_->distanceToClosestObstacle(
+                          cast<vec3f>(pt), maxSearchRadius)
+                    : pathfinder_->distanceToClosestObstacle(cast<vec3f>(pt),
+                                                             maxSearchRadius);
+
+  if (cached)
+    cached->distanceToClosestObstacle = dist;
+  return dist;
+}
+
 GreedyGeodesicFollowerImpl::TryStepResult GreedyGeodesicFollowerImpl::tryStep(
     const scene::SceneNode& node,
     const Mn::Vector3& end) {
@@ -55,17 +116,15 @@ GreedyGeodesicFollowerImpl::TryStepResult GreedyGeodesicFollowerImpl::tryStep(
   const Mn::Vector3 newPose = tryStepDummyNode_.MagnumObject::translation();
 
   const float geoDistAfter = geoDist(newPose, end);
-  const float distToObsAfter = pathfinder_->distanceToClosestObstacle(
-      cast<vec3f>(newPose), 1.1 * closeToObsThreshold_);
+  const float distToObsAfter = distanceToClosestObstacle(newPose);
 
   return {geoDistAfter, distToObsAfter, didCollide};
 }
 
-float GreedyGeodesicFollowerImpl::computeReward(const scene::SceneNode& node,
-                                                const ShortestPath& path,
-                                                const size_t primLen) {
-  const auto tryStepRes = tryStep(node, Mn::Vector3{path.requestedEnd});
-
+float GreedyGeodesicFollowerImpl::computeReward(
+    const TryStepResult& tryStepRes,
+    const ShortestPath& path,
+    const size_t primLen) {
   // Try to minimize geodesic distance to target
   // Divide by forwardAmount_ to make the reward structure independent of step
   // size
@@ -98,17 +157,28 @@ GreedyGeodesicFollowerImpl::nextBestPrimAlong(const core::RigidState& state,
   float bestReward = -collisionCost_;
   std::vector<CODES> bestPrim, leftPrim, rightPrim;
 
-  leftDummyNode_.setTranslation(state.translation);
-  leftDummyNode_.setRotation(state.rotation);
+  const Mn::Vector3 end{path.requestedEnd};
+  int leftNode = ID_UNDEFINED, rightNode = ID_UNDEFINED, goal = ID_UNDEFINED;
+  if (latticeEnabled_) {
+    leftNode = rightNode = latticeNode(
+        Mn::Matrix4::from(state.rotation.toMatrix(), state.translation));
+    goal = latticeGoal(end);
+  } else {
+    leftDummyNode_.setTranslation(state.translation);
+    leftDummyNode_.setRotation(state.rotation);
 
-  rightDummyNode_.setTranslation(state.translation);
-  rightDummyNode_.setRotation(state.rotation);
+    rightDummyNode_.setTranslation(state.translation);
+    rightDummyNode_.setRotation(state.rotation);
+  }
 
   // Plan over all primitives of the form [LEFT] * n + [FORWARD]
   // or [RIGHT] * n + [FORWARD]
   for (float angle = 0; angle < M_PI; angle += turnAmount_) {
     {
-      const float reward = computeReward(leftDummyNode_, path, leftPrim.size());
+      const float reward =
+          computeReward(latticeEnabled_ ? latticeTryStep(leftNode, goal)
+                                        : tryStep(leftDummyNode_, end),
+                        path, leftPrim.size());
       if (reward > bestReward) {
         bestReward = reward;
         bestPrim = leftPrim;
@@ -118,7 +188,9 @@ GreedyGeodesicFollowerImpl::nextBestPrimAlong(const core::RigidState& state,
 
     {
       const float reward =
-          computeReward(rightDummyNode_, path, rightPrim.size());
+          computeReward(latticeEnabled_ ? latticeTryStep(rightNode, goal)
+                                        : tryStep(rightDummyNode_, end),
+                        path, rightPrim.size());
       if (reward > bestReward) {
         bestReward = reward;
         bestPrim = rightPrim;
@@ -132,10 +204,14 @@ GreedyGeodesicFollowerImpl::nextBestPrimAlong(const core::RigidState& state,
       break;
 
     leftPrim.emplace_back(CODES::LEFT);
-    turnLeft_(&leftDummyNode_);
-
     rightPrim.emplace_back(CODES::RIGHT);
-    turnRight_(&rightDummyNode_);
+    if (latticeEnabled_) {
+      leftNode = latticeSuccessor(leftNode, CODES::LEFT);
+      rightNode = latticeSuccessor(rightNode, CODES::RIGHT);
+    } else {
+      turnLeft_(&leftDummyNode_);
+      turnRight_(&rightDummyNode_);
+    }
   }
 
   return bestPrim;
@@ -196,18 +272,42 @@ GreedyGeodesicFollowerImpl::findPath(const core::RigidState& start,
   findPathDummyNode_.setTranslation(Mn::Vector3{start.translation});
   findPathDummyNode_.setRotation(Mn::Quaternion{start.rotation});
 
+  // The end is fixed and the navmesh can't change until we return, so the
+  // distances from every pose visited while planning can be reused
+  distanceCache_.clear();
+  cacheDistances_ = true;
+
+  // On the lattice the poses are followed through the memoized actions
+  int node = ID_UNDEFINED, goal = ID_UNDEFINED;
+  if (latticeEnabled_) {
+    node = latticeNode(findPathDummyNode_.MagnumObject::transformation());
+    goal = latticeGoal(end);
+  }
+
   do {
+    if (latticeEnabled_) {
+      findPathDummyNode_.MagnumObject::setTransformation(
+          latticeNodes_[node].transformation);
+    }
     core::RigidState state{findPathDummyNode_.rotation(),
                            findPathDummyNode_.MagnumObject::translation()};
     ShortestPath path;
     path.requestedStart = cast<vec3f>(state.translation);
     path.requestedEnd = cast<vec3f>(end);
-    pathfinder_->findPath(path);
+    path.geodesicDistance = latticeEnabled_ ? latticeGeoDist(node, goal)
+                                            : geoDist(state.translation, end);
     const auto nextPrim = nextBestPrimAlong(state, path);
     if (nextPrim.empty()) {
       actions_.emplace_back(CODES::ERROR);
     } else {
       for (const auto nextAction : nextPrim) {
+        if (latticeEnabled_) {
+          if (nextAction != CODES::STOP && nextAction != CODES::ERROR)
+            node = latticeSuccessor(node, nextAction);
+          actions_.emplace_back(nextAction);
+          continue;
+        }
+
         switch (nextAction) {
           case CODES::FORWARD:
             moveForward_(&findPathDummyNode_);
@@ -232,6 +332,9 @@ GreedyGeodesicFollowerImpl::findPath(const core::RigidState& start,
   } while (actions_.back() != CODES::STOP && actions_.back() != CODES::ERROR &&
            actions_.size() < maxActions);
 
+  cacheDistances_ = false;
+  distanceCache_.clear();
+
   if (actions_.back() == CODES::ERROR)
     return {};
 
@@ -255,9 +358,194 @@ GreedyGeodesicFollowerImpl::findPath(const Mn::Quaternion& currentRot,
   return findPath({currentRot, currentPos}, end);
 }
 
+std::vector<std::vector<GreedyGeodesicFollowerImpl::CODES>>
+GreedyGeodesicFollowerImpl::findPaths(
+    const std::vector<core::RigidState>& starts,
+    const std::vector<Mn::Vector3>& ends,
+    bool allowSliding,
+    int numThreads) {
+  ESP_CHECK(starts.size() == ends.size(),
+            "GreedyGeodesicFollowerImpl::findPaths : Got" << starts.size()
+                << "start states but" << ends.size() << "end locations.");
+
+  if (!findPathsPool_ || numThreads != findPathsNumThreads_) {
+    findPathsPool_ = std::make_unique<core::ThreadPool>(numThreads);
+    findPathsNumThreads_ = numThreads;
+    findPathsWorkers_.clear();
+  }
+  // The workers' query contexts are snapshots of the navmesh and their
+  // lattices memoize moves, so both have to follow the navmesh and the moves
+  if (pathfinder_->getQueryStateVersion() != findPathsQueryStateVersion_ ||
+      allowSliding != findPathsAllowSliding_) {
+    findPathsWorkers_.clear();
+  }
+  if (findPathsWorkers_.empty()) {
+    findPathsQueryStateVersion_ = pathfinder_->getQueryStateVersion();
+    findPathsAllowSliding_ = allowSliding;
+    const float turnDegrees = float(Mn::Degd{Mn::Radd{turnAmount_}});
+    for (int i = 0; i < findPathsPool_->numThreads(); ++i) {
+      auto worker = std::make_unique<FindPathsWorker>();
+      FindPathsWorker* w = worker.get();
+      w->queryContext = pathfinder_->createQueryContext();
+      w->controls = scene::ObjectControls::create();
+      w->controls->setMoveFilterFunction([w, allowSliding](const vec3f& start,
+                                                           const vec3f& end) {
+        const vec3f filteredEnd =
+            allowSliding ? w->queryContext->tryStep(start, end)
+                         : w->queryContext->tryStepNoSliding(start, end);
+        constexpr float EPS = 1e-5;
+        w->collided = (filteredEnd - start).squaredNorm() + EPS <
+                      (end - start).squaredNorm();
+        return filteredEnd;
+      });
+
+      const float forwardAmount = forwardAmount_;
+      MoveFn moveForward = [w, forwardAmount](scene::SceneNode* node) {
+        w->controls->action(*node, "moveForward", forwardAmount);
+        return w->collided;
+      };
+      MoveFn turnLeft = [w, turnDegrees](scene::SceneNode* node) {
+        w->controls->action(*node, "turnLeft", turnDegrees, false);
+        return false;
+      };
+      MoveFn turnRight = [w, turnDegrees](scene::SceneNode* node) {
+        w->controls->action(*node, "turnRight", turnDegrees, false);
+        return false;
+      };
+      w->follower = GreedyGeodesicFollowerImpl::create(
+          pathfinder_, moveForward, turnLeft, turnRight, goalDist_,
+          forwardAmount_, turnAmount_, fixThrashing_, thrashingThreshold_);
+      w->follower->queryContext_ = w->queryContext;
+      findPathsWorkers_.emplace_back(std::move(worker));
+    }
+  }
+  for (const auto& worker : findPathsWorkers_) {
+    worker->follower->setLatticeEnabled(latticeEnabled_);
+  }
+
+  std::vector<std::vector<CODES>> paths(starts.size());
+  findPathsPool_->parallelFor(starts.size(), [&](size_t i, int threadIndex) {
+    GreedyGeodesicFollowerImpl& follower =
+        *findPathsWorkers_[threadIndex]->follower;
+    follower.reset();
+    paths[i] = follower.findPath(starts[i], ends[i]);
+  });
+
+  return paths;
+}
+
+void GreedyGeodesicFollowerImpl::setLatticeEnabled(bool enabled) {
+  latticeEnabled_ = enabled;
+}
+
+void GreedyGeodesicFollowerImpl::clearLattice() {
+  findPathsWorkers_.clear();
+  latticeNodes_.clear();
+  latticeNodeIds_.clear();
+  latticeGoals_.clear();
+  latticeGoalIds_.clear();
+  latticeGeodesicDistances_.clear();
+}
+
+int GreedyGeodesicFollowerImpl::latticeNode(
+    const Mn::Matrix4& transformation) {
+  LatticeKey key;
+  const Mn::Matrix3x3 rotation = transformation.rotationScaling();
+  for (int col = 0; col < 3; ++col) {
+    for (int row = 0; row < 3; ++row) {
+      key.cells[col * 3 + row] =
+          std::lround(rotation[col][row] / LatticeRotationResolution);
+    }
+    key.cells[9 + col] = std::lround(transformation.translation()[col] /
+                                     LatticePositionResolution);
+  }
+
+  const auto inserted = latticeNodeIds_.emplace(key, int(latticeNodes_.size()));
+  if (inserted.second) {
+    latticeNodes_.emplace_back();
+    latticeNodes_.back().transformation = transformation;
+  }
+  return inserted.first->second;
+}
+
+int GreedyGeodesicFollowerImpl::latticeSuccessor(int node, CODES action) {
+  const auto successor = [&]() -> int& {
+    LatticeNode& latticeNode = latticeNodes_[node];
+    return action == CODES::FORWARD ? latticeNode.forward
+           : action == CODES::LEFT  ? latticeNode.left
+                                    : latticeNode.right;
+  };
+  if (successor() != ID_UNDEFINED)
+    return successor();
+
+  tryStepDummyNode_.MagnumObject::setTransformation(
+      latticeNodes_[node].transformation);
+  bool didCollide = false;
+  switch (action) {
+    case CODES::FORWARD:
+      didCollide = moveForward_(&tryStepDummyNode_);
+      break;
+
+    case CODES::LEFT:
+      turnLeft_(&tryStepDummyNode_);
+      break;
+
+    case CODES::RIGHT:
+      turnRight_(&tryStepDummyNode_);
+      break;
+
+    default:
+      CORRADE_INTERNAL_ASSERT_UNREACHABLE();
+  }
+
+  // Adding the successor can reallocate the nodes, look the node up again
+  const int next =
+      latticeNode(tryStepDummyNode_.MagnumObject::transformation());
+  successor() = next;
+  if (action == CODES::FORWARD)
+    latticeNodes_[node].forwardCollided = didCollide;
+  return next;
+}
+
+int GreedyGeodesicFollowerImpl::latticeGoal(const Mn::Vector3& end) {
+  PositionKey key;
+  std::memcpy(key.bits, end.data(), sizeof(key.bits));
+  const auto inserted = latticeGoalIds_.emplace(key, int(latticeGoals_.size()));
+  if (inserted.second)
+    latticeGoals_.push_back(end);
+  return inserted.first->second;
+}
+
+float GreedyGeodesicFollowerImpl::latticeGeoDist(int node, int goal) {
+  const uint64_t key = uint64_t(node) << 32 | uint64_t(goal);
+  const auto found = latticeGeodesicDistances_.find(key);
+  if (found != latticeGeodesicDistances_.end())
+    return found->second;
+
+  const float dist = geoDist(latticeNodes_[node].transformation.translation(),
+                             latticeGoals_[goal]);
+  latticeGeodesicDistances_.emplace(key, dist);
+  return dist;
+}
+
+GreedyGeodesicFollowerImpl::TryStepResult
+GreedyGeodesicFollowerImpl::latticeTryStep(int node, int goal) {
+  const int next = latticeSuccessor(node, CODES::FORWARD);
+  LatticeNode& nextNode = latticeNodes_[next];
+  if (std::isnan(nextNode.distanceToClosestObstacle)) {
+    nextNode.distanceToClosestObstacle =
+        distanceToClosestObstacle(nextNode.transformation.translation());
+  }
+
+  return {latticeGeoDist(next, goal), nextNode.distanceToClosestObstacle,
+          latticeNodes_[node].forwardCollided};
+}
+
 void GreedyGeodesicFollowerImpl::reset() {
   actions_.clear();
   thrashingActions_.clear();
+  cacheDistances_ = false;
+  distanceCache_.clear();
 }
 
 }  // namespace nav
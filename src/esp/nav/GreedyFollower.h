@@ -5,6 +5,13 @@
 #ifndef ESP_NAV_GREEDYFOLLOWER_H_
 #define ESP_NAV_GREEDYFOLLOWER_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "esp/core/Esp.h"
 #include "esp/core/RigidState.h"
 #include "esp/nav/PathFinder.h"
@@ -12,6 +19,9 @@
 #include "esp/scene/SceneNode.h"
 
 namespace esp {
+namespace core {
+class ThreadPool;
+}
 namespace nav {
 
 /**
@@ -81,6 +91,8 @@ class GreedyGeodesicFollowerImpl {
                              bool fixThrashing = true,
                              int thrashingThreshold = 16);
 
+  ~GreedyGeodesicFollowerImpl();
+
   /**
    * @brief Calculates the next action to follow the path
    *
@@ -112,6 +124,76 @@ class GreedyGeodesicFollowerImpl {
   std::vector<CODES> findPath(const core::RigidState& start,
                               const Magnum::Vector3& end);
 
+  /**
+   * @brief Finds the full paths for many start states and end locations in
+   * parallel
+   *
+   * Same as calling @ref reset and @ref findPath for each pair. Each thread
+   * has its own @ref PathFinderQueryContext and dummy scene nodes.
+   *
+   * The move functions passed to the constructor usually call back into
+   * python, so they can't run in parallel. Moves are simulated natively
+   * instead. They match an agent's default `move_forward`, `turn_left` and
+   * `turn_right` controls filtered with @ref PathFinder::tryStep, or with
+   * @ref PathFinder::tryStepNoSliding if @p allowSliding is false. For such
+   * an agent the actions are identical to @ref findPath. If the lattice is
+   * enabled, each thread plans on a lattice of its own.
+   *
+   * The threads and their followers are kept for later calls, together with
+   * their lattices, until @ref clearLattice is called or the navmesh,
+   * @p allowSliding or @p numThreads change.
+   *
+   * @param[in] starts The start state of each path
+   * @param[in] ends The end location of each path
+   * @param[in] allowSliding Whether moves slide along obstacles
+   * @param[in] numThreads The number of threads, including the calling
+   *                       thread. Values <= 0 use the hardware concurrency.
+   *
+   * @return The actions of each path, empty where @ref findPath would fail.
+   */
+  std::vector<std::vector<CODES>> findPaths(
+      const std::vector<core::RigidState>& starts,
+      const std::vector<Magnum::Vector3>& ends,
+      bool allowSliding = true,
+      int numThreads = 0);
+
+  /**
+   * @brief Enable or disable planning on a lattice of poses.
+   *
+   * With discrete actions and no actuation noise the agent only visits the
+   * poses reachable from its start by "move_forward", "turn_left" and
+   * "turn_right". The lattice is a graph of those poses, built lazily, that
+   * memoizes the outcome of each action from a pose, the distance to the
+   * closest obstacle of a pose and the geodesic distance from a pose to each
+   * goal. The graph is kept across calls, so later queries in the same scene
+   * reuse the states explored by earlier ones.
+   *
+   * Poses are hashed after rounding positions to @ref LatticePositionResolution
+   * and rotation matrix entries to @ref LatticeRotationResolution, which
+   * absorbs the floating point error of turning back and forth. Actions are
+   * assumed to be deterministic. Call @ref clearLattice if the navmesh or the
+   * move functions change.
+   */
+  void setLatticeEnabled(bool enabled);
+
+  /** @brief Whether planning on a lattice of poses is enabled. */
+  bool isLatticeEnabled() const { return latticeEnabled_; }
+
+  /**
+   * @brief Discard the poses, actions and distances of the lattice, and the
+   * followers of @ref findPaths with their lattices.
+   */
+  void clearLattice();
+
+  /** @brief The number of poses explored in the lattice so far. */
+  size_t getLatticeSize() const { return latticeNodes_.size(); }
+
+  //! Lattice poses closer than this (in meters) are the same.
+  static constexpr float LatticePositionResolution = 1e-4f;
+  //! Lattice rotations closer than this in each entry of their rotation
+  //! matrix are the same.
+  static constexpr float LatticeRotationResolution = 1e-5f;
+
   /**
    * @brief Reset the planner.
    *
@@ -138,8 +220,54 @@ class GreedyGeodesicFollowerImpl {
       rightDummyNode_{dummyScene_.getRootNode()},
       tryStepDummyNode_{dummyScene_.getRootNode()};
 
+  //! Queries of a @ref findPaths worker, which runs on its own thread. Null
+  //! otherwise, pathfinder_ is queried directly.
+  PathFinderQueryContext::ptr queryContext_ = nullptr;
+
+  //! Thread pool of @ref findPaths and a follower for each of its threads,
+  //! created on first use. The workers are dropped with the lattice and
+  //! recreated when the state they were set up for changes.
+  struct FindPathsWorker;
+  std::unique_ptr<core::ThreadPool> findPathsPool_;
+  std::vector<std::unique_ptr<FindPathsWorker>> findPathsWorkers_;
+  int findPathsNumThreads_ = 0;
+  bool findPathsAllowSliding_ = true;
+  uint64_t findPathsQueryStateVersion_ = 0;
+
   ShortestPath geoDistPath_;
   float geoDist(const Magnum::Vector3& start, const Magnum::Vector3& end);
+  float distanceToClosestObstacle(const Magnum::Vector3& pt);
+
+  //! Distances from a visited position, NaN until computed.
+  struct PositionDistances {
+    float geodesicDistance = std::numeric_limits<float>::quiet_NaN();
+    float distanceToClosestObstacle = std::numeric_limits<float>::quiet_NaN();
+  };
+  //! Exact bit pattern of a position, so that only identical positions share
+  //! cached distances and the planned actions don't change.
+  struct PositionKey {
+    uint32_t bits[3];
+    bool operator==(const PositionKey& other) const {
+      return bits[0] == other.bits[0] && bits[1] == other.bits[1] &&
+             bits[2] == other.bits[2];
+    }
+  };
+  struct PositionKeyHash {
+    size_t operator()(const PositionKey& key) const {
+      return (size_t(key.bits[0]) * 73856093) ^
+             (size_t(key.bits[1]) * 19349663) ^
+             (size_t(key.bits[2]) * 83492791);
+    }
+  };
+  //! Distances from the positions visited by the running @ref findPath, which
+  //! revisits the same poses while trying the primitives of each step. Only
+  //! used within a @ref findPath call, during which neither the end nor the
+  //! navmesh can change.
+  bool cacheDistances_ = false;
+  std::unordered_map<PositionKey, PositionDistances, PositionKeyHash>
+      distanceCache_;
+  //! The cached distances of @p pt, nullptr if not caching.
+  PositionDistances* cachedDistances(const Magnum::Vector3& pt);
 
   struct TryStepResult {
     float postGeodesicDistance, postDistanceToClosestObstacle;
@@ -149,10 +277,52 @@ class GreedyGeodesicFollowerImpl {
   TryStepResult tryStep(const scene::SceneNode& node,
                         const Magnum::Vector3& end);
 
-  float computeReward(const scene::SceneNode& node,
+  float computeReward(const TryStepResult& tryStepRes,
                       const nav::ShortestPath& path,
                       size_t primLen);
 
+  //! A pose of the lattice and the memoized outcomes of the actions from it,
+  //! ID_UNDEFINED or NaN until computed.
+  struct LatticeNode {
+    Magnum::Matrix4 transformation;
+    int forward = ID_UNDEFINED, left = ID_UNDEFINED, right = ID_UNDEFINED;
+    bool forwardCollided = false;
+    float distanceToClosestObstacle = std::numeric_limits<float>::quiet_NaN();
+  };
+  //! A rounded pose, 9 rotation matrix entries followed by the translation.
+  struct LatticeKey {
+    int32_t cells[12];
+    bool operator==(const LatticeKey& other) const {
+      return std::equal(cells, cells + 12, other.cells);
+    }
+  };
+  struct LatticeKeyHash {
+    size_t operator()(const LatticeKey& key) const {
+      size_t hash = 0;
+      for (const int32_t cell : key.cells) {
+        hash = hash * 1000003 ^ size_t(uint32_t(cell));
+      }
+      return hash;
+    }
+  };
+  bool latticeEnabled_ = false;
+  std::vector<LatticeNode> latticeNodes_;
+  std::unordered_map<LatticeKey, int, LatticeKeyHash> latticeNodeIds_;
+  std::vector<Magnum::Vector3> latticeGoals_;
+  std::unordered_map<PositionKey, int, PositionKeyHash> latticeGoalIds_;
+  //! Geodesic distances, keyed by node index in the high and goal index in
+  //! the low 32 bits.
+  std::unordered_map<uint64_t, float> latticeGeodesicDistances_;
+
+  //! The lattice node of a pose, added if it wasn't visited yet.
+  int latticeNode(const Magnum::Matrix4& transformation);
+  //! The lattice node reached by taking @p action from @p node.
+  int latticeSuccessor(int node, CODES action);
+  //! The index of an end location among the lattice goals.
+  int latticeGoal(const Magnum::Vector3& end);
+  float latticeGeoDist(int node, int goal);
+  TryStepResult latticeTryStep(int node, int goal);
+
   bool isThrashing();
 
   std::vector<nav::GreedyGeodesicFollowerImpl::CODES> nextBestPrimAlong(
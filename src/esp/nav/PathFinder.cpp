@@ -3,9 +3,14 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "PathFinder.h"
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <numeric>
+#include <mutex>
+#include <queue>
 #include <stack>
+#include <thread>
 #include <unordered_map>
 
 #include <Magnum/Magnum.h>
@@ -15,7 +20,9 @@
 #include <Magnum/EigenIntegration/Integration.h>
 
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/Path.h>
+#include <Corrade/Utility/String.h>
 
 #include <cstdio>
 // NOLINTNEXTLINE
@@ -26,6 +33,9 @@
 
 #include "esp/assets/MeshData.h"
 #include "esp/core/Esp.h"
+#include "esp/core/MappedFile.h"
+#include "esp/core/Random.h"
+#include "esp/core/ThreadPool.h"
 
 #include "DetourNavMesh.h"
 #include "DetourNavMeshBuilder.h"
@@ -34,6 +44,7 @@
 #include "Recast.h"
 
 #include <rapidjson/document.h>
+
 #include "esp/core/Check.h"
 #include "esp/io/Json.h"
 #include "esp/io/JsonAllTypes.h"
@@ -54,7 +65,8 @@ bool operator==(const NavMeshSettings& a, const NavMeshSettings& b) {
          CLOSE(edgeMaxError) && CLOSE(vertsPerPoly) &&
          CLOSE(detailSampleDist) && CLOSE(detailSampleMaxError) &&
          EQ(filterLowHangingObstacles) && EQ(filterLedgeSpans) &&
-         EQ(filterWalkableLowHeightSpans) && EQ(includeStaticObjects);
+         EQ(filterWalkableLowHeightSpans) && EQ(includeStaticObjects) &&
+         EQ(tileSize);
 
 #undef CLOSE
 #undef EQ
@@ -102,6 +114,13 @@ struct MultiGoalShortestPath::Impl {
 
   std::vector<float> minTheoreticalDist;
   vec3f prevRequestedStart = vec3f::Zero();
+
+  //! Search from all requested ends, see
+  //! @ref MultiGoalShortestPath::useDistanceField, and the spacing it was
+  //! computed with. Computed on first use and again if the navmesh or the
+  //! spacing change.
+  GeodesicDistanceField::ptr distanceField;
+  float distanceFieldSpacing = 0;
 };
 
 MultiGoalShortestPath::MultiGoalShortestPath()
@@ -110,8 +129,10 @@ MultiGoalShortestPath::MultiGoalShortestPath()
 void MultiGoalShortestPath::setRequestedEnds(
     const std::vector<vec3f>& newEnds) {
   pimpl_->endRefs.clear();
+  pimpl_->endIsValid.clear();
   pimpl_->pathEnds.clear();
   pimpl_->requestedEnds = newEnds;
+  pimpl_->distanceField = nullptr;
 
   pimpl_->minTheoreticalDist.assign(newEnds.size(), 0);
 }
@@ -121,6 +142,16 @@ const std::vector<vec3f>& MultiGoalShortestPath::getRequestedEnds() const {
 }
 
 namespace {
+struct NavMeshDeleter {
+  //! Backing storage of tiles added without DT_TILE_FREE_DATA, if any. Freed
+  //! together with the navmesh.
+  std::shared_ptr<core::MappedFile> mapping;
+  void operator()(dtNavMesh* mesh) { dtFreeNavMesh(mesh); }
+};
+struct NavQueryDeleter {
+  void operator()(dtNavMeshQuery* query) { dtFreeNavMeshQuery(query); }
+};
+
 template <typename T>
 std::tuple<dtStatus, dtPolyRef, vec3f> projectToPoly(
     const T& pt,
@@ -143,34 +174,62 @@ std::tuple<dtStatus, dtPolyRef, vec3f> projectToPoly(
 
   return std::make_tuple(status, polyRef, polyXYZ);
 }
-}  // namespace
 
-namespace impl {
-// some systems lack this typedef (e.g. emscripten build)
-typedef unsigned short int ushort;  // NOLINT
+//! Obstacle distances sampled on a regular XZ grid over one island.
+struct ObstacleGrid {
+  //! Position of the first node.
+  float minX = 0;
+  float minZ = 0;
+  //! Number of nodes along X and Z.
+  int width = 0;
+  int depth = 0;
+  //! Distance to the closest obstacle and navmesh height at each node, row
+  //! major in Z. NaN where the node isn't on exactly one level of the island.
+  std::vector<float> distances;
+  std::vector<float> heights;
+};
 
-//! (flag & flag) operator wrapper for function pointers
-inline ushort andFlag(ushort curFlags, ushort flag) {
-  return curFlags & flag;
-}
-//! (flag | flag) operator wrapper for function pointers
-inline ushort orFlag(ushort curFlags, ushort flag) {
-  return curFlags | flag;
-}
+//! A 2.5D obstacle distance field, with a grid per island.
+struct ObstacleDistanceField {
+  float cellSize;
+  //! Search radius the distances were computed with, the distances saturate
+  //! at it.
+  float maxSearchRadius;
+  std::vector<ObstacleGrid> islands;
+};
+}  // namespace
 
+namespace impl {
 // Runs connected component analysis on the navmesh to figure out which polygons
 // are connected This gives O(1) lookup for if a path between two polygons
 // exists or not
 // Takes O(npolys) to construct
+//
+// Islands are stored in a flat array with one entry per polygon, indexed by
+// the tile and polygon index decoded from a dtPolyRef, so all lookups are array
+// reads and the array can be persisted with the navmesh.
 class IslandSystem {
  public:
-  IslandSystem(const dtNavMesh* navMesh, const dtQueryFilter* filter) {
+  //! Persisted form of an island system, following the tiles in a .navmesh
+  //! file. Followed by the radius and the area of each island and then the
+  //! island of each polygon, in tile and polygon order.
+  struct FileHeader {
+    int numIslands;
+    int numPolys;
+    float totalArea;
+  };
+
+  IslandSystem(const dtNavMesh* navMesh, const dtQueryFilter* filter)
+      : navMesh_{navMesh} {
+    initPolyIndex();
+    ownedPolyIslands_.assign(numPolys_, ID_UNDEFINED);
+    polyIslands_ = ownedPolyIslands_.data();
     std::vector<vec3f> islandVerts;
 
     // Iterate over all tiles
     for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
       const dtMeshTile* tile = navMesh->getTile(iTile);
-      if (!tile)
+      if (!tile || !tile->header)
         continue;
 
       // Iterate over all polygons in a tile
@@ -181,46 +240,47 @@ class IslandSystem {
         // If the polygon ref is valid, and we haven't seen it yet,
         // start connected component analysis from this polygon
         if (navMesh->isValidPolyRef(startRef) &&
-            (polyToIsland_.find(startRef) == polyToIsland_.end())) {
-          uint32_t newIslandId = islandRadius_.size();
+            getPolyIsland(startRef) == ID_UNDEFINED) {
+          int newIslandId = islandRadius_.size();
           expandFrom(navMesh, filter, newIslandId, startRef, islandVerts);
-
-          // The radius is calculated as the max deviation from the mean for all
-          // points in the island
-          vec3f centroid = vec3f::Zero();
-          for (auto& v : islandVerts) {
-            centroid += v;
-          }
-          centroid /= islandVerts.size();
-
-          float maxRadius = 0.0;
-          for (auto& v : islandVerts) {
-            maxRadius = std::max(maxRadius, (v - centroid).norm());
-          }
-
-          islandRadius_.emplace_back(maxRadius);
+          islandRadius_.emplace_back(vertsRadius(islandVerts));
         }
       }
     }
+    islandArea_.assign(islandRadius_.size(), 0.0f);
   }
 
+  /**
+   * @brief Update the islands of @p previous after some tiles of its navmesh
+   * were replaced, with the same result as building them from scratch and
+   * calling @ref removeZeroAreaPolys.
+   *
+   * Only islands touching a replaced tile are flood filled again, all others
+   * keep their polygons, radius and area. Zero area polygons are only looked
+   * for in the replaced tiles.
+   *
+   * @param[in] previous The islands before the change.
+   * @param[in] navMesh The navmesh after the change. Tiles with the same
+   * index and salt as in the navmesh of @p previous have to be unchanged,
+   * which holds for tiles that were neither removed nor added since.
+   * @param[in] filter The filter @p previous was built with.
+   */
+  IslandSystem(const IslandSystem& previous,
+               dtNavMesh* navMesh,
+               const dtQueryFilter* filter);
+
   inline bool hasConnection(dtPolyRef startRef, dtPolyRef endRef) const {
     // If both polygons are on the same island, there must be a path between
     // them
-    auto itStart = polyToIsland_.find(startRef);
-    if (itStart == polyToIsland_.end())
-      return false;
-
-    auto itEnd = polyToIsland_.find(endRef);
-    if (itEnd == polyToIsland_.end())
-      return false;
-
-    return itStart->second == itEnd->second;
+    const int startIsland = getPolyIsland(startRef);
+    return startIsland != ID_UNDEFINED &&
+           startIsland == getPolyIsland(endRef);
   }
 
   //! check that island index is valid. indexOptional allows ID_UNDEFINED as
   //! valid.
-  inline void assertValidIsland(int islandIndex, bool indexOptional = true) {
+  inline void assertValidIsland(int islandIndex,
+                                bool indexOptional = true) const {
     if (indexOptional && islandIndex == ID_UNDEFINED) {
       return;
     }
@@ -229,115 +289,212 @@ class IslandSystem {
         islandIndex << " not a valid index for this island system.", );
   }
 
-  inline float islandRadius(int islandIndex) {
+  inline float islandRadius(int islandIndex) const {
     assertValidIsland(islandIndex, /*indexOptional*/ false);
     return islandRadius_[islandIndex];
   }
 
   inline float polyIslandRadius(dtPolyRef ref) const {
-    auto itRef = polyToIsland_.find(ref);
-    if (itRef == polyToIsland_.end())
+    const int island = getPolyIsland(ref);
+    if (island == ID_UNDEFINED)
       return 0.0;
 
-    return islandRadius_[itRef->second];
+    return islandRadius_[island];
   }
 
   //! Get the area of an island.
   //! islandIndex=ID_UNDEFINED specifies the full NavMesh area.
-  inline float getNavigableArea(int islandIndex) {
+  inline float getNavigableArea(int islandIndex) const {
     assertValidIsland(islandIndex);
-    return islandsToArea_[islandIndex];
+    return islandIndex == ID_UNDEFINED ? totalArea_ : islandArea_[islandIndex];
+  }
+
+  inline int numIslands() const { return islandRadius_.size(); }
+
+  // Some polygons have zero area for some reason.  When we navigate into a zero
+  // area polygon, things crash.  So we find all zero area polygons and mark
+  // them as disabled/not navigable.
+  // Also compute the NavMesh areas for later query.
+  void removeZeroAreaPolys(dtNavMesh* navMesh);
+
+  //! return the island for a navmesh polygon, ID_UNDEFINED if it isn't on
+  //! one. Thread-safe.
+  inline int getPolyIsland(dtPolyRef polyRef) const {
+    const int index = getPolyIndex(polyRef);
+    return index == ID_UNDEFINED ? ID_UNDEFINED : polyIslands_[index];
+  }
+
+  //! return the index of a navmesh polygon in the per-polygon arrays, which
+  //! enumerate the polygons in tile and polygon order, ID_UNDEFINED if it
+  //! isn't in the navmesh the islands were built on. Thread-safe.
+  inline int getPolyIndex(dtPolyRef polyRef) const {
+    unsigned int salt = 0, it = 0, ip = 0;
+    navMesh_->decodePolyId(polyRef, salt, it, ip);
+    if (it >= tileSalts_.size() || salt != tileSalts_[it] ||
+        ip >= tilePolyOffsets_[it + 1] - tilePolyOffsets_[it])
+      return ID_UNDEFINED;
+    return tilePolyOffsets_[it] + ip;
   }
 
-  inline int numIslands() const {
-    // TODO: better way to track number of islands
-    return islandRadius_.size();
+  inline int numPolys() const { return numPolys_; }
+
+  //! return the island of the polygon at @p polyIndex in the per-polygon
+  //! arrays, see @ref getPolyIndex.
+  inline int getIndexIsland(int polyIndex) const {
+    return polyIslands_[polyIndex];
   }
 
   /**
-   * @brief Sets a specified poly flag for all polys specified by the
-   * islandIndex.
+   * @brief Index of each polygon in the per-polygon arrays of @p previous,
+   * ID_UNDEFINED for polygons of tiles replaced since.
    *
-   * @param[in] navMesh The navmesh to operate on.
-   * @param[in] flag The flag to set or clear.
-   * @param[in] islandIndex Specify the island. islandIndex == ID_UNDEFINED
-   * specifies all islands.
-   * @param[in] setFlag If true, set the flag(currentFlags OR newFlag),
-   * otherwise clear the flag(currentFlags AND ~newFlag).
-   * @param[in] invert If true, set or clear the flag for all islands except the
-   * specified one. Has no effect if islandIndex == ID_UNDEFINED.
+   * @p previous has to be an island system of the same navmesh before some
+   * of its tiles were replaced, or of a copy of it.
    */
-  inline void setPolyFlagForIsland(dtNavMesh* navMesh,
-                                   ushort flag,
-                                   int islandIndex = ID_UNDEFINED,
-                                   bool setFlag = true,
-                                   bool invert = false) {
-    assertValidIsland(islandIndex);
-    CORRADE_ASSERT(navMesh != nullptr, "invalid navMesh pointer", );
-    std::vector<int> islands;
-
-    if (islandIndex == ID_UNDEFINED) {
-      // all islands
-      islands.reserve(islandsToPolys_.size());
-      for (auto& itr : islandsToPolys_) {
-        islands.push_back(itr.first);
-      }
-    } else if (invert) {
-      // all but a single island
-      islands.reserve(islandsToPolys_.size());
-      for (auto& itr : islandsToPolys_) {
-        if (itr.first != islandIndex) {
-          islands.push_back(itr.first);
-        }
-      }
-    } else {
-      // a single island
-      islands.push_back(islandIndex);
-    }
-
-    // Pull this check and adjustment logic outside of the main loop
-    ushort (*op)(ushort, ushort) = nullptr;
-    op = setFlag ? orFlag : andFlag;
-    ushort modFlag = setFlag ? flag : ~flag;
-
-    // for each island
-    for (int island : islands) {
-      // for each poly
-      for (auto& polyRef : islandsToPolys_[island]) {
-        // get current flags
-        ushort f = 0;
-        navMesh->getPolyFlags(polyRef, &f);
-        // set the modified flags
-        navMesh->setPolyFlags(polyRef, op(f, modFlag));
+  std::vector<int> previousPolyIndices(const IslandSystem& previous) const {
+    std::vector<int> indices(numPolys_, ID_UNDEFINED);
+    for (size_t iTile = 0; iTile + 1 < tilePolyOffsets_.size(); ++iTile) {
+      if (!isSameTile(previous, iTile))
+        continue;
+      for (unsigned int i = tilePolyOffsets_[iTile];
+           i < tilePolyOffsets_[iTile + 1]; ++i) {
+        indices[i] = previous.tilePolyOffsets_[iTile] + i -
+                     tilePolyOffsets_[iTile];
       }
     }
+    return indices;
   }
 
-  // Some polygons have zero area for some reason.  When we navigate into a zero
-  // area polygon, things crash.  So we find all zero area polygons and mark
-  // them as disabled/not navigable.
-  // Also compute the NavMesh areas for later query.
-  void removeZeroAreaPolys(dtNavMesh* navMesh);
+  /**
+   * @brief Load an island system persisted by @ref save, skipping connected
+   * component analysis and the area computation.
+   *
+   * @param[in] navMesh The navmesh the islands were saved with.
+   * @param[in] data The persisted tables, as laid out by @ref save.
+   * @param[in] size Size of @p data in bytes.
+   * @param[in] storage If not null, @p data stays valid for as long as
+   * @p storage is alive and the per-polygon islands are used in place.
+   * @return The island system, nullptr if @p data is truncated or doesn't
+   * match @p navMesh.
+   */
+  static std::unique_ptr<IslandSystem> load(
+      const dtNavMesh* navMesh,
+      const char* data,
+      size_t size,
+      std::shared_ptr<const void> storage);
+
+  //! Write the islands, their radii and areas and the island of each polygon.
+  bool save(FILE* fp) const;
 
-  //! return the island for a navmesh polygon
-  inline int getPolyIsland(dtPolyRef polyRef) { return polyToIsland_[polyRef]; }
+  /**
+   * @brief Sample a point uniformly distributed over the navigable area of an
+   * island in O(1).
+   *
+   * Polygons are picked from a per-island alias table weighted by their area,
+   * which is built on first use. Thread-safe as long as each thread passes its
+   * own @p random.
+   *
+   * @param[in] islandIndex The island, ID_UNDEFINED picks an island by area
+   * first and so samples the whole navmesh uniformly.
+   * @param[in] random The random state to draw from.
+   * @return The sampled point, or NaN if the island has no navigable area.
+   */
+  vec3f samplePoint(int islandIndex, core::Random& random) const;
 
  private:
-  //! map islands to area for quick query
-  std::unordered_map<uint32_t, float> islandsToArea_;
-  //! map islands to lists of polys for quick query and enumeration
-  std::unordered_map<uint32_t, std::vector<dtPolyRef>> islandsToPolys_;
-  //! map polygons to their island for quick look-up
-  std::unordered_map<dtPolyRef, uint32_t> polyToIsland_;
+  //! The navmesh the polygon indices are decoded with.
+  const dtNavMesh* navMesh_;
+  //! Salt of each tile when the island system was built, to reject stale refs.
+  std::vector<unsigned int> tileSalts_;
+  //! Index of the first polygon of each tile in the per-polygon arrays, with
+  //! one extra entry for the end.
+  std::vector<unsigned int> tilePolyOffsets_;
+  size_t numPolys_ = 0;
+  //! The island of each polygon, ID_UNDEFINED if not on any. Points either
+  //! into ownedPolyIslands_ or into storage_.
+  const int* polyIslands_ = nullptr;
+  std::vector<int> ownedPolyIslands_;
+  std::shared_ptr<const void> storage_;
   std::vector<float> islandRadius_;
+  std::vector<float> islandArea_;
+  float totalArea_ = 0;
+
+  //! Alias tables over the navigable polygons of each island, see
+  //! @ref buildSampler.
+  mutable std::once_flag samplerBuilt_;
+  //! Index of the first entry of each island in the sample arrays, with one
+  //! extra entry for the end.
+  mutable std::vector<unsigned int> islandSampleOffsets_;
+  mutable std::vector<dtPolyRef> samplePolys_;
+  //! Probability of keeping an entry instead of taking its alias.
+  mutable std::vector<float> sampleProbability_;
+  //! Alias of an entry, as an index relative to the island's first entry.
+  mutable std::vector<unsigned int> sampleAlias_;
+  //! Running sum of the island areas, to pick an island by area.
+  mutable std::vector<float> islandAreaSums_;
+
+  //! Build Vose alias tables for all islands, weighting each navigable
+  //! polygon by its area.
+  void buildSampler() const;
+
+  explicit IslandSystem(const dtNavMesh* navMesh) : navMesh_{navMesh} {
+    initPolyIndex();
+  }
+
+  //! The radius of an island, calculated as the max deviation from the mean
+  //! for all points in the island.
+  static float vertsRadius(const std::vector<vec3f>& islandVerts) {
+    vec3f centroid = vec3f::Zero();
+    for (auto& v : islandVerts) {
+      centroid += v;
+    }
+    centroid /= islandVerts.size();
+
+    float maxRadius = 0.0;
+    for (auto& v : islandVerts) {
+      maxRadius = std::max(maxRadius, (v - centroid).norm());
+    }
+    return maxRadius;
+  }
+
+  //! Whether tile @p iTile holds the same polygons as in @p previous.
+  bool isSameTile(const IslandSystem& previous, const size_t iTile) const {
+    return iTile < previous.tileSalts_.size() &&
+           tileSalts_[iTile] == previous.tileSalts_[iTile] &&
+           tilePolyOffsets_[iTile + 1] - tilePolyOffsets_[iTile] ==
+               previous.tilePolyOffsets_[iTile + 1] -
+                   previous.tilePolyOffsets_[iTile];
+  }
+
+  void initPolyIndex() {
+    const int maxTiles = navMesh_->getMaxTiles();
+    tileSalts_.assign(maxTiles, 0);
+    tilePolyOffsets_.assign(maxTiles + 1, 0);
+    numPolys_ = 0;
+    for (int iTile = 0; iTile < maxTiles; ++iTile) {
+      const dtMeshTile* tile = navMesh_->getTile(iTile);
+      tilePolyOffsets_[iTile] = numPolys_;
+      if (!tile || !tile->header)
+        continue;
+      tileSalts_[iTile] = tile->salt;
+      numPolys_ += tile->header->polyCount;
+    }
+    tilePolyOffsets_[maxTiles] = numPolys_;
+  }
+
+  //! Set the island of a polygon known to be in the navmesh.
+  inline void setPolyIsland(dtPolyRef polyRef, int island) {
+    unsigned int salt = 0, it = 0, ip = 0;
+    navMesh_->decodePolyId(polyRef, salt, it, ip);
+    ownedPolyIslands_[tilePolyOffsets_[it] + ip] = island;
+  }
 
   void expandFrom(const dtNavMesh* navMesh,
                   const dtQueryFilter* filter,
-                  const uint32_t newIslandId,
+                  const int newIslandId,
                   const dtPolyRef& startRef,
                   std::vector<vec3f>& islandVerts) {
-    islandsToPolys_[newIslandId].push_back(startRef);
-    polyToIsland_.emplace(startRef, newIslandId);
+    setPolyIsland(startRef, newIslandId);
     islandVerts.clear();
 
     // Force std::stack to be implemented via an std::vector as linked
@@ -364,7 +521,7 @@ class IslandSystem {
            iLink = tile->links[iLink].next) {
         dtPolyRef neighbourRef = tile->links[iLink].ref;
         // If we've already visited this poly, skip it!
-        if (polyToIsland_.find(neighbourRef) != polyToIsland_.end())
+        if (getPolyIsland(neighbourRef) != ID_UNDEFINED)
           continue;
 
         const dtMeshTile* neighbourTile = nullptr;
@@ -376,15 +533,327 @@ class IslandSystem {
         if (!filter->passFilter(neighbourRef, neighbourTile, neighbourPoly))
           continue;
 
-        polyToIsland_.emplace(neighbourRef, newIslandId);
-        islandsToPolys_[newIslandId].push_back(neighbourRef);
+        setPolyIsland(neighbourRef, newIslandId);
         stack.push(neighbourRef);
       }
     }
   }
 };
+
+// HPA*-style abstraction of the navmesh for long-range path queries.
+//
+// The polygons of each island are grouped into clusters of connected polygons,
+// and every pair of adjacent clusters is connected by one entrance on a portal
+// between them. The cost of crossing a cluster between two of its entrances is
+// precomputed, so a query first plans over the entrances. The cost of that
+// route then bounds a polygon search over the whole navmesh, which finds the
+// shortest path without exploring much past it. Neither search uses the Detour
+// node pool, so long paths aren't truncated.
+//
+// Off-mesh connections aren't part of any cluster.
+class PathHierarchy {
+ public:
+  //! Persisted form of a path hierarchy, following the islands in a .navmesh
+  //! file. Followed by the cluster of each polygon, the position and the two
+  //! polygons of each entrance, and the edges between entrances in CSR layout
+  //! as offsets, targets and costs.
+  struct FileHeader {
+    int clusterSize;
+    int numClusters;
+    int numPolys;
+    int numEntrances;
+    int numEdges;
+  };
+
+  /**
+   * @brief Build the hierarchy.
+   *
+   * @param[in] navMesh The navmesh, which has to outlive the hierarchy.
+   * @param[in] islands The islands of @p navMesh, clusters never span two.
+   * @param[in] filter Polygons and links not passing it are left out.
+   * @param[in] clusterSize Maximum number of polygons per cluster.
+   */
+  PathHierarchy(const dtNavMesh* navMesh,
+                std::shared_ptr<const IslandSystem> islands,
+                const dtQueryFilter* filter,
+                int clusterSize);
+
+  /**
+   * @brief Update @p previous after some tiles of its navmesh were replaced.
+   *
+   * Clusters with all their polygons in unchanged tiles are kept, the other
+   * polygons are grouped into new clusters. Only entrances and edges of
+   * clusters next to a new one are computed again, so the clusters can
+   * differ from a full build, but not the corridors found on them.
+   *
+   * @param[in] previous The hierarchy before the change.
+   * @param[in] navMesh The navmesh after the change.
+   * @param[in] islands The islands of @p navMesh, updated from the islands of
+   * @p previous.
+   * @param[in] filter The filter @p previous was built with.
+   */
+  PathHierarchy(const PathHierarchy& previous,
+                const dtNavMesh* navMesh,
+                std::shared_ptr<const IslandSystem> islands,
+                const dtQueryFilter* filter);
+
+  /**
+   * @brief Load a hierarchy persisted by @ref save.
+   *
+   * @return The hierarchy, nullptr if @p data is truncated or doesn't match
+   * @p navMesh.
+   */
+  static std::unique_ptr<PathHierarchy> load(
+      const dtNavMesh* navMesh,
+      std::shared_ptr<const IslandSystem> islands,
+      const dtQueryFilter* filter,
+      const char* data,
+      size_t size);
+
+  //! Write the clusters, entrances and entrance edges.
+  bool save(FILE* fp) const;
+
+  //! Cluster size the hierarchy was built with, read from the header of a
+  //! persisted hierarchy at @p data, 0 if it's truncated.
+  static int persistedClusterSize(const char* data, size_t size);
+
+  int clusterSize() const { return clusterSize_; }
+
+  /**
+   * @brief Find the shortest polygon corridor from @p start on @p startRef to
+   * @p end on @p endRef, with the same costs as the Detour search.
+   * Thread-safe.
+   *
+   * @return False if either polygon isn't in a cluster or no path was found.
+   */
+  bool findCorridor(const vec3f& start,
+                    dtPolyRef startRef,
+                    const vec3f& end,
+                    dtPolyRef endRef,
+                    std::vector<dtPolyRef>& corridor) const;
+
+ private:
+  std::shared_ptr<const IslandSystem> islands_;
+  int clusterSize_ = 0;
+  int numClusters_ = 0;
+
+  //! Reference of each polygon, in the order of the island system's
+  //! per-polygon arrays.
+  std::vector<dtPolyRef> polyRefs_;
+  //! Walkable neighbours of each polygon and the midpoints of the portals to
+  //! them, in CSR layout. Derived from the navmesh, not persisted.
+  std::vector<int> neighbourOffsets_;
+  std::vector<int> neighbours_;
+  std::vector<vec3f> portalMidpoints_;
+
+  //! Cluster of each polygon, ID_UNDEFINED if it isn't in any.
+  std::vector<int> polyClusters_;
+  //! Position of each entrance and the polygons on either side of it.
+  std::vector<vec3f> entrancePositions_;
+  std::vector<int> entrancePolys_;
+  //! Entrances of each cluster in CSR layout, derived from the entrances.
+  std::vector<int> clusterEntranceOffsets_;
+  std::vector<int> clusterEntrances_;
+  //! Edges between entrances of the same cluster, in CSR layout.
+  std::vector<int> edgeOffsets_;
+  std::vector<int> edgeTargets_;
+  std::vector<float> edgeCosts_;
+
+  //! A portal between polygons of two adjacent clusters, the smaller cluster
+  //! first.
+  struct Portal {
+    std::pair<int, int> clusters;
+    int poly;
+    int neighbour;
+    vec3f midpoint;
+    //! The entrance of a previous hierarchy this portal was, if any.
+    int previousEntrance;
+  };
+
+  explicit PathHierarchy(std::shared_ptr<const IslandSystem> islands)
+      : islands_{std::move(islands)} {}
+
+  //! Collect the polygons and their walkable neighbours. Portals between
+  //! polygons that are in @p previous as well, as given by
+  //! @p previousIndices, are taken from it.
+  void initPolyGraph(const dtNavMesh* navMesh,
+                     const dtQueryFilter* filter,
+                     const PathHierarchy* previous = nullptr,
+                     const std::vector<int>& previousIndices = {});
+
+  //! Midpoint of the portal from polygon @p poly to @p neighbour, nullptr if
+  //! either is ID_UNDEFINED or they aren't neighbours.
+  const vec3f* portalMidpoint(const int poly, const int neighbour) const {
+    if (poly == ID_UNDEFINED || neighbour == ID_UNDEFINED)
+      return nullptr;
+    for (int i = neighbourOffsets_[poly]; i < neighbourOffsets_[poly + 1];
+         ++i) {
+      if (neighbours_[i] == neighbour)
+        return &portalMidpoints_[i];
+    }
+    return nullptr;
+  }
+
+  //! Grow clusters from the polygons not in any yet.
+  void growClusters();
+
+  //! Add the portals between clusters which are adjacent to one with an index
+  //! of at least @p firstCluster.
+  void collectPortals(int firstCluster, std::vector<Portal>& portals) const;
+
+  //! Make the portal closest to the middle of the shared boundary of each
+  //! pair of clusters in @p portals an entrance. Returns the previous
+  //! entrance of each.
+  std::vector<int> initEntrances(std::vector<Portal>& portals);
+
+  //! Build the entrances of each cluster from the entrance polygons.
+  void initClusterEntrances();
+
+  //! Compute the edges between the entrances of each cluster. Clusters with
+  //! a nonzero entry in @p unchangedClusters have the same polygons and
+  //! entrances in @p previous, their edges are copied from it.
+  void initEdges(const PathHierarchy* previous = nullptr,
+                 const std::vector<int>& previousEntrances = {},
+                 const std::vector<char>& unchangedClusters = {});
+
+  //! The polygon of @p entrance in @p cluster.
+  int entrancePoly(int entrance, int cluster) const {
+    const int poly = entrancePolys_[2 * entrance];
+    return polyClusters_[poly] == cluster ? poly
+                                          : entrancePolys_[2 * entrance + 1];
+  }
+
+  //! Travel costs from @p position on polygon @p poly to the entrances of its
+  //! cluster, walking only through the cluster. Infinite for unreachable
+  //! entrances. Symmetric, so also the costs from the entrances to
+  //! @p position.
+  std::vector<float> entranceCosts(int poly, const vec3f& position) const;
+
+  //! A* over the polygons, skipping those that can't be on a path costing
+  //! at most @p maxCost. If @p clusters isn't null, also those not in any of
+  //! the sorted @p clusters.
+  bool refineCorridor(int startPoly,
+                      const vec3f& start,
+                      int endPoly,
+                      const vec3f& end,
+                      float maxCost,
+                      const std::vector<int>* clusters,
+                      std::vector<dtPolyRef>& corridor) const;
+};
 }  // namespace impl
 
+//! Queries on a navmesh. The navmesh, its islands, the query filter, the
+//! obstacle distance field and the path hierarchy are shared read-only by a
+//! @ref PathFinder and all its query contexts, only the Detour query and its
+//! search node pool belong to one thread. Also runs the @ref PathFinder's own
+//! queries.
+struct PathFinderQueryContext::Impl {
+  //! Query @p navMesh. Returns false if the Detour query can't be created.
+  bool init(std::shared_ptr<dtNavMesh> navMesh,
+            std::shared_ptr<const impl::IslandSystem> islandSystem,
+            std::shared_ptr<const dtQueryFilter> filter,
+            std::shared_ptr<const ObstacleDistanceField> obstacleField,
+            std::shared_ptr<const impl::PathHierarchy> pathHierarchy);
+
+  bool isLoaded() const { return navQuery_ != nullptr; }
+
+  const dtNavMeshQuery* navQuery() const { return navQuery_.get(); }
+
+  bool findPath(ShortestPath& path) const;
+  bool findPath(MultiGoalShortestPath& path) const;
+
+  GeodesicDistanceField::ptr computeDistanceField(
+      const std::vector<vec3f>& goals,
+      float portalSampleSpacing) const;
+
+  template <typename T>
+  T tryStep(const T& start, const T& end, bool allowSliding) const;
+
+  template <typename T>
+  T tryStep(const T& start,
+            const T& end,
+            dtPolyRef& polyRef,
+            bool allowSliding) const;
+
+  template <typename T>
+  T snapPoint(const T& pt, int islandIndex) const;
+
+  template <typename T>
+  int getIsland(const T& pt) const;
+
+  float islandRadius(const vec3f& pt) const;
+
+  float distanceToClosestObstacle(const vec3f& pt, float maxSearchRadius) const;
+  HitRecord closestObstacleSurfacePoint(const vec3f& pt,
+                                        float maxSearchRadius) const;
+
+  //! The poly @p pt is navigable on as defined by @ref
+  //! PathFinder::isNavigable, or 0.
+  dtPolyRef navigablePoly(const vec3f& pt, float maxYDelta) const;
+
+  //! Detour draws its random numbers from @p frand.
+  vec3f getRandomNavigablePointAroundSphere(const vec3f& circleCenter,
+                                            float radius,
+                                            int maxTries,
+                                            int islandIndex,
+                                            float (*frand)()) const;
+
+  //! A point uniformly distributed over the navigable area of @p islandIndex,
+  //! drawn from @ref random.
+  vec3f samplePoint(int islandIndex);
+
+  //! Random state of a @ref PathFinderQueryContext, the @ref PathFinder's own
+  //! queries use its per-thread random state instead.
+  core::Random random{0};
+
+ private:
+  std::shared_ptr<dtNavMesh> navMesh_ = nullptr;
+  std::shared_ptr<const impl::IslandSystem> islandSystem_ = nullptr;
+  std::shared_ptr<const dtQueryFilter> filter_ = nullptr;
+  std::shared_ptr<const ObstacleDistanceField> obstacleField_ = nullptr;
+  std::shared_ptr<const impl::PathHierarchy> pathHierarchy_ = nullptr;
+  std::unique_ptr<dtNavMeshQuery, NavQueryDeleter> navQuery_ = nullptr;
+
+  //! Like @ref projectToPoly, but only onto polygons of @p islandIndex if it
+  //! isn't ID_UNDEFINED, and searching @p halfExtents around @p pt.
+  template <typename T>
+  std::tuple<dtStatus, dtPolyRef, vec3f> projectToIsland(
+      const T& pt,
+      int islandIndex,
+      const vec3f& halfExtents = vec3f{2.0f, 4.0f, 2.0f}) const;
+
+  //! Nudge the result @p endPoint of a step that ended in @p endPolyRef into
+  //! that poly if it landed on a thin wall to another island than @p startRef.
+  void nudgeOffThinWall(dtPolyRef startRef,
+                        dtPolyRef endPolyRef,
+                        vec3f& endPoint) const;
+
+  Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
+  findPathInternal(const vec3f& start,
+                   dtPolyRef startRef,
+                   const vec3f& pathStart,
+                   const vec3f& end,
+                   dtPolyRef endRef,
+                   const vec3f& pathEnd,
+                   bool usePathHierarchy) const;
+
+  bool findPathSetup(MultiGoalShortestPath& path,
+                     dtPolyRef& startRef,
+                     vec3f& pathStart) const;
+
+  //! @ref findPath for @ref MultiGoalShortestPath::useDistanceField.
+  bool findPathOnDistanceField(MultiGoalShortestPath& path,
+                               dtPolyRef startRef,
+                               const vec3f& pathStart) const;
+
+  //! String-pull the path from @p start to @p end through @p polys and
+  //! measure it.
+  Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>> straightPath(
+      const vec3f& start,
+      const vec3f& end,
+      const std::vector<dtPolyRef>& polys) const;
+};
+
 struct PathFinder::Impl {
   Impl();
   ~Impl() = default;
@@ -398,6 +867,19 @@ struct PathFinder::Impl {
              const float* bmax);
   bool build(const NavMeshSettings& bs, const esp::assets::MeshData& mesh);
 
+  //! Build a navmesh per entry of @p settings into the matching entry of
+  //! @p variants on @ref threadPool(). Returns which builds succeeded.
+  std::vector<char> buildVariants(const esp::assets::MeshData& mesh,
+                                  const std::vector<NavMeshSettings>& settings,
+                                  const std::vector<Impl*>& variants);
+
+  bool rebuildTiles(const esp::assets::MeshData& mesh,
+                    const vec3f& dirtyMin,
+                    const vec3f& dirtyMax);
+
+  std::pair<vec3f, vec3f> getRebuildRegion(const vec3f& dirtyMin,
+                                           const vec3f& dirtyMax) const;
+
   vec3f getRandomNavigablePoint(int maxTries,
                                 int islandIndex /*= ID_UNDEFINED*/);
   vec3f getRandomNavigablePointAroundSphere(const vec3f& circleCenter,
@@ -408,16 +890,61 @@ struct PathFinder::Impl {
   bool findPath(ShortestPath& path);
   bool findPath(MultiGoalShortestPath& path);
 
+  std::vector<bool> findPaths(std::vector<ShortestPath>& paths);
+  std::vector<float> geodesicDistances(const std::vector<vec3f>& starts,
+                                       const std::vector<vec3f>& ends);
+
+  Eigen::RowMatrixX3f snapPoints(
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& points,
+      int islandIndex);
+  Eigen::VectorXi getIslands(
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& points);
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> isNavigableBatch(
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& points,
+      float maxYDelta);
+  Eigen::RowMatrixX3f sampleNavigablePoints(int numPoints, int islandIndex);
+
+  GeodesicDistanceField::ptr computeDistanceField(
+      const std::vector<vec3f>& goals,
+      float portalSampleSpacing);
+
+  void setNumThreads(int numThreads);
+  int getNumThreads();
+
+  PathFinderQueryContext::ptr createQueryContext();
+
+  uint64_t getQueryStateVersion() const { return queryStateVersion_; }
+
+  template <typename T>
+  T tryStep(const T& start, const T& end, bool allowSliding) {
+    return query_->tryStep(start, end, allowSliding);
+  }
+
   template <typename T>
-  T tryStep(const T& start, const T& end, bool allowSliding);
+  T tryStep(const T& start,
+            const T& end,
+            dtPolyRef& polyRef,
+            bool allowSliding) {
+    return query_->tryStep(start, end, polyRef, allowSliding);
+  }
+
+  Eigen::RowMatrixX3f tryStepBatch(
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& starts,
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& ends,
+      Eigen::Ref<Eigen::Matrix<uint64_t, Eigen::Dynamic, 1>> polyRefs,
+      bool allowSliding);
 
   template <typename T>
-  T snapPoint(const T& pt, int islandIndex = ID_UNDEFINED);
+  T snapPoint(const T& pt, int islandIndex = ID_UNDEFINED) {
+    return query_->snapPoint(pt, islandIndex);
+  }
 
   template <typename T>
-  int getIsland(const T& pt) const;
+  int getIsland(const T& pt) const {
+    return query_->getIsland(pt);
+  }
 
-  bool loadNavMesh(const std::string& path);
+  bool loadNavMesh(const std::string& path, bool memoryMap);
 
   bool saveNavMesh(const std::string& path);
 
@@ -431,83 +958,238 @@ struct PathFinder::Impl {
 
   void seed(uint32_t newSeed);
 
-  float islandRadius(const vec3f& pt) const;
+  float islandRadius(const vec3f& pt) const {
+    return query_->islandRadius(pt);
+  }
 
   float islandRadius(int islandIndex) const;
 
   float distanceToClosestObstacle(const vec3f& pt,
-                                  float maxSearchRadius = 2.0) const;
+                                  float maxSearchRadius = 2.0) const {
+    return query_->distanceToClosestObstacle(pt, maxSearchRadius);
+  }
   HitRecord closestObstacleSurfacePoint(const vec3f& pt,
-                                        float maxSearchRadius = 2.0) const;
+                                        float maxSearchRadius = 2.0) const {
+    return query_->closestObstacleSurfacePoint(pt, maxSearchRadius);
+  }
+
+  bool buildObstacleDistanceField(float cellSize, float maxSearchRadius);
+  void clearObstacleDistanceField() {
+    obstacleField_ = nullptr;
+    resetQueries();
+  }
+  bool hasObstacleDistanceField() const { return bool(obstacleField_); }
 
-  bool isNavigable(const vec3f& pt, float maxYDelta = 0.5) const;
+  bool buildPathHierarchy(int clusterSize);
+  void clearPathHierarchy() {
+    pathHierarchy_ = nullptr;
+    pathHierarchyClusterSize_ = 0;
+    resetQueries();
+  }
+  bool hasPathHierarchy() const { return bool(pathHierarchy_); }
+
+  bool isNavigable(const vec3f& pt, float maxYDelta = 0.5) const {
+    return query_->navigablePoly(pt, maxYDelta) != 0;
+  }
 
   std::pair<vec3f, vec3f> bounds() const { return bounds_; };
 
   Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
-  getTopDownView(float metersPerPixel, float height, float eps) const;
+  getTopDownView(float metersPerPixel, float height, float eps);
 
   Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic>
-  getTopDownIslandView(float metersPerPixel, float height, float eps) const;
+  getTopDownIslandView(float metersPerPixel, float height, float eps);
 
   assets::MeshData::ptr getNavMeshData(int islandIndex /*= ID_UNDEFINED*/);
 
+  std::shared_ptr<const NavMeshGeometry> getNavMeshGeometry();
+
+  bool exportNavMeshGeometry(const std::string& path, int islandIndex);
+
   Cr::Containers::Optional<NavMeshSettings> getNavMeshSettings() const {
     return navMeshSettings_;
   }
 
  private:
-  struct NavMeshDeleter {
-    void operator()(dtNavMesh* mesh) { dtFreeNavMesh(mesh); }
-  };
-  struct NavQueryDeleter {
-    void operator()(dtNavMeshQuery* query) { dtFreeNavMeshQuery(query); }
-  };
-
-  std::unique_ptr<dtNavMesh, NavMeshDeleter> navMesh_ = nullptr;
-  std::unique_ptr<dtNavMeshQuery, NavQueryDeleter> navQuery_ = nullptr;
-  std::unique_ptr<dtQueryFilter> filter_ = nullptr;
-  std::unique_ptr<impl::IslandSystem> islandSystem_ = nullptr;
+  //! Shared with the @ref GeodesicDistanceField objects and query contexts
+  //! created on it so they stay valid if the navmesh is rebuilt or reloaded.
+  //! Never modified while shared, and neither are the filter, the islands
+  //! and the obstacle distance field.
+  std::shared_ptr<dtNavMesh> navMesh_ = nullptr;
+  std::shared_ptr<dtQueryFilter> filter_ = nullptr;
+  std::shared_ptr<impl::IslandSystem> islandSystem_ = nullptr;
+  //! Queries of the calling thread. Recreated whenever the navmesh or the
+  //! obstacle distance field change, see @ref resetQueries.
+  std::unique_ptr<PathFinderQueryContext::Impl> query_ = nullptr;
+
+  //! Worker pool for the batched query APIs. Created on first use.
+  std::unique_ptr<core::ThreadPool> threadPool_ = nullptr;
+  //! Requested pool size, <= 0 uses the hardware concurrency.
+  int numThreads_ = 0;
+  //! One query per pool thread except the calling thread, which uses
+  //! query_. A dtNavMeshQuery owns a mutable node pool, so queries can't be
+  //! shared between threads. Reset with query_.
+  std::vector<std::unique_ptr<PathFinderQueryContext::Impl>> workerQueries_;
+  //! Incremented with every reset of the queries.
+  uint64_t queryStateVersion_ = 0;
 
   //! Holds triangulated geom/topo. Generated when queried. Reset with
-  //! navQuery_.
+  //! query_.
   std::unordered_map<int, assets::MeshData::ptr> islandMeshData_;
+  //! Indexed geom/topo of all islands. Generated when queried. Reset with
+  //! query_.
+  std::shared_ptr<const NavMeshGeometry> navMeshGeometry_ = nullptr;
   Cr::Containers::Optional<NavMeshSettings> navMeshSettings_;
 
-  std::pair<vec3f, vec3f> bounds_;
-
-  bool initNavQuery();
+  //! The most recent top-down island view and its parameters. Reset with
+  //! query_.
+  struct TopDownCache {
+    float metersPerPixel;
+    float height;
+    float eps;
+    Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> islands;
+  };
+  Cr::Containers::Optional<TopDownCache> topDownCache_;
 
-  Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
-  findPathInternal(const vec3f& start,
-                   dtPolyRef startRef,
-                   const vec3f& pathStart,
-                   const vec3f& end,
-                   dtPolyRef endRef,
-                   const vec3f& pathEnd);
+  std::pair<vec3f, vec3f> bounds_;
 
-  bool findPathSetup(MultiGoalShortestPath& path,
-                     dtPolyRef& startRef,
-                     vec3f& pathStart);
+  //! Precomputed obstacle distances, see @ref buildObstacleDistanceField.
+  //! Recomputed with the islands.
+  std::shared_ptr<const ObstacleDistanceField> obstacleField_ = nullptr;
+
+  //! Compute the obstacle distance field on the current islands. If
+  //! @p previous is given, grids of islands with the same polygons as an
+  //! island of @p previousIslands outside of @p changedArea are taken from it
+  //! and only their nodes within the search radius of @p changedArea are
+  //! computed again.
+  ObstacleDistanceField computeObstacleDistanceField(
+      float cellSize,
+      float maxSearchRadius,
+      const ObstacleDistanceField* previous = nullptr,
+      const impl::IslandSystem* previousIslands = nullptr,
+      const Eigen::AlignedBox2f& changedArea = {});
+
+  //! Cluster-level abstraction for long paths, see @ref buildPathHierarchy.
+  //! Rebuilt with the islands while pathHierarchyClusterSize_ is positive.
+  std::shared_ptr<const impl::PathHierarchy> pathHierarchy_ = nullptr;
+  int pathHierarchyClusterSize_ = 0;
+
+  //! Unique among all PathFinders, identifies this one in the per-thread
+  //! cache of @ref threadRandom.
+  const uint64_t id_;
+  //! Seed given to @ref seed, how often it was set and by which thread.
+  std::atomic<uint32_t> seed_{0};
+  std::atomic<uint64_t> seedGeneration_{0};
+  std::atomic<std::thread::id> seedThread_;
+
+  struct ThreadRandom {
+    //! The @ref seedGeneration_ @ref random was derived from.
+    uint64_t seedGeneration = ~uint64_t{};
+    core::Random random{0};
+  };
+  //! Random state of each thread that used this PathFinder, freed with it.
+  //! Nodes are never erased, so pointers to them stay valid.
+  mutable std::unordered_map<std::thread::id, ThreadRandom> threadRandoms_;
+  mutable std::mutex threadRandomsMutex_;
+
+  //! Random state of this PathFinder for the calling thread. The thread that
+  //! called @ref seed continues the seeded sequence, other threads get their
+  //! own sequences derived from the seed.
+  core::Random& threadRandom() const;
+
+  //! Set up the islands, the path hierarchy, the queries and the obstacle
+  //! distance field for a new navmesh. @p islandSystem and @p pathHierarchy
+  //! are used instead of computing them if given.
+  bool initNavQuery(
+      std::shared_ptr<impl::IslandSystem> islandSystem = nullptr,
+      std::unique_ptr<impl::PathHierarchy> pathHierarchy = nullptr);
+
+  //! Like @ref initNavQuery, but after only tiles within @p changedArea in XZ
+  //! were replaced. Islands, the path hierarchy and the obstacle distance
+  //! field are updated from the current ones instead of computed again.
+  bool updateNavQuery(const Eigen::AlignedBox2f& changedArea);
+
+  //! Queries on the current navmesh, islands and obstacle distance field, or
+  //! nullptr if they can't be created.
+  std::unique_ptr<PathFinderQueryContext::Impl> createQuery() const;
+
+  //! Recreate query_ and drop the worker queries after any of the state they
+  //! share changed.
+  bool resetQueries();
+
+  //! Make the single tile navmesh in @p navData the current one. Takes
+  //! ownership of @p navData.
+  bool initSoloNavMesh(const NavMeshSettings& bs,
+                       unsigned char* navData,
+                       int navDataSize,
+                       const float* bmin,
+                       const float* bmax);
+
+  bool buildTiled(const NavMeshSettings& bs,
+                  const float* verts,
+                  int nverts,
+                  const int* tris,
+                  int ntris,
+                  const float* bmin,
+                  const float* bmax);
+
+  //! Build and replace the tiles in [tx0, tx1] x [ty0, ty1] of a tiled navmesh
+  //! on @ref threadPool(). The navmesh is only modified if all tiles could be
+  //! built.
+  bool buildTiles(dtNavMesh& navMesh,
+                  const NavMeshSettings& bs,
+                  const float* verts,
+                  int nverts,
+                  const int* tris,
+                  int ntris,
+                  int tx0,
+                  int ty0,
+                  int tx1,
+                  int ty1,
+                  float minY,
+                  float maxY);
+
+  core::ThreadPool& threadPool();
+
+  //! Get the queries for all threads of @ref threadPool(), indexed by thread
+  //! index.
+  std::vector<const PathFinderQueryContext::Impl*> workerQueries();
+
+  //! Rasterize the navmesh polygons into the top-down island view.
+  Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic>
+  rasterizeTopDownIslandView(float metersPerPixel, float height, float eps);
 };
 
 namespace {
 struct Workspace {
   rcHeightfield* solid = nullptr;
-  unsigned char* triareas = nullptr;
+  //! Kept across @ref reset so a workspace reused for many tiles only grows
+  //! it to the largest triangle count.
+  std::vector<unsigned char> triareas;
   rcCompactHeightfield* chf = nullptr;
   rcContourSet* cset = nullptr;
   rcPolyMesh* pmesh = nullptr;
   rcPolyMeshDetail* dmesh = nullptr;
 
-  ~Workspace() {
+  Workspace() = default;
+  Workspace(const Workspace&) = delete;
+  Workspace& operator=(const Workspace&) = delete;
+
+  //! Free the Recast data of the previous build.
+  void reset() {
     rcFreeHeightField(solid);
-    delete[] triareas;
     rcFreeCompactHeightfield(chf);
     rcFreeContourSet(cset);
     rcFreePolyMesh(pmesh);
     rcFreePolyMeshDetail(dmesh);
+    solid = nullptr;
+    chf = nullptr;
+    cset = nullptr;
+    pmesh = nullptr;
+    dmesh = nullptr;
   }
+
+  ~Workspace() { reset(); }
 };
 
 enum PolyAreas { POLYAREA_GROUND, POLYAREA_DOOR };
@@ -516,32 +1198,25 @@ enum PolyFlags {
   POLYFLAGS_WALK = 0x01,      // walkable
   POLYFLAGS_DOOR = 0x02,      // ability to move through doors
   POLYFLAGS_DISABLED = 0x04,  // disabled polygon
-  POLYFLAGS_OFF_ISLAND =
-      0x08,               // dynamically set to filter all but a specific island
-  POLYFLAGS_ALL = 0xffff  // all abilities
+  POLYFLAGS_ALL = 0xffff      // all abilities
 };
 }  // namespace
 
-PathFinder::Impl::Impl() {
-  filter_ = std::make_unique<dtQueryFilter>();
+namespace {
+std::atomic<uint64_t> nextPathFinderId{0};
+}  // namespace
+
+PathFinder::Impl::Impl()
+    : id_{nextPathFinderId++}, seedThread_{std::this_thread::get_id()} {
+  filter_ = std::make_shared<dtQueryFilter>();
   filter_->setIncludeFlags(POLYFLAGS_WALK);
   filter_->setExcludeFlags(0);
 }
 
-bool PathFinder::Impl::build(const NavMeshSettings& bs,
-                             const float* verts,
-                             const int nverts,
-                             const int* tris,
-                             const int ntris,
-                             const float* bmin,
-                             const float* bmax) {
-  Workspace ws;
-  rcContext ctx;
-
-  //
-  // Step 1. Initialize build config.
-  //
-
+namespace {
+//! Recast build config shared by the solo and the tiled build. Bounds and grid
+//! size are left for the caller to fill in.
+rcConfig recastConfig(const NavMeshSettings& bs) {
   // Init build configuration from GUI
   rcConfig cfg{};
   memset(&cfg, 0, sizeof(cfg));
@@ -561,16 +1236,125 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   cfg.detailSampleDist =
       bs.detailSampleDist < 0.9f ? 0 : bs.cellSize * bs.detailSampleDist;
   cfg.detailSampleMaxError = bs.cellHeight * bs.detailSampleMaxError;
+  return cfg;
+}
 
-  // Set the area where the navigation will be build.
-  // Here the bounds of the input mesh are used, but the
-  // area could be specified by an user defined box, etc.
-  rcVcopy(cfg.bmin, bmin);
-  rcVcopy(cfg.bmax, bmax);
-  rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
-  ESP_DEBUG() << "Building navmesh with" << cfg.width << "x" << cfg.height
-              << "cells";
+//! Recast build config for the tiles of a tiled build. The heightfield of each
+//! tile is padded by a border so that erosion and region partitioning see the
+//! geometry of the neighbouring tiles and the tile edges line up.
+rcConfig tileRecastConfig(const NavMeshSettings& bs) {
+  rcConfig cfg = recastConfig(bs);
+  cfg.tileSize = bs.tileSize;
+  cfg.borderSize = cfg.walkableRadius + 3;  // Reserve enough padding.
+  cfg.width = cfg.tileSize + cfg.borderSize * 2;
+  cfg.height = cfg.tileSize + cfg.borderSize * 2;
+  return cfg;
+}
+
+//! Set the padded bounds of tile (tx, ty) in a config from @ref
+//! tileRecastConfig. The Y extents come from the input geometry.
+void setTileBounds(rcConfig& cfg,
+                   const float* orig,
+                   const int tx,
+                   const int ty,
+                   const float minY,
+                   const float maxY) {
+  const float tcs = cfg.tileSize * cfg.cs;
+  const float border = cfg.borderSize * cfg.cs;
+  cfg.bmin[0] = orig[0] + tx * tcs - border;
+  cfg.bmin[1] = minY;
+  cfg.bmin[2] = orig[2] + ty * tcs - border;
+  cfg.bmax[0] = orig[0] + (tx + 1) * tcs + border;
+  cfg.bmax[1] = maxY;
+  cfg.bmax[2] = orig[2] + (ty + 1) * tcs + border;
+}
+
+//! Inclusive range [tx0, tx1] x [ty0, ty1] of tiles.
+struct TileRange {
+  int tx0, ty0, tx1, ty1;
+};
+
+//! The tiles of a navmesh whose bounds, padded by the border of a config from
+//! @ref tileRecastConfig, overlap [min, max] in XZ.
+TileRange overlappingTiles(const rcConfig& cfg,
+                           const dtNavMeshParams& params,
+                           const vec3f& min,
+                           const vec3f& max) {
+  const float border = cfg.borderSize * cfg.cs;
+  return {
+      static_cast<int>(
+          std::floor((min[0] - border - params.orig[0]) / params.tileWidth)),
+      static_cast<int>(
+          std::floor((min[2] - border - params.orig[2]) / params.tileHeight)),
+      static_cast<int>(
+          std::floor((max[0] + border - params.orig[0]) / params.tileWidth)),
+      static_cast<int>(
+          std::floor((max[2] + border - params.orig[2]) / params.tileHeight))};
+}
 
+/**
+ * @brief Collect the triangles touching each tile of the inclusive tile range
+ * [tx0, tx1] x [ty0, ty1], including the tile borders.
+ *
+ * Buckets are stored row-major over the range and hold the vertex indices of
+ * the triangles in input order, ready to be passed to Recast.
+ */
+std::vector<std::vector<int>> bucketTileTriangles(const rcConfig& cfg,
+                                                  const float* orig,
+                                                  const float* verts,
+                                                  const int* tris,
+                                                  const int ntris,
+                                                  const int tx0,
+                                                  const int ty0,
+                                                  const int tx1,
+                                                  const int ty1) {
+  const int numTilesX = tx1 - tx0 + 1;
+  const int numTilesY = ty1 - ty0 + 1;
+  std::vector<std::vector<int>> buckets(numTilesX * numTilesY);
+  const float tcs = cfg.tileSize * cfg.cs;
+  const float border = cfg.borderSize * cfg.cs;
+  for (int i = 0; i < ntris; ++i) {
+    const int* tri = &tris[i * 3];
+    float minX = verts[tri[0] * 3], maxX = minX;
+    float minZ = verts[tri[0] * 3 + 2], maxZ = minZ;
+    for (int j = 1; j < 3; ++j) {
+      minX = std::min(minX, verts[tri[j] * 3]);
+      maxX = std::max(maxX, verts[tri[j] * 3]);
+      minZ = std::min(minZ, verts[tri[j] * 3 + 2]);
+      maxZ = std::max(maxZ, verts[tri[j] * 3 + 2]);
+    }
+    const int x0 = std::max(
+        tx0, static_cast<int>(std::floor((minX - border - orig[0]) / tcs)));
+    const int x1 = std::min(
+        tx1, static_cast<int>(std::floor((maxX + border - orig[0]) / tcs)));
+    const int y0 = std::max(
+        ty0, static_cast<int>(std::floor((minZ - border - orig[2]) / tcs)));
+    const int y1 = std::min(
+        ty1, static_cast<int>(std::floor((maxZ + border - orig[2]) / tcs)));
+    for (int y = y0; y <= y1; ++y) {
+      for (int x = x0; x <= x1; ++x) {
+        std::vector<int>& bucket = buckets[(y - ty0) * numTilesX + (x - tx0)];
+        bucket.insert(bucket.end(), tri, tri + 3);
+      }
+    }
+  }
+  return buckets;
+}
+
+/**
+ * @brief Rasterize the input polygon soup into a new heightfield in @p ws.
+ *
+ * The bounds and grid size of @p cfg define the heightfield. Besides those,
+ * the result only depends on the cell size, the cell height, the walkable
+ * slope and the walkable climb of @p cfg, see @ref HeightfieldKey.
+ */
+bool rasterizeHeightfield(rcContext& ctx,
+                          const rcConfig& cfg,
+                          const float* verts,
+                          const int nverts,
+                          const int* tris,
+                          const int ntris,
+                          Workspace& ws) {
   //
   // Step 2. Rasterize input polygon soup.
   //
@@ -590,24 +1374,32 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   // Allocate array that can hold triangle area types.
   // If you have multiple meshes you need to process, allocate
   // and array which can hold the max number of triangles you need to process.
-  ws.triareas = new unsigned char[ntris];
-  if (!ws.triareas) {
-    ESP_ERROR() << "Out of memory for triareas" << ntris;
-    return false;
-  }
+  ws.triareas.assign(ntris, 0);
 
   // Find triangles which are walkable based on their slope and rasterize them.
   // If your input data is multiple meshes, you can transform them here,
   // calculate the are type for each of the meshes and rasterize them.
-  memset(ws.triareas, 0, ntris * sizeof(unsigned char));
   rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, verts, nverts, tris,
-                          ntris, ws.triareas);
-  if (!rcRasterizeTriangles(&ctx, verts, nverts, tris, ws.triareas, ntris,
-                            *ws.solid, cfg.walkableClimb)) {
+                          ntris, ws.triareas.data());
+  if (!rcRasterizeTriangles(&ctx, verts, nverts, tris, ws.triareas.data(),
+                            ntris, *ws.solid, cfg.walkableClimb)) {
     ESP_ERROR() << "Could not rasterize triangles.";
     return false;
   }
+  return true;
+}
 
+/**
+ * @brief Run the Recast pipeline from the heightfield in @p ws up to the
+ * detail mesh.
+ *
+ * Filtering modifies the heightfield. For tiles, cfg.borderSize cells on each
+ * side are only used as context and trimmed from the resulting poly mesh.
+ */
+bool buildPolyMeshFromHeightfield(rcContext& ctx,
+                                  const NavMeshSettings& bs,
+                                  const rcConfig& cfg,
+                                  Workspace& ws) {
   //
   // Step 3. Filter walkables surfaces.
   //
@@ -693,7 +1485,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     return false;
   }
   // Partition the walkable surface into simple regions without holes.
-  if (!rcBuildRegions(&ctx, *ws.chf, 0, cfg.minRegionArea,
+  if (!rcBuildRegions(&ctx, *ws.chf, cfg.borderSize, cfg.minRegionArea,
                       cfg.mergeRegionArea)) {
     ESP_ERROR() << "Could not build watershed regions";
     return false;
@@ -753,86 +1545,263 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     return false;
   }
 
-  // At this point the navigation mesh data is ready, you can access it from
-  // ws.pmesh. See duDebugDrawPolyMesh or dtCreateNavMeshData as examples how to
-  // access the data.
-
-  //
-  // (Optional) Step 8. Create Detour data from Recast poly mesh.
-  //
+  return true;
+}
 
-  // The GUI may allow more max points per polygon than Detour can handle.
-  // Only build the detour navmesh if we do not exceed the limit.
-  if (cfg.maxVertsPerPoly <= DT_VERTS_PER_POLYGON) {
-    unsigned char* navData = nullptr;
-    int navDataSize = 0;
+/**
+ * @brief Run the Recast pipeline from rasterization up to the detail mesh.
+ *
+ * The bounds and grid size of @p cfg define the heightfield. For tiles,
+ * cfg.borderSize cells on each side are only used as context and trimmed
+ * from the resulting poly mesh.
+ */
+bool buildPolyMesh(rcContext& ctx,
+                   const NavMeshSettings& bs,
+                   const rcConfig& cfg,
+                   const float* verts,
+                   const int nverts,
+                   const int* tris,
+                   const int ntris,
+                   Workspace& ws) {
+  return rasterizeHeightfield(ctx, cfg, verts, nverts, tris, ntris, ws) &&
+         buildPolyMeshFromHeightfield(ctx, bs, cfg, ws);
+}
 
-    // Update poly flags from areas.
-    for (int i = 0; i < ws.pmesh->npolys; ++i) {
-      if (ws.pmesh->areas[i] == RC_WALKABLE_AREA) {
-        ws.pmesh->areas[i] = POLYAREA_GROUND;
-      }
-      if (ws.pmesh->areas[i] == POLYAREA_GROUND) {
-        ws.pmesh->flags[i] = POLYFLAGS_WALK;
-      } else if (ws.pmesh->areas[i] == POLYAREA_DOOR) {
-        ws.pmesh->flags[i] = POLYFLAGS_WALK | POLYFLAGS_DOOR;
+//! The settings a rasterized heightfield depends on, besides the input
+//! geometry and bounds. Builds that agree on them can share a heightfield.
+struct HeightfieldKey {
+  float cs;
+  float ch;
+  float walkableSlopeAngle;
+  //! Also the span merge threshold of the rasterization.
+  int walkableClimb;
+
+  explicit HeightfieldKey(const rcConfig& cfg)
+      : cs{cfg.cs},
+        ch{cfg.ch},
+        walkableSlopeAngle{cfg.walkableSlopeAngle},
+        walkableClimb{cfg.walkableClimb} {}
+
+  bool operator==(const HeightfieldKey& other) const {
+    return cs == other.cs && ch == other.ch &&
+           walkableSlopeAngle == other.walkableSlopeAngle &&
+           walkableClimb == other.walkableClimb;
+  }
+};
+
+//! Copy @p src into a new heightfield in @p ws, so that the copy can be
+//! filtered without modifying the original.
+bool copyHeightfield(rcContext& ctx, const rcHeightfield& src, Workspace& ws) {
+  ws.solid = rcAllocHeightfield();
+  if (!ws.solid) {
+    ESP_ERROR() << "Out of memory for heightfield allocation";
+    return false;
+  }
+  if (!rcCreateHeightfield(&ctx, *ws.solid, src.width, src.height, src.bmin,
+                           src.bmax, src.cs, src.ch)) {
+    ESP_ERROR() << "Could not create solid heightfield";
+    return false;
+  }
+  // Spans of a column never overlap or touch, so adding them one by one
+  // doesn't merge any
+  for (int y = 0; y < src.height; ++y) {
+    for (int x = 0; x < src.width; ++x) {
+      for (const rcSpan* span = src.spans[x + y * src.width]; span;
+           span = span->next) {
+        rcAddSpan(&ctx, *ws.solid, x, y, span->smin, span->smax, span->area,
+                  0);
       }
     }
+  }
+  return true;
+}
 
-    dtNavMeshCreateParams params{};
-    memset(&params, 0, sizeof(params));
-    params.verts = ws.pmesh->verts;
-    params.vertCount = ws.pmesh->nverts;
-    params.polys = ws.pmesh->polys;
-    params.polyAreas = ws.pmesh->areas;
-    params.polyFlags = ws.pmesh->flags;
-    params.polyCount = ws.pmesh->npolys;
-    params.nvp = ws.pmesh->nvp;
-    params.detailMeshes = ws.dmesh->meshes;
-    params.detailVerts = ws.dmesh->verts;
-    params.detailVertsCount = ws.dmesh->nverts;
-    params.detailTris = ws.dmesh->tris;
-    params.detailTriCount = ws.dmesh->ntris;
-    // params.offMeshConVerts = geom->getOffMeshConnectionVerts();
-    // params.offMeshConRad = geom->getOffMeshConnectionRads();
-    // params.offMeshConDir = geom->getOffMeshConnectionDirs();
-    // params.offMeshConAreas = geom->getOffMeshConnectionAreas();
-    // params.offMeshConFlags = geom->getOffMeshConnectionFlags();
-    // params.offMeshConUserID = geom->getOffMeshConnectionId();
-    // params.offMeshConCount = geom->getOffMeshConnectionCount();
-    params.walkableHeight = bs.agentHeight;
-    params.walkableRadius = bs.agentRadius;
-    params.walkableClimb = bs.agentMaxClimb;
-    rcVcopy(params.bmin, ws.pmesh->bmin);
-    rcVcopy(params.bmax, ws.pmesh->bmax);
-    params.cs = cfg.cs;
-    params.ch = cfg.ch;
-    params.buildBvTree = true;
-
-    if (!dtCreateNavMeshData(&params, &navData, &navDataSize)) {
-      ESP_ERROR() << "Could not build Detour navmesh";
-      return false;
+//! Create Detour tile data for the poly mesh in @p ws.
+bool createNavMeshData(const NavMeshSettings& bs,
+                       const rcConfig& cfg,
+                       Workspace& ws,
+                       const int tileX,
+                       const int tileY,
+                       unsigned char** navData,
+                       int* navDataSize) {
+  // Update poly flags from areas.
+  for (int i = 0; i < ws.pmesh->npolys; ++i) {
+    if (ws.pmesh->areas[i] == RC_WALKABLE_AREA) {
+      ws.pmesh->areas[i] = POLYAREA_GROUND;
     }
-
-    navMesh_.reset(dtAllocNavMesh());
-    if (!navMesh_) {
-      dtFree(navData);
-      ESP_ERROR() << "Could not allocate Detour navmesh";
-      return false;
+    if (ws.pmesh->areas[i] == POLYAREA_GROUND) {
+      ws.pmesh->flags[i] = POLYFLAGS_WALK;
+    } else if (ws.pmesh->areas[i] == POLYAREA_DOOR) {
+      ws.pmesh->flags[i] = POLYFLAGS_WALK | POLYFLAGS_DOOR;
     }
+  }
 
-    dtStatus status = 0;
-    status = navMesh_->init(navData, navDataSize, DT_TILE_FREE_DATA);
-    if (dtStatusFailed(status)) {
-      dtFree(navData);
-      ESP_ERROR() << "Could not init Detour navmesh";
-      return false;
+  dtNavMeshCreateParams params{};
+  memset(&params, 0, sizeof(params));
+  params.verts = ws.pmesh->verts;
+  params.vertCount = ws.pmesh->nverts;
+  params.polys = ws.pmesh->polys;
+  params.polyAreas = ws.pmesh->areas;
+  params.polyFlags = ws.pmesh->flags;
+  params.polyCount = ws.pmesh->npolys;
+  params.nvp = ws.pmesh->nvp;
+  params.detailMeshes = ws.dmesh->meshes;
+  params.detailVerts = ws.dmesh->verts;
+  params.detailVertsCount = ws.dmesh->nverts;
+  params.detailTris = ws.dmesh->tris;
+  params.detailTriCount = ws.dmesh->ntris;
+  // params.offMeshConVerts = geom->getOffMeshConnectionVerts();
+  // params.offMeshConRad = geom->getOffMeshConnectionRads();
+  // params.offMeshConDir = geom->getOffMeshConnectionDirs();
+  // params.offMeshConAreas = geom->getOffMeshConnectionAreas();
+  // params.offMeshConFlags = geom->getOffMeshConnectionFlags();
+  // params.offMeshConUserID = geom->getOffMeshConnectionId();
+  // params.offMeshConCount = geom->getOffMeshConnectionCount();
+  params.walkableHeight = bs.agentHeight;
+  params.walkableRadius = bs.agentRadius;
+  params.walkableClimb = bs.agentMaxClimb;
+  params.tileX = tileX;
+  params.tileY = tileY;
+  params.tileLayer = 0;
+  rcVcopy(params.bmin, ws.pmesh->bmin);
+  rcVcopy(params.bmax, ws.pmesh->bmax);
+  params.cs = cfg.cs;
+  params.ch = cfg.ch;
+  params.buildBvTree = true;
+
+  if (!dtCreateNavMeshData(&params, navData, navDataSize)) {
+    ESP_ERROR() << "Could not build Detour navmesh";
+    return false;
+  }
+  return true;
+}
+
+//! Detour data of a navmesh tile. Freed unless handed over to a navmesh by
+//! @ref replaceTile.
+struct TileData {
+  unsigned char* data = nullptr;
+  int dataSize = 0;
+
+  TileData() = default;
+  TileData(const TileData&) = delete;
+  TileData& operator=(const TileData&) = delete;
+  ~TileData() { dtFree(data); }
+};
+
+//! Per-thread state for building tiles, reused from one tile to the next.
+//! rcContext isn't thread-safe, so every thread needs its own.
+struct TileBuilder {
+  rcContext ctx;
+  Workspace ws;
+};
+
+/**
+ * @brief Build the Detour data of tile (tx, ty) of a tiled navmesh from the
+ * triangles touching it.
+ *
+ * Doesn't modify the navmesh, so tiles can be built concurrently as long as
+ * each thread uses its own @p builder. @p tileData stays empty if the tile
+ * has no walkable area.
+ */
+bool buildTileData(TileBuilder& builder,
+                   const NavMeshSettings& bs,
+                   rcConfig cfg,
+                   const dtNavMeshParams& params,
+                   const float* verts,
+                   const int nverts,
+                   const std::vector<int>& tileTris,
+                   const int tx,
+                   const int ty,
+                   const float minY,
+                   const float maxY,
+                   TileData& tileData) {
+  if (tileTris.empty()) {
+    return true;
+  }
+  setTileBounds(cfg, params.orig, tx, ty, minY, maxY);
+
+  Workspace& ws = builder.ws;
+  ws.reset();
+  if (!buildPolyMesh(builder.ctx, bs, cfg, verts, nverts, tileTris.data(),
+                     static_cast<int>(tileTris.size() / 3), ws)) {
+    ESP_ERROR() << "Could not build navmesh tile" << tx << ty;
+    return false;
+  }
+  if (ws.pmesh->npolys > params.maxPolys) {
+    ESP_ERROR() << "Navmesh tile" << tx << ty << "has" << ws.pmesh->npolys
+                << "polygons, more than the supported" << params.maxPolys
+                << "per tile. Decrease NavMeshSettings::tileSize.";
+    return false;
+  }
+  if (ws.pmesh->npolys == 0) {
+    return true;
+  }
+  return createNavMeshData(bs, cfg, ws, tx, ty, &tileData.data,
+                           &tileData.dataSize);
+}
+
+//! Replace tile (tx, ty) of a navmesh, or only remove it if @p tileData is
+//! empty. The navmesh takes ownership of the data.
+bool replaceTile(dtNavMesh& navMesh,
+                 const int tx,
+                 const int ty,
+                 TileData& tileData) {
+  // Freeing of the old tile data is handled by DT_TILE_FREE_DATA.
+  navMesh.removeTile(navMesh.getTileRefAt(tx, ty, 0), nullptr, nullptr);
+  if (!tileData.data) {
+    return true;
+  }
+  if (dtStatusFailed(navMesh.addTile(tileData.data, tileData.dataSize,
+                                     DT_TILE_FREE_DATA, 0, nullptr))) {
+    ESP_ERROR() << "Could not add navmesh tile" << tx << ty;
+    return false;
+  }
+  tileData.data = nullptr;
+  return true;
+}
+
+//! Deep copy of a navmesh which preserves all tile and poly refs.
+std::shared_ptr<dtNavMesh> cloneNavMesh(const dtNavMesh& navMesh) {
+  std::shared_ptr<dtNavMesh> clone(dtAllocNavMesh(), NavMeshDeleter{});
+  if (!clone || dtStatusFailed(clone->init(navMesh.getParams()))) {
+    return nullptr;
+  }
+  for (int i = 0; i < navMesh.getMaxTiles(); ++i) {
+    const dtMeshTile* tile = navMesh.getTile(i);
+    if (!tile || !tile->header || (tile->dataSize == 0))
+      continue;
+    unsigned char* data =
+        static_cast<unsigned char*>(dtAlloc(tile->dataSize, DT_ALLOC_PERM));
+    if (!data) {
+      return nullptr;
     }
-    if (!initNavQuery()) {
-      return false;
+    memcpy(data, tile->data, tile->dataSize);
+    if (dtStatusFailed(clone->addTile(data, tile->dataSize, DT_TILE_FREE_DATA,
+                                      navMesh.getTileRef(tile), nullptr))) {
+      dtFree(data);
+      return nullptr;
     }
-    navMeshSettings_ = {bs};
-  } else {
+  }
+  return clone;
+}
+}  // namespace
+
+bool PathFinder::Impl::build(const NavMeshSettings& bs,
+                             const float* verts,
+                             const int nverts,
+                             const int* tris,
+                             const int ntris,
+                             const float* bmin,
+                             const float* bmax) {
+  //
+  // Step 1. Initialize build config.
+  //
+
+  rcConfig cfg = recastConfig(bs);
+
+  // The GUI may allow more max points per polygon than Detour can handle.
+  // Only build the detour navmesh if we do not exceed the limit.
+  if (cfg.maxVertsPerPoly > DT_VERTS_PER_POLYGON) {
     ESP_ERROR() << "cfg.maxVertsPerPoly(" << cfg.maxVertsPerPoly
                 << ") > DT_VERTS_PER_POLYGON(" << DT_VERTS_PER_POLYGON
                 << "), so cannot build the Detour NavMesh. Aborting NavMesh "
@@ -840,7 +1809,45 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     return false;
   }
 
-  bounds_ = std::make_pair(vec3f(bmin), vec3f(bmax));
+  if (bs.tileSize > 0) {
+    if (!buildTiled(bs, verts, nverts, tris, ntris, bmin, bmax)) {
+      return false;
+    }
+    navMeshSettings_ = {bs};
+    bounds_ = std::make_pair(vec3f(bmin), vec3f(bmax));
+    return true;
+  }
+
+  Workspace ws;
+  rcContext ctx;
+
+  // Set the area where the navigation will be build.
+  // Here the bounds of the input mesh are used, but the
+  // area could be specified by an user defined box, etc.
+  rcVcopy(cfg.bmin, bmin);
+  rcVcopy(cfg.bmax, bmax);
+  rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+  ESP_DEBUG() << "Building navmesh with" << cfg.width << "x" << cfg.height
+              << "cells";
+
+  if (!buildPolyMesh(ctx, bs, cfg, verts, nverts, tris, ntris, ws)) {
+    return false;
+  }
+
+  // At this point the navigation mesh data is ready, you can access it from
+  // ws.pmesh. See duDebugDrawPolyMesh or dtCreateNavMeshData as examples how to
+  // access the data.
+
+  //
+  // (Optional) Step 8. Create Detour data from Recast poly mesh.
+  //
+
+  unsigned char* navData = nullptr;
+  int navDataSize = 0;
+  if (!createNavMeshData(bs, cfg, ws, 0, 0, &navData, &navDataSize) ||
+      !initSoloNavMesh(bs, navData, navDataSize, bmin, bmax)) {
+    return false;
+  }
 
   ESP_DEBUG() << "Created navmesh with" << ws.pmesh->nverts << "vertices"
               << ws.pmesh->npolys << "polygons";
@@ -848,26 +1855,222 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   return true;
 }
 
-bool PathFinder::Impl::initNavQuery() {
+bool PathFinder::Impl::initSoloNavMesh(const NavMeshSettings& bs,
+                                       unsigned char* navData,
+                                       const int navDataSize,
+                                       const float* bmin,
+                                       const float* bmax) {
+  navMesh_.reset(dtAllocNavMesh(), NavMeshDeleter{});
+  if (!navMesh_) {
+    dtFree(navData);
+    ESP_ERROR() << "Could not allocate Detour navmesh";
+    return false;
+  }
+
+  dtStatus status = 0;
+  status = navMesh_->init(navData, navDataSize, DT_TILE_FREE_DATA);
+  if (dtStatusFailed(status)) {
+    dtFree(navData);
+    ESP_ERROR() << "Could not init Detour navmesh";
+    return false;
+  }
+  if (!initNavQuery()) {
+    return false;
+  }
+  navMeshSettings_ = {bs};
+
+  bounds_ = std::make_pair(vec3f(bmin), vec3f(bmax));
+  return true;
+}
+
+bool PathFinder::Impl::buildTiled(const NavMeshSettings& bs,
+                                  const float* verts,
+                                  const int nverts,
+                                  const int* tris,
+                                  const int ntris,
+                                  const float* bmin,
+                                  const float* bmax) {
+  const rcConfig cfg = tileRecastConfig(bs);
+  int gridWidth = 0;
+  int gridHeight = 0;
+  rcCalcGridSize(bmin, bmax, cfg.cs, &gridWidth, &gridHeight);
+  const int numTilesX = (gridWidth + cfg.tileSize - 1) / cfg.tileSize;
+  const int numTilesY = (gridHeight + cfg.tileSize - 1) / cfg.tileSize;
+
+  // A dtPolyRef packs a salt, the tile index and the poly index into 32 bits,
+  // so the more tiles there are the fewer polys a tile can hold.
+  int tileBits = 0;
+  while ((1 << tileBits) < numTilesX * numTilesY) {
+    ++tileBits;
+  }
+  if (tileBits > 14) {
+    ESP_ERROR() << "Navmesh needs" << numTilesX * numTilesY
+                << "tiles, more than the supported" << (1 << 14)
+                << ". Increase NavMeshSettings::tileSize.";
+    return false;
+  }
+
+  dtNavMeshParams params{};
+  rcVcopy(params.orig, bmin);
+  params.tileWidth = cfg.tileSize * cfg.cs;
+  params.tileHeight = cfg.tileSize * cfg.cs;
+  params.maxTiles = 1 << tileBits;
+  params.maxPolys = 1 << (22 - tileBits);
+
+  ESP_DEBUG() << "Building navmesh with" << numTilesX << "x" << numTilesY
+              << "tiles of" << cfg.tileSize << "x" << cfg.tileSize << "cells";
+
+  std::shared_ptr<dtNavMesh> navMesh(dtAllocNavMesh(), NavMeshDeleter{});
+  if (!navMesh) {
+    ESP_ERROR() << "Could not allocate Detour navmesh";
+    return false;
+  }
+  if (dtStatusFailed(navMesh->init(&params))) {
+    ESP_ERROR() << "Could not init Detour navmesh";
+    return false;
+  }
+
+  if (!buildTiles(*navMesh, bs, verts, nverts, tris, ntris, 0, 0,
+                  numTilesX - 1, numTilesY - 1, bmin[1], bmax[1])) {
+    return false;
+  }
+
+  navMesh_ = std::move(navMesh);
+  return initNavQuery();
+}
+
+bool PathFinder::Impl::initNavQuery(
+    std::shared_ptr<impl::IslandSystem> islandSystem,
+    std::unique_ptr<impl::PathHierarchy> pathHierarchy) {
   // if we are reinitializing the NavQuery, then also reset the MeshData
   islandMeshData_.clear();
+  navMeshGeometry_ = nullptr;
+  topDownCache_ = Cr::Containers::NullOpt;
 
-  navQuery_.reset(dtAllocNavMeshQuery());
-  dtStatus status = navQuery_->init(navMesh_.get(), 2048);
-  if (dtStatusFailed(status)) {
+  // Islands loaded alongside the navmesh already had zero area polys removed
+  if (islandSystem) {
+    islandSystem_ = std::move(islandSystem);
+  } else {
+    islandSystem_ =
+        std::make_shared<impl::IslandSystem>(navMesh_.get(), filter_.get());
+
+    // Added as we also need to remove these on navmesh recomputation
+    islandSystem_->removeZeroAreaPolys(navMesh_.get());
+  }
+
+  // The path hierarchy follows the navmesh if enabled
+  if (pathHierarchy) {
+    pathHierarchy_ = std::move(pathHierarchy);
+  } else if (pathHierarchyClusterSize_ > 0) {
+    pathHierarchy_ = std::make_shared<const impl::PathHierarchy>(
+        navMesh_.get(), islandSystem_, filter_.get(),
+        pathHierarchyClusterSize_);
+  } else {
+    pathHierarchy_ = nullptr;
+  }
+
+  // and the queries, which refer to the old navmesh
+  if (!resetQueries()) {
+    ESP_ERROR() << "Could not init Detour navmesh query";
+    return false;
+  }
+
+  // The obstacle distance field follows the navmesh if enabled
+  if (obstacleField_) {
+    obstacleField_ = std::make_shared<const ObstacleDistanceField>(
+        computeObstacleDistanceField(obstacleField_->cellSize,
+                                     obstacleField_->maxSearchRadius));
+    return resetQueries();
+  }
+
+  return true;
+}
+
+bool PathFinder::Impl::updateNavQuery(const Eigen::AlignedBox2f& changedArea) {
+  islandMeshData_.clear();
+  navMeshGeometry_ = nullptr;
+  topDownCache_ = Cr::Containers::NullOpt;
+
+  const std::shared_ptr<const impl::IslandSystem> previousIslands =
+      islandSystem_;
+  islandSystem_ = std::make_shared<impl::IslandSystem>(
+      *previousIslands, navMesh_.get(), filter_.get());
+
+  if (pathHierarchy_) {
+    pathHierarchy_ = std::make_shared<const impl::PathHierarchy>(
+        *pathHierarchy_, navMesh_.get(), islandSystem_, filter_.get());
+  } else if (pathHierarchyClusterSize_ > 0) {
+    pathHierarchy_ = std::make_shared<const impl::PathHierarchy>(
+        navMesh_.get(), islandSystem_, filter_.get(),
+        pathHierarchyClusterSize_);
+  }
+
+  if (!resetQueries()) {
     ESP_ERROR() << "Could not init Detour navmesh query";
     return false;
   }
 
-  islandSystem_ =
-      std::make_unique<impl::IslandSystem>(navMesh_.get(), filter_.get());
+  if (obstacleField_) {
+    obstacleField_ = std::make_shared<const ObstacleDistanceField>(
+        computeObstacleDistanceField(
+            obstacleField_->cellSize, obstacleField_->maxSearchRadius,
+            obstacleField_.get(), previousIslands.get(), changedArea));
+    return resetQueries();
+  }
 
-  // Added as we also need to remove these on navmesh recomputation
-  islandSystem_->removeZeroAreaPolys(navMesh_.get());
+  return true;
+}
 
+bool PathFinderQueryContext::Impl::init(
+    std::shared_ptr<dtNavMesh> navMesh,
+    std::shared_ptr<const impl::IslandSystem> islandSystem,
+    std::shared_ptr<const dtQueryFilter> filter,
+    std::shared_ptr<const ObstacleDistanceField> obstacleField,
+    std::shared_ptr<const impl::PathHierarchy> pathHierarchy) {
+  navQuery_.reset(dtAllocNavMeshQuery());
+  if (!navQuery_ || dtStatusFailed(navQuery_->init(navMesh.get(), 2048))) {
+    navQuery_ = nullptr;
+    return false;
+  }
+  navMesh_ = std::move(navMesh);
+  islandSystem_ = std::move(islandSystem);
+  filter_ = std::move(filter);
+  obstacleField_ = std::move(obstacleField);
+  pathHierarchy_ = std::move(pathHierarchy);
   return true;
 }
 
+std::unique_ptr<PathFinderQueryContext::Impl> PathFinder::Impl::createQuery()
+    const {
+  auto query = std::make_unique<PathFinderQueryContext::Impl>();
+  if (!navMesh_ ||
+      !query->init(navMesh_, islandSystem_, filter_, obstacleField_,
+                   pathHierarchy_))
+    return nullptr;
+  return query;
+}
+
+bool PathFinder::Impl::resetQueries() {
+  workerQueries_.clear();
+  ++queryStateVersion_;
+  query_ = createQuery();
+  return query_ != nullptr;
+}
+
+PathFinderQueryContext::ptr PathFinder::Impl::createQueryContext() {
+  if (!isLoaded())
+    return nullptr;
+  auto context = PathFinderQueryContext::create();
+  PathFinderQueryContext::Impl& c = *context->pimpl_;
+  ESP_CHECK(c.init(navMesh_, islandSystem_, filter_, obstacleField_,
+                   pathHierarchy_),
+            "PathFinder::createQueryContext : Could not init Detour navmesh "
+            "query");
+  // Follow the seed of this PathFinder, with a different sequence per context
+  c.random.seed(threadRandom().uniform_uint());
+  return context;
+}
+
 bool PathFinder::Impl::build(const NavMeshSettings& bs,
                              const esp::assets::MeshData& mesh) {
   const int numVerts = mesh.vbo.size();
@@ -893,9 +2096,255 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   return success;
 }
 
+std::vector<char> PathFinder::Impl::buildVariants(
+    const esp::assets::MeshData& mesh,
+    const std::vector<NavMeshSettings>& settings,
+    const std::vector<Impl*>& variants) {
+  std::vector<char> built(settings.size(), 0);
+  if (mesh.vbo.empty()) {
+    ESP_ERROR() << "Can't build navmeshes from an empty mesh";
+    return built;
+  }
+
+  const int numVerts = mesh.vbo.size();
+  const float mf = std::numeric_limits<float>::max();
+  vec3f bmin(mf, mf, mf);
+  vec3f bmax(-mf, -mf, -mf);
+  for (int i = 0; i < numVerts; ++i) {
+    bmin = bmin.cwiseMin(mesh.vbo[i]);
+    bmax = bmax.cwiseMax(mesh.vbo[i]);
+  }
+  const std::vector<int> indices(mesh.ibo.begin(), mesh.ibo.end());
+  const float* verts = mesh.vbo[0].data();
+  const int ntris = static_cast<int>(indices.size() / 3);
+
+  // Solo builds rasterize the whole mesh into one heightfield, which is
+  // shared by all builds with the same HeightfieldKey. Tiled builds
+  // rasterize per tile and are built on their own below.
+  std::vector<rcConfig> configs(settings.size());
+  std::vector<int> heightfieldIndex(settings.size(), ID_UNDEFINED);
+  std::vector<HeightfieldKey> heightfieldKeys;
+  std::vector<size_t> heightfieldConfigs;
+  for (size_t i = 0; i < settings.size(); ++i) {
+    variants[i]->setNumThreads(numThreads_);
+    rcConfig& cfg = configs[i] = recastConfig(settings[i]);
+    if (settings[i].tileSize > 0 || cfg.maxVertsPerPoly > DT_VERTS_PER_POLYGON)
+      continue;
+    rcVcopy(cfg.bmin, bmin.data());
+    rcVcopy(cfg.bmax, bmax.data());
+    rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+
+    const HeightfieldKey key{cfg};
+    const auto found =
+        std::find(heightfieldKeys.begin(), heightfieldKeys.end(), key);
+    heightfieldIndex[i] = found - heightfieldKeys.begin();
+    if (found == heightfieldKeys.end()) {
+      heightfieldKeys.push_back(key);
+      heightfieldConfigs.push_back(i);
+    }
+  }
+  ESP_DEBUG() << "Building" << settings.size() << "navmesh variants from"
+              << heightfieldKeys.size() << "shared heightfields";
+
+  core::ThreadPool& pool = threadPool();
+  std::vector<TileBuilder> builders(pool.numThreads());
+  std::vector<Workspace> heightfields(heightfieldKeys.size());
+  std::vector<char> rasterized(heightfieldKeys.size(), 0);
+  pool.parallelFor(heightfields.size(), [&](size_t j, int threadIndex) {
+    rasterized[j] = rasterizeHeightfield(
+        builders[threadIndex].ctx, configs[heightfieldConfigs[j]], verts,
+        numVerts, indices.data(), ntris, heightfields[j]);
+  });
+
+  // Filtering modifies the heightfield, so every build works on a copy
+  pool.parallelFor(settings.size(), [&](size_t i, int threadIndex) {
+    const int j = heightfieldIndex[i];
+    if (j == ID_UNDEFINED || !rasterized[j])
+      return;
+    TileBuilder& builder = builders[threadIndex];
+    builder.ws.reset();
+    if (!copyHeightfield(builder.ctx, *heightfields[j].solid, builder.ws) ||
+        !buildPolyMeshFromHeightfield(builder.ctx, settings[i], configs[i],
+                                      builder.ws))
+      return;
+    unsigned char* navData = nullptr;
+    int navDataSize = 0;
+    built[i] = createNavMeshData(settings[i], configs[i], builder.ws, 0, 0,
+                                 &navData, &navDataSize) &&
+               variants[i]->initSoloNavMesh(settings[i], navData, navDataSize,
+                                            bmin.data(), bmax.data());
+  });
+
+  for (size_t i = 0; i < settings.size(); ++i) {
+    if (heightfieldIndex[i] == ID_UNDEFINED) {
+      built[i] = variants[i]->build(settings[i], verts, numVerts,
+                                    indices.data(), ntris, bmin.data(),
+                                    bmax.data());
+    }
+  }
+  return built;
+}
+
+std::pair<vec3f, vec3f> PathFinder::Impl::getRebuildRegion(
+    const vec3f& dirtyMin,
+    const vec3f& dirtyMax) const {
+  const float inf = std::numeric_limits<float>::infinity();
+  if (!isLoaded() || !navMeshSettings_ || navMeshSettings_->tileSize <= 0) {
+    return std::make_pair(vec3f::Constant(-inf), vec3f::Constant(inf));
+  }
+
+  // The rebuilt tiles, padded by the border rasterized with them
+  const rcConfig cfg = tileRecastConfig(*navMeshSettings_);
+  const dtNavMeshParams& params = *navMesh_->getParams();
+  const TileRange tiles = overlappingTiles(cfg, params, dirtyMin, dirtyMax);
+  const float border = cfg.borderSize * cfg.cs;
+  return std::make_pair(
+      vec3f{params.orig[0] + tiles.tx0 * params.tileWidth - border, -inf,
+            params.orig[2] + tiles.ty0 * params.tileHeight - border},
+      vec3f{params.orig[0] + (tiles.tx1 + 1) * params.tileWidth + border, inf,
+            params.orig[2] + (tiles.ty1 + 1) * params.tileHeight + border});
+}
+
+bool PathFinder::Impl::rebuildTiles(const esp::assets::MeshData& mesh,
+                                    const vec3f& dirtyMin,
+                                    const vec3f& dirtyMax) {
+  if (!isLoaded() || !navMeshSettings_) {
+    ESP_ERROR() << "No navmesh to update, build or load one first";
+    return false;
+  }
+  const NavMeshSettings bs = *navMeshSettings_;
+  if (bs.tileSize <= 0) {
+    if (mesh.vbo.empty()) {
+      ESP_ERROR() << "Can't build navmeshes from an empty mesh";
+      return false;
+    }
+    ESP_DEBUG() << "Navmesh isn't tiled, rebuilding all of it";
+    return build(bs, mesh);
+  }
+
+  const rcConfig cfg = tileRecastConfig(bs);
+  const dtNavMeshParams& params = *navMesh_->getParams();
+  if (std::abs(params.tileWidth - cfg.tileSize * cfg.cs) >
+      1e-4f * params.tileWidth) {
+    ESP_ERROR() << "Tile width" << params.tileWidth
+                << "of the navmesh doesn't match its NavMeshSettings";
+    return false;
+  }
+
+  const int numVerts = mesh.vbo.size();
+  const int numIndices = mesh.ibo.size();
+  const float mf = std::numeric_limits<float>::max();
+  vec3f bmin(mf, mf, mf);
+  vec3f bmax(-mf, -mf, -mf);
+  for (int i = 0; i < numVerts; ++i) {
+    bmin = bmin.cwiseMin(mesh.vbo[i]);
+    bmax = bmax.cwiseMax(mesh.vbo[i]);
+  }
+  std::vector<int> indices(mesh.ibo.begin(), mesh.ibo.end());
+  // An empty mesh just clears the tiles
+  const float* verts = mesh.vbo.empty() ? nullptr : mesh.vbo[0].data();
+
+  // Tiles outside of both the old and the new geometry can't change.
+  const vec3f regionMin = dirtyMin.cwiseMax(bmin.cwiseMin(bounds_.first));
+  const vec3f regionMax = dirtyMax.cwiseMin(bmax.cwiseMax(bounds_.second));
+  if ((regionMin.array() > regionMax.array()).any()) {
+    return true;
+  }
+
+  // Geometry within the border of a tile affects it as well.
+  const TileRange tiles = overlappingTiles(cfg, params, regionMin, regionMax);
+
+  // GeodesicDistanceField objects and query contexts share the navmesh and
+  // assume it never changes, so give them the old copy. Our own queries are
+  // recreated afterwards.
+  const long numQueries = (query_ ? 1 : 0) + workerQueries_.size();
+  if (navMesh_.use_count() > 1 + numQueries) {
+    std::shared_ptr<dtNavMesh> navMesh = cloneNavMesh(*navMesh_);
+    if (!navMesh) {
+      ESP_ERROR() << "Could not copy Detour navmesh";
+      return false;
+    }
+    navMesh_ = std::move(navMesh);
+  }
+
+  // The mesh may only hold the geometry around the tiles, so keep the
+  // heightfield extents of the full build
+  bounds_ = std::make_pair(bounds_.first.cwiseMin(bmin),
+                           bounds_.second.cwiseMax(bmax));
+  const bool success = buildTiles(
+      *navMesh_, bs, verts, numVerts, indices.data(), numIndices / 3,
+      tiles.tx0, tiles.ty0, tiles.tx1, tiles.ty1, bounds_.first[1],
+      bounds_.second[1]);
+  ESP_DEBUG() << "Rebuilt"
+              << (tiles.tx1 - tiles.tx0 + 1) * (tiles.ty1 - tiles.ty0 + 1)
+              << "navmesh tiles";
+
+  // Even after a failure some tiles may have changed already. Only the
+  // islands, path hierarchy and obstacle distances around them are updated.
+  const Eigen::AlignedBox2f changedArea{
+      Eigen::Vector2f{params.orig[0] + tiles.tx0 * params.tileWidth,
+                      params.orig[2] + tiles.ty0 * params.tileHeight},
+      Eigen::Vector2f{params.orig[0] + (tiles.tx1 + 1) * params.tileWidth,
+                      params.orig[2] + (tiles.ty1 + 1) * params.tileHeight}};
+  return updateNavQuery(changedArea) && success;
+}
+
+bool PathFinder::Impl::buildTiles(dtNavMesh& navMesh,
+                                  const NavMeshSettings& bs,
+                                  const float* verts,
+                                  const int nverts,
+                                  const int* tris,
+                                  const int ntris,
+                                  const int tx0,
+                                  const int ty0,
+                                  const int tx1,
+                                  const int ty1,
+                                  const float minY,
+                                  const float maxY) {
+  const rcConfig cfg = tileRecastConfig(bs);
+  const dtNavMeshParams& params = *navMesh.getParams();
+  const std::vector<std::vector<int>> tileTris = bucketTileTriangles(
+      cfg, params.orig, verts, tris, ntris, tx0, ty0, tx1, ty1);
+  const int numTilesX = tx1 - tx0 + 1;
+
+  core::ThreadPool& pool = threadPool();
+  std::vector<TileBuilder> builders(pool.numThreads());
+  std::vector<TileData> tiles(tileTris.size());
+  std::vector<char> built(tileTris.size(), 0);
+  pool.parallelFor(tileTris.size(), [&](size_t i, int threadIndex) {
+    const int tileIndex = static_cast<int>(i);
+    built[i] = buildTileData(builders[threadIndex], bs, cfg, params, verts,
+                             nverts, tileTris[i], tx0 + tileIndex % numTilesX,
+                             ty0 + tileIndex / numTilesX, minY, maxY,
+                             tiles[i]);
+  });
+  if (std::find(built.begin(), built.end(), 0) != built.end()) {
+    return false;
+  }
+
+  // Tiles are always added in the same order, so the resulting navmesh
+  // doesn't depend on the number of threads.
+  for (int i = 0; i < static_cast<int>(tiles.size()); ++i) {
+    if (!replaceTile(navMesh, tx0 + i % numTilesX, ty0 + i / numTilesX,
+                     tiles[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 namespace {
 const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T';  //'MSET';
-const int NAVMESHSET_VERSION = 2;
+// Version 3 added NavMeshSettings::tileSize and optional sections after the
+// tiles, see NavMeshSectionHeader
+const int NAVMESHSET_VERSION = 3;
+
+//! Island system persisted by impl::IslandSystem::save
+const int NAVMESHSECTION_ISLANDS =
+    'I' << 24 | 'S' << 16 | 'L' << 8 | 'D';  //'ISLD';
+//! Path hierarchy persisted by impl::PathHierarchy::save
+const int NAVMESHSECTION_HIERARCHY =
+    'H' << 24 | 'I' << 16 | 'E' << 8 | 'R';  //'HIER';
 
 struct NavMeshSetHeader {
   int magic;
@@ -909,6 +2358,14 @@ struct NavMeshTileHeader {
   int dataSize;
 };
 
+// Each section is dataSize bytes of data padded to a multiple of 4, so the
+// next one stays aligned in a memory mapped file. Readers skip sections they
+// don't know, new data gets a new tag instead of a new version.
+struct NavMeshSectionHeader {
+  int tag;
+  int dataSize;
+};
+
 struct Triangle {
   std::vector<vec3f> v;
   Triangle() { v.resize(3); }
@@ -941,6 +2398,27 @@ std::vector<Triangle> getPolygonTriangles(const dtPoly* poly,
   return triangles;
 }
 
+//! Endpoints of the portal from @p poly through @p link. That's the shared
+//! edge, or the overlapping part of it for links between tiles (see
+//! dtNavMeshQuery::getPortalPoints).
+std::pair<vec3f, vec3f> portalPoints(const dtMeshTile* tile,
+                                     const dtPoly* poly,
+                                     const dtLink& link) {
+  const vec3f edgeStart = Eigen::Map<const vec3f>(
+      &tile->verts[static_cast<size_t>(poly->verts[link.edge]) * 3]);
+  const vec3f edgeEnd = Eigen::Map<const vec3f>(
+      &tile->verts[static_cast<size_t>(
+                       poly->verts[(link.edge + 1) % poly->vertCount]) *
+                   3]);
+  float tmin = 0.0f, tmax = 1.0f;
+  if (link.side != 0xff && (link.bmin != 0 || link.bmax != 255)) {
+    tmin = link.bmin / 255.0f;
+    tmax = link.bmax / 255.0f;
+  }
+  return std::make_pair(edgeStart + tmin * (edgeEnd - edgeStart),
+                        edgeStart + tmax * (edgeEnd - edgeStart));
+}
+
 // Calculate the area of a polygon by iterating over the triangles in the detail
 // mesh and computing their area
 float polyArea(const dtPoly* poly, const dtMeshTile* tile) {
@@ -962,17 +2440,13 @@ float polyArea(const dtPoly* poly, const dtMeshTile* tile) {
 // them as disabled/not navigable.
 // Also compute the NavMesh areas for later query.
 void impl::IslandSystem::removeZeroAreaPolys(dtNavMesh* navMesh) {
-  islandsToArea_ = std::unordered_map<uint32_t, float>();
-  islandsToArea_.reserve(islandsToPolys_.size());
   // initialize the area cache.
-  for (auto& itr : islandsToPolys_) {
-    islandsToArea_[itr.first] = 0.0;
-  }
+  islandArea_.assign(islandRadius_.size(), 0.0f);
   // Iterate over all tiles
   for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
     const dtMeshTile* tile =
         const_cast<const dtNavMesh*>(navMesh)->getTile(iTile);
-    if (!tile)
+    if (!tile || !tile->header)
       continue;
 
     // Iterate over all polygons in a tile
@@ -987,94 +2461,1190 @@ void impl::IslandSystem::removeZeroAreaPolys(dtNavMesh* navMesh) {
       CORRADE_INTERNAL_ASSERT(tmp != nullptr);
 
       float polygonArea = polyArea(poly, tile);
+      const int island = getPolyIsland(polyRef);
       if (polygonArea < 1e-5) {
         navMesh->setPolyFlags(polyRef, POLYFLAGS_DISABLED);
-      } else if ((poly->flags & POLYFLAGS_WALK) != 0) {
-        islandsToArea_[polyToIsland_[polyRef]] += polygonArea;
+      } else if ((poly->flags & POLYFLAGS_WALK) != 0 &&
+                 island != ID_UNDEFINED) {
+        islandArea_[island] += polygonArea;
       }
     }
   }
 
   // total of all island areas
-  float totalArea = 0;
-  for (auto& itr : islandsToArea_) {
-    totalArea += itr.second;
+  totalArea_ = 0;
+  for (const float area : islandArea_) {
+    totalArea_ += area;
   }
-  islandsToArea_[ID_UNDEFINED] = totalArea;
-}
-
-int PathFinder::Impl::numIslands() {
-  return islandSystem_->numIslands();
 }
 
-bool PathFinder::Impl::loadNavMesh(const std::string& path) {
-  FILE* fp = fopen(path.c_str(), "rb");
-  if (!fp)
-    return false;
+impl::IslandSystem::IslandSystem(const IslandSystem& previous,
+                                 dtNavMesh* navMesh,
+                                 const dtQueryFilter* filter)
+    : navMesh_{navMesh} {
+  initPolyIndex();
+  const std::vector<int> previousIndices = previousPolyIndices(previous);
+  const int numPrevious = previous.numIslands();
+  const auto previousIsland = [&](const dtPolyRef ref) {
+    const int index = getPolyIndex(ref);
+    return index == ID_UNDEFINED || previousIndices[index] == ID_UNDEFINED
+               ? ID_UNDEFINED
+               : previous.polyIslands_[previousIndices[index]];
+  };
 
-  // Read header.
-  NavMeshSetHeader header{};
-  size_t readLen = fread(&header, sizeof(NavMeshSetHeader), 1, fp);
-  if (readLen != 1) {
-    fclose(fp);
-    return false;
-  }
-  if (header.magic != NAVMESHSET_MAGIC) {
-    fclose(fp);
-    return false;
+  // Islands with polygons in the replaced tiles change
+  std::vector<char> affected(numPrevious, 0);
+  std::vector<char> keptPolys(previous.numPolys_, 0);
+  for (const int index : previousIndices) {
+    if (index != ID_UNDEFINED)
+      keptPolys[index] = 1;
   }
-  if (header.version < 1 || header.version > NAVMESHSET_VERSION) {
-    fclose(fp);
-    return false;
+  for (size_t i = 0; i < previous.numPolys_; ++i) {
+    const int island = previous.polyIslands_[i];
+    if (!keptPolys[i] && island != ID_UNDEFINED)
+      affected[island] = 1;
   }
 
-  navMeshSettings_ = {NavMeshSettings{}};
-  if (header.version >= 2) {
-    fread(&(*navMeshSettings_), sizeof(NavMeshSettings), 1, fp);
-  } else {
-    ESP_DEBUG()
-        << "NavMeshSettings aren't present, guessing that they are the default";
-  }
+  // and so do the ones the new tiles link to
+  std::vector<dtPolyRef> excludedRefs;
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    const bool sameTile = isSameTile(previous, iTile);
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef ref = navMesh->encodePolyId(tile->salt, iTile, jPoly);
+      if (sameTile) {
+        if (!filter->passFilter(ref, tile, poly))
+          excludedRefs.push_back(ref);
+        continue;
+      }
+      for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+           iLink = tile->links[iLink].next) {
+        const int island = previousIsland(tile->links[iLink].ref);
+        if (island != ID_UNDEFINED)
+          affected[island] = 1;
+      }
+    }
+  }
+
+  // Polygons not passing the filter are only reached as the start of a flood
+  // fill, so which island they end up on depends on the islands next to them
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (const dtPolyRef ref : excludedRefs) {
+      const int island = previousIsland(ref);
+      if (island == ID_UNDEFINED || affected[island])
+        continue;
+      const dtMeshTile* tile = nullptr;
+      const dtPoly* poly = nullptr;
+      navMesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+      for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+           iLink = tile->links[iLink].next) {
+        const int neighbourIsland = previousIsland(tile->links[iLink].ref);
+        if (neighbourIsland != ID_UNDEFINED && affected[neighbourIsland]) {
+          affected[island] = 1;
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+
+  // Keep the other islands and flood fill the rest in the same order as the
+  // full build, temporarily numbering the new islands after the previous ones
+  ownedPolyIslands_.assign(numPolys_, ID_UNDEFINED);
+  polyIslands_ = ownedPolyIslands_.data();
+  for (size_t i = 0; i < numPolys_; ++i) {
+    const int index = previousIndices[i];
+    const int island =
+        index == ID_UNDEFINED ? ID_UNDEFINED : previous.polyIslands_[index];
+    if (island != ID_UNDEFINED && !affected[island])
+      ownedPolyIslands_[i] = island;
+  }
+  std::vector<float> radii(previous.islandRadius_);
+  std::vector<vec3f> islandVerts;
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPolyRef startRef =
+          navMesh->encodePolyId(tile->salt, iTile, jPoly);
+      if (navMesh->isValidPolyRef(startRef) &&
+          getPolyIsland(startRef) == ID_UNDEFINED) {
+        expandFrom(navMesh, filter, radii.size(), startRef, islandVerts);
+        radii.emplace_back(vertsRadius(islandVerts));
+      }
+    }
+  }
+
+  // The full build numbers islands by their first polygon
+  std::vector<int> renumbered(radii.size(), ID_UNDEFINED);
+  std::vector<char> refilled;
+  for (int& island : ownedPolyIslands_) {
+    if (island == ID_UNDEFINED)
+      continue;
+    if (renumbered[island] == ID_UNDEFINED) {
+      renumbered[island] = islandRadius_.size();
+      islandRadius_.push_back(radii[island]);
+      islandArea_.push_back(island < numPrevious ? previous.islandArea_[island]
+                                                 : 0.0f);
+      refilled.push_back(island >= numPrevious);
+    }
+    island = renumbered[island];
+  }
+
+  // Same as removeZeroAreaPolys(), the previous tiles were already checked
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    const bool sameTile = isSameTile(previous, iTile);
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const int island = ownedPolyIslands_[tilePolyOffsets_[iTile] + jPoly];
+      if (sameTile && (island == ID_UNDEFINED || !refilled[island]))
+        continue;
+      const float polygonArea = polyArea(poly, tile);
+      if (polygonArea < 1e-5) {
+        navMesh->setPolyFlags(navMesh->encodePolyId(tile->salt, iTile, jPoly),
+                              POLYFLAGS_DISABLED);
+      } else if ((poly->flags & POLYFLAGS_WALK) != 0 &&
+                 island != ID_UNDEFINED) {
+        islandArea_[island] += polygonArea;
+      }
+    }
+  }
+
+  totalArea_ = 0;
+  for (const float area : islandArea_) {
+    totalArea_ += area;
+  }
+}
+
+std::unique_ptr<impl::IslandSystem> impl::IslandSystem::load(
+    const dtNavMesh* navMesh,
+    const char* data,
+    const size_t size,
+    std::shared_ptr<const void> storage) {
+  std::unique_ptr<IslandSystem> islands{new IslandSystem{navMesh}};
+
+  FileHeader header{};
+  if (size < sizeof(header))
+    return nullptr;
+  memcpy(&header, data, sizeof(header));
+  if (header.numIslands < 0 || header.numPolys < 0 ||
+      static_cast<size_t>(header.numPolys) != islands->numPolys_)
+    return nullptr;
+  const size_t numIslands = header.numIslands;
+  const size_t numPolys = header.numPolys;
+  if ((size - sizeof(header)) / sizeof(float) < 2 * numIslands ||
+      size != sizeof(header) + 2 * sizeof(float) * numIslands +
+                  sizeof(int) * numPolys)
+    return nullptr;
+  data += sizeof(header);
+
+  islands->islandRadius_.resize(numIslands);
+  memcpy(islands->islandRadius_.data(), data, sizeof(float) * numIslands);
+  data += sizeof(float) * numIslands;
+  islands->islandArea_.resize(numIslands);
+  memcpy(islands->islandArea_.data(), data, sizeof(float) * numIslands);
+  data += sizeof(float) * numIslands;
+  islands->totalArea_ = header.totalArea;
+
+  // Use the islands in place if the storage outlives us, otherwise copy
+  if (storage && reinterpret_cast<std::uintptr_t>(data) % alignof(int) == 0) {
+    islands->polyIslands_ = reinterpret_cast<const int*>(data);
+    islands->storage_ = std::move(storage);
+  } else {
+    islands->ownedPolyIslands_.resize(numPolys);
+    memcpy(islands->ownedPolyIslands_.data(), data, sizeof(int) * numPolys);
+    islands->polyIslands_ = islands->ownedPolyIslands_.data();
+  }
+
+  for (size_t i = 0; i < numPolys; ++i) {
+    const int island = islands->polyIslands_[i];
+    if (island != ID_UNDEFINED && (island < 0 || island >= numIslands))
+      return nullptr;
+  }
+
+  return islands;
+}
+
+bool impl::IslandSystem::save(FILE* fp) const {
+  FileHeader header{};
+  header.numIslands = islandRadius_.size();
+  header.numPolys = numPolys_;
+  header.totalArea = totalArea_;
+  return fwrite(&header, sizeof(header), 1, fp) == 1 &&
+         fwrite(islandRadius_.data(), sizeof(float), islandRadius_.size(),
+                fp) == islandRadius_.size() &&
+         fwrite(islandArea_.data(), sizeof(float), islandArea_.size(), fp) ==
+             islandArea_.size() &&
+         fwrite(polyIslands_, sizeof(int), numPolys_, fp) == numPolys_;
+}
+
+void impl::IslandSystem::buildSampler() const {
+  // Navigable polygons sorted by island, and their areas
+  std::vector<float> areas;
+  islandSampleOffsets_.assign(islandRadius_.size() + 1, 0);
+  for (int pass = 0; pass < 2; ++pass) {
+    std::vector<unsigned int> next;
+    if (pass == 1) {
+      // prefix sum of the counts from the first pass
+      for (size_t i = 1; i < islandSampleOffsets_.size(); ++i) {
+        islandSampleOffsets_[i] += islandSampleOffsets_[i - 1];
+      }
+      next.assign(islandSampleOffsets_.begin(), islandSampleOffsets_.end() - 1);
+      samplePolys_.resize(islandSampleOffsets_.back());
+      areas.resize(islandSampleOffsets_.back());
+    }
+    for (int iTile = 0; iTile < navMesh_->getMaxTiles(); ++iTile) {
+      const dtMeshTile* tile = navMesh_->getTile(iTile);
+      if (!tile || !tile->header)
+        continue;
+      for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+        const dtPoly* poly = &tile->polys[jPoly];
+        const int island = polyIslands_[tilePolyOffsets_[iTile] + jPoly];
+        // Same polygons as counted by removeZeroAreaPolys()
+        if (island == ID_UNDEFINED || (poly->flags & POLYFLAGS_WALK) == 0 ||
+            poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+          continue;
+        if (pass == 0) {
+          ++islandSampleOffsets_[island + 1];
+          continue;
+        }
+        const unsigned int index = next[island]++;
+        samplePolys_[index] = navMesh_->encodePolyId(tile->salt, iTile, jPoly);
+        areas[index] = polyArea(poly, tile);
+      }
+    }
+  }
+
+  islandAreaSums_.resize(islandArea_.size());
+  std::partial_sum(islandArea_.begin(), islandArea_.end(),
+                   islandAreaSums_.begin());
+
+  sampleProbability_.assign(samplePolys_.size(), 1.0f);
+  sampleAlias_.resize(samplePolys_.size());
+  std::vector<unsigned int> small, large;
+  for (size_t island = 0; island + 1 < islandSampleOffsets_.size(); ++island) {
+    const unsigned int begin = islandSampleOffsets_[island];
+    const unsigned int count = islandSampleOffsets_[island + 1] - begin;
+    double totalArea = 0;
+    for (unsigned int i = 0; i < count; ++i) {
+      totalArea += areas[begin + i];
+    }
+    if (totalArea <= 0)
+      continue;
+
+    // Scale the weights to average 1 and pair each underfull entry with an
+    // overfull one
+    std::vector<double> scaled(count);
+    small.clear();
+    large.clear();
+    for (unsigned int i = 0; i < count; ++i) {
+      scaled[i] = areas[begin + i] * count / totalArea;
+      (scaled[i] < 1.0 ? small : large).push_back(i);
+      sampleAlias_[begin + i] = i;
+    }
+    while (!small.empty() && !large.empty()) {
+      const unsigned int s = small.back();
+      small.pop_back();
+      const unsigned int l = large.back();
+      sampleProbability_[begin + s] = scaled[s];
+      sampleAlias_[begin + s] = l;
+      scaled[l] -= 1.0 - scaled[s];
+      if (scaled[l] < 1.0) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+    // Leftovers are 1 up to rounding error
+    for (const unsigned int i : small) {
+      sampleProbability_[begin + i] = 1.0f;
+    }
+    for (const unsigned int i : large) {
+      sampleProbability_[begin + i] = 1.0f;
+    }
+  }
+}
+
+vec3f impl::IslandSystem::samplePoint(int islandIndex,
+                                      core::Random& random) const {
+  assertValidIsland(islandIndex);
+  std::call_once(samplerBuilt_, [this]() { buildSampler(); });
+
+  if (islandIndex == ID_UNDEFINED) {
+    if (islandAreaSums_.empty() || islandAreaSums_.back() <= 0)
+      return vec3f::Constant(Mn::Constants::nan());
+    const float pick = random.uniform_float_01() * islandAreaSums_.back();
+    islandIndex = std::min<int>(
+        std::upper_bound(islandAreaSums_.begin(), islandAreaSums_.end(),
+                         pick) -
+            islandAreaSums_.begin(),
+        islandAreaSums_.size() - 1);
+  }
+
+  const unsigned int begin = islandSampleOffsets_[islandIndex];
+  const unsigned int count = islandSampleOffsets_[islandIndex + 1] - begin;
+  if (count == 0 || islandArea_[islandIndex] <= 0)
+    return vec3f::Constant(Mn::Constants::nan());
+
+  // Pick a polygon with probability proportional to its area
+  unsigned int index = random.uniform_uint() % count;
+  if (random.uniform_float_01() >= sampleProbability_[begin + index]) {
+    index = sampleAlias_[begin + index];
+  }
+  const dtMeshTile* tile = nullptr;
+  const dtPoly* poly = nullptr;
+  navMesh_->getTileAndPolyByRefUnsafe(samplePolys_[begin + index], &tile,
+                                      &poly);
+
+  // Then a detail triangle the same way, and a point uniformly inside it
+  const std::vector<Triangle> triangles = getPolygonTriangles(poly, tile);
+  std::vector<float> triangleAreas(triangles.size());
+  float polygonArea = 0;
+  for (size_t i = 0; i < triangles.size(); ++i) {
+    const Triangle& tri = triangles[i];
+    triangleAreas[i] =
+        0.5f * (tri.v[1] - tri.v[0]).cross(tri.v[2] - tri.v[1]).norm();
+    polygonArea += triangleAreas[i];
+  }
+  float pick = random.uniform_float_01() * polygonArea;
+  size_t iTri = 0;
+  while (iTri + 1 < triangles.size() && pick >= triangleAreas[iTri]) {
+    pick -= triangleAreas[iTri];
+    ++iTri;
+  }
+  const Triangle& tri = triangles[iTri];
+  const float s = std::sqrt(random.uniform_float_01());
+  const float t = random.uniform_float_01();
+  return (1.0f - s) * tri.v[0] + s * (1.0f - t) * tri.v[1] + s * t * tri.v[2];
+}
+
+impl::PathHierarchy::PathHierarchy(const dtNavMesh* navMesh,
+                                   std::shared_ptr<const IslandSystem> islands,
+                                   const dtQueryFilter* filter,
+                                   const int clusterSize)
+    : islands_{std::move(islands)}, clusterSize_{clusterSize} {
+  initPolyGraph(navMesh, filter);
+  polyClusters_.assign(polyRefs_.size(), ID_UNDEFINED);
+  growClusters();
+
+  std::vector<Portal> portals;
+  collectPortals(0, portals);
+  initEntrances(portals);
+  initClusterEntrances();
+  initEdges();
+
+  ESP_DEBUG() << "Built path hierarchy with" << numClusters_ << "clusters and"
+              << entrancePositions_.size() << "entrances";
+}
+
+impl::PathHierarchy::PathHierarchy(const PathHierarchy& previous,
+                                   const dtNavMesh* navMesh,
+                                   std::shared_ptr<const IslandSystem> islands,
+                                   const dtQueryFilter* filter)
+    : islands_{std::move(islands)}, clusterSize_{previous.clusterSize_} {
+  const std::vector<int> previousIndices =
+      islands_->previousPolyIndices(*previous.islands_);
+  initPolyGraph(navMesh, filter, &previous, previousIndices);
+  const int numPolys = polyRefs_.size();
+
+  // Keep the clusters whose polygons are all still there
+  std::vector<int> previousPolys(previous.polyRefs_.size(), ID_UNDEFINED);
+  for (int poly = 0; poly < numPolys; ++poly) {
+    if (previousIndices[poly] != ID_UNDEFINED)
+      previousPolys[previousIndices[poly]] = poly;
+  }
+  std::vector<int> keptClusters(previous.numClusters_, 0);
+  for (size_t i = 0; i < previousPolys.size(); ++i) {
+    const int cluster = previous.polyClusters_[i];
+    if (cluster == ID_UNDEFINED)
+      continue;
+    const int poly = previousPolys[i];
+    keptClusters[cluster] =
+        keptClusters[cluster] != ID_UNDEFINED && poly != ID_UNDEFINED &&
+                polyRefs_[poly] != 0 &&
+                islands_->getPolyIsland(polyRefs_[poly]) != ID_UNDEFINED
+            ? 0
+            : ID_UNDEFINED;
+  }
+  for (int& cluster : keptClusters) {
+    if (cluster != ID_UNDEFINED)
+      cluster = numClusters_++;
+  }
+  const int numKept = numClusters_;
+  polyClusters_.assign(numPolys, ID_UNDEFINED);
+  for (size_t i = 0; i < previousPolys.size(); ++i) {
+    const int cluster = previous.polyClusters_[i];
+    if (cluster != ID_UNDEFINED && keptClusters[cluster] != ID_UNDEFINED)
+      polyClusters_[previousPolys[i]] = keptClusters[cluster];
+  }
+  growClusters();
+
+  // Entrances between two kept clusters stay, only portals of the new
+  // clusters have to be looked at
+  std::vector<Portal> portals;
+  for (size_t entrance = 0; entrance < previous.entrancePositions_.size();
+       ++entrance) {
+    const int poly = previous.entrancePolys_[2 * entrance];
+    const int neighbour = previous.entrancePolys_[2 * entrance + 1];
+    const int cluster = keptClusters[previous.polyClusters_[poly]];
+    const int neighbourCluster =
+        keptClusters[previous.polyClusters_[neighbour]];
+    if (cluster != ID_UNDEFINED && neighbourCluster != ID_UNDEFINED) {
+      portals.push_back(Portal{{cluster, neighbourCluster},
+                               previousPolys[poly],
+                               previousPolys[neighbour],
+                               previous.entrancePositions_[entrance],
+                               static_cast<int>(entrance)});
+    }
+  }
+  collectPortals(numKept, portals);
+  const std::vector<int> previousEntrances = initEntrances(portals);
+  initClusterEntrances();
+
+  // Kept clusters next to a new one got new entrances, the edges of the
+  // others can be copied
+  std::vector<char> unchangedClusters(numClusters_, 0);
+  for (int cluster = 0; cluster < previous.numClusters_; ++cluster) {
+    const int kept = keptClusters[cluster];
+    if (kept == ID_UNDEFINED)
+      continue;
+    unchangedClusters[kept] =
+        clusterEntranceOffsets_[kept + 1] - clusterEntranceOffsets_[kept] ==
+        previous.clusterEntranceOffsets_[cluster + 1] -
+            previous.clusterEntranceOffsets_[cluster];
+    for (int i = clusterEntranceOffsets_[kept];
+         i < clusterEntranceOffsets_[kept + 1]; ++i) {
+      if (previousEntrances[clusterEntrances_[i]] == ID_UNDEFINED)
+        unchangedClusters[kept] = 0;
+    }
+  }
+  initEdges(&previous, previousEntrances, unchangedClusters);
+
+  ESP_DEBUG() << "Updated path hierarchy, kept" << numKept << "of"
+              << numClusters_ << "clusters";
+}
+
+void impl::PathHierarchy::growClusters() {
+  // Grow clusters breadth first from the first polygon not in any yet, which
+  // keeps them compact and connected. Walkable neighbours are always on the
+  // same island.
+  const int numPolys = polyRefs_.size();
+  std::vector<int> clusterPolys;
+  for (int seed = 0; seed < numPolys; ++seed) {
+    if (polyRefs_[seed] == 0 || polyClusters_[seed] != ID_UNDEFINED ||
+        islands_->getPolyIsland(polyRefs_[seed]) == ID_UNDEFINED)
+      continue;
+    const int cluster = numClusters_++;
+    polyClusters_[seed] = cluster;
+    clusterPolys.assign(1, seed);
+    for (size_t head = 0;
+         head < clusterPolys.size() &&
+         clusterPolys.size() < static_cast<size_t>(clusterSize_);
+         ++head) {
+      const int poly = clusterPolys[head];
+      for (int i = neighbourOffsets_[poly];
+           i < neighbourOffsets_[poly + 1] &&
+           clusterPolys.size() < static_cast<size_t>(clusterSize_);
+           ++i) {
+        const int neighbour = neighbours_[i];
+        if (polyClusters_[neighbour] != ID_UNDEFINED)
+          continue;
+        polyClusters_[neighbour] = cluster;
+        clusterPolys.push_back(neighbour);
+      }
+    }
+  }
+}
+
+void impl::PathHierarchy::collectPortals(const int firstCluster,
+                                         std::vector<Portal>& portals) const {
+  // Each portal is visited from both sides, so only add it from the cluster
+  // with the smaller index
+  for (size_t poly = 0; poly < polyClusters_.size(); ++poly) {
+    const int cluster = polyClusters_[poly];
+    if (cluster == ID_UNDEFINED)
+      continue;
+    for (int i = neighbourOffsets_[poly]; i < neighbourOffsets_[poly + 1];
+         ++i) {
+      const int neighbourCluster = polyClusters_[neighbours_[i]];
+      if (neighbourCluster > cluster && neighbourCluster >= firstCluster) {
+        portals.push_back(Portal{{cluster, neighbourCluster},
+                                 static_cast<int>(poly),
+                                 neighbours_[i],
+                                 portalMidpoints_[i],
+                                 ID_UNDEFINED});
+      }
+    }
+  }
+}
+
+std::vector<int> impl::PathHierarchy::initEntrances(
+    std::vector<Portal>& portals) {
+  // One entrance per pair of adjacent clusters, on the portal closest to the
+  // middle of their shared boundary
+  std::vector<int> previousEntrances;
+  std::stable_sort(portals.begin(), portals.end(),
+                   [](const Portal& a, const Portal& b) {
+                     return a.clusters < b.clusters;
+                   });
+  for (size_t begin = 0, end = 0; begin < portals.size(); begin = end) {
+    vec3f middle = vec3f::Zero();
+    const std::pair<int, int> clusters = portals[begin].clusters;
+    for (end = begin;
+         end < portals.size() && portals[end].clusters == clusters; ++end) {
+      middle += portals[end].midpoint;
+    }
+    middle /= end - begin;
+    size_t best = begin;
+    for (size_t i = begin + 1; i < end; ++i) {
+      if ((portals[i].midpoint - middle).squaredNorm() <
+          (portals[best].midpoint - middle).squaredNorm())
+        best = i;
+    }
+    entrancePositions_.push_back(portals[best].midpoint);
+    entrancePolys_.push_back(portals[best].poly);
+    entrancePolys_.push_back(portals[best].neighbour);
+    previousEntrances.push_back(portals[best].previousEntrance);
+  }
+  return previousEntrances;
+}
+
+void impl::PathHierarchy::initEdges(
+    const PathHierarchy* previous,
+    const std::vector<int>& previousEntrances,
+    const std::vector<char>& unchangedClusters) {
+  // Costs between the entrances of each cluster
+  const int numEntrances = entrancePositions_.size();
+  std::vector<std::vector<std::pair<int, float>>> edges(numEntrances);
+  for (int cluster = 0; cluster < numClusters_; ++cluster) {
+    const int begin = clusterEntranceOffsets_[cluster];
+    const int end = clusterEntranceOffsets_[cluster + 1];
+    const bool kept = previous && unchangedClusters[cluster];
+    for (int i = begin; i < end; ++i) {
+      const int entrance = clusterEntrances_[i];
+      if (kept) {
+        // Two entrances share at most one cluster, so an edge between them
+        // is one of this cluster
+        const int previousEntrance = previousEntrances[entrance];
+        for (int j = begin; j < end; ++j) {
+          if (j == i)
+            continue;
+          const int target = previousEntrances[clusterEntrances_[j]];
+          for (int k = previous->edgeOffsets_[previousEntrance];
+               k < previous->edgeOffsets_[previousEntrance + 1]; ++k) {
+            if (previous->edgeTargets_[k] == target)
+              edges[entrance].emplace_back(clusterEntrances_[j],
+                                           previous->edgeCosts_[k]);
+          }
+        }
+        continue;
+      }
+      const std::vector<float> costs = entranceCosts(
+          entrancePoly(entrance, cluster), entrancePositions_[entrance]);
+      for (int j = begin; j < end; ++j) {
+        if (j != i && costs[j - begin] < std::numeric_limits<float>::infinity())
+          edges[entrance].emplace_back(clusterEntrances_[j], costs[j - begin]);
+      }
+    }
+  }
+  edgeOffsets_.reserve(numEntrances + 1);
+  edgeOffsets_.push_back(0);
+  for (const std::vector<std::pair<int, float>>& entranceEdges : edges) {
+    for (const std::pair<int, float>& edge : entranceEdges) {
+      edgeTargets_.push_back(edge.first);
+      edgeCosts_.push_back(edge.second);
+    }
+    edgeOffsets_.push_back(edgeTargets_.size());
+  }
+}
+
+void impl::PathHierarchy::initPolyGraph(
+    const dtNavMesh* navMesh,
+    const dtQueryFilter* filter,
+    const PathHierarchy* previous,
+    const std::vector<int>& previousIndices) {
+  const int numPolys = islands_->numPolys();
+  polyRefs_.assign(numPolys, 0);
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef ref = navMesh->encodePolyId(tile->salt, iTile, jPoly);
+      const int index = islands_->getPolyIndex(ref);
+      if (index == ID_UNDEFINED ||
+          poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter->passFilter(ref, tile, poly))
+        continue;
+      polyRefs_[index] = ref;
+    }
+  }
+
+  neighbourOffsets_.reserve(numPolys + 1);
+  neighbourOffsets_.push_back(0);
+  for (int index = 0; index < numPolys; ++index) {
+    if (polyRefs_[index] != 0) {
+      const dtMeshTile* tile = nullptr;
+      const dtPoly* poly = nullptr;
+      navMesh->getTileAndPolyByRefUnsafe(polyRefs_[index], &tile, &poly);
+      for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+           iLink = tile->links[iLink].next) {
+        const dtLink& link = tile->links[iLink];
+        const int neighbour = islands_->getPolyIndex(link.ref);
+        if (neighbour == ID_UNDEFINED || polyRefs_[neighbour] == 0)
+          continue;
+        neighbours_.push_back(neighbour);
+        if (const vec3f* midpoint =
+                previous ? previous->portalMidpoint(previousIndices[index],
+                                                    previousIndices[neighbour])
+                         : nullptr) {
+          portalMidpoints_.push_back(*midpoint);
+          continue;
+        }
+        const std::pair<vec3f, vec3f> portal = portalPoints(tile, poly, link);
+        portalMidpoints_.emplace_back(0.5f * (portal.first + portal.second));
+      }
+    }
+    neighbourOffsets_.push_back(neighbours_.size());
+  }
+}
+
+void impl::PathHierarchy::initClusterEntrances() {
+  const int numEntrances = entrancePositions_.size();
+  clusterEntranceOffsets_.assign(numClusters_ + 1, 0);
+  for (const int poly : entrancePolys_) {
+    ++clusterEntranceOffsets_[polyClusters_[poly] + 1];
+  }
+  for (int cluster = 0; cluster < numClusters_; ++cluster) {
+    clusterEntranceOffsets_[cluster + 1] += clusterEntranceOffsets_[cluster];
+  }
+  std::vector<int> next(clusterEntranceOffsets_.begin(),
+                        clusterEntranceOffsets_.end() - 1);
+  clusterEntrances_.resize(entrancePolys_.size());
+  for (int entrance = 0; entrance < numEntrances; ++entrance) {
+    for (int side = 0; side < 2; ++side) {
+      const int cluster = polyClusters_[entrancePolys_[2 * entrance + side]];
+      clusterEntrances_[next[cluster]++] = entrance;
+    }
+  }
+}
+
+std::vector<float> impl::PathHierarchy::entranceCosts(
+    const int poly,
+    const vec3f& position) const {
+  const int cluster = polyClusters_[poly];
+
+  // Dijkstra over the polygons of the cluster. Like in Detour's search, each
+  // polygon is entered at the midpoint of the portal it's reached through.
+  struct Node {
+    float cost;
+    vec3f position;
+  };
+  std::unordered_map<int, Node> nodes;
+  typedef std::pair<float, int> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      std::greater<QueueEntry>>
+      queue;
+  nodes[poly] = Node{0.0f, position};
+  queue.emplace(0.0f, poly);
+  while (!queue.empty()) {
+    const QueueEntry top = queue.top();
+    queue.pop();
+    const Node node = nodes.at(top.second);
+    if (top.first > node.cost)
+      continue;
+
+    for (int i = neighbourOffsets_[top.second];
+         i < neighbourOffsets_[top.second + 1]; ++i) {
+      const int neighbour = neighbours_[i];
+      if (polyClusters_[neighbour] != cluster)
+        continue;
+      const float cost =
+          node.cost + (portalMidpoints_[i] - node.position).norm();
+      auto found = nodes.find(neighbour);
+      if (found == nodes.end() || cost < found->second.cost) {
+        nodes[neighbour] = Node{cost, portalMidpoints_[i]};
+        queue.emplace(cost, neighbour);
+      }
+    }
+  }
+
+  const int begin = clusterEntranceOffsets_[cluster];
+  const int end = clusterEntranceOffsets_[cluster + 1];
+  std::vector<float> costs(end - begin,
+                           std::numeric_limits<float>::infinity());
+  for (int i = begin; i < end; ++i) {
+    const int entrance = clusterEntrances_[i];
+    auto found = nodes.find(entrancePoly(entrance, cluster));
+    if (found != nodes.end()) {
+      costs[i - begin] =
+          found->second.cost +
+          (entrancePositions_[entrance] - found->second.position).norm();
+    }
+  }
+  return costs;
+}
+
+bool impl::PathHierarchy::findCorridor(const vec3f& start,
+                                       const dtPolyRef startRef,
+                                       const vec3f& end,
+                                       const dtPolyRef endRef,
+                                       std::vector<dtPolyRef>& corridor) const {
+  const int startPoly = islands_->getPolyIndex(startRef);
+  const int endPoly = islands_->getPolyIndex(endRef);
+  if (startPoly == ID_UNDEFINED || endPoly == ID_UNDEFINED)
+    return false;
+  const int startCluster = polyClusters_[startPoly];
+  const int endCluster = polyClusters_[endPoly];
+  if (startCluster == ID_UNDEFINED || endCluster == ID_UNDEFINED)
+    return false;
+  if (startCluster == endCluster) {
+    return refineCorridor(startPoly, start, endPoly, end,
+                          std::numeric_limits<float>::infinity(), nullptr,
+                          corridor);
+  }
+
+  // A* over the entrances, from the entrances of the start cluster to the
+  // ones of the end cluster. Entrance costs are walking distances, so the
+  // straight-line distance to the end never overestimates.
+  const std::vector<float> startCosts = entranceCosts(startPoly, start);
+  const std::vector<float> endCosts = entranceCosts(endPoly, end);
+  std::unordered_map<int, float> exitCosts;
+  for (int i = clusterEntranceOffsets_[endCluster];
+       i < clusterEntranceOffsets_[endCluster + 1]; ++i) {
+    const float cost = endCosts[i - clusterEntranceOffsets_[endCluster]];
+    if (cost < std::numeric_limits<float>::infinity())
+      exitCosts[clusterEntrances_[i]] = cost;
+  }
+
+  const int numEntrances = entrancePositions_.size();
+  std::vector<float> costs(numEntrances,
+                           std::numeric_limits<float>::infinity());
+  std::vector<int> parents(numEntrances, ID_UNDEFINED);
+  std::vector<bool> closed(numEntrances, false);
+  typedef std::pair<float, int> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      std::greater<QueueEntry>>
+      queue;
+  for (int i = clusterEntranceOffsets_[startCluster];
+       i < clusterEntranceOffsets_[startCluster + 1]; ++i) {
+    const int entrance = clusterEntrances_[i];
+    const float cost = startCosts[i - clusterEntranceOffsets_[startCluster]];
+    if (cost < costs[entrance]) {
+      costs[entrance] = cost;
+      queue.emplace(cost + (entrancePositions_[entrance] - end).norm(),
+                    entrance);
+    }
+  }
+
+  float bestCost = std::numeric_limits<float>::infinity();
+  int bestExit = ID_UNDEFINED;
+  while (!queue.empty() && queue.top().first < bestCost) {
+    const int entrance = queue.top().second;
+    queue.pop();
+    if (closed[entrance])
+      continue;
+    closed[entrance] = true;
+
+    auto exit = exitCosts.find(entrance);
+    if (exit != exitCosts.end() && costs[entrance] + exit->second < bestCost) {
+      bestCost = costs[entrance] + exit->second;
+      bestExit = entrance;
+    }
+
+    for (int i = edgeOffsets_[entrance]; i < edgeOffsets_[entrance + 1]; ++i) {
+      const int target = edgeTargets_[i];
+      const float cost = costs[entrance] + edgeCosts_[i];
+      if (!closed[target] && cost < costs[target]) {
+        costs[target] = cost;
+        parents[target] = entrance;
+        queue.emplace(cost + (entrancePositions_[target] - end).norm(),
+                      target);
+      }
+    }
+  }
+  if (bestExit == ID_UNDEFINED) {
+    return refineCorridor(startPoly, start, endPoly, end,
+                          std::numeric_limits<float>::infinity(), nullptr,
+                          corridor);
+  }
+
+  // The route is a path the polygon search could take, so its cost, plus
+  // some slack for rounding, bounds the shortest one
+  if (refineCorridor(startPoly, start, endPoly, end,
+                     bestCost * (1.0f + 1e-4f) + 1e-3f, nullptr, corridor))
+    return true;
+
+  // Each polygon is entered through a single portal, so in rare cases the
+  // bound cuts the route off. Follow the clusters along it then.
+  std::vector<int> corridorClusters{startCluster, endCluster};
+  for (int entrance = bestExit; entrance != ID_UNDEFINED;
+       entrance = parents[entrance]) {
+    corridorClusters.push_back(polyClusters_[entrancePolys_[2 * entrance]]);
+    corridorClusters.push_back(
+        polyClusters_[entrancePolys_[2 * entrance + 1]]);
+  }
+  std::sort(corridorClusters.begin(), corridorClusters.end());
+  corridorClusters.erase(
+      std::unique(corridorClusters.begin(), corridorClusters.end()),
+      corridorClusters.end());
+  return refineCorridor(startPoly, start, endPoly, end,
+                        std::numeric_limits<float>::infinity(),
+                        &corridorClusters, corridor);
+}
+
+bool impl::PathHierarchy::refineCorridor(
+    const int startPoly,
+    const vec3f& start,
+    const int endPoly,
+    const vec3f& end,
+    const float maxCost,
+    const std::vector<int>* clusters,
+    std::vector<dtPolyRef>& corridor) const {
+  // Same costs as the cluster search. The end polygon's cost includes the
+  // last leg to the end, so the heuristic is exact there.
+  struct Node {
+    float cost;
+    vec3f position;
+    int parent;
+    bool closed;
+  };
+  std::unordered_map<int, Node> nodes;
+  typedef std::pair<float, int> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      std::greater<QueueEntry>>
+      queue;
+  nodes[startPoly] = Node{0.0f, start, ID_UNDEFINED, false};
+  queue.emplace((end - start).norm(), startPoly);
+  while (!queue.empty()) {
+    const int poly = queue.top().second;
+    queue.pop();
+    // References to unordered_map elements survive insertions
+    Node& node = nodes.at(poly);
+    if (node.closed)
+      continue;
+    node.closed = true;
+    if (poly == endPoly)
+      break;
+
+    for (int i = neighbourOffsets_[poly]; i < neighbourOffsets_[poly + 1];
+         ++i) {
+      const int neighbour = neighbours_[i];
+      if (polyClusters_[neighbour] == ID_UNDEFINED ||
+          (clusters && !std::binary_search(clusters->begin(), clusters->end(),
+                                           polyClusters_[neighbour])))
+        continue;
+      const vec3f& position = portalMidpoints_[i];
+      const float toEnd = (end - position).norm();
+      float cost = node.cost + (position - node.position).norm();
+      if (neighbour == endPoly)
+        cost += toEnd;
+      // The straight line to the end never overestimates
+      const float estimate = neighbour == endPoly ? cost : cost + toEnd;
+      if (estimate > maxCost)
+        continue;
+
+      auto found = nodes.find(neighbour);
+      if (found == nodes.end()) {
+        nodes.emplace(neighbour, Node{cost, position, poly, false});
+      } else if (!found->second.closed && cost < found->second.cost) {
+        found->second = Node{cost, position, poly, false};
+      } else {
+        continue;
+      }
+      queue.emplace(estimate, neighbour);
+    }
+  }
+
+  auto found = nodes.find(endPoly);
+  if (found == nodes.end() || !found->second.closed)
+    return false;
+  corridor.clear();
+  for (int poly = endPoly; poly != ID_UNDEFINED; poly = nodes.at(poly).parent) {
+    corridor.push_back(polyRefs_[poly]);
+  }
+  std::reverse(corridor.begin(), corridor.end());
+  return true;
+}
+
+std::unique_ptr<impl::PathHierarchy> impl::PathHierarchy::load(
+    const dtNavMesh* navMesh,
+    std::shared_ptr<const IslandSystem> islands,
+    const dtQueryFilter* filter,
+    const char* data,
+    const size_t size) {
+  std::unique_ptr<PathHierarchy> hierarchy{
+      new PathHierarchy{std::move(islands)}};
+
+  FileHeader header{};
+  if (size < sizeof(header))
+    return nullptr;
+  memcpy(&header, data, sizeof(header));
+  hierarchy->initPolyGraph(navMesh, filter);
+  if (header.clusterSize <= 0 || header.numClusters < 0 ||
+      header.numEntrances < 0 || header.numEdges < 0 ||
+      header.numPolys != hierarchy->polyRefs_.size())
+    return nullptr;
+  const size_t numPolys = header.numPolys;
+  const size_t numEntrances = header.numEntrances;
+  const size_t numEdges = header.numEdges;
+  if (size != sizeof(header) + sizeof(int) * numPolys +
+                  sizeof(vec3f) * numEntrances +
+                  sizeof(int) * (3 * numEntrances + 1) +
+                  (sizeof(int) + sizeof(float)) * numEdges)
+    return nullptr;
+  data += sizeof(header);
+
+  const auto read = [&data](void* dst, size_t bytes) {
+    if (bytes > 0)
+      memcpy(dst, data, bytes);
+    data += bytes;
+  };
+  PathHierarchy& h = *hierarchy;
+  h.clusterSize_ = header.clusterSize;
+  h.numClusters_ = header.numClusters;
+  h.polyClusters_.resize(numPolys);
+  read(h.polyClusters_.data(), sizeof(int) * numPolys);
+  h.entrancePositions_.resize(numEntrances);
+  read(h.entrancePositions_.data(), sizeof(vec3f) * numEntrances);
+  h.entrancePolys_.resize(2 * numEntrances);
+  read(h.entrancePolys_.data(), sizeof(int) * 2 * numEntrances);
+  h.edgeOffsets_.resize(numEntrances + 1);
+  read(h.edgeOffsets_.data(), sizeof(int) * (numEntrances + 1));
+  h.edgeTargets_.resize(numEdges);
+  read(h.edgeTargets_.data(), sizeof(int) * numEdges);
+  h.edgeCosts_.resize(numEdges);
+  read(h.edgeCosts_.data(), sizeof(float) * numEdges);
+
+  for (size_t i = 0; i < numPolys; ++i) {
+    const int cluster = h.polyClusters_[i];
+    if (cluster != ID_UNDEFINED &&
+        (cluster < 0 || cluster >= h.numClusters_ || h.polyRefs_[i] == 0))
+      return nullptr;
+  }
+  for (const int poly : h.entrancePolys_) {
+    if (poly < 0 || poly >= numPolys ||
+        h.polyClusters_[poly] == ID_UNDEFINED)
+      return nullptr;
+  }
+  if (h.edgeOffsets_.front() != 0 || h.edgeOffsets_.back() != numEdges)
+    return nullptr;
+  for (size_t i = 0; i < numEntrances; ++i) {
+    if (h.edgeOffsets_[i] > h.edgeOffsets_[i + 1])
+      return nullptr;
+  }
+  for (const int target : h.edgeTargets_) {
+    if (target < 0 || target >= numEntrances)
+      return nullptr;
+  }
+
+  h.initClusterEntrances();
+  return hierarchy;
+}
+
+bool impl::PathHierarchy::save(FILE* fp) const {
+  FileHeader header{};
+  header.clusterSize = clusterSize_;
+  header.numClusters = numClusters_;
+  header.numPolys = polyClusters_.size();
+  header.numEntrances = entrancePositions_.size();
+  header.numEdges = edgeTargets_.size();
+  const auto write = [fp](const void* src, size_t elementSize, size_t count) {
+    return fwrite(src, elementSize, count, fp) == count;
+  };
+  return write(&header, sizeof(header), 1) &&
+         write(polyClusters_.data(), sizeof(int), polyClusters_.size()) &&
+         write(entrancePositions_.data(), sizeof(vec3f),
+               entrancePositions_.size()) &&
+         write(entrancePolys_.data(), sizeof(int), entrancePolys_.size()) &&
+         write(edgeOffsets_.data(), sizeof(int), edgeOffsets_.size()) &&
+         write(edgeTargets_.data(), sizeof(int), edgeTargets_.size()) &&
+         write(edgeCosts_.data(), sizeof(float), edgeCosts_.size());
+}
+
+int impl::PathHierarchy::persistedClusterSize(const char* data,
+                                              const size_t size) {
+  FileHeader header{};
+  if (size < sizeof(header))
+    return 0;
+  memcpy(&header, data, sizeof(header));
+  return std::max(header.clusterSize, 0);
+}
+
+int PathFinder::Impl::numIslands() {
+  return islandSystem_->numIslands();
+}
+
+namespace {
+//! Sequential, bounds-checked reads from an in-memory .navmesh file.
+class NavMeshFileReader {
+ public:
+  NavMeshFileReader(char* data, size_t size) : data_{data}, size_{size} {}
+
+  template <typename T>
+  bool read(T& value) {
+    return read(&value, sizeof(T));
+  }
+
+  bool read(void* dst, size_t size) {
+    char* src = view(size);
+    if (!src)
+      return false;
+    memcpy(dst, src, size);
+    return true;
+  }
+
+  //! Pointer to the next @p size bytes which are then skipped, nullptr if the
+  //! file is too short.
+  char* view(size_t size) {
+    if (size > size_ - offset_)
+      return nullptr;
+    char* ptr = data_ + offset_;
+    offset_ += size;
+    return ptr;
+  }
+
+  size_t remaining() const { return size_ - offset_; }
+
+ private:
+  char* data_;
+  size_t size_;
+  size_t offset_ = 0;
+};
+
+bool readFile(const std::string& path, std::vector<char>& contents) {
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (!fp)
+    return false;
+  char buffer[1 << 16];
+  size_t readLen = 0;
+  while ((readLen = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+    contents.insert(contents.end(), buffer, buffer + readLen);
+  }
+  const bool ok = !ferror(fp);
+  fclose(fp);
+  return ok;
+}
+
+//! Write a section with @p tag and whatever @p write puts in @p fp, see
+//! NavMeshSectionHeader.
+template <typename WriteFn>
+bool writeSection(FILE* fp, const int tag, WriteFn&& write) {
+  NavMeshSectionHeader sectionHeader{tag, 0};
+  const long headerOffset = ftell(fp);
+  if (headerOffset < 0 ||
+      fwrite(&sectionHeader, sizeof(sectionHeader), 1, fp) != 1 || !write(fp))
+    return false;
+  const long endOffset = ftell(fp);
+  const long dataSize = endOffset - headerOffset - long{sizeof(sectionHeader)};
+  if (endOffset < 0 || dataSize > std::numeric_limits<int>::max())
+    return false;
+  sectionHeader.dataSize = static_cast<int>(dataSize);
+  const char padding[3]{};
+  const size_t paddingSize = (4 - dataSize % 4) % 4;
+  return fseek(fp, headerOffset, SEEK_SET) == 0 &&
+         fwrite(&sectionHeader, sizeof(sectionHeader), 1, fp) == 1 &&
+         fseek(fp, endOffset, SEEK_SET) == 0 &&
+         fwrite(padding, 1, paddingSize, fp) == paddingSize;
+}
+}  // namespace
+
+bool PathFinder::Impl::loadNavMesh(const std::string& path,
+                                   const bool memoryMap) {
+  std::shared_ptr<core::MappedFile> mapping;
+  std::vector<char> contents;
+  if (memoryMap) {
+    mapping = core::MappedFile::map(path);
+#ifndef CORRADE_TARGET_UNIX
+    ESP_WARNING() << "Memory mapping isn't supported on this platform, "
+                     "reading the navmesh instead";
+#endif
+  }
+  if (!mapping && !readFile(path, contents))
+    return false;
+  NavMeshFileReader reader =
+      mapping ? NavMeshFileReader{mapping->data(), mapping->size()}
+              : NavMeshFileReader{contents.data(), contents.size()};
+
+  // Read header.
+  NavMeshSetHeader header{};
+  if (!reader.read(header))
+    return false;
+  if (header.magic != NAVMESHSET_MAGIC)
+    return false;
+  if (header.version < 1 || header.version > NAVMESHSET_VERSION)
+    return false;
+
+  NavMeshSettings settings{};
+  if (header.version >= 3) {
+    if (!reader.read(settings))
+      return false;
+  } else if (header.version == 2) {
+    // Settings fields added since are appended, so older ones are a prefix.
+    if (!reader.read(&settings, offsetof(NavMeshSettings, tileSize)))
+      return false;
+  } else {
+    ESP_DEBUG()
+        << "NavMeshSettings aren't present, guessing that they are the default";
+  }
 
   vec3f bmin, bmax;
 
-  dtNavMesh* mesh = dtAllocNavMesh();
-  if (!mesh) {
-    fclose(fp);
+  // Tiles added without DT_TILE_FREE_DATA point into the mapping, which the
+  // deleter keeps alive for as long as the navmesh exists.
+  std::shared_ptr<dtNavMesh> mesh(dtAllocNavMesh(), NavMeshDeleter{mapping});
+  if (!mesh)
     return false;
-  }
   dtStatus status = mesh->init(&header.params);
-  if (dtStatusFailed(status)) {
-    fclose(fp);
+  if (dtStatusFailed(status))
     return false;
-  }
 
   // Read tiles.
+  bool allTilesRead = true;
   for (int i = 0; i < header.numTiles; ++i) {
     NavMeshTileHeader tileHeader{};
-    readLen = fread(&tileHeader, sizeof(tileHeader), 1, fp);
-    if (readLen != 1) {
-      fclose(fp);
+    if (!reader.read(tileHeader))
       return false;
-    }
 
-    if ((tileHeader.tileRef == 0u) || (tileHeader.dataSize == 0))
+    if ((tileHeader.tileRef == 0u) || (tileHeader.dataSize == 0)) {
+      allTilesRead = false;
       break;
+    }
 
-    unsigned char* data = static_cast<unsigned char*>(
-        dtAlloc(tileHeader.dataSize, DT_ALLOC_PERM));
-    if (!data)
-      break;
-    memset(data, 0, tileHeader.dataSize);
-    readLen = fread(data, tileHeader.dataSize, 1, fp);
-    if (readLen != 1) {
-      dtFree(data);
-      fclose(fp);
+    unsigned char* fileData =
+        reinterpret_cast<unsigned char*>(reader.view(tileHeader.dataSize));
+    if (!fileData)
       return false;
+
+    // Detour accesses tile data in place and needs it 4-byte aligned, which
+    // holds for files written by saveNavMesh.
+    unsigned char* data = fileData;
+    int flags = 0;
+    if (!mapping || reinterpret_cast<std::uintptr_t>(fileData) % 4 != 0) {
+      data = static_cast<unsigned char*>(
+          dtAlloc(tileHeader.dataSize, DT_ALLOC_PERM));
+      if (!data) {
+        allTilesRead = false;
+        break;
+      }
+      memcpy(data, fileData, tileHeader.dataSize);
+      flags = DT_TILE_FREE_DATA;
     }
 
-    mesh->addTile(data, tileHeader.dataSize, DT_TILE_FREE_DATA,
-                  tileHeader.tileRef, nullptr);
+    if (dtStatusFailed(mesh->addTile(data, tileHeader.dataSize, flags,
+                                     tileHeader.tileRef, nullptr))) {
+      if (flags & DT_TILE_FREE_DATA)
+        dtFree(data);
+      return false;
+    }
     const dtMeshTile* tile = mesh->getTileByRef(tileHeader.tileRef);
     if (i == 0) {
       bmin = vec3f(tile->header->bmin);
@@ -1085,12 +3655,69 @@ bool PathFinder::Impl::loadNavMesh(const std::string& path) {
     }
   }
 
-  fclose(fp);
+  // Optional sections, see NavMeshSectionHeader. Anything missing or unusable
+  // is recomputed.
+  const char* islandsData = nullptr;
+  size_t islandsSize = 0;
+  const char* hierarchyData = nullptr;
+  size_t hierarchySize = 0;
+  if (header.version >= 3 && allTilesRead) {
+    while (reader.remaining() > 0) {
+      NavMeshSectionHeader sectionHeader{};
+      const char* sectionData = nullptr;
+      if (reader.read(sectionHeader) && sectionHeader.dataSize >= 0) {
+        const size_t dataSize = sectionHeader.dataSize;
+        sectionData = reader.view((dataSize + 3) & ~size_t{3});
+      }
+      if (!sectionData) {
+        ESP_WARNING() << "Ignoring a truncated section in" << path;
+        break;
+      }
+      if (sectionHeader.tag == NAVMESHSECTION_ISLANDS) {
+        islandsData = sectionData;
+        islandsSize = sectionHeader.dataSize;
+      } else if (sectionHeader.tag == NAVMESHSECTION_HIERARCHY) {
+        hierarchyData = sectionData;
+        hierarchySize = sectionHeader.dataSize;
+      } else {
+        ESP_DEBUG() << "Skipping unknown section" << sectionHeader.tag << "in"
+                    << path;
+      }
+    }
+  }
+
+  std::shared_ptr<impl::IslandSystem> islandSystem;
+  if (islandsData) {
+    islandSystem = impl::IslandSystem::load(mesh.get(), islandsData,
+                                            islandsSize, mapping);
+    if (!islandSystem) {
+      ESP_WARNING() << "Persisted navmesh islands in" << path
+                    << "are invalid, recomputing them";
+    }
+  }
 
-  navMesh_.reset(mesh);
+  // A saved hierarchy only replaces rebuilding the one this PathFinder already
+  // has, loading a navmesh doesn't turn it on
+  std::unique_ptr<impl::PathHierarchy> pathHierarchy;
+  if (hierarchyData && pathHierarchyClusterSize_ > 0 &&
+      impl::PathHierarchy::persistedClusterSize(hierarchyData, hierarchySize) ==
+          pathHierarchyClusterSize_) {
+    if (islandSystem) {
+      pathHierarchy =
+          impl::PathHierarchy::load(mesh.get(), islandSystem, filter_.get(),
+                                    hierarchyData, hierarchySize);
+    }
+    if (!pathHierarchy) {
+      ESP_WARNING() << "Persisted path hierarchy in" << path
+                    << "is invalid, rebuilding it";
+    }
+  }
+
+  navMeshSettings_ = settings;
+  navMesh_ = std::move(mesh);
   bounds_ = std::make_pair(bmin, bmax);
 
-  return initNavQuery();
+  return initNavQuery(std::move(islandSystem), std::move(pathHierarchy));
 }
 
 bool PathFinder::Impl::saveNavMesh(const std::string& path) {
@@ -1136,21 +3763,65 @@ bool PathFinder::Impl::saveNavMesh(const std::string& path) {
     fwrite(tile->data, tile->dataSize, 1, fp);
   }
 
+  const bool sectionsSaved =
+      writeSection(fp, NAVMESHSECTION_ISLANDS,
+                   [this](FILE* f) { return islandSystem_->save(f); }) &&
+      (!pathHierarchy_ ||
+       writeSection(fp, NAVMESHSECTION_HIERARCHY,
+                    [this](FILE* f) { return pathHierarchy_->save(f); }));
   fclose(fp);
 
-  return true;
+  return sectionsSaved;
 }
 
 void PathFinder::Impl::seed(uint32_t newSeed) {
-  // TODO: this should be using core::Random instead, but passing function
-  // to navQuery_->findRandomPoint needs to be figured out first
+  // The navmesh queries only use threadRandom, but other rand() users have
+  // always been seeded here as well
   srand(newSeed);
+  seed_ = newSeed;
+  seedThread_ = std::this_thread::get_id();
+  ++seedGeneration_;
+}
+
+core::Random& PathFinder::Impl::threadRandom() const {
+  // Skip the lock while a thread keeps using the same PathFinder. Ids are
+  // never reused, so a destroyed PathFinder's entry is never hit.
+  struct Cache {
+    uint64_t pathFinderId = ~uint64_t{};
+    ThreadRandom* threadRandom = nullptr;
+  };
+  thread_local Cache cache;
+
+  const uint64_t seedGeneration = seedGeneration_;
+  if (cache.pathFinderId != id_) {
+    std::lock_guard<std::mutex> lock{threadRandomsMutex_};
+    cache.threadRandom = &threadRandoms_[std::this_thread::get_id()];
+    cache.pathFinderId = id_;
+  }
+  ThreadRandom& threadRandom = *cache.threadRandom;
+  if (threadRandom.seedGeneration != seedGeneration) {
+    uint32_t seed = seed_;
+    const std::thread::id thread = std::this_thread::get_id();
+    if (thread != seedThread_.load()) {
+      seed ^= static_cast<uint32_t>(std::hash<std::thread::id>{}(thread) *
+                                    0x9e3779b97f4a7c15ull >> 32);
+    }
+    threadRandom.random.seed(seed);
+    threadRandom.seedGeneration = seedGeneration;
+  }
+  return threadRandom.random;
 }
 
-// Returns a random number [0..1]
-static float frand() {
-  return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+namespace {
+//! Random state of the PathFinder or query context currently sampling on
+//! this thread. Detour takes a plain function pointer, see @ref contextFrand.
+thread_local core::Random* contextRandom = nullptr;
+
+// Returns a random number [0..1] from contextRandom
+float contextFrand() {
+  return contextRandom->uniform_float_01();
 }
+}  // namespace
 
 vec3f PathFinder::Impl::getRandomNavigablePoint(
     const int maxTries /*= 10*/,
@@ -1161,36 +3832,23 @@ vec3f PathFinder::Impl::getRandomNavigablePoint(
         "NavMesh has no navigable area, this indicates an issue with the "
         "NavMesh");
 
-  // If this query should be island specific
+  // Island specific queries sample the island's alias table, which doesn't
+  // touch the navmesh and can't fail on an island with area
   if (islandIndex != ID_UNDEFINED) {
-    // set the poly flag to identify polys not on the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/true, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() |
-                             PolyFlags::POLYFLAGS_OFF_ISLAND);
+    return islandSystem_->samplePoint(islandIndex, threadRandom());
   }
 
   vec3f pt;
   int i = 0;
+  contextRandom = &threadRandom();
   for (i = 0; i < maxTries; ++i) {
     dtPolyRef ref = 0;
-    dtStatus status =
-        navQuery_->findRandomPoint(filter_.get(), frand, &ref, pt.data());
+    dtStatus status = query_->navQuery()->findRandomPoint(
+        filter_.get(), contextFrand, &ref, pt.data());
     if (dtStatusSucceed(status))
       break;
   }
 
-  // Clean up if this query was island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // reset the poly flag identifing polys off the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/false, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() &
-                             ~PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
-
   if (i == maxTries) {
     ESP_ERROR() << "Failed to getRandomNavigablePoint.  Try increasing max "
                    "tries if the navmesh is fine but just hard to sample from";
@@ -1204,57 +3862,47 @@ vec3f PathFinder::Impl::getRandomNavigablePointAroundSphere(
     const float radius,
     const int maxTries,
     int islandIndex) {
+  contextRandom = &threadRandom();
+  return query_->getRandomNavigablePointAroundSphere(
+      circleCenter, radius, maxTries, islandIndex, contextFrand);
+}
+
+vec3f PathFinderQueryContext::Impl::getRandomNavigablePointAroundSphere(
+    const vec3f& circleCenter,
+    const float radius,
+    const int maxTries,
+    int islandIndex,
+    float (*frand)()) const {
   islandSystem_->assertValidIsland(islandIndex);
-  if (getNavigableArea(islandIndex) <= 0.0)
+  if (islandSystem_->getNavigableArea(islandIndex) <= 0.0)
     throw std::runtime_error(
         "NavMesh has no navigable area, this indicates an issue with the "
         "NavMesh");
 
-  // If this query should be island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // set the poly flag to identify polys not on the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/true, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() |
-                             PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
-
+  // Islands are connected components, so everything the search reaches from
+  // a start polygon on the island is on the island too
   vec3f pt = vec3f::Constant(Mn::Constants::nan());
   dtPolyRef start_ref = 0;  // ID to start our search
-  dtStatus status = navQuery_->findNearestPoly(
-      circleCenter.data(), vec3f{radius, radius, radius}.data(), filter_.get(),
-      &start_ref, pt.data());
-
-  // cache and handle later to unify required clean-up
-  bool failedAndAborting = (!dtStatusSucceed(status) || std::isnan(pt[0]));
+  dtStatus status = 0;
+  std::tie(status, start_ref, std::ignore) = projectToIsland(
+      circleCenter, islandIndex, vec3f::Constant(radius));
 
-  int i = 0;
-  if (!failedAndAborting) {
-    for (; i < maxTries; ++i) {
-      dtPolyRef rand_ref = 0;
-      status = navQuery_->findRandomPointAroundCircle(
-          start_ref, circleCenter.data(), radius, filter_.get(), frand,
-          &rand_ref, pt.data());
-      if (dtStatusSucceed(status) && (pt - circleCenter).norm() <= radius) {
-        break;
-      }
-    }
-  }
-  // Clean up if this query was island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // reset the poly flag identifing polys off the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/false, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() &
-                             ~PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
-  if (failedAndAborting) {
+  if (!dtStatusSucceed(status) || start_ref == 0) {
     ESP_ERROR()
         << "Failed to getRandomNavigablePoint. No polygon found within radius";
     return vec3f::Constant(Mn::Constants::nan());
   }
+
+  int i = 0;
+  for (; i < maxTries; ++i) {
+    dtPolyRef rand_ref = 0;
+    status = navQuery_->findRandomPointAroundCircle(
+        start_ref, circleCenter.data(), radius, filter_.get(), frand,
+        &rand_ref, pt.data());
+    if (dtStatusSucceed(status) && (pt - circleCenter).norm() <= radius) {
+      break;
+    }
+  }
   if (i == maxTries) {
     ESP_ERROR() << "Failed to getRandomNavigablePoint.  Try increasing max "
                    "tries if the navmesh is fine but just hard to sample from";
@@ -1263,6 +3911,15 @@ vec3f PathFinder::Impl::getRandomNavigablePointAroundSphere(
   return pt;
 }
 
+vec3f PathFinderQueryContext::Impl::samplePoint(int islandIndex) {
+  islandSystem_->assertValidIsland(islandIndex);
+  if (islandSystem_->getNavigableArea(islandIndex) <= 0.0)
+    throw std::runtime_error(
+        "NavMesh has no navigable area, this indicates an issue with the "
+        "NavMesh");
+  return islandSystem_->samplePoint(islandIndex, random);
+}
+
 namespace {
 float pathLength(const std::vector<vec3f>& points) {
   CORRADE_INTERNAL_ASSERT(points.size() > 0);
@@ -1279,9 +3936,14 @@ float pathLength(const std::vector<vec3f>& points) {
 }  // namespace
 
 bool PathFinder::Impl::findPath(ShortestPath& path) {
+  return query_->findPath(path);
+}
+
+bool PathFinderQueryContext::Impl::findPath(ShortestPath& path) const {
   MultiGoalShortestPath tmp;
   tmp.requestedStart = path.requestedStart;
   tmp.setRequestedEnds({path.requestedEnd});
+  tmp.usePathHierarchy = path.usePathHierarchy;
 
   bool status = findPath(tmp);
 
@@ -1291,12 +3953,13 @@ bool PathFinder::Impl::findPath(ShortestPath& path) {
 }
 
 Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
-PathFinder::Impl::findPathInternal(const vec3f& start,
-                                   dtPolyRef startRef,
-                                   const vec3f& pathStart,
-                                   const vec3f& end,
-                                   dtPolyRef endRef,
-                                   const vec3f& pathEnd) {
+PathFinderQueryContext::Impl::findPathInternal(const vec3f& start,
+                                               dtPolyRef startRef,
+                                               const vec3f& pathStart,
+                                               const vec3f& end,
+                                               dtPolyRef endRef,
+                                               const vec3f& pathEnd,
+                                               bool usePathHierarchy) const {
   // check if trivial path (start is same as end) and early return
   if (pathStart.isApprox(pathEnd)) {
     return std::make_tuple(0.0f, std::vector<vec3f>{pathStart, pathEnd});
@@ -1308,138 +3971,707 @@ PathFinder::Impl::findPathInternal(const vec3f& start,
   }
 
   static const int MAX_POLYS = 256;
-  dtPolyRef polys[MAX_POLYS];
-
   int numPolys = 0;
-  dtStatus status =
-      navQuery_->findPath(startRef, endRef, pathStart.data(), pathEnd.data(),
-                          filter_.get(), polys, &numPolys, MAX_POLYS);
-  if (status != DT_SUCCESS || numPolys == 0) {
-    return Cr::Containers::NullOpt;
+  std::vector<dtPolyRef> polys(MAX_POLYS);
+  dtStatus status = navQuery_->findPath(
+      startRef, endRef, pathStart.data(), pathEnd.data(), filter_.get(),
+      polys.data(), &numPolys, MAX_POLYS);
+  if (status == DT_SUCCESS && numPolys > 0) {
+    polys.resize(numPolys);
+    return straightPath(start, end, polys);
+  }
+
+  // Detour ran out of nodes or MAX_POLYS before reaching the end, the path
+  // hierarchy isn't limited by either
+  if (usePathHierarchy && pathHierarchy_ && dtStatusSucceed(status) &&
+      pathHierarchy_->findCorridor(pathStart, startRef, pathEnd, endRef,
+                                   polys)) {
+    return straightPath(start, end, polys);
+  }
+  return Cr::Containers::NullOpt;
+}
+
+Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
+PathFinderQueryContext::Impl::straightPath(
+    const vec3f& start,
+    const vec3f& end,
+    const std::vector<dtPolyRef>& polys) const {
+  // The string-pulled path has at most one point per portal plus the ends
+  const int maxPoints = std::max<int>(256, polys.size() + 1);
+  int numPoints = 0;
+  std::vector<vec3f> points(maxPoints);
+  const dtStatus status = navQuery_->findStraightPath(
+      start.data(), end.data(), polys.data(), polys.size(), points[0].data(),
+      nullptr, nullptr, &numPoints, maxPoints);
+  if (status != DT_SUCCESS || numPoints == 0) {
+    return Corrade::Containers::NullOpt;
+  }
+
+  points.resize(numPoints);
+
+  const float length = pathLength(points);
+
+  return std::make_tuple(length, std::move(points));
+}
+
+bool PathFinderQueryContext::Impl::findPathSetup(MultiGoalShortestPath& path,
+                                                 dtPolyRef& startRef,
+                                                 vec3f& pathStart) const {
+  path.geodesicDistance = std::numeric_limits<float>::infinity();
+  path.closestEndPointIndex = -1;
+  path.points.clear();
+
+  // find nearest polys and path
+  dtStatus status = 0;
+  std::tie(status, startRef, pathStart) =
+      projectToPoly(path.requestedStart, navQuery_.get(), filter_.get());
+
+  if (status != DT_SUCCESS || startRef == 0) {
+    return false;
+  }
+
+  if (!path.pimpl_->endRefs.empty())
+    return true;
+
+  int numValidPoints = 0;
+  for (const auto& rqEnd : path.getRequestedEnds()) {
+    dtPolyRef endRef = 0;
+    vec3f pathEnd;
+    std::tie(status, endRef, pathEnd) =
+        projectToPoly(rqEnd, navQuery_.get(), filter_.get());
+
+    if (status != DT_SUCCESS || endRef == 0) {
+      path.pimpl_->endIsValid.emplace_back(false);
+      ESP_DEBUG() << "Can't project end-point to navmesh, skipping: " << rqEnd;
+    } else {
+      path.pimpl_->endIsValid.emplace_back(true);
+      numValidPoints++;
+    }
+
+    path.pimpl_->endRefs.emplace_back(endRef);
+    path.pimpl_->pathEnds.emplace_back(pathEnd);
+  }
+  if (numValidPoints == 0) {
+    ESP_DEBUG() << "Early abort, can't project any points to navmesh.";
+    return false;
+  }
+
+  return true;
+}
+
+bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
+  return query_->findPath(path);
+}
+
+bool PathFinderQueryContext::Impl::findPath(MultiGoalShortestPath& path) const {
+  dtPolyRef startRef = 0;
+  vec3f pathStart;
+  if (!findPathSetup(path, startRef, pathStart))
+    return false;
+
+  if (path.useDistanceField)
+    return findPathOnDistanceField(path, startRef, pathStart);
+
+  if (path.pimpl_->requestedEnds.size() > 1) {
+    // Bound the minimum distance any point could be from the start by either
+    // how close it use to be minus how much we moved from the last search point
+    // or just the L2 distance.
+
+    ShortestPath prevPath;
+    prevPath.requestedStart = path.requestedStart;
+    prevPath.requestedEnd = path.pimpl_->prevRequestedStart;
+    prevPath.usePathHierarchy = path.usePathHierarchy;
+    findPath(prevPath);
+    const float movedAmount = prevPath.geodesicDistance;
+
+    for (int i = 0; i < path.pimpl_->requestedEnds.size(); ++i) {
+      path.pimpl_->minTheoreticalDist[i] = std::max(
+          path.pimpl_->minTheoreticalDist[i] - movedAmount,
+          (path.pimpl_->requestedEnds[i] - path.requestedStart).norm());
+    }
+
+    path.pimpl_->prevRequestedStart = path.requestedStart;
+  }
+
+  // Explore possible goal points by their minimum theoretical distance.
+  std::vector<size_t> ordering(path.pimpl_->requestedEnds.size());
+  std::iota(ordering.begin(), ordering.end(), 0);
+  std::sort(ordering.begin(), ordering.end(),
+            [&path](const size_t a, const size_t b) -> bool {
+              return path.pimpl_->minTheoreticalDist[a] <
+                     path.pimpl_->minTheoreticalDist[b];
+            });
+
+  for (size_t i : ordering) {
+    if (!path.pimpl_->endIsValid[i])
+      continue;
+
+    if (path.pimpl_->minTheoreticalDist[i] > path.geodesicDistance)
+      continue;
+
+    const Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
+        findResult =
+            findPathInternal(path.requestedStart, startRef, pathStart,
+                             path.pimpl_->requestedEnds[i],
+                             path.pimpl_->endRefs[i], path.pimpl_->pathEnds[i],
+                             path.usePathHierarchy);
+
+    if (findResult && std::get<0>(*findResult) < path.geodesicDistance) {
+      path.pimpl_->minTheoreticalDist[i] = std::get<0>(*findResult);
+      path.geodesicDistance = std::get<0>(*findResult);
+      path.points = std::get<1>(*findResult);
+      path.closestEndPointIndex = i;
+    }
+  }
+
+  return path.geodesicDistance < std::numeric_limits<float>::infinity();
+}
+
+core::ThreadPool& PathFinder::Impl::threadPool() {
+  if (!threadPool_) {
+    threadPool_ = std::make_unique<core::ThreadPool>(numThreads_);
+  }
+  return *threadPool_;
+}
+
+void PathFinder::Impl::setNumThreads(int numThreads) {
+  if (numThreads == numThreads_) {
+    return;
+  }
+  numThreads_ = numThreads;
+  threadPool_ = nullptr;
+  workerQueries_.clear();
+}
+
+int PathFinder::Impl::getNumThreads() {
+  return threadPool().numThreads();
+}
+
+std::vector<const PathFinderQueryContext::Impl*>
+PathFinder::Impl::workerQueries() {
+  const int numThreads = threadPool().numThreads();
+  while (static_cast<int>(workerQueries_.size()) + 1 < numThreads) {
+    std::unique_ptr<PathFinderQueryContext::Impl> query = createQuery();
+    ESP_CHECK(query, "Could not init Detour navmesh query for worker thread");
+    workerQueries_.emplace_back(std::move(query));
+  }
+
+  // the calling thread participates as thread 0 and uses the main query
+  std::vector<const PathFinderQueryContext::Impl*> queries;
+  queries.reserve(numThreads);
+  queries.push_back(query_.get());
+  for (int i = 0; i + 1 < numThreads; ++i) {
+    queries.push_back(workerQueries_[i].get());
+  }
+  return queries;
+}
+
+std::vector<bool> PathFinder::Impl::findPaths(
+    std::vector<ShortestPath>& paths) {
+  const std::vector<const PathFinderQueryContext::Impl*> queries =
+      workerQueries();
+  // std::vector<bool> packs bits, so concurrent writes need a byte per result
+  std::vector<char> found(paths.size(), 0);
+  threadPool().parallelFor(
+      paths.size(), [&](const size_t i, const int threadIndex) {
+        found[i] = queries[threadIndex]->findPath(paths[i]);
+      });
+  return {found.begin(), found.end()};
+}
+
+std::vector<float> PathFinder::Impl::geodesicDistances(
+    const std::vector<vec3f>& starts,
+    const std::vector<vec3f>& ends) {
+  ESP_CHECK(starts.size() == ends.size(),
+            "PathFinder::geodesicDistances : Got" << starts.size()
+                                                  << "start points but"
+                                                  << ends.size()
+                                                  << "end points.");
+  const std::vector<const PathFinderQueryContext::Impl*> queries =
+      workerQueries();
+  std::vector<float> distances(starts.size());
+  threadPool().parallelFor(
+      starts.size(), [&](const size_t i, const int threadIndex) {
+        ShortestPath path;
+        path.requestedStart = starts[i];
+        path.requestedEnd = ends[i];
+        queries[threadIndex]->findPath(path);
+        distances[i] = path.geodesicDistance;
+      });
+  return distances;
+}
+
+Eigen::RowMatrixX3f PathFinder::Impl::snapPoints(
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& points,
+    const int islandIndex) {
+  islandSystem_->assertValidIsland(islandIndex);
+  const std::vector<const PathFinderQueryContext::Impl*> queries =
+      workerQueries();
+  Eigen::RowMatrixX3f snapped(points.rows(), 3);
+  threadPool().parallelFor(
+      points.rows(), [&](const size_t i, const int threadIndex) {
+        snapped.row(i) = queries[threadIndex]
+                             ->snapPoint(vec3f{points.row(i).transpose()},
+                                         islandIndex)
+                             .transpose();
+      });
+  return snapped;
+}
+
+Eigen::VectorXi PathFinder::Impl::getIslands(
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& points) {
+  const std::vector<const PathFinderQueryContext::Impl*> queries =
+      workerQueries();
+  Eigen::VectorXi islands(points.rows());
+  threadPool().parallelFor(
+      points.rows(), [&](const size_t i, const int threadIndex) {
+        islands[i] =
+            queries[threadIndex]->getIsland(vec3f{points.row(i).transpose()});
+      });
+  return islands;
+}
+
+Eigen::RowMatrixX3f PathFinder::Impl::tryStepBatch(
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& starts,
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& ends,
+    Eigen::Ref<Eigen::Matrix<uint64_t, Eigen::Dynamic, 1>> polyRefs,
+    const bool allowSliding) {
+  ESP_CHECK(starts.rows() == ends.rows() && starts.rows() == polyRefs.rows(),
+            "PathFinder::tryStepBatch : Got" << starts.rows() << "starts,"
+                                             << ends.rows() << "ends and"
+                                             << polyRefs.rows()
+                                             << "polygon refs.");
+  const std::vector<const PathFinderQueryContext::Impl*> queries =
+      workerQueries();
+  Eigen::RowMatrixX3f stepped(starts.rows(), 3);
+  threadPool().parallelFor(
+      starts.rows(), [&](const size_t i, const int threadIndex) {
+        dtPolyRef polyRef = polyRefs[i];
+        stepped.row(i) = queries[threadIndex]
+                             ->tryStep(vec3f{starts.row(i).transpose()},
+                                       vec3f{ends.row(i).transpose()},
+                                       polyRef, allowSliding)
+                             .transpose();
+        polyRefs[i] = polyRef;
+      });
+  return stepped;
+}
+
+Eigen::Matrix<bool, Eigen::Dynamic, 1> PathFinder::Impl::isNavigableBatch(
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& points,
+    const float maxYDelta) {
+  const std::vector<const PathFinderQueryContext::Impl*> queries =
+      workerQueries();
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> navigable(points.rows());
+  threadPool().parallelFor(
+      points.rows(), [&](const size_t i, const int threadIndex) {
+        navigable[i] = queries[threadIndex]->navigablePoly(
+                           vec3f{points.row(i).transpose()}, maxYDelta) != 0;
+      });
+  return navigable;
+}
+
+namespace {
+//! Number of points sampled with each random state by
+//! sampleNavigablePoints().
+constexpr int SAMPLE_CHUNK_SIZE = 256;
+}  // namespace
+
+Eigen::RowMatrixX3f PathFinder::Impl::sampleNavigablePoints(
+    const int numPoints,
+    const int islandIndex) {
+  islandSystem_->assertValidIsland(islandIndex);
+  ESP_CHECK(numPoints >= 0, "PathFinder::sampleNavigablePoints : Can't sample"
+                                << numPoints << "points.");
+  if (getNavigableArea(islandIndex) <= 0.0)
+    throw std::runtime_error(
+        "NavMesh has no navigable area, this indicates an issue with the "
+        "NavMesh");
+
+  // Seed each chunk from the calling thread's random state, so the points
+  // only depend on the seed and not on how chunks are spread over threads
+  const int numChunks = (numPoints + SAMPLE_CHUNK_SIZE - 1) / SAMPLE_CHUNK_SIZE;
+  std::vector<uint32_t> chunkSeeds(numChunks);
+  core::Random& random = threadRandom();
+  for (uint32_t& chunkSeed : chunkSeeds) {
+    chunkSeed = random.uniform_uint();
+  }
+
+  Eigen::RowMatrixX3f points(numPoints, 3);
+  threadPool().parallelFor(numChunks, [&](const size_t chunk, int) {
+    core::Random chunkRandom{chunkSeeds[chunk]};
+    const int end = std::min<int>((chunk + 1) * SAMPLE_CHUNK_SIZE, numPoints);
+    for (int i = chunk * SAMPLE_CHUNK_SIZE; i < end; ++i) {
+      points.row(i) =
+          islandSystem_->samplePoint(islandIndex, chunkRandom).transpose();
+    }
+  });
+  return points;
+}
+
+struct GeodesicDistanceField::Impl {
+  //! The navmesh the field was computed on, kept alive by the field.
+  std::shared_ptr<dtNavMesh> navMesh;
+  //! Only used to snap query points to their polygon.
+  std::unique_ptr<dtNavMeshQuery, NavQueryDeleter> navQuery;
+  dtQueryFilter filter;
+
+  std::vector<vec3f> goals;
+
+  //! Dense polygon index of the first polygon of each tile.
+  std::vector<int> tilePolyBase;
+
+  //! Portal sample nodes of each polygon, in CSR layout: the nodes of polygon
+  //! i are polyNodes[polyNodeStart[i]..polyNodeStart[i + 1]).
+  std::vector<int> polyNodeStart;
+  std::vector<int> polyNodes;
+
+  //! Position of each portal sample node and its distance to the closest goal.
+  std::vector<vec3f> nodePositions;
+  std::vector<float> nodeDistances;
+
+  //! The search tree: the next node towards the closest goal, -1 for nodes
+  //! reached straight from a goal, the polygon crossed to get there and the
+  //! index of the goal.
+  std::vector<int> nodeParents;
+  std::vector<int> nodeVias;
+  std::vector<int> nodeGoals;
+
+  //! Goals of the (few) polygons containing a goal.
+  std::unordered_map<int, std::vector<int>> polyGoals;
+  //! Snapped position of each goal.
+  std::vector<vec3f> goalPositions;
+
+  //! Reference of each polygon, by dense index.
+  std::vector<dtPolyRef> polyRefs;
+
+  int denseIndex(dtPolyRef ref) const {
+    unsigned int salt = 0, tileIndex = 0, polyIndex = 0;
+    navMesh->decodePolyId(ref, salt, tileIndex, polyIndex);
+    return tilePolyBase[tileIndex] + static_cast<int>(polyIndex);
+  }
+
+  //! Distance from @p polyPt on polygon @p poly to the closest goal. @p node
+  //! is the portal sample node the path leaves @p poly through, or -1 if the
+  //! goal is in @p poly, and @p goal the goal's index.
+  float closestGoal(int poly, const vec3f& polyPt, int& node, int& goal) const;
+
+  //! The polygons along the search tree from @p startRef to the closest goal
+  //! and that goal's index. False if no goal is reachable.
+  bool corridorToClosestGoal(dtPolyRef startRef,
+                             const vec3f& startPt,
+                             std::vector<dtPolyRef>& corridor,
+                             int& goal) const;
+};
+
+float GeodesicDistanceField::Impl::closestGoal(const int poly,
+                                               const vec3f& polyPt,
+                                               int& node,
+                                               int& goal) const {
+  float dist = std::numeric_limits<float>::infinity();
+  node = -1;
+  goal = ID_UNDEFINED;
+
+  // A goal in the same (convex) polygon is reachable in a straight line
+  auto goalsIt = polyGoals.find(poly);
+  if (goalsIt != polyGoals.end()) {
+    for (const int polyGoal : goalsIt->second) {
+      const float goalDist = (goalPositions[polyGoal] - polyPt).norm();
+      if (goalDist < dist) {
+        dist = goalDist;
+        goal = polyGoal;
+      }
+    }
+  }
+
+  // Otherwise the path leaves the polygon through one of its portals
+  for (int i = polyNodeStart[poly]; i < polyNodeStart[poly + 1]; ++i) {
+    const int polyNode = polyNodes[i];
+    const float nodeDist =
+        nodeDistances[polyNode] + (nodePositions[polyNode] - polyPt).norm();
+    if (nodeDist < dist) {
+      dist = nodeDist;
+      node = polyNode;
+      goal = nodeGoals[polyNode];
+    }
   }
 
-  int numPoints = 0;
-  std::vector<vec3f> points(MAX_POLYS);
-  status = navQuery_->findStraightPath(start.data(), end.data(), polys,
-                                       numPolys, points[0].data(), nullptr,
-                                       nullptr, &numPoints, MAX_POLYS);
-  if (status != DT_SUCCESS || numPoints == 0) {
-    return Corrade::Containers::NullOpt;
-  }
+  return dist;
+}
 
-  points.resize(numPoints);
+bool GeodesicDistanceField::Impl::corridorToClosestGoal(
+    const dtPolyRef startRef,
+    const vec3f& startPt,
+    std::vector<dtPolyRef>& corridor,
+    int& goal) const {
+  const int startPoly = denseIndex(startRef);
+  int node = -1;
+  if (closestGoal(startPoly, startPt, node, goal) ==
+      std::numeric_limits<float>::infinity())
+    return false;
 
-  const float length = pathLength(points);
+  // Consecutive nodes share the polygon crossed between them, so the
+  // polygons form a corridor. Loops, e.g. where the tree runs along a portal,
+  // are cut out.
+  std::vector<int> polys{startPoly};
+  for (; node != -1; node = nodeParents[node]) {
+    auto found = std::find(polys.begin(), polys.end(), nodeVias[node]);
+    if (found == polys.end()) {
+      polys.push_back(nodeVias[node]);
+    } else {
+      polys.erase(found + 1, polys.end());
+    }
+  }
 
-  return std::make_tuple(length, std::move(points));
+  corridor.clear();
+  for (const int poly : polys) {
+    corridor.push_back(polyRefs[poly]);
+  }
+  return true;
 }
 
-bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
-                                     dtPolyRef& startRef,
-                                     vec3f& pathStart) {
-  path.geodesicDistance = std::numeric_limits<float>::infinity();
-  path.closestEndPointIndex = -1;
-  path.points.clear();
+GeodesicDistanceField::GeodesicDistanceField()
+    : pimpl_{spimpl::make_unique_impl<Impl>()} {};
 
-  // find nearest polys and path
+float GeodesicDistanceField::distanceTo(const vec3f& pt) const {
   dtStatus status = 0;
-  std::tie(status, startRef, pathStart) =
-      projectToPoly(path.requestedStart, navQuery_.get(), filter_.get());
-
-  if (status != DT_SUCCESS || startRef == 0) {
-    return false;
+  dtPolyRef polyRef = 0;
+  vec3f polyPt;
+  std::tie(status, polyRef, polyPt) =
+      projectToPoly(pt, pimpl_->navQuery.get(), &pimpl_->filter);
+  if (status != DT_SUCCESS || polyRef == 0) {
+    return std::numeric_limits<float>::infinity();
   }
 
-  if (!path.pimpl_->endRefs.empty())
-    return true;
+  int node = -1, goal = ID_UNDEFINED;
+  return pimpl_->closestGoal(pimpl_->denseIndex(polyRef), polyPt, node, goal);
+}
 
-  int numValidPoints = 0;
-  for (const auto& rqEnd : path.getRequestedEnds()) {
-    dtPolyRef endRef = 0;
-    vec3f pathEnd;
-    std::tie(status, endRef, pathEnd) =
-        projectToPoly(rqEnd, navQuery_.get(), filter_.get());
+std::vector<float> GeodesicDistanceField::distancesTo(
+    const std::vector<vec3f>& points) const {
+  std::vector<float> distances;
+  distances.reserve(points.size());
+  for (const vec3f& pt : points) {
+    distances.push_back(distanceTo(pt));
+  }
+  return distances;
+}
 
-    if (status != DT_SUCCESS || endRef == 0) {
-      path.pimpl_->endIsValid.emplace_back(false);
-      ESP_DEBUG() << "Can't project end-point to navmesh, skipping: " << rqEnd;
-    } else {
-      path.pimpl_->endIsValid.emplace_back(true);
-      numValidPoints++;
-    }
+const std::vector<vec3f>& GeodesicDistanceField::getGoals() const {
+  return pimpl_->goals;
+}
 
-    path.pimpl_->endRefs.emplace_back(endRef);
-    path.pimpl_->pathEnds.emplace_back(pathEnd);
+GeodesicDistanceField::ptr PathFinder::Impl::computeDistanceField(
+    const std::vector<vec3f>& goals,
+    const float portalSampleSpacing) {
+  if (!isLoaded()) {
+    return nullptr;
   }
-  if (numValidPoints == 0) {
-    ESP_DEBUG() << "Early abort, can't project any points to navmesh.";
-    return false;
+  ESP_CHECK(portalSampleSpacing > 0,
+            "PathFinder::computeDistanceField : portalSampleSpacing must be "
+            "positive but is"
+                << portalSampleSpacing);
+  return query_->computeDistanceField(goals, portalSampleSpacing);
+}
+
+GeodesicDistanceField::ptr PathFinderQueryContext::Impl::computeDistanceField(
+    const std::vector<vec3f>& goals,
+    const float portalSampleSpacing) const {
+  GeodesicDistanceField::ptr field = GeodesicDistanceField::create();
+  GeodesicDistanceField::Impl& f = *field->pimpl_;
+  f.navMesh = navMesh_;
+  f.navQuery.reset(dtAllocNavMeshQuery());
+  if (dtStatusFailed(f.navQuery->init(navMesh_.get(), 2048))) {
+    ESP_ERROR() << "Could not init Detour navmesh query";
+    return nullptr;
   }
+  f.filter.setIncludeFlags(filter_->getIncludeFlags());
+  f.filter.setExcludeFlags(filter_->getExcludeFlags());
+  f.goals = goals;
 
-  return true;
-}
+  const dtNavMesh* navMesh = navMesh_.get();
+  int numPolys = 0;
+  f.tilePolyBase.assign(navMesh->getMaxTiles(), 0);
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    f.tilePolyBase[iTile] = numPolys;
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (tile && tile->header) {
+      numPolys += tile->header->polyCount;
+      for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+        f.polyRefs.push_back(navMesh->encodePolyId(tile->salt, iTile, jPoly));
+      }
+    }
+  }
 
-bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
-  dtPolyRef startRef = 0;
-  vec3f pathStart;
-  if (!findPathSetup(path, startRef, pathStart))
-    return false;
+  // Sample points along every portal between two walkable polygons. Each
+  // portal is visited from both sides, so only add it from the polygon with
+  // the smaller dense index.
+  std::vector<std::vector<int>> polyNodeLists(numPolys);
+  std::vector<std::pair<int, int>> nodePolys;
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
 
-  if (path.pimpl_->requestedEnds.size() > 1) {
-    // Bound the minimum distance any point could be from the start by either
-    // how close it use to be minus how much we moved from the last search point
-    // or just the L2 distance.
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef polyRef = navMesh->encodePolyId(tile->salt, iTile, jPoly);
+      if (!f.filter.passFilter(polyRef, tile, poly))
+        continue;
+      const int polyIdx = f.tilePolyBase[iTile] + jPoly;
 
-    ShortestPath prevPath;
-    prevPath.requestedStart = path.requestedStart;
-    prevPath.requestedEnd = path.pimpl_->prevRequestedStart;
-    findPath(prevPath);
-    const float movedAmount = prevPath.geodesicDistance;
+      for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+           iLink = tile->links[iLink].next) {
+        const dtLink& link = tile->links[iLink];
+        const dtMeshTile* neighbourTile = nullptr;
+        const dtPoly* neighbourPoly = nullptr;
+        navMesh->getTileAndPolyByRefUnsafe(link.ref, &neighbourTile,
+                                           &neighbourPoly);
+        if (!f.filter.passFilter(link.ref, neighbourTile, neighbourPoly))
+          continue;
+        const int neighbourIdx = f.denseIndex(link.ref);
+        if (neighbourIdx <= polyIdx)
+          continue;
 
-    for (int i = 0; i < path.pimpl_->requestedEnds.size(); ++i) {
-      path.pimpl_->minTheoreticalDist[i] = std::max(
-          path.pimpl_->minTheoreticalDist[i] - movedAmount,
-          (path.pimpl_->requestedEnds[i] - path.requestedStart).norm());
+        vec3f left, right;
+        std::tie(left, right) = portalPoints(tile, poly, link);
+
+        const int numSamples =
+            std::max(2, static_cast<int>(std::ceil((right - left).norm() /
+                                                   portalSampleSpacing)) +
+                            1);
+        for (int iSample = 0; iSample < numSamples; ++iSample) {
+          const float t = static_cast<float>(iSample) / (numSamples - 1);
+          const int node = f.nodePositions.size();
+          f.nodePositions.emplace_back(left + t * (right - left));
+          nodePolys.emplace_back(polyIdx, neighbourIdx);
+          polyNodeLists[polyIdx].push_back(node);
+          polyNodeLists[neighbourIdx].push_back(node);
+        }
+      }
     }
-
-    path.pimpl_->prevRequestedStart = path.requestedStart;
   }
 
-  // Explore possible goal points by their minimum theoretical distance.
-  std::vector<size_t> ordering(path.pimpl_->requestedEnds.size());
-  std::iota(ordering.begin(), ordering.end(), 0);
-  std::sort(ordering.begin(), ordering.end(),
-            [&path](const size_t a, const size_t b) -> bool {
-              return path.pimpl_->minTheoreticalDist[a] <
-                     path.pimpl_->minTheoreticalDist[b];
-            });
-
-  for (size_t i : ordering) {
-    if (!path.pimpl_->endIsValid[i])
+  f.polyNodeStart.reserve(numPolys + 1);
+  f.polyNodeStart.push_back(0);
+  for (const std::vector<int>& nodes : polyNodeLists) {
+    f.polyNodes.insert(f.polyNodes.end(), nodes.begin(), nodes.end());
+    f.polyNodeStart.push_back(f.polyNodes.size());
+  }
+  polyNodeLists.clear();
+
+  // Seed the search with the straight-line distance from each goal to the
+  // portal samples of its polygon
+  typedef std::pair<float, int> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      std::greater<QueueEntry>>
+      queue;
+  f.nodeDistances.assign(f.nodePositions.size(),
+                         std::numeric_limits<float>::infinity());
+  f.nodeParents.assign(f.nodePositions.size(), -1);
+  f.nodeVias.assign(f.nodePositions.size(), -1);
+  f.nodeGoals.assign(f.nodePositions.size(), ID_UNDEFINED);
+  f.goalPositions.resize(goals.size());
+  for (int goal = 0; goal < goals.size(); ++goal) {
+    dtStatus status = 0;
+    dtPolyRef goalRef = 0;
+    vec3f goalPt;
+    std::tie(status, goalRef, goalPt) =
+        projectToPoly(goals[goal], f.navQuery.get(), &f.filter);
+    if (status != DT_SUCCESS || goalRef == 0) {
+      ESP_DEBUG() << "Can't project goal to navmesh, skipping:" << goals[goal];
       continue;
+    }
+    const int goalPoly = f.denseIndex(goalRef);
+    f.polyGoals[goalPoly].push_back(goal);
+    f.goalPositions[goal] = goalPt;
+    for (int i = f.polyNodeStart[goalPoly]; i < f.polyNodeStart[goalPoly + 1];
+         ++i) {
+      const int node = f.polyNodes[i];
+      const float dist = (f.nodePositions[node] - goalPt).norm();
+      if (dist < f.nodeDistances[node]) {
+        f.nodeDistances[node] = dist;
+        f.nodeVias[node] = goalPoly;
+        f.nodeGoals[node] = goal;
+        queue.emplace(dist, node);
+      }
+    }
+  }
 
-    if (path.pimpl_->minTheoreticalDist[i] > path.geodesicDistance)
+  // Multi-source Dijkstra. Polygons are convex, so every pair of samples on
+  // the boundary of the same polygon is connected by a straight line.
+  while (!queue.empty()) {
+    const QueueEntry top = queue.top();
+    queue.pop();
+    const int node = top.second;
+    if (top.first > f.nodeDistances[node])
       continue;
 
-    const Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
-        findResult =
-            findPathInternal(path.requestedStart, startRef, pathStart,
-                             path.pimpl_->requestedEnds[i],
-                             path.pimpl_->endRefs[i], path.pimpl_->pathEnds[i]);
-
-    if (findResult && std::get<0>(*findResult) < path.geodesicDistance) {
-      path.pimpl_->minTheoreticalDist[i] = std::get<0>(*findResult);
-      path.geodesicDistance = std::get<0>(*findResult);
-      path.points = std::get<1>(*findResult);
-      path.closestEndPointIndex = i;
+    for (const int poly : {nodePolys[node].first, nodePolys[node].second}) {
+      for (int i = f.polyNodeStart[poly]; i < f.polyNodeStart[poly + 1]; ++i) {
+        const int neighbour = f.polyNodes[i];
+        const float dist =
+            top.first +
+            (f.nodePositions[neighbour] - f.nodePositions[node]).norm();
+        if (dist < f.nodeDistances[neighbour]) {
+          f.nodeDistances[neighbour] = dist;
+          f.nodeParents[neighbour] = node;
+          f.nodeVias[neighbour] = poly;
+          f.nodeGoals[neighbour] = f.nodeGoals[node];
+          queue.emplace(dist, neighbour);
+        }
+      }
     }
   }
 
-  return path.geodesicDistance < std::numeric_limits<float>::infinity();
+  ESP_DEBUG() << "Computed geodesic distance field for" << goals.size()
+              << "goals over" << f.nodePositions.size() << "portal samples";
+
+  return field;
+}
+
+bool PathFinderQueryContext::Impl::findPathOnDistanceField(
+    MultiGoalShortestPath& path,
+    const dtPolyRef startRef,
+    const vec3f& pathStart) const {
+  // One search from all ends, reused for every start on this navmesh
+  MultiGoalShortestPath::Impl& p = *path.pimpl_;
+  if (!p.distanceField || p.distanceField->pimpl_->navMesh != navMesh_ ||
+      p.distanceFieldSpacing != path.distanceFieldSpacing) {
+    ESP_CHECK(path.distanceFieldSpacing > 0,
+              "MultiGoalShortestPath::distanceFieldSpacing must be positive "
+              "but is"
+                  << path.distanceFieldSpacing);
+    p.distanceField =
+        computeDistanceField(p.requestedEnds, path.distanceFieldSpacing);
+    p.distanceFieldSpacing = path.distanceFieldSpacing;
+    if (!p.distanceField)
+      return false;
+  }
+
+  // Follow the search tree to the closest end, then string-pull the
+  // polygons along it
+  std::vector<dtPolyRef> corridor;
+  int end = ID_UNDEFINED;
+  if (!p.distanceField->pimpl_->corridorToClosestGoal(startRef, pathStart,
+                                                      corridor, end))
+    return false;
+  const Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
+      result =
+          straightPath(path.requestedStart, p.requestedEnds[end], corridor);
+  if (!result)
+    return false;
+
+  path.geodesicDistance = std::get<0>(*result);
+  path.points = std::get<1>(*result);
+  path.closestEndPointIndex = end;
+  return true;
 }
 
 template <typename T>
-T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
+T PathFinderQueryContext::Impl::tryStep(const T& start,
+                                        const T& end,
+                                        bool allowSliding) const {
   static const int MAX_POLYS = 256;
   dtPolyRef polys[MAX_POLYS];
 
@@ -1479,69 +4711,171 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
   // Note, this will never fail as endPoint is always within in the poly
   // polys[numPolys - 1]
   navQuery_->getPolyHeight(polys[numPolys - 1], endPoint.data(), &endPoint[1]);
+  nudgeOffThinWall(startRef, polys[numPolys - 1], endPoint);
 
+  return T{std::move(endPoint)};
+}
+
+void PathFinderQueryContext::Impl::nudgeOffThinWall(dtPolyRef startRef,
+                                                    dtPolyRef endPolyRef,
+                                                    vec3f& endPoint) const {
   // Hack to deal with infinitely thin walls in recast allowing you to
   // transition between two different connected components
   // First check to see if the endPoint as returned by `moveAlongSurface`
   // is in the same connected component as the startRef according to
   // findNearestPoly
+  dtPolyRef endRef = 0;
   std::tie(std::ignore, endRef, std::ignore) =
       projectToPoly(endPoint, navQuery_.get(), filter_.get());
-  if (!this->islandSystem_->hasConnection(startRef, endRef)) {
-    // There isn't a connection!  This happens when endPoint is on an edge
-    // shared between two different connected components (aka infinitely thin
-    // walls) The way to deal with this is to nudge the point into the polygon
-    // we want it to be 'moveAlongSurface' tells us which polygon we want
-    // endPoint to be in through the polys list
-    const dtMeshTile* tile = nullptr;
-    const dtPoly* poly = nullptr;
-    navMesh_->getTileAndPolyByRefUnsafe(polys[numPolys - 1], &tile, &poly);
-
-    // Calculate the center of the polygon we want the points to be in
-    vec3f polyCenter = vec3f::Zero();
-    for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
-      polyCenter += Eigen::Map<vec3f>(
-          &tile->verts[static_cast<size_t>(poly->verts[iVert]) * 3]);
-    }
-    polyCenter /= poly->vertCount;
-
-    constexpr float nudgeDistance = 1e-4;  // 0.1mm
-    const vec3f nudgeDir = (polyCenter - endPoint).normalized();
-    // And nudge the point towards the center by a little tiny bit :)
-    endPoint = endPoint + nudgeDistance * nudgeDir;
+  if (islandSystem_->hasConnection(startRef, endRef)) {
+    return;
+  }
+
+  // There isn't a connection!  This happens when endPoint is on an edge
+  // shared between two different connected components (aka infinitely thin
+  // walls) The way to deal with this is to nudge the point into the polygon
+  // we want it to be 'moveAlongSurface' tells us which polygon we want
+  // endPoint to be in through the polys list
+  const dtMeshTile* tile = nullptr;
+  const dtPoly* poly = nullptr;
+  navMesh_->getTileAndPolyByRefUnsafe(endPolyRef, &tile, &poly);
+
+  // Calculate the center of the polygon we want the points to be in
+  vec3f polyCenter = vec3f::Zero();
+  for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+    polyCenter += Eigen::Map<vec3f>(
+        &tile->verts[static_cast<size_t>(poly->verts[iVert]) * 3]);
+  }
+  polyCenter /= poly->vertCount;
+
+  constexpr float nudgeDistance = 1e-4;  // 0.1mm
+  const vec3f nudgeDir = (polyCenter - endPoint).normalized();
+  // And nudge the point towards the center by a little tiny bit :)
+  endPoint = endPoint + nudgeDistance * nudgeDir;
+}
+
+template <typename T>
+T PathFinderQueryContext::Impl::tryStep(const T& start,
+                                        const T& end,
+                                        dtPolyRef& polyRef,
+                                        bool allowSliding) const {
+  static const int MAX_POLYS = 256;
+  dtPolyRef polys[MAX_POLYS];
+
+  // Keep the cached polygon if start is still over it, otherwise the agent
+  // moved (or was moved) since and start has to be projected again
+  constexpr float maxYDelta = 0.5;
+  vec3f pathStart;
+  bool posOverPoly = false;
+  if (polyRef == 0 || !navMesh_->isValidPolyRef(polyRef) ||
+      dtStatusFailed(navQuery_->closestPointOnPoly(
+          polyRef, vec3f{start[0], start[1], start[2]}.data(),
+          pathStart.data(), &posOverPoly)) ||
+      !posOverPoly || std::abs(pathStart[1] - start[1]) > maxYDelta) {
+    dtStatus startStatus = 0;
+    std::tie(startStatus, polyRef, pathStart) =
+        projectToPoly(start, navQuery_.get(), filter_.get());
+    if (dtStatusFailed(startStatus)) {
+      polyRef = 0;
+      return start;
+    }
+  }
+
+  dtStatus endStatus = 0;
+  dtPolyRef endRef = 0;
+  std::tie(endStatus, endRef, std::ignore) =
+      projectToPoly(end, navQuery_.get(), filter_.get());
+  if (dtStatusFailed(endStatus) ||
+      !islandSystem_->hasConnection(polyRef, endRef)) {
+    return start;
+  }
+
+  vec3f endPoint;
+  int numPolys = 0;
+  navQuery_->moveAlongSurface(polyRef, pathStart.data(), end.data(),
+                              filter_.get(), endPoint.data(), polys, &numPolys,
+                              MAX_POLYS, allowSliding);
+  if (numPolys == 0) {
+    return start;
   }
 
+  // See the uncached tryStep, endPoint isn't guaranteed to be on the surface
+  // and may end up on a thin wall to another island
+  navQuery_->getPolyHeight(polys[numPolys - 1], endPoint.data(), &endPoint[1]);
+  nudgeOffThinWall(polyRef, polys[numPolys - 1], endPoint);
+  polyRef = polys[numPolys - 1];
+
   return T{std::move(endPoint)};
 }
 
 template <typename T>
-T PathFinder::Impl::snapPoint(const T& pt, int islandIndex /*=ID_UNDEFINED*/) {
-  islandSystem_->assertValidIsland(islandIndex);
+std::tuple<dtStatus, dtPolyRef, vec3f>
+PathFinderQueryContext::Impl::projectToIsland(const T& pt,
+                                              const int islandIndex,
+                                              const vec3f& halfExtents) const {
+  const vec3f center{pt[0], pt[1], pt[2]};
+  if (islandIndex == ID_UNDEFINED) {
+    dtPolyRef polyRef = 0;
+    vec3f polyXYZ = vec3f::Constant(Mn::Constants::nan());
+    dtStatus status =
+        navQuery_->findNearestPoly(center.data(), halfExtents.data(),
+                                   filter_.get(), &polyRef, polyXYZ.data());
+    if (std::isnan(polyXYZ[0]))
+      status = DT_FAILURE;
+    return std::make_tuple(status, polyRef, polyXYZ);
+  }
 
-  // If this query should be island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // set the poly flag to identify polys not on the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/true, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() |
-                             PolyFlags::POLYFLAGS_OFF_ISLAND);
+  // Same as findNearestPoly, but skipping the polygons of other islands.
+  // Unlike excluding them with poly flags this doesn't modify the navmesh,
+  // which is shared with other threads.
+  constexpr int MAX_POLYS = 512;
+  dtPolyRef polys[MAX_POLYS];
+  int numPolys = 0;
+  navQuery_->queryPolygons(center.data(), halfExtents.data(), filter_.get(),
+                           polys, &numPolys, MAX_POLYS);
+
+  dtPolyRef nearestRef = 0;
+  vec3f nearestPt = vec3f::Constant(Mn::Constants::nan());
+  float nearestDistanceSqr = std::numeric_limits<float>::max();
+  for (int i = 0; i < numPolys; ++i) {
+    if (islandSystem_->getPolyIsland(polys[i]) != islandIndex)
+      continue;
+    vec3f closest;
+    bool posOverPoly = false;
+    if (dtStatusFailed(navQuery_->closestPointOnPoly(
+            polys[i], center.data(), closest.data(), &posOverPoly)))
+      continue;
+
+    // A point above a polygon is as close as its height difference beyond
+    // the climb height, like in findNearestPoly
+    float distanceSqr = (center - closest).squaredNorm();
+    if (posOverPoly) {
+      const dtMeshTile* tile = nullptr;
+      const dtPoly* poly = nullptr;
+      navMesh_->getTileAndPolyByRefUnsafe(polys[i], &tile, &poly);
+      const float d =
+          std::abs(center[1] - closest[1]) - tile->header->walkableClimb;
+      distanceSqr = d > 0 ? d * d : 0;
+    }
+    if (distanceSqr < nearestDistanceSqr) {
+      nearestDistanceSqr = distanceSqr;
+      nearestRef = polys[i];
+      nearestPt = closest;
+    }
   }
 
+  return std::make_tuple(nearestRef != 0 ? DT_SUCCESS : DT_FAILURE,
+                         nearestRef, nearestPt);
+}
+
+template <typename T>
+T PathFinderQueryContext::Impl::snapPoint(const T& pt,
+                                          int islandIndex) const {
+  islandSystem_->assertValidIsland(islandIndex);
+
   dtStatus status = 0;
   vec3f projectedPt;
-  std::tie(status, std::ignore, projectedPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
-
-  // Clean up if this query was island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // reset the poly flag identifing polys off the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/false, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() &
-                             ~PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
+  std::tie(status, std::ignore, projectedPt) = projectToIsland(pt, islandIndex);
 
   if (dtStatusSucceed(status)) {
     return T{std::move(projectedPt)};
@@ -1550,7 +4884,7 @@ T PathFinder::Impl::snapPoint(const T& pt, int islandIndex /*=ID_UNDEFINED*/) {
 }
 
 template <typename T>
-int PathFinder::Impl::getIsland(const T& pt) const {
+int PathFinderQueryContext::Impl::getIsland(const T& pt) const {
   dtStatus status = 0;
   vec3f projectedPt;
   dtPolyRef polyRef = 0;
@@ -1567,7 +4901,7 @@ float PathFinder::Impl::islandRadius(int islandIndex) const {
   return islandSystem_->islandRadius(islandIndex);
 }
 
-float PathFinder::Impl::islandRadius(const vec3f& pt) const {
+float PathFinderQueryContext::Impl::islandRadius(const vec3f& pt) const {
   dtPolyRef ptRef = 0;
   dtStatus status = 0;
   std::tie(status, ptRef, std::ignore) =
@@ -1578,15 +4912,305 @@ float PathFinder::Impl::islandRadius(const vec3f& pt) const {
   return islandSystem_->polyIslandRadius(ptRef);
 }
 
-float PathFinder::Impl::distanceToClosestObstacle(
-    const vec3f& pt,
-    const float maxSearchRadius /*= 2.0*/) const {
-  return closestObstacleSurfacePoint(pt, maxSearchRadius).hitDist;
+namespace {
+//! Maximum height difference between a query point and the obstacle grid
+//! nodes it's interpolated from, and between navmesh levels of an island
+//! sharing a node.
+constexpr float OBSTACLE_GRID_MAX_Y_DELTA = 0.5f;
+}  // namespace
+
+float PathFinderQueryContext::Impl::distanceToClosestObstacle(
+    const vec3f& pt,
+    const float maxSearchRadius) const {
+  if (!obstacleField_ || maxSearchRadius > obstacleField_->maxSearchRadius)
+    return closestObstacleSurfacePoint(pt, maxSearchRadius).hitDist;
+
+  dtPolyRef ptRef = 0;
+  dtStatus status = 0;
+  vec3f polyPt;
+  std::tie(status, ptRef, polyPt) =
+      projectToPoly(pt, navQuery_.get(), filter_.get());
+  if (status != DT_SUCCESS || ptRef == 0)
+    return std::numeric_limits<float>::infinity();
+
+  // Bilinear lookup in the grid of the point's island, if all four
+  // surrounding nodes are on the point's level
+  const int island = islandSystem_->getPolyIsland(ptRef);
+  if (island != ID_UNDEFINED && island < obstacleField_->islands.size()) {
+    const ObstacleGrid& grid = obstacleField_->islands[island];
+    const float fx = (polyPt[0] - grid.minX) / obstacleField_->cellSize;
+    const float fz = (polyPt[2] - grid.minZ) / obstacleField_->cellSize;
+    const int x = std::floor(fx);
+    const int z = std::floor(fz);
+    if (x >= 0 && z >= 0 && x + 1 < grid.width && z + 1 < grid.depth) {
+      const int i00 = z * grid.width + x;
+      const int nodes[4] = {i00, i00 + 1, i00 + grid.width,
+                            i00 + grid.width + 1};
+      bool valid = true;
+      for (const int node : nodes) {
+        valid = valid && !std::isnan(grid.distances[node]) &&
+                std::abs(grid.heights[node] - polyPt[1]) <=
+                    OBSTACLE_GRID_MAX_Y_DELTA;
+      }
+      if (valid) {
+        const float tx = fx - x;
+        const float tz = fz - z;
+        const float d0 = grid.distances[nodes[0]] * (1 - tx) +
+                         grid.distances[nodes[1]] * tx;
+        const float d1 = grid.distances[nodes[2]] * (1 - tx) +
+                         grid.distances[nodes[3]] * tx;
+        return std::min(d0 * (1 - tz) + d1 * tz, maxSearchRadius);
+      }
+    }
+  }
+
+  // Exact fallback
+  float hitDist = Mn::Constants::nan();
+  vec3f hitPos, hitNormal;
+  navQuery_->findDistanceToWall(ptRef, polyPt.data(), maxSearchRadius,
+                                filter_.get(), &hitDist, hitPos.data(),
+                                hitNormal.data());
+  return hitDist;
+}
+
+bool PathFinder::Impl::buildObstacleDistanceField(
+    const float cellSize,
+    const float maxSearchRadius) {
+  ESP_CHECK(cellSize > 0 && maxSearchRadius > 0,
+            "PathFinder::buildObstacleDistanceField : cellSize and "
+            "maxSearchRadius must be positive, got"
+                << cellSize << "and" << maxSearchRadius);
+  if (!isLoaded())
+    return false;
+  obstacleField_ = std::make_shared<const ObstacleDistanceField>(
+      computeObstacleDistanceField(cellSize, maxSearchRadius));
+  return resetQueries();
+}
+
+bool PathFinder::Impl::buildPathHierarchy(const int clusterSize) {
+  ESP_CHECK(clusterSize > 0,
+            "PathFinder::buildPathHierarchy : clusterSize must be positive, got"
+                << clusterSize);
+  if (!isLoaded())
+    return false;
+  pathHierarchyClusterSize_ = clusterSize;
+  pathHierarchy_ = std::make_shared<const impl::PathHierarchy>(
+      navMesh_.get(), islandSystem_, filter_.get(), clusterSize);
+  return resetQueries();
+}
+
+ObstacleDistanceField PathFinder::Impl::computeObstacleDistanceField(
+    const float cellSize,
+    const float maxSearchRadius,
+    const ObstacleDistanceField* previous,
+    const impl::IslandSystem* previousIslands,
+    const Eigen::AlignedBox2f& changedArea) {
+  ObstacleDistanceField field{cellSize, maxSearchRadius, {}};
+  const dtNavMesh* navMesh = navMesh_.get();
+
+  // Islands with the same walkable polygons as a previous island outside of
+  // the changed area. The polygons of the replaced tiles are all inside it.
+  const int CONFLICT = ID_UNDEFINED - 1;
+  std::vector<int> previousMatches;
+  std::vector<int> matches(numIslands(), ID_UNDEFINED);
+  std::vector<int> previousIndices;
+  if (previous) {
+    previousIndices = islandSystem_->previousPolyIndices(*previousIslands);
+    previousMatches.assign(previousIslands->numIslands(), ID_UNDEFINED);
+  }
+  const auto match = [CONFLICT](int& matched, const int island) {
+    matched = matched == ID_UNDEFINED || matched == island ? island : CONFLICT;
+  };
+
+  // Walkable polygons of each island and the islands' XZ bounds
+  std::vector<std::vector<dtPolyRef>> islandPolys(numIslands());
+  std::vector<Eigen::AlignedBox2f> islandBounds(numIslands());
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    const dtPolyRef base = navMesh->getPolyRefBase(tile);
+    for (int iPoly = 0; iPoly < tile->header->polyCount; ++iPoly) {
+      const dtPoly* poly = &tile->polys[iPoly];
+      const dtPolyRef ref = base | static_cast<dtPolyRef>(iPoly);
+      const int island = islandSystem_->getPolyIsland(ref);
+      if (island == ID_UNDEFINED ||
+          poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter_->passFilter(ref, tile, poly))
+        continue;
+      islandPolys[island].push_back(ref);
+      for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+        const float* v = &tile->verts[poly->verts[iVert] * 3];
+        islandBounds[island].extend(Eigen::Vector2f{v[0], v[2]});
+      }
+      const int index =
+          previous ? previousIndices[islandSystem_->getPolyIndex(ref)]
+                   : ID_UNDEFINED;
+      if (index != ID_UNDEFINED) {
+        const int previousIsland = previousIslands->getIndexIsland(index);
+        match(matches[island], previousIsland);
+        match(previousMatches[previousIsland], island);
+      }
+    }
+  }
+  const Eigen::AlignedBox2f dirtyArea{
+      changedArea.min() - Eigen::Vector2f::Constant(maxSearchRadius + cellSize),
+      changedArea.max() +
+          Eigen::Vector2f::Constant(maxSearchRadius + cellSize)};
+
+  // Find the polygon under each grid node. Nodes under several levels of an
+  // island can't be interpolated and are left NaN.
+  struct Node {
+    int island;
+    int index;
+    dtPolyRef ref;
+  };
+  std::vector<Node> nodes;
+  field.islands.resize(numIslands());
+  for (int island = 0; island < numIslands(); ++island) {
+    if (islandPolys[island].empty())
+      continue;
+    ObstacleGrid& grid = field.islands[island];
+    const Eigen::AlignedBox2f& bounds = islandBounds[island];
+    grid.minX = bounds.min()[0];
+    grid.minZ = bounds.min()[1];
+    grid.width = static_cast<int>(bounds.sizes()[0] / cellSize) + 2;
+    grid.depth = static_cast<int>(bounds.sizes()[1] / cellSize) + 2;
+    const size_t numNodes = static_cast<size_t>(grid.width) * grid.depth;
+    std::vector<dtPolyRef> nodeRefs(numNodes, 0);
+    std::vector<char> ambiguous(numNodes, 0);
+
+    // Nodes further away from the changed area than the search radius see
+    // the same polygons and walls as in a matching previous grid
+    int minNodeX = 0, maxNodeX = grid.width - 1;
+    int minNodeZ = 0, maxNodeZ = grid.depth - 1;
+    const int previousIsland = matches[island];
+    const ObstacleGrid* previousGrid =
+        previousIsland >= 0 && previousMatches[previousIsland] == island
+            ? &previous->islands[previousIsland]
+            : nullptr;
+    if (previousGrid && previousGrid->minX == grid.minX &&
+        previousGrid->minZ == grid.minZ &&
+        previousGrid->width == grid.width &&
+        previousGrid->depth == grid.depth) {
+      grid.distances = previousGrid->distances;
+      grid.heights = previousGrid->heights;
+      minNodeX = std::max(
+          minNodeX, static_cast<int>(std::ceil(
+                        (dirtyArea.min()[0] - grid.minX) / cellSize)));
+      maxNodeX = std::min(
+          maxNodeX, static_cast<int>(std::floor(
+                        (dirtyArea.max()[0] - grid.minX) / cellSize)));
+      minNodeZ = std::max(
+          minNodeZ, static_cast<int>(std::ceil(
+                        (dirtyArea.min()[1] - grid.minZ) / cellSize)));
+      maxNodeZ = std::min(
+          maxNodeZ, static_cast<int>(std::floor(
+                        (dirtyArea.max()[1] - grid.minZ) / cellSize)));
+      for (int z = minNodeZ; z <= maxNodeZ; ++z) {
+        for (int x = minNodeX; x <= maxNodeX; ++x) {
+          grid.distances[z * grid.width + x] = Mn::Constants::nan();
+          grid.heights[z * grid.width + x] = Mn::Constants::nan();
+        }
+      }
+    } else {
+      grid.distances.assign(numNodes, Mn::Constants::nan());
+      grid.heights.assign(numNodes, Mn::Constants::nan());
+    }
+
+    for (const dtPolyRef ref : islandPolys[island]) {
+      const dtMeshTile* tile = nullptr;
+      const dtPoly* poly = nullptr;
+      navMesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+      Eigen::AlignedBox2f polyBounds;
+      std::vector<Eigen::Vector2f> outline(poly->vertCount);
+      for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+        const float* v = &tile->verts[poly->verts[iVert] * 3];
+        outline[iVert] = {v[0], v[2]};
+        polyBounds.extend(outline[iVert]);
+      }
+      const int x0 = std::max(
+          minNodeX, static_cast<int>(std::ceil(
+                        (polyBounds.min()[0] - grid.minX) / cellSize)));
+      const int x1 = std::min(
+          maxNodeX,
+          static_cast<int>((polyBounds.max()[0] - grid.minX) / cellSize));
+      const int z0 = std::max(
+          minNodeZ, static_cast<int>(std::ceil(
+                        (polyBounds.min()[1] - grid.minZ) / cellSize)));
+      const int z1 = std::min(
+          maxNodeZ,
+          static_cast<int>((polyBounds.max()[1] - grid.minZ) / cellSize));
+      for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+          const Eigen::Vector2f p{grid.minX + x * cellSize,
+                                  grid.minZ + z * cellSize};
+          // Inside test for the convex outline, in either winding
+          bool hasNeg = false, hasPos = false;
+          for (size_t i = 0, j = outline.size() - 1; i < outline.size();
+               j = i++) {
+            const Eigen::Vector2f edge = outline[i] - outline[j];
+            const Eigen::Vector2f rel = p - outline[j];
+            const float cross = edge[0] * rel[1] - edge[1] * rel[0];
+            hasNeg = hasNeg || cross < -1e-6f;
+            hasPos = hasPos || cross > 1e-6f;
+          }
+          if (hasNeg && hasPos)
+            continue;
+
+          const int index = z * grid.width + x;
+          float height = 0;
+          const vec3f pos{p[0], 0, p[1]};
+          if (dtStatusFailed(
+                  query_->navQuery()->getPolyHeight(ref, pos.data(), &height)))
+            continue;
+          if (nodeRefs[index] == 0) {
+            nodeRefs[index] = ref;
+            grid.heights[index] = height;
+          } else if (std::abs(grid.heights[index] - height) >
+                     OBSTACLE_GRID_MAX_Y_DELTA) {
+            ambiguous[index] = 1;
+          }
+        }
+      }
+    }
+
+    for (int z = minNodeZ; z <= maxNodeZ; ++z) {
+      for (int x = minNodeX; x <= maxNodeX; ++x) {
+        const int index = z * grid.width + x;
+        if (nodeRefs[index] == 0 || ambiguous[index]) {
+          grid.heights[index] = Mn::Constants::nan();
+          continue;
+        }
+        nodes.push_back({island, index, nodeRefs[index]});
+      }
+    }
+  }
+
+  // Exact obstacle distances at the nodes
+  const std::vector<const PathFinderQueryContext::Impl*> queries =
+      workerQueries();
+  threadPool().parallelFor(
+      nodes.size(), [&](const size_t i, const int threadIndex) {
+        const Node& node = nodes[i];
+        ObstacleGrid& grid = field.islands[node.island];
+        const vec3f pos{grid.minX + (node.index % grid.width) * cellSize,
+                        grid.heights[node.index],
+                        grid.minZ + (node.index / grid.width) * cellSize};
+        float hitDist = Mn::Constants::nan();
+        vec3f hitPos, hitNormal;
+        queries[threadIndex]->navQuery()->findDistanceToWall(
+            node.ref, pos.data(), maxSearchRadius, filter_.get(), &hitDist,
+            hitPos.data(), hitNormal.data());
+        grid.distances[node.index] = hitDist;
+      });
+
+  return field;
 }
 
-HitRecord PathFinder::Impl::closestObstacleSurfacePoint(
+HitRecord PathFinderQueryContext::Impl::closestObstacleSurfacePoint(
     const vec3f& pt,
-    const float maxSearchRadius /*= 2.0*/) const {
+    const float maxSearchRadius) const {
   dtPolyRef ptRef = 0;
   dtStatus status = 0;
   vec3f polyPt;
@@ -1604,8 +5228,9 @@ HitRecord PathFinder::Impl::closestObstacleSurfacePoint(
   return {std::move(hitPos), std::move(hitNormal), hitDist};
 }
 
-bool PathFinder::Impl::isNavigable(const vec3f& pt,
-                                   const float maxYDelta /*= 0.5*/) const {
+dtPolyRef PathFinderQueryContext::Impl::navigablePoly(
+    const vec3f& pt,
+    const float maxYDelta) const {
   dtPolyRef ptRef = 0;
   dtStatus status = 0;
   vec3f polyPt;
@@ -1613,54 +5238,135 @@ bool PathFinder::Impl::isNavigable(const vec3f& pt,
       projectToPoly(pt, navQuery_.get(), filter_.get());
 
   if (status != DT_SUCCESS || ptRef == 0)
-    return false;
+    return 0;
 
   if (std::abs(polyPt[1] - pt[1]) > maxYDelta ||
       (Eigen::Vector2f(pt[0], pt[2]) - Eigen::Vector2f(polyPt[0], polyPt[2]))
               .norm() > 1e-2)
-    return false;
+    return 0;
 
-  return true;
+  return ptRef;
 }
 
 typedef Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> MatrixXb;
+typedef Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> MatrixXi;
 
 Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
 PathFinder::Impl::getTopDownView(const float metersPerPixel,
                                  const float height,
-                                 const float eps) const {
-  std::pair<vec3f, vec3f> mapBounds = bounds();
-  vec3f bound1 = std::move(mapBounds.first);
-  vec3f bound2 = std::move(mapBounds.second);
+                                 const float eps) {
+  // A pixel is navigable exactly if it has an island
+  const MatrixXi islands = getTopDownIslandView(metersPerPixel, height, eps);
+  return (islands.array() != ID_UNDEFINED).matrix();
+}
 
-  float xspan = std::abs(bound1[0] - bound2[0]);
-  float zspan = std::abs(bound1[2] - bound2[2]);
-  int xResolution = xspan / metersPerPixel;
-  int zResolution = zspan / metersPerPixel;
-  float startx = fmin(bound1[0], bound2[0]);
-  float startz = fmin(bound1[2], bound2[2]);
-  MatrixXb topdownMap(zResolution, xResolution);
+MatrixXi PathFinder::Impl::getTopDownIslandView(const float metersPerPixel,
+                                                const float height,
+                                                const float eps) {
+  if (!topDownCache_ || topDownCache_->metersPerPixel != metersPerPixel ||
+      topDownCache_->height != height || topDownCache_->eps != eps) {
+    topDownCache_ = TopDownCache{
+        metersPerPixel, height, eps,
+        rasterizeTopDownIslandView(metersPerPixel, height, eps)};
+  }
+  return topDownCache_->islands;
+}
 
-  float curz = startz;
-  float curx = startx;
-  for (int h = 0; h < zResolution; ++h) {
-    for (int w = 0; w < xResolution; ++w) {
-      vec3f point = vec3f(curx, height, curz);
-      topdownMap(h, w) = isNavigable(point, eps);
-      curx = curx + metersPerPixel;
+namespace {
+//! Distance from a polygon outline within which a rasterized top-down view
+//! pixel is resolved with an exact navmesh query instead. Covers the 1cm XZ
+//! tolerance of isNavigable plus float error.
+constexpr float TOPDOWN_EDGE_MARGIN = 0.011f;
+//! Slack for comparing heights of pixels inside a polygon against eps and the
+//! walkable climb.
+constexpr float TOPDOWN_HEIGHT_TOL = 1e-3f;
+//! Slack for polygons only touching a pixel through the edge margin, as their
+//! closest point height can differ by the slope over the margin.
+constexpr float TOPDOWN_EDGE_HEIGHT_TOL = 0.02f;
+//! Vertical half extent of the polygon search box of projectToPoly.
+constexpr float TOPDOWN_MAX_Y_DELTA = 4.0f;
+//! Number of map rows rasterized by each parallelFor index.
+constexpr int TOPDOWN_BAND_ROWS = 16;
+
+//! A navmesh polygon prepared for rasterization.
+struct TopDownPoly {
+  //! Outline in the XZ-plane.
+  std::vector<Eigen::Vector2f> outline;
+  //! Sign of the outline's winding, so that @ref outlineDistance is positive
+  //! inside.
+  float winding = 1;
+  std::vector<Triangle> triangles;
+  Eigen::Vector2f min;
+  Eigen::Vector2f max;
+  float walkableClimb = 0;
+  int island = ID_UNDEFINED;
+};
+
+//! Signed distance from the closest edge line of a convex outline, positive
+//! inside. Outside it can underestimate the distance near corners.
+float outlineDistance(const TopDownPoly& poly, const Eigen::Vector2f& p) {
+  float dist = std::numeric_limits<float>::max();
+  const size_t n = poly.outline.size();
+  for (size_t i = 0, j = n - 1; i < n; j = i++) {
+    const Eigen::Vector2f edge = poly.outline[i] - poly.outline[j];
+    const float edgeLength = edge.norm();
+    if (edgeLength < 1e-6f) {
+      continue;
     }
-    curz = curz + metersPerPixel;
-    curx = startx;
+    const Eigen::Vector2f rel = p - poly.outline[j];
+    const float cross = edge[0] * rel[1] - edge[1] * rel[0];
+    dist = std::min(dist, poly.winding * cross / edgeLength);
   }
+  return dist;
+}
 
-  return topdownMap;
+//! Height of the detail mesh of a polygon at p, extrapolated from the closest
+//! triangle if p isn't inside any. NaN for degenerate polygons.
+float detailHeight(const TopDownPoly& poly, const Eigen::Vector2f& p) {
+  float height = std::numeric_limits<float>::quiet_NaN();
+  float bestMinWeight = -std::numeric_limits<float>::max();
+  for (const Triangle& tri : poly.triangles) {
+    const vec3f& a = tri.v[0];
+    const vec3f& b = tri.v[1];
+    const vec3f& c = tri.v[2];
+    const float det =
+        (b[2] - c[2]) * (a[0] - c[0]) + (c[0] - b[0]) * (a[2] - c[2]);
+    if (std::abs(det) < 1e-12f) {
+      continue;
+    }
+    const float wa =
+        ((b[2] - c[2]) * (p[0] - c[0]) + (c[0] - b[0]) * (p[1] - c[2])) / det;
+    const float wb =
+        ((c[2] - a[2]) * (p[0] - c[0]) + (a[0] - c[0]) * (p[1] - c[2])) / det;
+    const float wc = 1.0f - wa - wb;
+    const float minWeight = std::min(wa, std::min(wb, wc));
+    if (minWeight > bestMinWeight) {
+      bestMinWeight = minWeight;
+      height = wa * a[1] + wb * b[1] + wc * c[1];
+    }
+  }
+  return height;
 }
 
-typedef Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> MatrixXi;
+//! What the polygons touching a top-down view pixel tell about it.
+struct TopDownPixel {
+  //! Number of polygons findNearestPoly may rate at distance 0, i.e. with the
+  //! pixel over them within their walkable climb.
+  int numAtZeroDistance = 0;
+  //! Index of a polygon containing the pixel well inside its outline and
+  //! within both eps and the walkable climb, or -1.
+  int containingPoly = -1;
+  //! Whether any polygon is close enough for the pixel to be navigable.
+  bool maybeNavigable = false;
+  //! Whether the pixel can't be resolved without a navmesh query.
+  bool needsQuery = false;
+};
+}  // namespace
 
-MatrixXi PathFinder::Impl::getTopDownIslandView(const float metersPerPixel,
-                                                const float height,
-                                                const float eps) const {
+MatrixXi PathFinder::Impl::rasterizeTopDownIslandView(
+    const float metersPerPixel,
+    const float height,
+    const float eps) {
   std::pair<vec3f, vec3f> mapBounds = bounds();
   vec3f bound1 = std::move(mapBounds.first);
   vec3f bound2 = std::move(mapBounds.second);
@@ -1672,27 +5378,366 @@ MatrixXi PathFinder::Impl::getTopDownIslandView(const float metersPerPixel,
   float startx = fmin(bound1[0], bound2[0]);
   float startz = fmin(bound1[2], bound2[2]);
   MatrixXi topdownMap(zResolution, xResolution);
+  if (xResolution <= 0 || zResolution <= 0) {
+    return topdownMap;
+  }
 
-  float curz = startz;
+  // Pixel sample positions, accumulated the same way as a per-pixel walk so
+  // that queried pixels land on exactly the same points
+  std::vector<float> xs(xResolution);
+  std::vector<float> zs(zResolution);
   float curx = startx;
-  for (int h = 0; h < zResolution; ++h) {
-    for (int w = 0; w < xResolution; ++w) {
-      vec3f point = vec3f(curx, height, curz);
-      if (isNavigable(point, eps)) {
-        // get the island
-        topdownMap(h, w) = getIsland(point);
-      } else {
-        topdownMap(h, w) = -1;
+  for (float& x : xs) {
+    x = curx;
+    curx = curx + metersPerPixel;
+  }
+  float curz = startz;
+  for (float& z : zs) {
+    z = curz;
+    curz = curz + metersPerPixel;
+  }
+
+  // Gather the polygons a navmesh query could return
+  const dtNavMesh* navMesh = navMesh_.get();
+  std::vector<TopDownPoly> polys;
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile->header)
+      continue;
+    const dtPolyRef base = navMesh->getPolyRefBase(tile);
+    for (int iPoly = 0; iPoly < tile->header->polyCount; ++iPoly) {
+      const dtPoly* poly = &tile->polys[iPoly];
+      const dtPolyRef ref = base | static_cast<dtPolyRef>(iPoly);
+      if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter_->passFilter(ref, tile, poly))
+        continue;
+
+      TopDownPoly topDownPoly;
+      float signedArea = 0;
+      for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+        const float* v = &tile->verts[poly->verts[iVert] * 3];
+        topDownPoly.outline.emplace_back(v[0], v[2]);
+      }
+      topDownPoly.min = topDownPoly.max = topDownPoly.outline[0];
+      for (size_t i = 0, j = topDownPoly.outline.size() - 1;
+           i < topDownPoly.outline.size(); j = i++) {
+        const Eigen::Vector2f& a = topDownPoly.outline[j];
+        const Eigen::Vector2f& b = topDownPoly.outline[i];
+        signedArea += a[0] * b[1] - b[0] * a[1];
+        topDownPoly.min = topDownPoly.min.cwiseMin(b);
+        topDownPoly.max = topDownPoly.max.cwiseMax(b);
       }
-      curx = curx + metersPerPixel;
+      topDownPoly.winding = signedArea < 0 ? -1.0f : 1.0f;
+      topDownPoly.triangles = getPolygonTriangles(poly, tile);
+      topDownPoly.walkableClimb = tile->header->walkableClimb;
+      topDownPoly.island = islandSystem_->getPolyIsland(ref);
+      polys.push_back(std::move(topDownPoly));
     }
-    curz = curz + metersPerPixel;
-    curx = startx;
   }
 
+  const float maxYDelta = std::min(eps, TOPDOWN_MAX_Y_DELTA);
+  const int numBands =
+      (zResolution + TOPDOWN_BAND_ROWS - 1) / TOPDOWN_BAND_ROWS;
+  const std::vector<const PathFinderQueryContext::Impl*> queries =
+      workerQueries();
+  threadPool().parallelFor(numBands, [&](size_t band, int threadIndex) {
+    const int h0 = static_cast<int>(band) * TOPDOWN_BAND_ROWS;
+    const int h1 = std::min(h0 + TOPDOWN_BAND_ROWS, zResolution);
+    std::vector<TopDownPixel> pixels((h1 - h0) * xResolution);
+
+    for (int iPoly = 0; iPoly < static_cast<int>(polys.size()); ++iPoly) {
+      const TopDownPoly& poly = polys[iPoly];
+      // pixel range covered by the outline plus margin
+      const int w0 = std::lower_bound(xs.begin(), xs.end(),
+                                      poly.min[0] - TOPDOWN_EDGE_MARGIN) -
+                     xs.begin();
+      const int w1 = std::upper_bound(xs.begin(), xs.end(),
+                                      poly.max[0] + TOPDOWN_EDGE_MARGIN) -
+                     xs.begin();
+      const int ph0 = std::max<int>(
+          h0, std::lower_bound(zs.begin(), zs.end(),
+                               poly.min[1] - TOPDOWN_EDGE_MARGIN) -
+                  zs.begin());
+      const int ph1 = std::min<int>(
+          h1, std::upper_bound(zs.begin(), zs.end(),
+                               poly.max[1] + TOPDOWN_EDGE_MARGIN) -
+                  zs.begin());
+      for (int h = ph0; h < ph1; ++h) {
+        for (int w = w0; w < w1; ++w) {
+          const Eigen::Vector2f p{xs[w], zs[h]};
+          const float dist = outlineDistance(poly, p);
+          if (dist < -TOPDOWN_EDGE_MARGIN) {
+            continue;
+          }
+          TopDownPixel& pixel = pixels[(h - h0) * xResolution + w];
+          const float dy = std::abs(detailHeight(poly, p) - height);
+          if (std::isnan(dy)) {
+            pixel.needsQuery = true;
+            continue;
+          }
+          const bool inside = dist >= TOPDOWN_EDGE_MARGIN;
+          const float tol =
+              inside ? TOPDOWN_HEIGHT_TOL : TOPDOWN_EDGE_HEIGHT_TOL;
+          if (dy <= maxYDelta + tol) {
+            pixel.maybeNavigable = true;
+          }
+          if (dy <= poly.walkableClimb + tol) {
+            ++pixel.numAtZeroDistance;
+            if (inside &&
+                dy < std::min(maxYDelta, poly.walkableClimb) - tol) {
+              pixel.containingPoly = iPoly;
+            }
+          }
+        }
+      }
+    }
+
+    // findNearestPoly prefers a polygon the pixel is over within the walkable
+    // climb. If there is exactly one such polygon and it clearly contains the
+    // pixel, that's the navigable polygon. If no polygon comes close, the pixel
+    // can't be navigable. Everything else needs the real query.
+    for (int h = h0; h < h1; ++h) {
+      for (int w = 0; w < xResolution; ++w) {
+        const TopDownPixel& pixel = pixels[(h - h0) * xResolution + w];
+        if (!pixel.needsQuery && !pixel.maybeNavigable) {
+          topdownMap(h, w) = ID_UNDEFINED;
+        } else if (!pixel.needsQuery && pixel.numAtZeroDistance == 1 &&
+                   pixel.containingPoly != -1) {
+          topdownMap(h, w) = polys[pixel.containingPoly].island;
+        } else {
+          const dtPolyRef ref = queries[threadIndex]->navigablePoly(
+              vec3f(xs[w], height, zs[h]), eps);
+          topdownMap(h, w) =
+              ref != 0 ? islandSystem_->getPolyIsland(ref) : ID_UNDEFINED;
+        }
+      }
+    }
+  });
+
   return topdownMap;
 }
 
+namespace {
+
+//! Range of @ref NavMeshGeometry::indices holding the triangles of
+//! @p islandIndex, or of all triangles for ID_UNDEFINED.
+std::pair<size_t, size_t> islandIndexRange(const NavMeshGeometry& geometry,
+                                           int islandIndex) {
+  if (islandIndex == ID_UNDEFINED)
+    return {0, geometry.indices.size()};
+  return {geometry.islandIndexOffsets[islandIndex],
+          geometry.islandIndexOffsets[islandIndex + 1]};
+}
+
+bool writePly(const std::string& path,
+              const std::vector<vec3f>& vertices,
+              const std::vector<uint32_t>& indices) {
+  FILE* fp = fopen(path.c_str(), "wb");
+  if (!fp)
+    return false;
+
+  fprintf(fp,
+          "ply\n"
+          "format binary_little_endian 1.0\n"
+          "element vertex %zu\n"
+          "property float x\n"
+          "property float y\n"
+          "property float z\n"
+          "element face %zu\n"
+          "property list uchar uint vertex_indices\n"
+          "end_header\n",
+          vertices.size(), indices.size() / 3);
+  for (const vec3f& vertex : vertices) {
+    fwrite(vertex.data(), sizeof(float), 3, fp);
+  }
+  const unsigned char faceSize = 3;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    fwrite(&faceSize, sizeof(faceSize), 1, fp);
+    fwrite(&indices[i], sizeof(uint32_t), 3, fp);
+  }
+
+  const bool written = !ferror(fp);
+  fclose(fp);
+  return written;
+}
+
+bool writeGlb(const std::string& path,
+              const std::vector<vec3f>& vertices,
+              const std::vector<uint32_t>& indices) {
+  vec3f min = vec3f::Zero();
+  vec3f max = vec3f::Zero();
+  if (!vertices.empty()) {
+    min = max = vertices.front();
+    for (const vec3f& vertex : vertices) {
+      min = min.cwiseMin(vertex);
+      max = max.cwiseMax(vertex);
+    }
+  }
+
+  // A single mesh with indices following the positions in one buffer
+  const size_t positionsSize = vertices.size() * sizeof(vec3f);
+  const size_t indicesSize = indices.size() * sizeof(uint32_t);
+  const size_t binSize = positionsSize + indicesSize;
+  char json[2048];
+  const int jsonLength = snprintf(
+      json, sizeof(json),
+      R"({"asset":{"version":"2.0","generator":"habitat-sim"},)"
+      R"("scene":0,"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}],)"
+      R"("meshes":[{"primitives":[{"attributes":{"POSITION":0},)"
+      R"("indices":1}]}],"buffers":[{"byteLength":%zu}],)"
+      R"("bufferViews":[{"buffer":0,"byteOffset":0,"byteLength":%zu,)"
+      R"("target":34962},{"buffer":0,"byteOffset":%zu,"byteLength":%zu,)"
+      R"("target":34963}],)"
+      R"("accessors":[{"bufferView":0,"componentType":5126,"count":%zu,)"
+      R"("type":"VEC3","min":[%.9g,%.9g,%.9g],"max":[%.9g,%.9g,%.9g]},)"
+      R"({"bufferView":1,"componentType":5125,"count":%zu,"type":"SCALAR"}]})",
+      binSize, positionsSize, positionsSize, indicesSize, vertices.size(),
+      min[0], min[1], min[2], max[0], max[1], max[2], indices.size());
+  if (jsonLength < 0 || jsonLength >= int(sizeof(json)))
+    return false;
+
+  // Chunks are 4-byte aligned, JSON padded with spaces and binary data with
+  // zeros
+  const uint32_t jsonChunkSize = (jsonLength + 3) & ~3u;
+  const uint32_t binChunkSize = (binSize + 3) & ~size_t{3};
+  const uint32_t header[]{0x46546C67 /* glTF */, 2,
+                          12 + 8 + jsonChunkSize + 8 + binChunkSize};
+  const uint32_t jsonChunkHeader[]{jsonChunkSize, 0x4E4F534A /* JSON */};
+  const uint32_t binChunkHeader[]{binChunkSize, 0x004E4942 /* BIN */};
+  const char spaces[]{' ', ' ', ' '};
+  const char zeros[]{0, 0, 0};
+
+  FILE* fp = fopen(path.c_str(), "wb");
+  if (!fp)
+    return false;
+  fwrite(header, sizeof(header), 1, fp);
+  fwrite(jsonChunkHeader, sizeof(jsonChunkHeader), 1, fp);
+  fwrite(json, 1, jsonLength, fp);
+  fwrite(spaces, 1, jsonChunkSize - jsonLength, fp);
+  fwrite(binChunkHeader, sizeof(binChunkHeader), 1, fp);
+  fwrite(vertices.data(), 1, positionsSize, fp);
+  fwrite(indices.data(), 1, indicesSize, fp);
+  fwrite(zeros, 1, binChunkSize - binSize, fp);
+
+  const bool written = !ferror(fp);
+  fclose(fp);
+  return written;
+}
+
+}  // namespace
+
+std::shared_ptr<const NavMeshGeometry>
+PathFinder::Impl::getNavMeshGeometry() {
+  if (navMeshGeometry_ || !isLoaded())
+    return navMeshGeometry_;
+
+  auto geometry = NavMeshGeometry::create();
+  std::vector<vec3f>& vertices = geometry->vertices;
+  const int numIslands = islandSystem_->numIslands();
+  // Triangles of each island, then of polygons that aren't on one
+  std::vector<std::vector<uint32_t>> islandIndices(numIslands + 1);
+
+  constexpr uint32_t NoVertex = ~uint32_t{0};
+  std::vector<uint32_t> tileVertices;
+  for (int iTile = 0; iTile < navMesh_->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile =
+        const_cast<const dtNavMesh*>(navMesh_.get())->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+
+    // Vertices shared by the polygons of the tile, added on first use
+    tileVertices.assign(tile->header->vertCount, NoVertex);
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPolyRef polyRef =
+          navMesh_->encodePolyId(tile->salt, iTile, jPoly);
+      const int island = islandSystem_->getPolyIsland(polyRef);
+      std::vector<uint32_t>& indices =
+          islandIndices[island == ID_UNDEFINED ? numIslands : island];
+
+      // Same traversal as getPolygonTriangles(). Detail vertices belong to a
+      // single polygon.
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyDetail* pd = &tile->detailMeshes[jPoly];
+      const uint32_t detailVertexBase = vertices.size();
+      for (int k = 0; k < pd->vertCount; ++k) {
+        vertices.emplace_back(Eigen::Map<const vec3f>(
+            &tile->detailVerts[static_cast<size_t>(pd->vertBase + k) * 3]));
+      }
+      for (int j = 0; j < pd->triCount; ++j) {
+        const unsigned char* t =
+            &tile->detailTris[static_cast<size_t>((pd->triBase + j)) * 4];
+        for (int k = 0; k < 3; ++k) {
+          if (t[k] >= poly->vertCount) {
+            indices.push_back(detailVertexBase + (t[k] - poly->vertCount));
+            continue;
+          }
+          uint32_t& vertex = tileVertices[poly->verts[t[k]]];
+          if (vertex == NoVertex) {
+            vertex = vertices.size();
+            vertices.emplace_back(Eigen::Map<const vec3f>(
+                &tile->verts[static_cast<size_t>(poly->verts[t[k]]) * 3]));
+          }
+          indices.push_back(vertex);
+        }
+      }
+    }
+  }
+
+  geometry->islandIndexOffsets.reserve(numIslands + 1);
+  for (const std::vector<uint32_t>& indices : islandIndices) {
+    geometry->islandIndexOffsets.push_back(geometry->indices.size());
+    geometry->indices.insert(geometry->indices.end(), indices.begin(),
+                             indices.end());
+  }
+
+  navMeshGeometry_ = std::move(geometry);
+  return navMeshGeometry_;
+}
+
+bool PathFinder::Impl::exportNavMeshGeometry(const std::string& path,
+                                             int islandIndex) {
+  if (!isLoaded()) {
+    ESP_ERROR() << "No NavMesh loaded, can't export" << path;
+    return false;
+  }
+  islandSystem_->assertValidIsland(islandIndex);
+
+  const std::shared_ptr<const NavMeshGeometry> geometry = getNavMeshGeometry();
+  const std::pair<size_t, size_t> range =
+      islandIndexRange(*geometry, islandIndex);
+
+  // Keep only the vertices of the exported triangles
+  constexpr uint32_t NoVertex = ~uint32_t{0};
+  std::vector<uint32_t> remap(geometry->vertices.size(), NoVertex);
+  std::vector<vec3f> vertices;
+  std::vector<uint32_t> indices;
+  indices.reserve(range.second - range.first);
+  for (size_t i = range.first; i < range.second; ++i) {
+    uint32_t& vertex = remap[geometry->indices[i]];
+    if (vertex == NoVertex) {
+      vertex = vertices.size();
+      vertices.push_back(geometry->vertices[geometry->indices[i]]);
+    }
+    indices.push_back(vertex);
+  }
+
+  const std::string extension = Cr::Utility::String::lowercase(
+      Cr::Utility::Path::splitExtension(path).second());
+  bool written = false;
+  if (extension == ".ply") {
+    written = writePly(path, vertices, indices);
+  } else if (extension == ".glb") {
+    written = writeGlb(path, vertices, indices);
+  } else {
+    ESP_ERROR() << "Unsupported NavMesh export format" << extension
+                << ", expected .ply or .glb";
+    return false;
+  }
+  if (!written)
+    ESP_ERROR() << "Could not write" << path;
+  return written;
+}
+
 assets::MeshData::ptr PathFinder::Impl::getNavMeshData(
     int islandIndex /*= ID_UNDEFINED*/) {
   islandSystem_->assertValidIsland(islandIndex);
@@ -1703,38 +5748,17 @@ assets::MeshData::ptr PathFinder::Impl::getNavMeshData(
     std::vector<esp::vec3f>& vbo = curIslandMeshData->vbo;
     std::vector<uint32_t>& ibo = curIslandMeshData->ibo;
 
-    // Iterate over all tiles
-    for (int iTile = 0; iTile < navMesh_->getMaxTiles(); ++iTile) {
-      const dtMeshTile* tile =
-          const_cast<const dtNavMesh*>(navMesh_.get())->getTile(iTile);
-      if (!tile)
-        continue;
-
-      // Iterate over all polygons in a tile
-      for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
-        // Get the polygon reference from the tile and polygon id
-        dtPolyRef polyRef = navMesh_->encodePolyId(tile->salt, iTile, jPoly);
-        if (islandIndex != ID_UNDEFINED &&
-            islandSystem_->getPolyIsland(polyRef) != islandIndex) {
-          // skip polys not in the island.
-          continue;
-        }
-        const dtPoly* poly = nullptr;
-        const dtMeshTile* tmp = nullptr;
-        navMesh_->getTileAndPolyByRefUnsafe(polyRef, &tmp, &poly);
-
-        CORRADE_INTERNAL_ASSERT(poly != nullptr);
-        CORRADE_INTERNAL_ASSERT(tmp != nullptr);
-
-        std::vector<Triangle> triangles = getPolygonTriangles(poly, tile);
-
-        for (auto& tri : triangles) {
-          for (int k = 0; k < 3; ++k) {
-            vbo.push_back(tri.v[k]);
-            ibo.push_back(vbo.size() - 1);
-          }
-        }
-      }
+    // Expanded from the shared geometry into a triangle soup, one vertex per
+    // index
+    const std::shared_ptr<const NavMeshGeometry> geometry =
+        getNavMeshGeometry();
+    const std::pair<size_t, size_t> range =
+        islandIndexRange(*geometry, islandIndex);
+    vbo.reserve(range.second - range.first);
+    ibo.reserve(range.second - range.first);
+    for (size_t i = range.first; i < range.second; ++i) {
+      vbo.push_back(geometry->vertices[geometry->indices[i]]);
+      ibo.push_back(vbo.size() - 1);
     }
     // return newly added meshdata
     return islandMeshData_.emplace(islandIndex, std::move(curIslandMeshData))
@@ -1760,6 +5784,36 @@ bool PathFinder::build(const NavMeshSettings& bs,
   return pimpl_->build(bs, mesh);
 }
 
+std::vector<std::shared_ptr<PathFinder>> PathFinder::buildVariants(
+    const esp::assets::MeshData& mesh,
+    const std::vector<NavMeshSettings>& settings) {
+  std::vector<std::shared_ptr<PathFinder>> variants;
+  std::vector<Impl*> impls;
+  for (size_t i = 0; i < settings.size(); ++i) {
+    variants.push_back(PathFinder::create());
+    impls.push_back(variants.back()->pimpl_.get());
+  }
+  const std::vector<char> built =
+      pimpl_->buildVariants(mesh, settings, impls);
+  for (size_t i = 0; i < settings.size(); ++i) {
+    if (!built[i])
+      variants[i] = nullptr;
+  }
+  return variants;
+}
+
+bool PathFinder::rebuildTiles(const esp::assets::MeshData& mesh,
+                              const vec3f& dirtyMin,
+                              const vec3f& dirtyMax) {
+  return pimpl_->rebuildTiles(mesh, dirtyMin, dirtyMax);
+}
+
+std::pair<vec3f, vec3f> PathFinder::getRebuildRegion(
+    const vec3f& dirtyMin,
+    const vec3f& dirtyMax) const {
+  return pimpl_->getRebuildRegion(dirtyMin, dirtyMax);
+}
+
 vec3f PathFinder::getRandomNavigablePoint(const int maxTries /*= 10*/,
                                           int islandIndex /*= ID_UNDEFINED*/) {
   return pimpl_->getRandomNavigablePoint(maxTries, islandIndex);
@@ -1782,6 +5836,38 @@ bool PathFinder::findPath(MultiGoalShortestPath& path) {
   return pimpl_->findPath(path);
 }
 
+std::vector<bool> PathFinder::findPaths(std::vector<ShortestPath>& paths) {
+  return pimpl_->findPaths(paths);
+}
+
+std::vector<float> PathFinder::geodesicDistances(
+    const std::vector<vec3f>& starts,
+    const std::vector<vec3f>& ends) {
+  return pimpl_->geodesicDistances(starts, ends);
+}
+
+GeodesicDistanceField::ptr PathFinder::computeDistanceField(
+    const std::vector<vec3f>& goals,
+    const float portalSampleSpacing) {
+  return pimpl_->computeDistanceField(goals, portalSampleSpacing);
+}
+
+void PathFinder::setNumThreads(int numThreads) {
+  pimpl_->setNumThreads(numThreads);
+}
+
+int PathFinder::getNumThreads() {
+  return pimpl_->getNumThreads();
+}
+
+PathFinderQueryContext::ptr PathFinder::createQueryContext() {
+  return pimpl_->createQueryContext();
+}
+
+uint64_t PathFinder::getQueryStateVersion() const {
+  return pimpl_->getQueryStateVersion();
+}
+
 template vec3f PathFinder::tryStep<vec3f>(const vec3f&, const vec3f&);
 template Mn::Vector3 PathFinder::tryStep<Mn::Vector3>(const Mn::Vector3&,
                                                       const Mn::Vector3&);
@@ -1801,6 +5887,34 @@ T PathFinder::tryStepNoSliding(const T& start, const T& end) {
   return pimpl_->tryStep(start, end, /*allowSliding=*/false);
 }
 
+template vec3f PathFinder::tryStep<vec3f>(const vec3f&,
+                                          const vec3f&,
+                                          uint64_t&,
+                                          bool);
+template Mn::Vector3 PathFinder::tryStep<Mn::Vector3>(const Mn::Vector3&,
+                                                      const Mn::Vector3&,
+                                                      uint64_t&,
+                                                      bool);
+
+template <typename T>
+T PathFinder::tryStep(const T& start,
+                      const T& end,
+                      uint64_t& polyRef,
+                      const bool allowSliding /*= true*/) {
+  dtPolyRef ref = polyRef;
+  const T result = pimpl_->tryStep(start, end, ref, allowSliding);
+  polyRef = ref;
+  return result;
+}
+
+Eigen::RowMatrixX3f PathFinder::tryStepBatch(
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& starts,
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& ends,
+    Eigen::Ref<Eigen::Matrix<uint64_t, Eigen::Dynamic, 1>> polyRefs,
+    const bool allowSliding /*= true*/) {
+  return pimpl_->tryStepBatch(starts, ends, polyRefs, allowSliding);
+}
+
 template vec3f PathFinder::snapPoint<vec3f>(const vec3f& pt, int islandIndex);
 template Mn::Vector3 PathFinder::snapPoint<Mn::Vector3>(const Mn::Vector3& pt,
                                                         int islandIndex);
@@ -1818,8 +5932,9 @@ int PathFinder::getIsland(const T& pt) {
   return pimpl_->getIsland(pt);
 }
 
-bool PathFinder::loadNavMesh(const std::string& path) {
-  return pimpl_->loadNavMesh(path);
+bool PathFinder::loadNavMesh(const std::string& path,
+                             const bool memoryMap /*= false*/) {
+  return pimpl_->loadNavMesh(path, memoryMap);
 }
 
 bool PathFinder::saveNavMesh(const std::string& path) {
@@ -1830,6 +5945,29 @@ bool PathFinder::isLoaded() const {
   return pimpl_->isLoaded();
 }
 
+Eigen::RowMatrixX3f PathFinder::snapPoints(
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& points,
+    const int islandIndex /*= ID_UNDEFINED*/) {
+  return pimpl_->snapPoints(points, islandIndex);
+}
+
+Eigen::VectorXi PathFinder::getIslands(
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& points) {
+  return pimpl_->getIslands(points);
+}
+
+Eigen::Matrix<bool, Eigen::Dynamic, 1> PathFinder::isNavigableBatch(
+    const Eigen::Ref<const Eigen::RowMatrixX3f>& points,
+    const float maxYDelta /*= 0.5*/) {
+  return pimpl_->isNavigableBatch(points, maxYDelta);
+}
+
+Eigen::RowMatrixX3f PathFinder::sampleNavigablePoints(
+    const int numPoints,
+    const int islandIndex /*= ID_UNDEFINED*/) {
+  return pimpl_->sampleNavigablePoints(numPoints, islandIndex);
+}
+
 void PathFinder::seed(uint32_t newSeed) {
   return pimpl_->seed(newSeed);
 }
@@ -1851,6 +5989,32 @@ float PathFinder::distanceToClosestObstacle(const vec3f& pt,
   return pimpl_->distanceToClosestObstacle(pt, maxSearchRadius);
 }
 
+bool PathFinder::buildObstacleDistanceField(
+    const float cellSize /*= 0.1*/,
+    const float maxSearchRadius /*= 2.0*/) {
+  return pimpl_->buildObstacleDistanceField(cellSize, maxSearchRadius);
+}
+
+void PathFinder::clearObstacleDistanceField() {
+  pimpl_->clearObstacleDistanceField();
+}
+
+bool PathFinder::hasObstacleDistanceField() const {
+  return pimpl_->hasObstacleDistanceField();
+}
+
+bool PathFinder::buildPathHierarchy(const int clusterSize /*= 64*/) {
+  return pimpl_->buildPathHierarchy(clusterSize);
+}
+
+void PathFinder::clearPathHierarchy() {
+  pimpl_->clearPathHierarchy();
+}
+
+bool PathFinder::hasPathHierarchy() const {
+  return pimpl_->hasPathHierarchy();
+}
+
 HitRecord PathFinder::closestObstacleSurfacePoint(
     const vec3f& pt,
     const float maxSearchRadius) const {
@@ -1888,10 +6052,127 @@ assets::MeshData::ptr PathFinder::getNavMeshData(
   return pimpl_->getNavMeshData(islandIndex);
 }
 
+std::shared_ptr<const NavMeshGeometry> PathFinder::getNavMeshGeometry() {
+  return pimpl_->getNavMeshGeometry();
+}
+
+bool PathFinder::exportNavMeshGeometry(const std::string& path,
+                                       int islandIndex /*= ID_UNDEFINED*/) {
+  return pimpl_->exportNavMeshGeometry(path, islandIndex);
+}
+
 Cr::Containers::Optional<NavMeshSettings> PathFinder::getNavMeshSettings()
     const {
   return pimpl_->getNavMeshSettings();
 }
 
+PathFinderQueryContext::PathFinderQueryContext()
+    : pimpl_{spimpl::make_unique_impl<Impl>()} {};
+
+bool PathFinderQueryContext::isLoaded() const {
+  return pimpl_->isLoaded();
+}
+
+bool PathFinderQueryContext::findPath(ShortestPath& path) {
+  return pimpl_->findPath(path);
+}
+
+bool PathFinderQueryContext::findPath(MultiGoalShortestPath& path) {
+  return pimpl_->findPath(path);
+}
+
+template vec3f PathFinderQueryContext::tryStep<vec3f>(const vec3f&,
+                                                      const vec3f&);
+template Mn::Vector3 PathFinderQueryContext::tryStep<Mn::Vector3>(
+    const Mn::Vector3&,
+    const Mn::Vector3&);
+
+template <typename T>
+T PathFinderQueryContext::tryStep(const T& start, const T& end) {
+  return pimpl_->tryStep(start, end, /*allowSliding=*/true);
+}
+
+template vec3f PathFinderQueryContext::tryStepNoSliding<vec3f>(const vec3f&,
+                                                               const vec3f&);
+template Mn::Vector3 PathFinderQueryContext::tryStepNoSliding<Mn::Vector3>(
+    const Mn::Vector3&,
+    const Mn::Vector3&);
+
+template <typename T>
+T PathFinderQueryContext::tryStepNoSliding(const T& start, const T& end) {
+  return pimpl_->tryStep(start, end, /*allowSliding=*/false);
+}
+
+template vec3f PathFinderQueryContext::tryStep<vec3f>(const vec3f&,
+                                                      const vec3f&,
+                                                      uint64_t&,
+                                                      bool);
+template Mn::Vector3 PathFinderQueryContext::tryStep<Mn::Vector3>(
+    const Mn::Vector3&,
+    const Mn::Vector3&,
+    uint64_t&,
+    bool);
+
+template <typename T>
+T PathFinderQueryContext::tryStep(const T& start,
+                                  const T& end,
+                                  uint64_t& polyRef,
+                                  const bool allowSliding /*= true*/) {
+  dtPolyRef ref = polyRef;
+  const T result = pimpl_->tryStep(start, end, ref, allowSliding);
+  polyRef = ref;
+  return result;
+}
+
+template vec3f PathFinderQueryContext::snapPoint<vec3f>(const vec3f& pt,
+                                                        int islandIndex);
+template Mn::Vector3 PathFinderQueryContext::snapPoint<Mn::Vector3>(
+    const Mn::Vector3& pt,
+    int islandIndex);
+
+template int PathFinderQueryContext::getIsland<vec3f>(const vec3f& pt);
+template int PathFinderQueryContext::getIsland<Mn::Vector3>(
+    const Mn::Vector3& pt);
+
+template <typename T>
+T PathFinderQueryContext::snapPoint(const T& pt, int islandIndex) {
+  return pimpl_->snapPoint(pt, islandIndex);
+}
+
+template <typename T>
+int PathFinderQueryContext::getIsland(const T& pt) {
+  return pimpl_->getIsland(pt);
+}
+
+bool PathFinderQueryContext::isNavigable(const vec3f& pt,
+                                         const float maxYDelta /*= 0.5*/) {
+  return pimpl_->navigablePoly(pt, maxYDelta) != 0;
+}
+
+float PathFinderQueryContext::distanceToClosestObstacle(
+    const vec3f& pt,
+    const float maxSearchRadius /*= 2.0*/) {
+  return pimpl_->distanceToClosestObstacle(pt, maxSearchRadius);
+}
+
+vec3f PathFinderQueryContext::getRandomNavigablePoint(
+    int islandIndex /*= ID_UNDEFINED*/) {
+  return pimpl_->samplePoint(islandIndex);
+}
+
+vec3f PathFinderQueryContext::getRandomNavigablePointAroundSphere(
+    const vec3f& circleCenter,
+    const float radius,
+    const int maxTries /*= 10*/,
+    int islandIndex /*= ID_UNDEFINED*/) {
+  contextRandom = &pimpl_->random;
+  return pimpl_->getRandomNavigablePointAroundSphere(
+      circleCenter, radius, maxTries, islandIndex, contextFrand);
+}
+
+void PathFinderQueryContext::seed(uint32_t newSeed) {
+  pimpl_->random.seed(newSeed);
+}
+
 }  // namespace nav
 }  // namespace esp
@@ -22,6 +22,27 @@ struct MeshData;
 namespace nav {
 
 class PathFinder;
+class PathFinderQueryContext;
+
+/**
+ * @brief Indexed triangle mesh of a navmesh.
+ *
+ * Vertices shared by the polygons of a tile are stored once, so the size
+ * scales with the unique geometry. Triangles are grouped by island instead of
+ * storing a copy of the geometry per island.
+ */
+struct NavMeshGeometry {
+  //! Vertex positions.
+  std::vector<vec3f> vertices;
+  //! Three vertex indices per triangle.
+  std::vector<uint32_t> indices;
+  //! The triangles of island i are @ref indices [islandIndexOffsets[i],
+  //! islandIndexOffsets[i + 1]). Triangles of polygons that aren't on an
+  //! island follow the last range.
+  std::vector<uint32_t> islandIndexOffsets;
+
+  ESP_SMART_POINTERS(NavMeshGeometry)
+};
 
 /**
  * @brief Struct for recording closest obstacle information.
@@ -67,6 +88,15 @@ struct ShortestPath {
    */
   float geodesicDistance{};
 
+  /**
+   * @brief Fall back to the path hierarchy if the Detour search gives up
+   * before reaching the end, see @ref PathFinder::buildPathHierarchy
+   *
+   * Paths the Detour search finds are unchanged. This rescues paths that are
+   * too long for Detour, it doesn't make queries faster.
+   */
+  bool usePathHierarchy{};
+
   ESP_SMART_POINTERS(ShortestPath)
 };
 
@@ -113,11 +143,94 @@ struct MultiGoalShortestPath {
    */
   int closestEndPointIndex{};
 
+  /**
+   * @brief Answer queries from a single search from all requested end points
+   * instead of a search per end point
+   *
+   * On the first query, the search builds a @ref GeodesicDistanceField over the
+   * requested ends. The field is kept until the ends change, the navmesh
+   * changes or @ref distanceFieldSpacing changes. Each query then follows the
+   * field from the start to the closest end. The polygons it crosses are
+   * string-pulled into @ref points, and @ref geodesicDistance is the length of
+   * that path. Use this for static goals queried from many starts, such as
+   * per-step distances to the view points of an episode.
+   *
+   * The closest end is picked by the field, so the result can differ from the
+   * default search by up to @ref distanceFieldSpacing per portal crossed.
+   */
+  bool useDistanceField{};
+
+  /**
+   * @brief The portal sample spacing of the distance field used with
+   * @ref useDistanceField, see @ref PathFinder::computeDistanceField.
+   */
+  float distanceFieldSpacing{0.25};
+
+  /**
+   * @brief Fall back to the path hierarchy if the Detour search gives up
+   * before reaching an end, see @ref PathFinder::buildPathHierarchy
+   *
+   * Paths the Detour search finds are unchanged. This rescues paths that are
+   * too long for Detour, it doesn't make queries faster. Not used with
+   * @ref useDistanceField.
+   */
+  bool usePathHierarchy{};
+
   friend class PathFinder;
+  friend class PathFinderQueryContext;
 
   ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(MultiGoalShortestPath)
 };
 
+/**
+ * @brief Precomputed geodesic distances from a fixed set of goal points to
+ * every point on the navigation mesh.
+ *
+ * Created with @ref PathFinder::computeDistanceField, which runs a single
+ * multi-source Dijkstra search from all goals over points sampled along the
+ * portals between navmesh polygons. Queries then only need to snap the point
+ * to its polygon and refine with the straight-line distance to the portal
+ * samples of that polygon, which is much cheaper than an A* search per query.
+ *
+ * Distances are exact when the shortest path crosses portals at sample
+ * points or bends around navmesh vertices, and otherwise slightly
+ * overestimate the true geodesic distance, by at most the portal sample
+ * spacing per portal crossed.
+ *
+ * The field keeps the navmesh it was computed on alive, so it remains valid
+ * (for that navmesh) if the @ref PathFinder is rebuilt or reloaded.
+ */
+class GeodesicDistanceField {
+ public:
+  GeodesicDistanceField();
+
+  /**
+   * @brief Returns the geodesic distance from @p pt to the closest goal.
+   *
+   * @param[in] pt The query point. It is snapped to the navigation mesh first.
+   *
+   * @return The geodesic distance or inf if @p pt can't be snapped to the
+   * navmesh or no goal is reachable from it.
+   */
+  float distanceTo(const vec3f& pt) const;
+
+  /**
+   * @brief Returns the geodesic distance from each of @p points to the closest
+   * goal. See @ref distanceTo.
+   */
+  std::vector<float> distancesTo(const std::vector<vec3f>& points) const;
+
+  /**
+   * @brief The goal points this field was computed for.
+   */
+  const std::vector<vec3f>& getGoals() const;
+
+  friend class PathFinder;
+  friend class PathFinderQueryContext;
+
+  ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(GeodesicDistanceField)
+};
+
 /**
  * @brief Configuration structure for NavMesh generation with recast.
  *
@@ -263,6 +376,17 @@ struct NavMeshSettings {
    */
   bool includeStaticObjects{};
 
+  /**
+   * @brief Width and depth of a navmesh tile in voxels.
+   *
+   * A value of zero builds the whole navmesh as a single tile. Otherwise the
+   * XZ-plane is split into square tiles which are built independently and can
+   * later be rebuilt individually with @ref PathFinder::rebuildTiles. Values
+   * in the 32-128 range are usually a good tradeoff between rebuild speed and
+   * navmesh quality. [Limit: >= 0]
+   */
+  int tileSize{};
+
   void setDefaults() {
     cellSize = 0.05f;
     cellHeight = 0.2f;
@@ -281,6 +405,7 @@ struct NavMeshSettings {
     filterLedgeSpans = true;
     filterWalkableLowHeightSpans = true;
     includeStaticObjects = false;
+    tileSize = 0;
   }
 
   //! Load the settings from a JSON file
@@ -305,6 +430,128 @@ bool operator==(const NavMeshSettings& a, const NavMeshSettings& b);
  */
 bool operator!=(const NavMeshSettings& a, const NavMeshSettings& b);
 
+/**
+ * @brief Per-thread query state for a @ref PathFinder.
+ *
+ * Created with @ref PathFinder::createQueryContext. The navmesh, its islands
+ * and the obstacle distance field are shared read-only with the @ref
+ * PathFinder and all its other contexts, a context only owns a Detour query
+ * object with its search node pool and a random state. Giving each thread its
+ * own context lets any number of threads query one loaded navmesh
+ * concurrently without locking.
+ *
+ * A context is a snapshot: it keeps querying the navmesh the @ref PathFinder
+ * had when the context was created, even if the @ref PathFinder is rebuilt or
+ * reloaded afterwards. A single context must not be used by several threads
+ * at once.
+ *
+ * The queries behave like the @ref PathFinder methods of the same name.
+ */
+class PathFinderQueryContext {
+ public:
+  /**
+   * @brief Constructor. Use @ref PathFinder::createQueryContext to get a
+   * context with a navmesh to query.
+   */
+  PathFinderQueryContext();
+
+  /**
+   * @return Whether the context has a navmesh to query.
+   */
+  bool isLoaded() const;
+
+  /**
+   * @brief See @ref PathFinder::findPath(ShortestPath&).
+   */
+  bool findPath(ShortestPath& path);
+
+  /**
+   * @brief See @ref PathFinder::findPath(MultiGoalShortestPath&).
+   */
+  bool findPath(MultiGoalShortestPath& path);
+
+  /**
+   * @brief See @ref PathFinder::tryStep.
+   */
+  template <typename T>
+  T tryStep(const T& start, const T& end);
+
+  /**
+   * @brief See @ref PathFinder::tryStepNoSliding.
+   */
+  template <typename T>
+  T tryStepNoSliding(const T& start, const T& end);
+
+  /**
+   * @brief See @ref PathFinder::tryStep(const T&, const T&, uint64_t&, bool).
+   */
+  template <typename T>
+  T tryStep(const T& start,
+            const T& end,
+            uint64_t& polyRef,
+            bool allowSliding = true);
+
+  /**
+   * @brief See @ref PathFinder::snapPoint.
+   */
+  template <typename T>
+  T snapPoint(const T& pt, int islandIndex = ID_UNDEFINED);
+
+  /**
+   * @brief See @ref PathFinder::getIsland.
+   */
+  template <typename T>
+  int getIsland(const T& pt);
+
+  /**
+   * @brief See @ref PathFinder::isNavigable.
+   */
+  bool isNavigable(const vec3f& pt, float maxYDelta = 0.5);
+
+  /**
+   * @brief See @ref PathFinder::distanceToClosestObstacle.
+   */
+  float distanceToClosestObstacle(const vec3f& pt,
+                                  float maxSearchRadius = 2.0);
+
+  /**
+   * @brief Returns a random navigable point, uniformly distributed over the
+   * navigable area of the navmesh or of an island.
+   *
+   * Drawn from the context's own random state, see @ref seed.
+   *
+   * @param[in] islandIndex Optionally specify the island from which to sample
+   * the point. Default -1 samples the full navmesh.
+   *
+   * @return A random navigable point or NAN if none found.
+   */
+  vec3f getRandomNavigablePoint(int islandIndex = ID_UNDEFINED);
+
+  /**
+   * @brief See @ref PathFinder::getRandomNavigablePointAroundSphere. Drawn
+   * from the context's own random state, see @ref seed.
+   */
+  vec3f getRandomNavigablePointAroundSphere(const vec3f& circleCenter,
+                                            float radius,
+                                            int maxTries = 10,
+                                            int islandIndex = ID_UNDEFINED);
+
+  /**
+   * @brief Seed the random state of this context.
+   *
+   * Contexts are seeded from the random state of the @ref PathFinder when
+   * they are created, so seeding the @ref PathFinder before creating its
+   * contexts also makes them reproducible.
+   *
+   * @param[in] newSeed The random seed
+   */
+  void seed(uint32_t newSeed);
+
+  friend class PathFinder;
+
+  ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(PathFinderQueryContext)
+};
+
 /** @brief Loads and/or builds a navigation mesh and then allows point sampling,
  * path finding, collision, and island queries on that navmesh.
  *
@@ -328,6 +575,12 @@ bool operator!=(const NavMeshSettings& a, const NavMeshSettings& b);
  * surfaces of solid voxels where the cylinder would sit without intersection or
  * overhanging and respecting configured constraints such as maximum climbable
  * slope and step-height.
+ *
+ * Unless noted otherwise, a PathFinder must not be used by several threads at
+ * once. Its batched query methods run on its own worker threads (see @ref
+ * setNumThreads), and threads that need to query the navmesh concurrently can
+ * each get their own @ref PathFinderQueryContext from @ref
+ * createQueryContext.
  */
 class PathFinder {
  public:
@@ -372,6 +625,72 @@ class PathFinder {
    */
   bool build(const NavMeshSettings& bs, const esp::assets::MeshData& mesh);
 
+  /**
+   * @brief Construct a NavMesh per entry of @p settings from the same mesh,
+   * e.g. when sweeping agent parameters for a new robot.
+   *
+   * Rasterizing the mesh into a voxel heightfield is done once for all
+   * settings that agree on @ref NavMeshSettings::cellSize, @ref
+   * NavMeshSettings::cellHeight, @ref NavMeshSettings::agentMaxSlope and
+   * @ref NavMeshSettings::agentMaxClimb, only filtering, erosion, region
+   * partitioning and polygonization run per entry. Heightfields and variants
+   * are built concurrently on the threads set with @ref setNumThreads.
+   * Tiled settings (@ref NavMeshSettings::tileSize > 0) don't share a
+   * heightfield and are built one after another, each tiled on the same
+   * number of threads.
+   *
+   * The result is the same as calling @ref build with each entry. This
+   * PathFinder isn't modified.
+   *
+   * @param mesh A joined mesh for which to compute the navmeshes.
+   * @param settings Parameter settings of each NavMesh.
+   *
+   * @return A PathFinder per entry of @p settings, nullptr where construction
+   * failed.
+   */
+  std::vector<std::shared_ptr<PathFinder>> buildVariants(
+      const esp::assets::MeshData& mesh,
+      const std::vector<NavMeshSettings>& settings);
+
+  /**
+   * @brief Rebuild the tiles of the current NavMesh which are affected by
+   * changes of the input geometry inside an axis-aligned region.
+   *
+   * Only tiles whose bounds, padded by the agent radius, overlap the region
+   * are re-rasterized and replaced. Everything else, including tile refs of
+   * untouched tiles, stays as is. Islands, the path hierarchy and the
+   * obstacle distance field are only updated around the replaced tiles.
+   * Requires a NavMesh built or loaded with @ref NavMeshSettings::tileSize >
+   * 0, otherwise the whole NavMesh is rebuilt from @p mesh.
+   *
+   * @param mesh The joined mesh after the change. For a tiled NavMesh it only
+   * needs to contain the triangles overlapping @ref getRebuildRegion, an
+   * empty mesh removes the affected tiles.
+   * @param dirtyMin Min corner of the changed region, should cover the
+   * geometry both before and after the change.
+   * @param dirtyMax Max corner of the changed region.
+   *
+   * @return Whether or not the update was successful.
+   */
+  bool rebuildTiles(const esp::assets::MeshData& mesh,
+                    const vec3f& dirtyMin,
+                    const vec3f& dirtyMax);
+
+  /**
+   * @brief The region whose geometry @ref rebuildTiles rasterizes for a
+   * change inside an axis-aligned region.
+   *
+   * This is the XZ extent of the affected tiles, padded by the agent radius
+   * and unbounded in Y. Unbounded if the NavMesh isn't tiled.
+   *
+   * @param dirtyMin Min corner of the changed region.
+   * @param dirtyMax Max corner of the changed region.
+   *
+   * @return The min and max corner of the region.
+   */
+  std::pair<vec3f, vec3f> getRebuildRegion(const vec3f& dirtyMin,
+                                           const vec3f& dirtyMax) const;
+
   /**
    * @brief Returns a random navigable point.
    *
@@ -380,6 +699,11 @@ class PathFinder {
    *  @param[in] islandIndex Optionally specify the island from which to sample
    * the point. Default -1 queries the full navmesh.
    *
+   * Points on a specific island are sampled uniformly by area in constant
+   * time from a per-island alias table, without modifying the navmesh. Such
+   * queries can be made concurrently from several threads, each with its own
+   * random state derived from @ref seed.
+   *
    * @return A random navigable point or NAN if none found.
    *
    * @note This method can fail.  If it does,
@@ -444,6 +768,157 @@ class PathFinder {
    */
   bool findPath(MultiGoalShortestPath& path);
 
+  /**
+   * @brief Finds the shortest paths for a batch of @ref ShortestPath queries.
+   *
+   * Queries are distributed over the PathFinder's worker threads (see @ref
+   * setNumThreads), each thread using its own navmesh query object. Each
+   * element is populated exactly as with @ref findPath(ShortestPath&).
+   *
+   * @param[inout] paths The queries to solve.
+   *
+   * @return Whether or not a path exists for each query, in input order.
+   */
+  std::vector<bool> findPaths(std::vector<ShortestPath>& paths);
+
+  /**
+   * @brief Computes the geodesic distance between each pair of start and end
+   * points.
+   *
+   * Batched, multi-threaded equivalent of calling @ref findPath for each pair
+   * and reading @ref ShortestPath.geodesicDistance.
+   *
+   * @param[in] starts The starting points.
+   * @param[in] ends The end points. Must be the same size as @p starts.
+   *
+   * @return The geodesic distance for each pair, in input order. Will be inf
+   * for pairs with no path between them.
+   */
+  std::vector<float> geodesicDistances(const std::vector<vec3f>& starts,
+                                       const std::vector<vec3f>& ends);
+
+  /**
+   * @brief Snaps each point to the navigation mesh.
+   *
+   * Batched, multi-threaded equivalent of calling @ref snapPoint for each
+   * point.
+   *
+   * @param[in] points The points to snap, one per row.
+   * @param[in] islandIndex Optionally specify the island to snap to. Default
+   * -1 snaps to the full navmesh.
+   *
+   * @return The snapped points, in input order. Rows are NaN for points that
+   * couldn't be snapped.
+   */
+  Eigen::RowMatrixX3f snapPoints(
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& points,
+      int islandIndex = ID_UNDEFINED);
+
+  /**
+   * @brief Gets the island of each point.
+   *
+   * Batched, multi-threaded equivalent of calling @ref getIsland for each
+   * point.
+   *
+   * @param[in] points The points to query, one per row.
+   *
+   * @return The island of each point, in input order. -1 for points that
+   * couldn't be snapped to the navmesh.
+   */
+  Eigen::VectorXi getIslands(
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& points);
+
+  /**
+   * @brief Checks whether each point is navigable.
+   *
+   * Batched, multi-threaded equivalent of calling @ref isNavigable for each
+   * point.
+   *
+   * @param[in] points The points to query, one per row.
+   * @param[in] maxYDelta The maximum y-axis distance between each point and
+   * the navmesh.
+   *
+   * @return Whether each point is navigable, in input order.
+   */
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> isNavigableBatch(
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& points,
+      float maxYDelta = 0.5);
+
+  /**
+   * @brief Samples random navigable points, uniformly distributed over the
+   * navigable area.
+   *
+   * Points are sampled on the worker threads from the per-island alias tables
+   * (see @ref getRandomNavigablePoint). Given the same @ref seed, the result
+   * doesn't depend on the number of threads. Unlike
+   * @ref getRandomNavigablePoint, sampling the full navmesh weights every
+   * polygon by its area, including on tiled navmeshes.
+   *
+   * @param[in] numPoints The number of points to sample.
+   * @param[in] islandIndex Optionally specify the island from which to sample
+   * the points. Default -1 samples the full navmesh.
+   *
+   * @return The sampled points, one per row.
+   */
+  Eigen::RowMatrixX3f sampleNavigablePoints(int numPoints,
+                                            int islandIndex = ID_UNDEFINED);
+
+  /**
+   * @brief Precomputes geodesic distances from a set of goal points to the
+   * whole navigation mesh.
+   *
+   * Use this instead of repeated @ref findPath calls when many queries share
+   * the same goal(s), e.g. for per-step geodesic distance rewards.
+   *
+   * @param[in] goals The goal points. Goals which can't be snapped to the
+   * navmesh are ignored.
+   * @param[in] portalSampleSpacing Maximum distance between the points sampled
+   * along each portal between adjacent polygons. Smaller values are more
+   * accurate but slower to compute.
+   *
+   * @return The distance field, or nullptr if the navmesh isn't loaded.
+   */
+  GeodesicDistanceField::ptr computeDistanceField(
+      const std::vector<vec3f>& goals,
+      float portalSampleSpacing = 0.25);
+
+  /**
+   * @brief Set the number of threads used by the batched query methods such as
+   * @ref findPaths and @ref geodesicDistances, and to build the tiles of a
+   * tiled NavMesh (see @ref NavMeshSettings::tileSize).
+   *
+   * Tiled builds produce the same NavMesh regardless of the thread count.
+   *
+   * @param[in] numThreads The number of threads, including the calling
+   * thread. Values <= 0 use the hardware concurrency.
+   */
+  void setNumThreads(int numThreads);
+
+  /**
+   * @brief Get the number of threads used by the batched query methods.
+   */
+  int getNumThreads();
+
+  /**
+   * @brief Create a context for querying the current navmesh from another
+   * thread, see @ref PathFinderQueryContext.
+   *
+   * Cheap, the navmesh and its islands are shared and not copied.
+   *
+   * @return The context, or nullptr if the navmesh isn't loaded.
+   */
+  PathFinderQueryContext::ptr createQueryContext();
+
+  /**
+   * @brief Changes whenever the navmesh, its islands, the obstacle distance
+   * field or the path hierarchy change.
+   *
+   * Query contexts created before a change still see the old state, see
+   * @ref PathFinderQueryContext. Lets their owners tell when to recreate
+   * them.
+   */
+  uint64_t getQueryStateVersion() const;
+
   /**
    * @brief Attempts to move from @ref start to @ref end and returns the
    * navigable point closest to @ref end that is feasibly reachable from @ref
@@ -463,6 +938,51 @@ class PathFinder {
   template <typename T>
   T tryStepNoSliding(const T& start, const T& end);
 
+  /**
+   * @brief Same as @ref tryStep and @ref tryStepNoSliding, but starting from a
+   * cached navmesh polygon.
+   *
+   * Finding the polygon nearest to @p start is skipped while @p polyRef still
+   * contains it, e.g. when an agent passes in the polygon it ended on in its
+   * previous step. Only that projection of @p start is skipped: the returned
+   * point is still projected to detect infinitely thin walls between
+   * islands, so the result is the same as without a cached polygon.
+   *
+   * @param[in] start The starting location
+   * @param[in] end The desired end location
+   * @param[in,out] polyRef Opaque reference to the navmesh polygon containing
+   * @p start, or 0 if unknown. Set to the polygon of the returned point, or to
+   * 0 if @p start isn't on the navmesh.
+   * @param[in] allowSliding Whether to slide along walls
+   *
+   * @return The found end location.
+   */
+  template <typename T>
+  T tryStep(const T& start,
+            const T& end,
+            uint64_t& polyRef,
+            bool allowSliding = true);
+
+  /**
+   * @brief Takes a step for each pair of start and end points.
+   *
+   * Batched, multi-threaded equivalent of calling
+   * @ref tryStep(const T&, const T&, uint64_t&, bool) for each row.
+   *
+   * @param[in] starts The starting locations, one per row.
+   * @param[in] ends The desired end locations, one per row.
+   * @param[in,out] polyRefs The cached polygon of each start, or 0 if
+   * unknown. Updated to the polygon of each returned point.
+   * @param[in] allowSliding Whether to slide along walls
+   *
+   * @return The found end locations, in input order.
+   */
+  Eigen::RowMatrixX3f tryStepBatch(
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& starts,
+      const Eigen::Ref<const Eigen::RowMatrixX3f>& ends,
+      Eigen::Ref<Eigen::Matrix<uint64_t, Eigen::Dynamic, 1>> polyRefs,
+      bool allowSliding = true);
+
   /**
    * @brief Snaps a point to the navigation mesh.
    *
@@ -497,14 +1017,21 @@ class PathFinder {
   /**
    * @brief Loads a navigation meshed saved by @ref saveNavMesh
    *
-   * Also imports serialized @ref NavMeshSettings if available.
+   * Also imports serialized @ref NavMeshSettings if available, and the
+   * navmesh islands if the file was saved with them, skipping their
+   * computation.
    *
    * @param[in] path The saved navigation mesh file, generally has extension
    * ``.navmesh``
+   * @param[in] memoryMap If true, map the file instead of reading it and use
+   * the tile data in place. The mapping is private and copy-on-write, so the
+   * pages Detour only reads (vertices, detail meshes, BV trees) are shared by
+   * all processes loading the same file. Falls back to reading the file on
+   * platforms without mmap.
    *
    * @return Whether or not the navmesh was successfully loaded
    */
-  bool loadNavMesh(const std::string& path);
+  bool loadNavMesh(const std::string& path, bool memoryMap = false);
 
   /**
    * @brief Saves a navigation mesh to later be loaded by @ref loadNavMesh
@@ -527,7 +1054,10 @@ class PathFinder {
    *
    * @param[in] newSeed The random seed
    *
-   * @note This just seeds the global c @ref rand function.
+   * @note This seeds the global c @ref rand function, and the random state
+   * used by island-restricted @ref getRandomNavigablePoint. That state is per
+   * thread, the calling thread continues the seeded sequence while other
+   * threads derive their own from the seed.
    */
   void seed(uint32_t newSeed);
 
@@ -567,6 +1097,10 @@ class PathFinder {
    * @param[in] pt The point to begin searching from
    * @param[in] pt The radius to search in
    *
+   * If an obstacle distance field was built with at least @ref
+   * maxSearchRadius (see @ref buildObstacleDistanceField), the distance is
+   * interpolated from it where possible.
+   *
    * @return The distance to the closest non-navigable location or @ref
    * maxSearchRadius if all locations within @ref maxSearchRadius are navigable
    */
@@ -576,10 +1110,89 @@ class PathFinder {
   /**
    * @brief Same as @ref distanceToClosestObstacle but returns additional
    * information.
+   *
+   * Always searches the navmesh, it doesn't use the obstacle distance field.
    */
   HitRecord closestObstacleSurfacePoint(const vec3f& pt,
                                         float maxSearchRadius = 2.0) const;
 
+  /**
+   * @brief Precompute obstacle distances on a grid so that @ref
+   * distanceToClosestObstacle becomes a bilinear lookup.
+   *
+   * Each island gets a 2.5D grid over its XZ bounds. Grid nodes store the
+   * exact obstacle distance of the navmesh point below them. Nodes over more
+   * than one level of the same island, or off the navmesh, aren't usable.
+   * Queries fall back to the exact search if any of the four surrounding
+   * nodes isn't usable or is at a different height. This includes points
+   * near walls and outside the grid. Elsewhere the interpolation error is at
+   * most about @p cellSize.
+   *
+   * The field is recomputed whenever the navmesh changes, until @ref
+   * clearObstacleDistanceField is called. Node distances are computed on the
+   * threads set with @ref setNumThreads.
+   *
+   * @param[in] cellSize The grid spacing in meters.
+   * @param[in] maxSearchRadius The search radius the node distances are
+   * computed with. Queries with a larger radius use the exact search.
+   *
+   * @return Whether the field was built, false if no navmesh is loaded.
+   */
+  bool buildObstacleDistanceField(float cellSize = 0.1,
+                                  float maxSearchRadius = 2.0);
+
+  /**
+   * @brief Remove the obstacle distance field, see @ref
+   * buildObstacleDistanceField.
+   */
+  void clearObstacleDistanceField();
+
+  /**
+   * @brief Whether an obstacle distance field is built, see @ref
+   * buildObstacleDistanceField.
+   */
+  bool hasObstacleDistanceField() const;
+
+  /**
+   * @brief Build a cluster-level abstraction of the navmesh that lets
+   * long-range path queries succeed where the Detour search gives up.
+   *
+   * The polygons of each island are grouped into connected clusters, with
+   * precomputed walking distances between the entrances of each cluster.
+   * Queries with @ref ShortestPath::usePathHierarchy set use it when the
+   * Detour search runs out of nodes or corridor polygons before reaching the
+   * end, which otherwise fails the query. A route planned over the clusters
+   * then bounds a polygon search over the whole navmesh, which isn't limited
+   * by the query's node pool. The result is as short as the path Detour finds
+   * with an unlimited node pool, string-pulled as before. Other queries are
+   * unchanged.
+   *
+   * The hierarchy doesn't speed queries up: it only runs after the Detour
+   * search failed, so a rescued query costs that failed search plus the
+   * cluster route and the bounded polygon search.
+   *
+   * The hierarchy is rebuilt whenever the navmesh changes, until @ref
+   * clearPathHierarchy is called. It is saved with the navmesh by @ref
+   * saveNavMesh, and @ref loadNavMesh uses a saved one instead of rebuilding
+   * it if this PathFinder already has a hierarchy with the same cluster size.
+   * Loading a navmesh never builds a hierarchy by itself.
+   *
+   * @param[in] clusterSize Maximum number of polygons per cluster.
+   *
+   * @return Whether the hierarchy was built, false if no navmesh is loaded.
+   */
+  bool buildPathHierarchy(int clusterSize = 64);
+
+  /**
+   * @brief Remove the path hierarchy, see @ref buildPathHierarchy.
+   */
+  void clearPathHierarchy();
+
+  /**
+   * @brief Whether a path hierarchy is built, see @ref buildPathHierarchy.
+   */
+  bool hasPathHierarchy() const;
+
   /**
    * @brief Query whether or not a given location is navigable
    *
@@ -625,6 +1238,11 @@ class PathFinder {
    * @param eps Sets allowable epsilon meter Y offsets from the configured
    * height value.
    *
+   * The navmesh polygons are rasterized in parallel row bands, see @ref
+   * setNumThreads. Cells close to polygon edges or overlapping polygons fall
+   * back to @ref isNavigable, so the result matches querying each cell
+   * individually. The most recent grid is cached until the navmesh changes.
+   *
    * @return The 2D grid marking cells as navigable or not.
    */
   Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
@@ -642,6 +1260,8 @@ class PathFinder {
    * @param eps Sets allowable epsilon meter Y offsets from the configured
    * height value.
    *
+   * Rasterized and cached the same way as @ref getTopDownView.
+   *
    * @return The 2D grid marking cell islands or -1 for not navigable.
    */
   Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic>
@@ -663,6 +1283,33 @@ class PathFinder {
   std::shared_ptr<assets::MeshData> getNavMeshData(
       int islandIndex = ID_UNDEFINED);
 
+  /**
+   * @brief Returns the indexed, deduplicated triangle mesh of the NavMesh.
+   *
+   * Unlike @ref getNavMeshData, vertices aren't duplicated per triangle and
+   * islands are index ranges into a single mesh. Generated on first query and
+   * cached until the NavMesh changes.
+   *
+   * @return The geometry, or nullptr if the PathFinder is not loaded.
+   */
+  std::shared_ptr<const NavMeshGeometry> getNavMeshGeometry();
+
+  /**
+   * @brief Writes the triangle mesh of the NavMesh to a file, for use in
+   * offline tools.
+   *
+   * The format is chosen by the extension of @p path: binary `.ply` or `.glb`.
+   * Only the vertices used by the exported triangles are written.
+   *
+   * @param[in] path The file to write.
+   * @param[in] islandIndex Optionally limit the export to a specific island.
+   * Default -1 exports all islands.
+   *
+   * @return Whether the file was written.
+   */
+  bool exportNavMeshGeometry(const std::string& path,
+                             int islandIndex = ID_UNDEFINED);
+
   /**
    * @brief Return the settings for the current NavMesh.
    */
@@ -5,6 +5,7 @@
 #include "PhysicsManager.h"
 #include <Magnum/Math/Range.h>
 
+#include <algorithm>
 #include <utility>
 #include "esp/assets/CollisionMeshData.h"
 #include "esp/assets/ResourceManager.h"
@@ -619,6 +620,199 @@ int PhysicsManager::checkActiveObjects() {
   return numActive;
 }
 
+namespace {
+// Number of floats describing one rigid object in the batched state arrays
+constexpr std::size_t PoseSize = 7;
+constexpr std::size_t VelocitySize = 6;
+}  // namespace
+
+void PhysicsManager::getRigidObjectPoses(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<float> poses) const {
+  ESP_CHECK(poses.size() == objectIds.size() * PoseSize,
+            "PhysicsManager::getRigidObjectPoses : Expected"
+                << objectIds.size() * PoseSize << "floats for"
+                << objectIds.size() << "objects but got" << poses.size());
+  float* out = poses.data();
+  for (const int objectId : objectIds) {
+    const auto objIter = existingObjects_.find(objectId);
+    ESP_CHECK(objIter != existingObjects_.end(),
+              "PhysicsManager::getRigidObjectPoses : No rigid object with ID"
+                  << objectId);
+    const Mn::Vector3 translation = objIter->second->getTranslation();
+    const Mn::Quaternion rotation = objIter->second->getRotation();
+    std::copy_n(translation.data(), 3, out);
+    std::copy_n(rotation.vector().data(), 3, out + 3);
+    out[6] = rotation.scalar();
+    out += PoseSize;
+  }
+}  // PhysicsManager::getRigidObjectPoses
+
+void PhysicsManager::setRigidObjectPoses(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<const float> poses) {
+  ESP_CHECK(poses.size() == objectIds.size() * PoseSize,
+            "PhysicsManager::setRigidObjectPoses : Expected"
+                << objectIds.size() * PoseSize << "floats for"
+                << objectIds.size() << "objects but got" << poses.size());
+  // validate the whole batch first so an unknown ID doesn't leave it half
+  // applied
+  std::vector<RigidObject*> objects;
+  objects.reserve(objectIds.size());
+  for (const int objectId : objectIds) {
+    const auto objIter = existingObjects_.find(objectId);
+    ESP_CHECK(objIter != existingObjects_.end(),
+              "PhysicsManager::setRigidObjectPoses : No rigid object with ID"
+                  << objectId);
+    objects.push_back(objIter->second.get());
+  }
+  const float* in = poses.data();
+  for (RigidObject* object : objects) {
+    object->setTranslation(Mn::Vector3::from(in));
+    object->setRotation(Mn::Quaternion{Mn::Vector3::from(in + 3), in[6]});
+    in += PoseSize;
+  }
+}  // PhysicsManager::setRigidObjectPoses
+
+void PhysicsManager::getRigidObjectVelocities(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<float> velocities) const {
+  ESP_CHECK(velocities.size() == objectIds.size() * VelocitySize,
+            "PhysicsManager::getRigidObjectVelocities : Expected"
+                << objectIds.size() * VelocitySize << "floats for"
+                << objectIds.size() << "objects but got"
+                << velocities.size());
+  float* out = velocities.data();
+  for (const int objectId : objectIds) {
+    const auto objIter = existingObjects_.find(objectId);
+    ESP_CHECK(objIter != existingObjects_.end(),
+              "PhysicsManager::getRigidObjectVelocities : No rigid object "
+              "with ID"
+                  << objectId);
+    const Mn::Vector3 linVel = objIter->second->getLinearVelocity();
+    const Mn::Vector3 angVel = objIter->second->getAngularVelocity();
+    std::copy_n(linVel.data(), 3, out);
+    std::copy_n(angVel.data(), 3, out + 3);
+    out += VelocitySize;
+  }
+}  // PhysicsManager::getRigidObjectVelocities
+
+void PhysicsManager::setRigidObjectVelocities(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<const float> velocities) {
+  ESP_CHECK(velocities.size() == objectIds.size() * VelocitySize,
+            "PhysicsManager::setRigidObjectVelocities : Expected"
+                << objectIds.size() * VelocitySize << "floats for"
+                << objectIds.size() << "objects but got"
+                << velocities.size());
+  std::vector<RigidObject*> objects;
+  objects.reserve(objectIds.size());
+  for (const int objectId : objectIds) {
+    const auto objIter = existingObjects_.find(objectId);
+    ESP_CHECK(objIter != existingObjects_.end(),
+              "PhysicsManager::setRigidObjectVelocities : No rigid object "
+              "with ID"
+                  << objectId);
+    objects.push_back(objIter->second.get());
+  }
+  const float* in = velocities.data();
+  for (RigidObject* object : objects) {
+    object->setLinearVelocity(Mn::Vector3::from(in));
+    object->setAngularVelocity(Mn::Vector3::from(in + 3));
+    in += VelocitySize;
+  }
+}  // PhysicsManager::setRigidObjectVelocities
+
+std::vector<float> PhysicsManager::getArticulatedObjectJointPositions(
+    const std::vector<int>& objectIds) const {
+  std::vector<float> positions;
+  for (const int objectId : objectIds) {
+    const auto aoIter = existingArticulatedObjects_.find(objectId);
+    ESP_CHECK(aoIter != existingArticulatedObjects_.end(),
+              "PhysicsManager::getArticulatedObjectJointPositions : No "
+              "articulated object with ID"
+                  << objectId);
+    const std::vector<float> aoPositions = aoIter->second->getJointPositions();
+    positions.insert(positions.end(), aoPositions.begin(), aoPositions.end());
+  }
+  return positions;
+}  // PhysicsManager::getArticulatedObjectJointPositions
+
+void PhysicsManager::setArticulatedObjectJointPositions(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<const float> positions) {
+  // validate the whole batch first so a size mismatch doesn't leave it half
+  // applied
+  std::vector<std::pair<ArticulatedObject*, std::size_t>> aos;
+  aos.reserve(objectIds.size());
+  std::size_t expectedSize = 0;
+  for (const int objectId : objectIds) {
+    const auto aoIter = existingArticulatedObjects_.find(objectId);
+    ESP_CHECK(aoIter != existingArticulatedObjects_.end(),
+              "PhysicsManager::setArticulatedObjectJointPositions : No "
+              "articulated object with ID"
+                  << objectId);
+    aos.emplace_back(aoIter->second.get(),
+                     aoIter->second->getJointPositions().size());
+    expectedSize += aos.back().second;
+  }
+  ESP_CHECK(positions.size() == expectedSize,
+            "PhysicsManager::setArticulatedObjectJointPositions : Expected"
+                << expectedSize << "joint positions but got"
+                << positions.size());
+  std::size_t offset = 0;
+  for (const auto& ao : aos) {
+    ao.first->setJointPositions(std::vector<float>(
+        positions.begin() + offset, positions.begin() + offset + ao.second));
+    offset += ao.second;
+  }
+}  // PhysicsManager::setArticulatedObjectJointPositions
+
+std::vector<float> PhysicsManager::getArticulatedObjectJointVelocities(
+    const std::vector<int>& objectIds) const {
+  std::vector<float> velocities;
+  for (const int objectId : objectIds) {
+    const auto aoIter = existingArticulatedObjects_.find(objectId);
+    ESP_CHECK(aoIter != existingArticulatedObjects_.end(),
+              "PhysicsManager::getArticulatedObjectJointVelocities : No "
+              "articulated object with ID"
+                  << objectId);
+    const std::vector<float> aoVelocities =
+        aoIter->second->getJointVelocities();
+    velocities.insert(velocities.end(), aoVelocities.begin(),
+                      aoVelocities.end());
+  }
+  return velocities;
+}  // PhysicsManager::getArticulatedObjectJointVelocities
+
+void PhysicsManager::setArticulatedObjectJointVelocities(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<const float> velocities) {
+  std::vector<std::pair<ArticulatedObject*, std::size_t>> aos;
+  aos.reserve(objectIds.size());
+  std::size_t expectedSize = 0;
+  for (const int objectId : objectIds) {
+    const auto aoIter = existingArticulatedObjects_.find(objectId);
+    ESP_CHECK(aoIter != existingArticulatedObjects_.end(),
+              "PhysicsManager::setArticulatedObjectJointVelocities : No "
+              "articulated object with ID"
+                  << objectId);
+    aos.emplace_back(aoIter->second.get(),
+                     aoIter->second->getJointVelocities().size());
+    expectedSize += aos.back().second;
+  }
+  ESP_CHECK(velocities.size() == expectedSize,
+            "PhysicsManager::setArticulatedObjectJointVelocities : Expected"
+                << expectedSize << "joint velocities but got"
+                << velocities.size());
+  std::size_t offset = 0;
+  for (const auto& ao : aos) {
+    ao.first->setJointVelocities(std::vector<float>(
+        velocities.begin() + offset, velocities.begin() + offset + ao.second));
+    offset += ao.second;
+  }
+}  // PhysicsManager::setArticulatedObjectJointVelocities
+
 void PhysicsManager::setObjectBBDraw(int physObjectID,
                                      DrawableGroup* drawables,
                                      bool drawBB) {
@@ -10,6 +10,7 @@
  * PhysicsManager::PhysicsSimulationLibrary
  */
 
+#include <Corrade/Containers/ArrayView.h>
 #include <map>
 #include <memory>
 #include <string>
@@ -432,6 +433,83 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
     return v;
   }
 
+  //============= Batched state functions =============
+
+  /**
+   * @brief Read the poses of several rigid objects into a contiguous array.
+   *
+   * @param objectIds The IDs of the rigid objects.
+   * @param poses Receives 7 floats per object, in the order of @p objectIds:
+   * the translation (x y z) followed by the rotation quaternion (x y z w).
+   * Must be exactly @cpp objectIds.size() * 7 @ce floats long.
+   */
+  void getRigidObjectPoses(const std::vector<int>& objectIds,
+                           Corrade::Containers::ArrayView<float> poses) const;
+
+  /**
+   * @brief Set the poses of several rigid objects from a contiguous array
+   * laid out as in @ref getRigidObjectPoses().
+   */
+  void setRigidObjectPoses(const std::vector<int>& objectIds,
+                           Corrade::Containers::ArrayView<const float> poses);
+
+  /**
+   * @brief Read the velocities of several rigid objects into a contiguous
+   * array.
+   *
+   * @param objectIds The IDs of the rigid objects.
+   * @param velocities Receives 6 floats per object, in the order of @p
+   * objectIds: the linear velocity (x y z) followed by the angular velocity
+   * (x y z). Must be exactly @cpp objectIds.size() * 6 @ce floats long.
+   */
+  void getRigidObjectVelocities(
+      const std::vector<int>& objectIds,
+      Corrade::Containers::ArrayView<float> velocities) const;
+
+  /**
+   * @brief Set the velocities of several rigid objects from a contiguous
+   * array laid out as in @ref getRigidObjectVelocities().
+   */
+  void setRigidObjectVelocities(
+      const std::vector<int>& objectIds,
+      Corrade::Containers::ArrayView<const float> velocities);
+
+  /**
+   * @brief Get the joint positions of several articulated objects,
+   * concatenated in the order of @p objectIds.
+   *
+   * Each object contributes as many values as its @ref
+   * ArticulatedObject::getJointPositions() returns.
+   */
+  std::vector<float> getArticulatedObjectJointPositions(
+      const std::vector<int>& objectIds) const;
+
+  /**
+   * @brief Set the joint positions of several articulated objects from
+   * values concatenated as in @ref getArticulatedObjectJointPositions().
+   */
+  void setArticulatedObjectJointPositions(
+      const std::vector<int>& objectIds,
+      Corrade::Containers::ArrayView<const float> positions);
+
+  /**
+   * @brief Get the joint velocities of several articulated objects,
+   * concatenated in the order of @p objectIds.
+   *
+   * Each object contributes as many values as its @ref
+   * ArticulatedObject::getJointVelocities() returns.
+   */
+  std::vector<float> getArticulatedObjectJointVelocities(
+      const std::vector<int>& objectIds) const;
+
+  /**
+   * @brief Set the joint velocities of several articulated objects from
+   * values concatenated as in @ref getArticulatedObjectJointVelocities().
+   */
+  void setArticulatedObjectJointVelocities(
+      const std::vector<int>& objectIds,
+      Corrade::Containers::ArrayView<const float> velocities);
+
   //============= ArticulatedObject functions =============
 
   /**
@@ -0,0 +1,42 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "PhysicsWorldPool.h"
+
+#include <unordered_set>
+
+#include "PhysicsManager.h"
+#include "esp/core/Check.h"
+
+namespace esp {
+namespace physics {
+
+PhysicsWorldPool::PhysicsWorldPool(int numThreads) : threadPool_{numThreads} {}
+
+std::vector<double> PhysicsWorldPool::stepWorlds(
+    const std::vector<PhysicsManager*>& worlds,
+    double dt) {
+  // stepping the same world from two threads at once would corrupt it
+  std::unordered_set<const PhysicsManager*> uniqueWorlds;
+  for (const PhysicsManager* world : worlds) {
+    ESP_CHECK(world != nullptr,
+              "PhysicsWorldPool::stepWorlds : Worlds must not be null.");
+    ESP_CHECK(uniqueWorlds.insert(world).second,
+              "PhysicsWorldPool::stepWorlds : Each world may be stepped only "
+              "once per call.");
+  }
+
+  std::vector<double> worldTimes(worlds.size());
+  threadPool_.parallelFor(worlds.size(), [&](size_t i, int) {
+    PhysicsManager& world = *worlds[i];
+    world.deferNodesUpdate();
+    world.stepPhysics(dt);
+    world.updateNodes();
+    worldTimes[i] = world.getWorldTime();
+  });
+  return worldTimes;
+}  // PhysicsWorldPool::stepWorlds
+
+}  // namespace physics
+}  // namespace esp
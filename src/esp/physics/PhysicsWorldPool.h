@@ -0,0 +1,77 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_PHYSICSWORLDPOOL_H_
+#define ESP_PHYSICS_PHYSICSWORLDPOOL_H_
+
+/** @file
+ * @brief Class @ref esp::physics::PhysicsWorldPool
+ */
+
+#include <vector>
+
+#include "esp/core/Esp.h"
+#include "esp/core/ThreadPool.h"
+
+namespace esp {
+namespace physics {
+
+class PhysicsManager;
+
+/**
+ * @brief Steps many independent physical worlds in parallel.
+ *
+ * Each world is stepped from start to end by a single thread, and worlds
+ * don't share any state which is modified during a step, so a world ends up
+ * in exactly the same state as if it had been stepped on its own, no matter
+ * how many threads the pool has or which of them picked it up. Worlds are
+ * handed out to the threads one by one as they become free, so worlds which
+ * take longer to step don't stall the rest.
+ *
+ * This allows packing many headless environments into a single process
+ * instead of running a process per environment.
+ */
+class PhysicsWorldPool {
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param numThreads Total number of threads stepping worlds, including the
+   * calling thread. Values <= 0 use one thread per hardware thread.
+   */
+  explicit PhysicsWorldPool(int numThreads = 0);
+
+  /**
+   * @brief Total number of threads stepping worlds, including the calling
+   * thread.
+   */
+  int getNumThreads() const { return threadPool_.numThreads(); }
+
+  /**
+   * @brief Step each of @p worlds forward by @p dt and block until all of
+   * them are done.
+   *
+   * Scene node updates are deferred during the step and applied at its end,
+   * as in @ref esp::sim::Simulator::stepWorld. Each world may appear only
+   * once.
+   *
+   * @param worlds The worlds to step.
+   * @param dt The desired amount of time to advance each world. See @ref
+   * PhysicsManager::stepPhysics.
+   * @return The world time of each of @p worlds after the step.
+   */
+  std::vector<double> stepWorlds(const std::vector<PhysicsManager*>& worlds,
+                                 double dt = 1.0 / 60.0);
+
+ private:
+  core::ThreadPool threadPool_;
+
+ public:
+  ESP_SMART_POINTERS(PhysicsWorldPool)
+};
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_PHYSICSWORLDPOOL_H_
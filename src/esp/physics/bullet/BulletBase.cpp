@@ -18,17 +18,15 @@ void BulletBase::constructConvexShapesFromMeshes(
     const std::vector<assets::CollisionMeshData>& meshGroup,
     const assets::MeshTransformNode& node,
     btCompoundShape* bObjectShape,
-    std::vector<std::unique_ptr<btConvexHullShape>>& bObjectConvexShapes) {
+    std::vector<std::unique_ptr<btConvexHullShape>>& bObjectConvexShapes,
+    const std::vector<CollisionMeshHulls>* meshHulls) {
   Magnum::Matrix4 transformFromLocalToWorld =
       transformFromParentToWorld * node.transformFromLocalToParent;
-  if (node.meshIDLocal != ID_UNDEFINED) {
-    // This node has a mesh, so add it to the compound
-    const assets::CollisionMeshData& mesh = meshGroup[node.meshIDLocal];
-
+  // transform points into world space, including any scale/shear in
+  // transformFromLocalToWorld, and add the hull to the compound
+  const auto addHull = [&](const auto& points) {
     bObjectConvexShapes.emplace_back(std::make_unique<btConvexHullShape>());
-    // transform points into world space, including any scale/shear in
-    // transformFromLocalToWorld.
-    for (auto& v : mesh.positions) {
+    for (auto& v : points) {
       bObjectConvexShapes.back()->addPoint(
           btVector3(transformFromLocalToWorld.transformPoint(v)), false);
     }
@@ -39,11 +37,22 @@ void BulletBase::constructConvexShapesFromMeshes(
       bObjectShape->addChildShape(btTransform::getIdentity(),
                                   bObjectConvexShapes.back().get());
     }
+  };
+  if (node.meshIDLocal != ID_UNDEFINED) {
+    // This node has a mesh, so add it to the compound
+    if (meshHulls != nullptr) {
+      for (const auto& hull : (*meshHulls)[node.meshIDLocal]) {
+        addHull(hull);
+      }
+    } else {
+      addHull(meshGroup[node.meshIDLocal].positions);
+    }
   }
 
   for (const auto& child : node.children) {
     constructConvexShapesFromMeshes(transformFromLocalToWorld, meshGroup, child,
-                                    bObjectShape, bObjectConvexShapes);
+                                    bObjectShape, bObjectConvexShapes,
+                                    meshHulls);
   }
 }  // constructConvexShapesFromMeshes
 
@@ -8,9 +8,13 @@
 #include <Magnum/BulletIntegration/MotionState.h>
 #include <btBulletDynamicsCommon.h>
 
+#include <map>
+#include <string>
+#include <tuple>
 #include <utility>
 
 #include "BulletDynamics/Featherstone/btMultiBodyDynamicsWorld.h"
+#include "BulletCollisionHulls.h"
 #include "BulletDynamics/Featherstone/btMultiBodyLinkCollider.h"
 #include "esp/assets/Asset.h"
 #include "esp/assets/BaseMesh.h"
@@ -60,6 +64,65 @@ struct SimulationContactResultCallback
   }
 };
 
+/**
+ * @brief Convex hulls built from a collision asset. Shared by all rigid
+ * objects created from the same asset at the same scale and never modified
+ * once built, see @ref BulletCollisionShapeCache.
+ */
+struct BulletConvexShapeSet {
+  //! The hulls, scaled and with zero margin.
+  std::vector<std::unique_ptr<btConvexHullShape>> convexShapes;
+
+  ESP_SMART_POINTERS(BulletConvexShapeSet)
+};
+
+/**
+ * @brief Cache of @ref BulletConvexShapeSet, so that spawning many copies of
+ * an object builds its convex hulls only once.
+ *
+ * Keyed by collision asset handle, whether the meshes are joined into a single
+ * hull, the @ref CollisionHullSettings they were processed with and the local
+ * scaling of the hulls. Entries are kept until @ref clear
+ * even if no object uses them anymore, so that objects re-added after a reset
+ * don't rebuild them. Objects keep their entries alive on their own.
+ */
+class BulletCollisionShapeCache {
+ public:
+  //! Collision asset handle, joined meshes, max hull vertices, convex
+  //! decomposition, hull scaling.
+  typedef std::tuple<std::string, bool, int, bool, float, float, float> Key;
+
+  /**
+   * @brief Get the hulls cached for @p key.
+   * @return The hulls, or nullptr if they haven't been built yet.
+   */
+  BulletConvexShapeSet::ptr get(const Key& key) const {
+    auto found = shapes_.find(key);
+    return found == shapes_.end() ? nullptr : found->second;
+  }
+
+  /**
+   * @brief Cache the hulls built for @p key.
+   * @return The cached hulls.
+   */
+  BulletConvexShapeSet::ptr add(const Key& key,
+                                BulletConvexShapeSet::ptr shapes) {
+    return shapes_[key] = std::move(shapes);
+  }
+
+  //! Number of cached hull sets.
+  int size() const { return static_cast<int>(shapes_.size()); }
+
+  //! Drop all cached hulls. Objects using them keep their own reference.
+  void clear() { shapes_.clear(); }
+
+ private:
+  std::map<Key, BulletConvexShapeSet::ptr> shapes_;
+
+ public:
+  ESP_SMART_POINTERS(BulletCollisionShapeCache)
+};
+
 /**
  * @brief This class is intended to implement bullet-specific
  */
@@ -125,13 +188,17 @@ class BulletBase {
    * @param node The current @ref MeshTransformNode in the recursion.
    * @param bObjectShape The compound shape parent for all generated convexes
    * @param bObjectConvexShapes Datastructure to cache generated convex shapes
+   * @param meshHulls Processed hulls of each mesh in @p meshGroup, see @ref
+   * computeCollisionHulls(). If nullptr, each mesh becomes a single hull of
+   * all its vertices.
    */
   static void constructConvexShapesFromMeshes(
       const Magnum::Matrix4& transformFromParentToWorld,
       const std::vector<assets::CollisionMeshData>& meshGroup,
       const assets::MeshTransformNode& node,
       btCompoundShape* bObjectShape,
-      std::vector<std::unique_ptr<btConvexHullShape>>& bObjectConvexShapes);
+      std::vector<std::unique_ptr<btConvexHullShape>>& bObjectConvexShapes,
+      const std::vector<CollisionMeshHulls>* meshHulls = nullptr);
 
  protected:
   /** @brief A pointer to the Bullet world to which this object belongs. See
@@ -0,0 +1,374 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "BulletCollisionHulls.h"
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
+#include <LinearMath/btConvexHull.h>
+#include <LinearMath/btConvexHullComputer.h>
+#include <Magnum/BulletIntegration/Integration.h>
+#include <Magnum/Math/FunctionsBatch.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Mesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "esp/core/Logging.h"
+#include "esp/core/MappedFile.h"
+
+namespace Mn = Magnum;
+namespace Cr = Corrade;
+
+namespace esp {
+namespace physics {
+
+namespace {
+
+//! Bumped whenever the layout of hull cache files changes.
+constexpr std::uint32_t HullCacheVersion = 1;
+
+/**
+ * @brief Header of a hull cache file.
+ *
+ * Followed by, for each mesh, the number of its hulls and for each hull the
+ * number of its vertices and the vertices.
+ */
+struct HullCacheHeader {
+  char magic[8]{'E', 'S', 'P', 'H', 'U', 'L', 'L', '\0'};
+  std::uint32_t version = HullCacheVersion;
+  std::int32_t maxHullVertices = 0;
+  std::int32_t decompose = 0;
+  std::int32_t maxDecompositionDepth = 0;
+  float concavityThreshold = 0.0f;
+  std::uint32_t numMeshes = 0;
+  std::uint64_t meshesHash = 0;
+};
+static_assert(sizeof(HullCacheHeader) == 40, "unexpected hull header size");
+
+HullCacheHeader hullCacheKey(
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const CollisionHullSettings& settings) {
+  HullCacheHeader header;
+  header.maxHullVertices = settings.maxHullVertices;
+  header.decompose = settings.decompose;
+  header.maxDecompositionDepth = settings.maxDecompositionDepth;
+  header.concavityThreshold = settings.concavityThreshold;
+  header.numMeshes = meshGroup.size();
+  std::vector<std::uint64_t> hashes;
+  hashes.reserve(2 * meshGroup.size());
+  for (const assets::CollisionMeshData& mesh : meshGroup) {
+    hashes.push_back(core::hashBytes(
+        mesh.positions.data(), mesh.positions.size() * sizeof(Mn::Vector3)));
+    hashes.push_back(core::hashBytes(
+        mesh.indices.data(), mesh.indices.size() * sizeof(Mn::UnsignedInt)));
+  }
+  header.meshesHash =
+      core::hashBytes(hashes.data(), hashes.size() * sizeof(std::uint64_t));
+  return header;
+}
+
+//! Exact hull of a point set, and its volume.
+struct Hull {
+  std::vector<Mn::Vector3> vertices;
+  double volume = 0.0;
+};
+
+Hull computeExactHull(const std::vector<Mn::Vector3>& points) {
+  Hull hull;
+  btConvexHullComputer computer;
+  computer.compute(points.front().data(), sizeof(Mn::Vector3),
+                   static_cast<int>(points.size()), 0.0, 0.0);
+  hull.vertices.reserve(computer.vertices.size());
+  for (int i = 0; i < computer.vertices.size(); ++i) {
+    hull.vertices.emplace_back(computer.vertices[i]);
+  }
+  // Sum of the tetrahedra between the origin and a fan of each face
+  for (int i = 0; i < computer.faces.size(); ++i) {
+    const btConvexHullComputer::Edge* first =
+        &computer.edges[computer.faces[i]];
+    const btVector3& a = computer.vertices[first->getSourceVertex()];
+    const btConvexHullComputer::Edge* edge = first->getNextEdgeOfFace();
+    for (const btConvexHullComputer::Edge* next = edge->getNextEdgeOfFace();
+         next != first; edge = next, next = next->getNextEdgeOfFace()) {
+      hull.volume += a.dot(computer.vertices[edge->getSourceVertex()].cross(
+                         computer.vertices[next->getSourceVertex()])) /
+                     6.0;
+    }
+  }
+  hull.volume = std::abs(hull.volume);
+  return hull;
+}
+
+//! Vertices of the triangles @p triangles of @p mesh.
+std::vector<Mn::Vector3> trianglePoints(
+    const assets::CollisionMeshData& mesh,
+    const std::vector<std::uint32_t>& triangles) {
+  std::vector<Mn::Vector3> points;
+  points.reserve(3 * triangles.size());
+  for (const std::uint32_t triangle : triangles) {
+    for (int i = 0; i < 3; ++i) {
+      points.push_back(mesh.positions[mesh.indices[3 * triangle + i]]);
+    }
+  }
+  return points;
+}
+
+//! Part of a mesh in a decomposition.
+struct Part {
+  std::vector<std::uint32_t> triangles;
+  Hull hull;
+};
+
+/**
+ * @brief Split @p part at the middle of the longest axis of its triangle
+ * centroids.
+ * @return false if all triangles ended up on the same side.
+ */
+bool splitPart(const assets::CollisionMeshData& mesh,
+               const Part& part,
+               Part (&halves)[2]) {
+  if (part.triangles.size() < 2) {
+    return false;
+  }
+  std::vector<Mn::Vector3> centroids;
+  centroids.reserve(part.triangles.size());
+  for (const std::uint32_t triangle : part.triangles) {
+    centroids.push_back((mesh.positions[mesh.indices[3 * triangle]] +
+                         mesh.positions[mesh.indices[3 * triangle + 1]] +
+                         mesh.positions[mesh.indices[3 * triangle + 2]]) /
+                        3.0f);
+  }
+  const Mn::Range3D bounds = Mn::Math::minmax(centroids);
+  const Mn::Vector3 size = bounds.size();
+  const int axis = size.x() >= size.y() && size.x() >= size.z()
+                       ? 0
+                       : (size.y() >= size.z() ? 1 : 2);
+  const float split = bounds.center()[axis];
+
+  for (Part& half : halves) {
+    half.triangles.clear();
+  }
+  for (std::size_t i = 0; i < part.triangles.size(); ++i) {
+    halves[centroids[i][axis] > split].triangles.push_back(part.triangles[i]);
+  }
+  if (halves[0].triangles.empty() || halves[1].triangles.empty()) {
+    return false;
+  }
+  for (Part& half : halves) {
+    half.hull = computeExactHull(trianglePoints(mesh, half.triangles));
+  }
+  return true;
+}
+
+void decompose(const assets::CollisionMeshData& mesh,
+               const Part& part,
+               const int depth,
+               const CollisionHullSettings& settings,
+               CollisionMeshHulls& hulls) {
+  Part halves[2];
+  if (depth < settings.maxDecompositionDepth && part.hull.volume > 0.0 &&
+      splitPart(mesh, part, halves)) {
+    const double maxVolume =
+        (1.0 - settings.concavityThreshold) * part.hull.volume;
+    double splitVolume = halves[0].hull.volume + halves[1].hull.volume;
+    if (splitVolume >= maxVolume &&
+        depth + 1 < settings.maxDecompositionDepth) {
+      // The halves of ring-like parts can have hulls as large as the whole,
+      // so look at the quarters as well before giving up
+      splitVolume = 0.0;
+      for (const Part& half : halves) {
+        Part quarters[2];
+        splitVolume += splitPart(mesh, half, quarters)
+                           ? quarters[0].hull.volume + quarters[1].hull.volume
+                           : half.hull.volume;
+      }
+    }
+    if (splitVolume < maxVolume) {
+      for (const Part& half : halves) {
+        decompose(mesh, half, depth + 1, settings, hulls);
+      }
+      return;
+    }
+  }
+
+  hulls.push_back(
+      computeConvexHull(part.hull.vertices, settings.maxHullVertices));
+}
+
+}  // namespace
+
+std::vector<Mn::Vector3> computeConvexHull(
+    const std::vector<Mn::Vector3>& points,
+    const int maxVertices) {
+  if (points.size() < 4) {
+    return points;
+  }
+  // The exact hull first, the simplification is quadratic in the number of
+  // points it gets
+  std::vector<Mn::Vector3> hull = computeExactHull(points).vertices;
+  if (hull.size() < 4) {
+    return points;
+  }
+  if (maxVertices <= 0 || hull.size() <= std::size_t(maxVertices)) {
+    return hull;
+  }
+
+  std::vector<btVector3> btHull(hull.begin(), hull.end());
+  HullDesc desc{QF_TRIANGLES, static_cast<unsigned int>(btHull.size()),
+                btHull.data()};
+  desc.mMaxVertices = std::max(maxVertices, 4);
+  HullLibrary library;
+  HullResult result;
+  if (library.CreateConvexHull(desc, result) != QE_OK) {
+    return hull;
+  }
+  std::vector<Mn::Vector3> simplified;
+  simplified.reserve(result.mNumOutputVertices);
+  for (unsigned int i = 0; i < result.mNumOutputVertices; ++i) {
+    simplified.emplace_back(result.m_OutputVertices[i]);
+  }
+  library.ReleaseResult(result);
+  return simplified;
+}
+
+std::vector<CollisionMeshHulls> computeCollisionHulls(
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const CollisionHullSettings& settings) {
+  std::vector<CollisionMeshHulls> hulls(meshGroup.size());
+  for (std::size_t i = 0; i < meshGroup.size(); ++i) {
+    const assets::CollisionMeshData& mesh = meshGroup[i];
+    const std::vector<Mn::Vector3> points(mesh.positions.begin(),
+                                          mesh.positions.end());
+    if (!settings.decompose ||
+        mesh.primitive != Mn::MeshPrimitive::Triangles ||
+        mesh.indices.size() < 6 || points.size() < 4) {
+      hulls[i].push_back(computeConvexHull(points, settings.maxHullVertices));
+      continue;
+    }
+    Part whole;
+    whole.triangles.resize(mesh.indices.size() / 3);
+    for (std::size_t j = 0; j < whole.triangles.size(); ++j) {
+      whole.triangles[j] = j;
+    }
+    whole.hull = computeExactHull(points);
+    decompose(mesh, whole, 0, settings, hulls[i]);
+  }
+  return hulls;
+}
+
+std::string collisionHullCacheFile(const std::string& assetFile,
+                                   const CollisionHullSettings& settings) {
+  return Cr::Utility::formatString("{}.{}{}.hulls", assetFile,
+                                   std::max(settings.maxHullVertices, 0),
+                                   settings.decompose ? ".acd" : "");
+}
+
+bool loadCollisionHulls(const std::string& cacheFile,
+                        const std::vector<assets::CollisionMeshData>& meshGroup,
+                        const CollisionHullSettings& settings,
+                        std::vector<CollisionMeshHulls>& hulls) {
+  if (!Cr::Utility::Path::exists(cacheFile)) {
+    return false;
+  }
+  const Cr::Containers::Optional<Cr::Containers::Array<char>> data =
+      Cr::Utility::Path::read(cacheFile);
+  if (!data) {
+    return false;
+  }
+  std::size_t offset = 0;
+  const auto read = [&](void* out, std::size_t size) {
+    if (data->size() - offset < size) {
+      return false;
+    }
+    std::memcpy(out, data->data() + offset, size);
+    offset += size;
+    return true;
+  };
+
+  const HullCacheHeader key = hullCacheKey(meshGroup, settings);
+  HullCacheHeader header;
+  if (!read(&header, sizeof(header)) ||
+      std::memcmp(&header, &key, sizeof(header)) != 0) {
+    return false;
+  }
+  std::vector<CollisionMeshHulls> loaded(meshGroup.size());
+  for (CollisionMeshHulls& meshHulls : loaded) {
+    std::uint32_t numHulls = 0;
+    if (!read(&numHulls, sizeof(numHulls))) {
+      return false;
+    }
+    for (std::uint32_t i = 0; i < numHulls; ++i) {
+      std::uint32_t numVertices = 0;
+      if (!read(&numVertices, sizeof(numVertices)) ||
+          data->size() - offset < numVertices * sizeof(Mn::Vector3)) {
+        return false;
+      }
+      meshHulls.emplace_back(numVertices);
+      read(meshHulls.back().data(), numVertices * sizeof(Mn::Vector3));
+    }
+  }
+  if (offset != data->size()) {
+    return false;
+  }
+  hulls = std::move(loaded);
+  return true;
+}
+
+bool saveCollisionHulls(const std::string& cacheFile,
+                        const std::vector<assets::CollisionMeshData>& meshGroup,
+                        const CollisionHullSettings& settings,
+                        const std::vector<CollisionMeshHulls>& hulls) {
+  CORRADE_INTERNAL_ASSERT(hulls.size() == meshGroup.size());
+  const HullCacheHeader header = hullCacheKey(meshGroup, settings);
+  std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+  const auto write = [&data](const void* in, std::size_t size) {
+    data.append(static_cast<const char*>(in), size);
+  };
+  for (const CollisionMeshHulls& meshHulls : hulls) {
+    const std::uint32_t numHulls = meshHulls.size();
+    write(&numHulls, sizeof(numHulls));
+    for (const std::vector<Mn::Vector3>& hull : meshHulls) {
+      const std::uint32_t numVertices = hull.size();
+      write(&numVertices, sizeof(numVertices));
+      write(hull.data(), hull.size() * sizeof(Mn::Vector3));
+    }
+  }
+
+  // Processes loading the same asset concurrently must never read a partially
+  // written file
+  return core::writeFileAtomically(
+      cacheFile, Cr::Containers::arrayView(data.data(), data.size()));
+}
+
+std::vector<CollisionMeshHulls> loadOrComputeCollisionHulls(
+    const std::string& assetFile,
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const CollisionHullSettings& settings) {
+  const std::string cacheFile = collisionHullCacheFile(assetFile, settings);
+  std::vector<CollisionMeshHulls> hulls;
+  if (loadCollisionHulls(cacheFile, meshGroup, settings, hulls)) {
+    ESP_DEBUG() << "Loaded collision hulls from" << cacheFile;
+    return hulls;
+  }
+  hulls = computeCollisionHulls(meshGroup, settings);
+  // Datasets may well be read-only, the hulls just aren't cached then
+  if (saveCollisionHulls(cacheFile, meshGroup, settings, hulls)) {
+    ESP_DEBUG() << "Wrote collision hulls to" << cacheFile;
+  } else {
+    ESP_DEBUG() << "Unable to cache collision hulls in" << cacheFile;
+  }
+  return hulls;
+}
+
+}  // namespace physics
+}  // namespace esp
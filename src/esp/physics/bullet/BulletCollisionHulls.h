@@ -0,0 +1,137 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_BULLET_BULLETCOLLISIONHULLS_H_
+#define ESP_PHYSICS_BULLET_BULLETCOLLISIONHULLS_H_
+
+/** @file
+ * @brief Struct @ref esp::physics::CollisionHullSettings, functions @ref
+ * esp::physics::computeCollisionHulls(), @ref
+ * esp::physics::loadOrComputeCollisionHulls()
+ */
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Vector3.h>
+#include <string>
+#include <vector>
+
+#include "esp/assets/CollisionMeshData.h"
+
+namespace esp {
+namespace physics {
+
+/**
+ * @brief How the convex collision hulls of an object's meshes are built.
+ *
+ * The defaults keep every vertex of every mesh in its hull, which is how
+ * hulls were always built.
+ */
+struct CollisionHullSettings {
+  /**
+   * @brief Max number of vertices of each hull.
+   *
+   * Larger hulls are simplified to this many of their most extreme vertices.
+   * 0 doesn't limit the vertex count.
+   */
+  int maxHullVertices = 0;
+
+  /**
+   * @brief Approximate each mesh by several convex parts instead of a single
+   * hull.
+   */
+  bool decompose = false;
+
+  /**
+   * @brief How many times a part may be split in half during decomposition.
+   * A mesh gets at most 2^depth parts.
+   */
+  int maxDecompositionDepth = 4;
+
+  /**
+   * @brief Minimal relative volume a split has to remove from a part's hull
+   * for the part to be split.
+   */
+  float concavityThreshold = 0.05f;
+
+  /**
+   * @brief Whether these settings keep all mesh vertices, without any
+   * processing.
+   */
+  bool isPassthrough() const { return maxHullVertices <= 0 && !decompose; }
+};
+
+/**
+ * @brief Convex parts approximating a single collision mesh, each given by
+ * its hull vertices in the local space of the mesh.
+ */
+typedef std::vector<std::vector<Magnum::Vector3>> CollisionMeshHulls;
+
+/**
+ * @brief Compute the convex hull of @p points, simplified to at most @p
+ * maxVertices vertices if that's > 0.
+ *
+ * Returns @p points unchanged if the hull can't be computed.
+ */
+std::vector<Magnum::Vector3> computeConvexHull(
+    const std::vector<Magnum::Vector3>& points,
+    int maxVertices);
+
+/**
+ * @brief Compute the hulls of every mesh in @p meshGroup.
+ *
+ * With @ref CollisionHullSettings::decompose, meshes are split recursively
+ * at the middle of their longest axis for as long as that makes the hulls of
+ * the halves noticeably smaller than the hull of the whole, which is an
+ * approximate convex decomposition that's cheap enough to run at load.
+ */
+std::vector<CollisionMeshHulls> computeCollisionHulls(
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const CollisionHullSettings& settings);
+
+/**
+ * @brief The file caching the hulls of @p assetFile built with @p settings.
+ *
+ * The file is next to the asset and named after the settings, so objects
+ * using the same asset with different settings don't overwrite each other's
+ * hulls.
+ */
+std::string collisionHullCacheFile(const std::string& assetFile,
+                                   const CollisionHullSettings& settings);
+
+/**
+ * @brief Load the hulls of @p meshGroup from @p cacheFile.
+ * @return false if the file is missing or was written for different meshes
+ * or settings.
+ */
+bool loadCollisionHulls(const std::string& cacheFile,
+                        const std::vector<assets::CollisionMeshData>& meshGroup,
+                        const CollisionHullSettings& settings,
+                        std::vector<CollisionMeshHulls>& hulls);
+
+/**
+ * @brief Save the hulls of @p meshGroup built with @p settings to @p
+ * cacheFile.
+ * @return Whether the file was written.
+ */
+bool saveCollisionHulls(const std::string& cacheFile,
+                        const std::vector<assets::CollisionMeshData>& meshGroup,
+                        const CollisionHullSettings& settings,
+                        const std::vector<CollisionMeshHulls>& hulls);
+
+/**
+ * @brief Load the hulls of the collision meshes of @p assetFile from the
+ * cache next to it, or compute them and try to cache them there.
+ *
+ * Datasets in read-only locations can be processed offline with the
+ * `create_collision_hulls` task of Datatool.
+ */
+std::vector<CollisionMeshHulls> loadOrComputeCollisionHulls(
+    const std::string& assetFile,
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const CollisionHullSettings& settings);
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_BULLET_BULLETCOLLISIONHULLS_H_
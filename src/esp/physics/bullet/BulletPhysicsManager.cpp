@@ -12,6 +12,7 @@
 #include "BulletDynamics/Featherstone/btMultiBodyLinkCollider.h"
 #include "BulletRigidObject.h"
 #include "BulletURDFImporter.h"
+#include "LinearMath/btQuickprof.h"
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
 #include "esp/assets/ResourceManager.h"
 #include "esp/metadata/attributes/PhysicsManagerAttributes.h"
@@ -23,13 +24,29 @@
 namespace esp {
 namespace physics {
 
+namespace {
+void enterProfileZoneNoop(const char*) {}
+void leaveProfileZoneNoop() {}
+}  // namespace
+
 BulletPhysicsManager::BulletPhysicsManager(
     assets::ResourceManager& _resourceManager,
     const metadata::attributes::PhysicsManagerAttributes::cptr&
         _physicsManagerAttributes)
     : PhysicsManager(_resourceManager, _physicsManagerAttributes) {
+  // Bullet's built-in profiler is never read, and its per-thread bookkeeping
+  // isn't safe to set up from several threads at once, which happens when
+  // worlds are first stepped by a PhysicsWorldPool. So it's turned off.
+  static const bool profilerDisabled = []() {
+    btSetCustomEnterProfileZoneFunc(enterProfileZoneNoop);
+    btSetCustomLeaveProfileZoneFunc(leaveProfileZoneNoop);
+    return true;
+  }();
+  static_cast<void>(profilerDisabled);
+
   collisionObjToObjIds_ =
       std::make_shared<std::map<const btCollisionObject*, int>>();
+  collisionShapeCache_ = BulletCollisionShapeCache::create();
   urdfImporter_ = std::make_unique<BulletURDFImporter>(_resourceManager);
   if (_resourceManager.getCreateRenderer()) {
     debugDrawer_ = std::make_unique<Magnum::BulletIntegration::DebugDraw>();
@@ -79,7 +96,7 @@ bool BulletPhysicsManager::initPhysicsFinalize() {
   //! Create new scene node
   staticStageObject_ = physics::BulletRigidStage::create(
       &physicsNode_->createChild(), resourceManager_, bWorld_,
-      collisionObjToObjIds_);
+      collisionObjToObjIds_, physicsManagerAttributes_->getBvhCacheDirectory());
 
   recentNumSubStepsTaken_ = -1;
   return true;
@@ -99,9 +116,9 @@ bool BulletPhysicsManager::makeAndAddRigidObject(
     int newObjectID,
     const esp::metadata::attributes::ObjectAttributes::ptr& objectAttributes,
     scene::SceneNode* objectNode) {
-  auto ptr = physics::BulletRigidObject::create(objectNode, newObjectID,
-                                                resourceManager_, bWorld_,
-                                                collisionObjToObjIds_);
+  auto ptr = physics::BulletRigidObject::create(
+      objectNode, newObjectID, resourceManager_, bWorld_, collisionObjToObjIds_,
+      collisionShapeCache_);
   bool objSuccess = ptr->initialize(objectAttributes);
   if (objSuccess) {
     existingObjects_.emplace(newObjectID, std::move(ptr));
@@ -501,6 +518,11 @@ Magnum::Range3D BulletPhysicsManager::getStageCollisionShapeAabb() const {
       ->getCollisionShapeAabb();
 }
 
+int BulletPhysicsManager::getNumStageBvhsLoadedFromCache() const {
+  return static_cast<BulletRigidStage*>(staticStageObject_.get())
+      ->getNumBvhsLoadedFromCache();
+}
+
 void BulletPhysicsManager::debugDraw(const Magnum::Matrix4& projTrans) const {
   if (debugDrawer_) {
     debugDrawer_->setTransformationProjectionMatrix(projTrans);
@@ -168,6 +168,28 @@ class BulletPhysicsManager : public PhysicsManager {
    */
   void removeArticulatedObject(int objectId) override;
 
+  /**
+   * @brief Get the number of convex hull sets cached for sharing between
+   * rigid objects built from the same collision asset at the same scale. See
+   * @ref BulletCollisionShapeCache.
+   */
+  int getCollisionShapeCacheSize() const {
+    return collisionShapeCache_->size();
+  }
+
+  /**
+   * @brief Drop the cached convex hulls, e.g. after collision assets were
+   * reloaded. Existing objects keep the hulls they use.
+   */
+  void clearCollisionShapeCache() { collisionShapeCache_->clear(); }
+
+  /**
+   * @brief Get the number of stage collision mesh BVHs that were loaded from
+   * @ref metadata::attributes::PhysicsManagerAttributes::getBvhCacheDirectory
+   * instead of being built.
+   */
+  int getNumStageBvhsLoadedFromCache() const;
+
   /** @brief Step the physical world forward in time. Time may only advance in
    * increments of @ref fixedTimeStep_. See @ref
    * btMultiBodyDynamicsWorld::stepSimulation.
@@ -432,6 +454,10 @@ class BulletPhysicsManager : public PhysicsManager {
   std::shared_ptr<std::map<const btCollisionObject*, int>>
       collisionObjToObjIds_;
 
+  //! convex hulls shared between rigid objects built from the same collision
+  //! asset at the same scale.
+  std::shared_ptr<BulletCollisionShapeCache> collisionShapeCache_;
+
   //! necessary to acquire forces from impulses
   double recentTimeStep_ = fixedTimeStep_;
   //! for recent call to stepPhysics
@@ -35,16 +35,39 @@
 namespace esp {
 namespace physics {
 
+namespace {
+
+//! A copy of @p shape simplified to at most @p maxVertices hull vertices.
+std::unique_ptr<btConvexHullShape> simplifiedConvexShape(
+    const btConvexHullShape& shape,
+    const int maxVertices) {
+  std::vector<Mn::Vector3> points;
+  points.reserve(shape.getNumPoints());
+  for (int i = 0; i < shape.getNumPoints(); ++i) {
+    points.emplace_back(shape.getUnscaledPoints()[i]);
+  }
+  auto simplified = std::make_unique<btConvexHullShape>();
+  for (const Mn::Vector3& point : computeConvexHull(points, maxVertices)) {
+    simplified->addPoint(btVector3(point), false);
+  }
+  simplified->recalcLocalAabb();
+  return simplified;
+}
+
+}  // namespace
+
 BulletRigidObject::BulletRigidObject(
     scene::SceneNode* rigidBodyNode,
     int objectId,
     const assets::ResourceManager& resMgr,
     std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
     std::shared_ptr<std::map<const btCollisionObject*, int> >
-        collisionObjToObjIds)
+        collisionObjToObjIds,
+    std::shared_ptr<BulletCollisionShapeCache> collisionShapeCache)
     : BulletBase(std::move(bWorld), std::move(collisionObjToObjIds)),
       RigidObject(rigidBodyNode, objectId, resMgr),
-      MotionState{*rigidBodyNode} {}
+      MotionState{*rigidBodyNode},
+      collisionShapeCache_{std::move(collisionShapeCache)} {}
 
 BulletRigidObject::~BulletRigidObject() {
   if (!BulletRigidObject::isActive()) {
@@ -124,13 +147,78 @@ bool BulletRigidObject::constructCollisionShape() {
     const assets::MeshMetaData& metaData =
         resMgr_.getMeshMetaData(collisionAssetHandle);
 
-    if (!usingBBCollisionShape_) {
+    CollisionHullSettings hullSettings;
+    hullSettings.maxHullVertices = tmpAttr->getCollisionHullMaxVertices();
+    hullSettings.decompose = tmpAttr->getCollisionConvexDecomposition();
+    // Processed only when the hulls get built, which with the shape cache is
+    // once per asset and settings
+    std::vector<CollisionMeshHulls> meshHulls;
+    const auto processedMeshHulls =
+        [&]() -> const std::vector<CollisionMeshHulls>* {
+      if (hullSettings.isPassthrough()) {
+        return nullptr;
+      }
+      meshHulls = loadOrComputeCollisionHulls(collisionAssetHandle, meshGroup,
+                                              hullSettings);
+      return &meshHulls;
+    };
+
+    if (!usingBBCollisionShape_ && collisionShapeCache_) {
+      // Objects built from the same asset at the same scale share their
+      // hulls. Scaling the compound would scale its children, so the scale
+      // is baked into the hulls instead.
+      const Mn::Vector3 hullScaling =
+          joinCollisionMeshes
+              ? tmpAttr->getCollisionAssetSize() * tmpAttr->getScale()
+              : tmpAttr->getScale();
+      const BulletCollisionShapeCache::Key key{collisionAssetHandle,
+                                               joinCollisionMeshes,
+                                               hullSettings.maxHullVertices,
+                                               hullSettings.decompose,
+                                               hullScaling.x(),
+                                               hullScaling.y(),
+                                               hullScaling.z()};
+      bSharedConvexShapes_ = collisionShapeCache_->get(key);
+      if (!bSharedConvexShapes_) {
+        auto shapes = BulletConvexShapeSet::create();
+        if (joinCollisionMeshes) {
+          shapes->convexShapes.emplace_back(
+              std::make_unique<btConvexHullShape>());
+          constructJoinedConvexShapeFromMeshes(
+              Magnum::Matrix4{}, meshGroup, metaData.root,
+              shapes->convexShapes.back().get());
+          if (hullSettings.maxHullVertices > 0) {
+            shapes->convexShapes.back() = simplifiedConvexShape(
+                *shapes->convexShapes.back(), hullSettings.maxHullVertices);
+          }
+        } else {
+          constructConvexShapesFromMeshes(
+              Magnum::Matrix4{}, meshGroup, metaData.root, nullptr,
+              shapes->convexShapes, processedMeshHulls());
+        }
+        for (const auto& convexShape : shapes->convexShapes) {
+          convexShape->setLocalScaling(btVector3(hullScaling));
+          convexShape->setMargin(0.0);
+          convexShape->recalcLocalAabb();
+        }
+        bSharedConvexShapes_ =
+            collisionShapeCache_->add(key, std::move(shapes));
+      }
+      for (const auto& convexShape : bSharedConvexShapes_->convexShapes) {
+        bObjectShape_->addChildShape(btTransform::getIdentity(),
+                                     convexShape.get());
+      }
+    } else if (!usingBBCollisionShape_) {
       if (joinCollisionMeshes) {
         bObjectConvexShapes_.emplace_back(
             std::make_unique<btConvexHullShape>());
         constructJoinedConvexShapeFromMeshes(Magnum::Matrix4{}, meshGroup,
                                              metaData.root,
                                              bObjectConvexShapes_.back().get());
+        if (hullSettings.maxHullVertices > 0) {
+          bObjectConvexShapes_.back() = simplifiedConvexShape(
+              *bObjectConvexShapes_.back(), hullSettings.maxHullVertices);
+        }
 
         // add the final object after joining meshes
         bObjectConvexShapes_.back()->setLocalScaling(
@@ -140,9 +228,9 @@ bool BulletRigidObject::constructCollisionShape() {
         bObjectShape_->addChildShape(btTransform::getIdentity(),
                                      bObjectConvexShapes_.back().get());
       } else {
-        constructConvexShapesFromMeshes(Magnum::Matrix4{}, meshGroup,
-                                        metaData.root, bObjectShape_.get(),
-                                        bObjectConvexShapes_);
+        constructConvexShapesFromMeshes(
+            Magnum::Matrix4{}, meshGroup, metaData.root, bObjectShape_.get(),
+            bObjectConvexShapes_, processedMeshHulls());
       }
     }
   }  // if using prim collider else use mesh collider
@@ -150,7 +238,9 @@ bool BulletRigidObject::constructCollisionShape() {
   //! Set properties
   bObjectShape_->setMargin(margin);
 
-  bObjectShape_->setLocalScaling(btVector3{tmpAttr->getScale()});
+  if (!bSharedConvexShapes_) {
+    bObjectShape_->setLocalScaling(btVector3{tmpAttr->getScale()});
+  }
   bObjectShape_->recalculateLocalAabb();
 
   if (!originShift_.isZero()) {
@@ -316,6 +406,35 @@ void BulletRigidObject::shiftObjectCollisionShape(
   bObjectShape_->recalculateLocalAabb();
 }
 
+void BulletRigidObject::unshareConvexShapes() {
+  if (!bSharedConvexShapes_) {
+    return;
+  }
+  // The compound only holds the shared hulls, replace them in order keeping
+  // any origin shift
+  std::vector<btTransform> childTransforms;
+  for (int i = 0; i < bObjectShape_->getNumChildShapes(); ++i) {
+    childTransforms.push_back(bObjectShape_->getChildTransform(i));
+  }
+  while (bObjectShape_->getNumChildShapes() > 0) {
+    bObjectShape_->removeChildShapeByIndex(
+        bObjectShape_->getNumChildShapes() - 1);
+  }
+  const auto& sharedShapes = bSharedConvexShapes_->convexShapes;
+  for (std::size_t i = 0; i < sharedShapes.size(); ++i) {
+    const btConvexHullShape& shared = *sharedShapes[i];
+    bObjectConvexShapes_.emplace_back(std::make_unique<btConvexHullShape>(
+        reinterpret_cast<const btScalar*>(shared.getUnscaledPoints()),
+        shared.getNumPoints()));
+    bObjectConvexShapes_.back()->setLocalScaling(shared.getLocalScaling());
+    bObjectConvexShapes_.back()->setMargin(shared.getMargin());
+    bObjectConvexShapes_.back()->recalcLocalAabb();
+    bObjectShape_->addChildShape(childTransforms[i],
+                                 bObjectConvexShapes_.back().get());
+  }
+  bSharedConvexShapes_ = nullptr;
+}
+
 //! Synchronize Physics transformations
 //! Needed after changing the pose from Magnum side
 void BulletRigidObject::syncPose() {
@@ -49,13 +49,17 @@ class BulletRigidObject : public BulletBase,
    * @param bWorld The Bullet world to which this object will belong.
    * @param collisionObjToObjIds The global map of btCollisionObjects to Habitat
    * object IDs for contact query identification.
+   * @param collisionShapeCache Convex hulls shared with other objects built
+   * from the same collision asset. If nullptr, the object builds its own.
    */
   BulletRigidObject(scene::SceneNode* rigidBodyNode,
                     int objectId,
                     const assets::ResourceManager& resMgr,
                     std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
                     std::shared_ptr<std::map<const btCollisionObject*, int>>
-                        collisionObjToObjIds);
+                        collisionObjToObjIds,
+                    std::shared_ptr<BulletCollisionShapeCache>
+                        collisionShapeCache = nullptr);
 
   /**
    * @brief Destructor cleans up simulation structures for the object.
@@ -440,6 +444,8 @@ class BulletRigidObject : public BulletBase,
    * @param margin The new scalar collision margin of the object.
    */
   void setMargin(const double margin) override {
+    // The margin is a property of the hulls, which may be shared
+    unshareConvexShapes();
     for (std::size_t i = 0; i < bObjectConvexShapes_.size(); ++i) {
       bObjectConvexShapes_[i]->setMargin(margin);
     }
@@ -521,6 +527,13 @@ class BulletRigidObject : public BulletBase,
    */
   void activateCollisionIsland();
 
+  /**
+   * @brief Replace the hulls shared through the @ref BulletCollisionShapeCache
+   * by copies owned by this object, so that they can be modified. Does
+   * nothing if the object already owns its hulls.
+   */
+  void unshareConvexShapes();
+
  private:
   // === Physical object ===
   //! If true, the object's bounding box will be used for collision once
@@ -531,6 +544,14 @@ class BulletRigidObject : public BulletBase,
   //! deffered construction of collision shape
   Mn::Vector3 originShift_;
 
+  //! Cache to get the convex hulls of mesh colliders from, may be nullptr.
+  std::shared_ptr<BulletCollisionShapeCache> collisionShapeCache_;
+
+  //! Convex hulls of the collision shape if shared with other objects,
+  //! otherwise in @ref bObjectConvexShapes_. Declared before @ref
+  //! bObjectShape_ so it outlives the compound referencing it.
+  BulletConvexShapeSet::ptr bSharedConvexShapes_;
+
   //! Object data: All components of the collision shape
   std::unique_ptr<btCompoundShape> bObjectShape_;
 
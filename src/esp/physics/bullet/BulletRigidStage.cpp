@@ -2,9 +2,15 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/MurmurHash2.h>
+#include <Corrade/Utility/Path.h>
 #include <Magnum/BulletIntegration/DebugDraw.h>
 #include <Magnum/BulletIntegration/Integration.h>
 
+#include <cstdint>
+#include <cstring>
 #include <utility>
 
 #include "BulletCollision/CollisionShapes/btCompoundShape.h"
@@ -20,14 +26,73 @@
 namespace esp {
 namespace physics {
 
+namespace {
+
+//! Bumped whenever the layout of cached BVH files changes.
+constexpr std::uint32_t BvhCacheVersion = 1;
+
+/**
+ * @brief Header of a cached BVH file.
+ *
+ * Followed by the BVH serialized with @ref btOptimizedBvh::serializeInPlace.
+ * Everything the BVH depends on is in the header, and a file is only used if
+ * its header matches the one computed for the mesh being loaded.
+ */
+struct BvhCacheHeader {
+  char magic[8]{'E', 'S', 'P', 'B', 'V', 'H', '\0', '\0'};
+  std::uint32_t version = BvhCacheVersion;
+  std::uint32_t bulletVersion = BT_BULLET_VERSION;
+  std::uint32_t scalarSize = sizeof(btScalar);
+  std::uint32_t numVertices = 0;
+  std::uint32_t numTriangles = 0;
+  float scaling[3]{};
+  float margin = 0.0f;
+  //! Size of the serialized BVH, not part of the key
+  std::uint32_t bvhSize = 0;
+  std::uint64_t positionsHash = 0;
+  std::uint64_t indicesHash = 0;
+};
+// Keeps the serialized BVH 16-byte aligned in the page-aligned mapping
+static_assert(sizeof(BvhCacheHeader) == 64, "unexpected BVH header size");
+
+BvhCacheHeader bvhCacheKey(const assets::CollisionMeshData& mesh,
+                           const btVector3& scaling,
+                           const float margin) {
+  BvhCacheHeader header;
+  header.numVertices = mesh.positions.size();
+  header.numTriangles = mesh.indices.size() / 3;
+  for (int i = 0; i < 3; ++i) {
+    header.scaling[i] = scaling[i];
+  }
+  header.margin = margin;
+  header.positionsHash = core::hashBytes(
+      mesh.positions.data(), mesh.positions.size() * sizeof(Mn::Vector3));
+  header.indicesHash = core::hashBytes(
+      mesh.indices.data(), mesh.indices.size() * sizeof(Mn::UnsignedInt));
+  return header;
+}
+
+//! The cache file name of a key, the hash of the whole header.
+std::string bvhCacheFilename(BvhCacheHeader key) {
+  key.bvhSize = 0;
+  return Cr::Utility::MurmurHash2{}(reinterpret_cast<const char*>(&key),
+                                    sizeof(key))
+             .hexString() +
+         ".bvh";
+}
+
+}  // namespace
+
 BulletRigidStage::BulletRigidStage(
     scene::SceneNode* rigidBodyNode,
     const assets::ResourceManager& resMgr,
     std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
     std::shared_ptr<std::map<const btCollisionObject*, int> >
-        collisionObjToObjIds)
+        collisionObjToObjIds,
+    std::string bvhCacheDirectory)
     : BulletBase(std::move(bWorld), std::move(collisionObjToObjIds)),
-      RigidStage{rigidBodyNode, resMgr} {}
+      RigidStage{rigidBodyNode, resMgr},
+      bvhCacheDirectory_{std::move(bvhCacheDirectory)} {}
 
 BulletRigidStage::~BulletRigidStage() {
   // remove collision objects from the world
@@ -138,16 +203,14 @@ void BulletRigidStage::constructBulletSceneFromMeshes(
     //! Embed 3D mesh into bullet shape
     //! btBvhTriangleMeshShape is the most generic/slow choice
     //! which allows concavity if the object is static
+    //! The BVH is built (or loaded) only once the scaling is known
     std::unique_ptr<btBvhTriangleMeshShape> meshShape =
         std::make_unique<btBvhTriangleMeshShape>(indexedVertexArray.get(),
-                                                 true);
+                                                 true, false);
     meshShape->setMargin(initializationAttributes_->getMargin());
-    meshShape->setLocalScaling(
-        btVector3{transformFromLocalToWorld
-                      .scaling()});  // scale is a property of the shape
-
-    // re-build the bvh after setting margin
-    meshShape->buildOptimizedBvh();
+    // scale is a property of the shape
+    buildOrLoadBvh(*meshShape, *mesh,
+                   btVector3{transformFromLocalToWorld.scaling()});
     // mass == 0 to indicate static. See isStaticObject assert below. See also
     // examples/MultiThreadedDemo/CommonRigidBodyMTBase.h
     btVector3 localInertia(0, 0, 0);
@@ -172,6 +235,67 @@ void BulletRigidStage::constructBulletSceneFromMeshes(
   }
 }  // constructBulletSceneFromMeshes
 
+void BulletRigidStage::buildOrLoadBvh(btBvhTriangleMeshShape& meshShape,
+                                      const assets::CollisionMeshData& mesh,
+                                      const btVector3& scaling) {
+  BvhCacheHeader key;
+  std::string file;
+  if (!bvhCacheDirectory_.empty()) {
+    key = bvhCacheKey(mesh, scaling, meshShape.getMargin());
+    file = Cr::Utility::Path::join(bvhCacheDirectory_, bvhCacheFilename(key));
+
+    // The BVH is deserialized in place. Only the pages it fixes up get
+    // copied, the nodes stay shared with other processes mapping the file.
+    std::shared_ptr<core::MappedFile> mapping = core::MappedFile::map(file);
+    BvhCacheHeader header;
+    if (mapping && mapping->size() >= sizeof(header)) {
+      std::memcpy(&header, mapping->data(), sizeof(header));
+      key.bvhSize = header.bvhSize;
+      btQuantizedBvh* bvh = nullptr;
+      if (std::memcmp(&header, &key, sizeof(header)) == 0 &&
+          mapping->size() == sizeof(header) + header.bvhSize) {
+        bvh = btQuantizedBvh::deSerializeInPlace(
+            mapping->data() + sizeof(header), header.bvhSize, false);
+      }
+      if (bvh) {
+        // btOptimizedBvh adds no data, and the BVH is never refit
+        meshShape.setOptimizedBvh(static_cast<btOptimizedBvh*>(bvh), scaling);
+        bStageBvhMappings_.emplace_back(std::move(mapping));
+        ++numBvhsLoadedFromCache_;
+        ESP_DEBUG() << "Loaded collision mesh BVH from" << file;
+        return;
+      }
+      ESP_WARNING() << "Ignoring invalid cached collision mesh BVH" << file;
+    }
+  }
+
+  // Set the scaling without the BVH rebuild the override does
+  meshShape.btTriangleMeshShape::setLocalScaling(scaling);
+  meshShape.buildOptimizedBvh();
+  if (file.empty()) {
+    return;
+  }
+
+  const btOptimizedBvh* bvh = meshShape.getOptimizedBvh();
+  key.bvhSize = bvh->calculateSerializeBufferSize();
+  const std::size_t size = sizeof(key) + key.bvhSize;
+  char* data = static_cast<char*>(btAlignedAlloc(size, 16));
+  std::memcpy(data, &key, sizeof(key));
+  bool written =
+      bvh->serializeInPlace(data + sizeof(key), key.bvhSize, false) &&
+      Cr::Utility::Path::make(bvhCacheDirectory_);
+  // Processes loading the same stage concurrently must never map a partially
+  // written file
+  written = written && core::writeFileAtomically(
+                           file, Cr::Containers::arrayView(data, size));
+  btAlignedFree(data);
+  if (!written) {
+    ESP_WARNING() << "Unable to write collision mesh BVH cache file" << file;
+  } else {
+    ESP_DEBUG() << "Wrote collision mesh BVH to" << file;
+  }
+}  // buildOrLoadBvh
+
 void BulletRigidStage::setFrictionCoefficient(
     const double frictionCoefficient) {
   for (std::size_t i = 0; i < bStaticCollisionObjects_.size(); ++i) {
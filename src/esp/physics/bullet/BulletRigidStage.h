@@ -5,6 +5,7 @@
 #ifndef ESP_PHYSICS_BULLET_BULLETRIGIDSTAGE_H_
 #define ESP_PHYSICS_BULLET_BULLETRIGIDSTAGE_H_
 
+#include "esp/core/MappedFile.h"
 #include "esp/physics/RigidStage.h"
 #include "esp/physics/bullet/BulletBase.h"
 
@@ -21,11 +22,20 @@ namespace physics {
 
 class BulletRigidStage : public BulletBase, public RigidStage {
  public:
+  /**
+   * @brief Constructor.
+   *
+   * @param bvhCacheDirectory Directory holding serialized BVHs of the static
+   * collision meshes, keyed by mesh contents, scaling and margin. BVHs found
+   * there are memory-mapped instead of rebuilt, missing ones are built and
+   * written. Empty disables the cache.
+   */
   BulletRigidStage(scene::SceneNode* rigidBodyNode,
                    const assets::ResourceManager& resMgr,
                    std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
                    std::shared_ptr<std::map<const btCollisionObject*, int>>
-                       collisionObjToObjIds);
+                       collisionObjToObjIds,
+                   std::string bvhCacheDirectory = "");
 
   /**
    * @brief Destructor cleans up simulation structures for the stage object.
@@ -105,15 +115,41 @@ class BulletRigidStage : public BulletBase, public RigidStage {
    */
   void setRestitutionCoefficient(double restitutionCoefficient) override;
 
+  /**
+   * @brief Get the number of collision mesh BVHs that were loaded from the
+   * BVH cache directory instead of being built.
+   */
+  int getNumBvhsLoadedFromCache() const { return numBvhsLoadedFromCache_; }
+
  private:
+  /**
+   * @brief Build the BVH of @p meshShape, or load it from the BVH cache
+   * directory if it's there.
+   * @param meshShape Shape constructed without a BVH.
+   * @param mesh The collision mesh referenced by @p meshShape.
+   * @param scaling Local scaling of the shape, baked into the BVH.
+   */
+  void buildOrLoadBvh(btBvhTriangleMeshShape& meshShape,
+                      const assets::CollisionMeshData& mesh,
+                      const btVector3& scaling);
+
   // === Physical stage ===
 
   //! Stage data: Bullet triangular mesh vertices
   std::vector<std::unique_ptr<btTriangleIndexVertexArray>> bStageArrays_;
 
+  //! Stage data: cached BVH files the shapes' BVHs live in. Declared before
+  //! the shapes so they're unmapped only after the shapes are gone.
+  std::vector<std::shared_ptr<core::MappedFile>> bStageBvhMappings_;
+
   //! Stage data: Bullet triangular mesh shape
   std::vector<std::unique_ptr<btBvhTriangleMeshShape>> bStageShapes_;
 
+  //! Directory of the serialized BVH cache, empty if disabled
+  std::string bvhCacheDirectory_;
+
+  int numBvhsLoadedFromCache_ = 0;
+
  public:
   ESP_SMART_POINTERS(BulletRigidStage)
 
@@ -68,5 +68,37 @@ ArticulatedObjectManager::addArticulatedObjectFromURDFWithDrawables(
   return nullptr;
 }
 
+std::vector<float> ArticulatedObjectManager::getJointPositions(
+    const std::vector<int>& objectIds) const {
+  if (auto physMgr = this->getPhysicsManager()) {
+    return physMgr->getArticulatedObjectJointPositions(objectIds);
+  }
+  return {};
+}  // ArticulatedObjectManager::getJointPositions
+
+void ArticulatedObjectManager::setJointPositions(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<const float> positions) {
+  if (auto physMgr = this->getPhysicsManager()) {
+    physMgr->setArticulatedObjectJointPositions(objectIds, positions);
+  }
+}  // ArticulatedObjectManager::setJointPositions
+
+std::vector<float> ArticulatedObjectManager::getJointVelocities(
+    const std::vector<int>& objectIds) const {
+  if (auto physMgr = this->getPhysicsManager()) {
+    return physMgr->getArticulatedObjectJointVelocities(objectIds);
+  }
+  return {};
+}  // ArticulatedObjectManager::getJointVelocities
+
+void ArticulatedObjectManager::setJointVelocities(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<const float> velocities) {
+  if (auto physMgr = this->getPhysicsManager()) {
+    physMgr->setArticulatedObjectJointVelocities(objectIds, velocities);
+  }
+}  // ArticulatedObjectManager::setJointVelocities
+
 }  // namespace physics
 }  // namespace esp
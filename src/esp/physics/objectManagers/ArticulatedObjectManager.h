@@ -132,6 +132,38 @@ class ArticulatedObjectManager
       bool intertiaFromURDF = false,
       const std::string& lightSetup = DEFAULT_LIGHTING_KEY);
 
+  /**
+   * @brief Get the joint positions of several articulated objects,
+   * concatenated in the order of @p objectIds. See @ref
+   * PhysicsManager::getArticulatedObjectJointPositions().
+   */
+  std::vector<float> getJointPositions(const std::vector<int>& objectIds) const;
+
+  /**
+   * @brief Set the joint positions of several articulated objects from
+   * values concatenated in the order of @p objectIds. See @ref
+   * PhysicsManager::setArticulatedObjectJointPositions().
+   */
+  void setJointPositions(const std::vector<int>& objectIds,
+                         Corrade::Containers::ArrayView<const float> positions);
+
+  /**
+   * @brief Get the joint velocities of several articulated objects,
+   * concatenated in the order of @p objectIds. See @ref
+   * PhysicsManager::getArticulatedObjectJointVelocities().
+   */
+  std::vector<float> getJointVelocities(
+      const std::vector<int>& objectIds) const;
+
+  /**
+   * @brief Set the joint velocities of several articulated objects from
+   * values concatenated in the order of @p objectIds. See @ref
+   * PhysicsManager::setArticulatedObjectJointVelocities().
+   */
+  void setJointVelocities(
+      const std::vector<int>& objectIds,
+      Corrade::Containers::ArrayView<const float> velocities);
+
  protected:
   /**
    * @brief This method will remove articulated objects from physics manager.
@@ -74,5 +74,37 @@ RigidObjectManager::removePhysObjectByHandle(const std::string& objectHandle,
   return nullptr;
 }  // RigidObjectManager::removeObjectByHandle
 
+void RigidObjectManager::getPoses(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<float> poses) const {
+  if (auto physMgr = this->getPhysicsManager()) {
+    physMgr->getRigidObjectPoses(objectIds, poses);
+  }
+}  // RigidObjectManager::getPoses
+
+void RigidObjectManager::setPoses(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<const float> poses) {
+  if (auto physMgr = this->getPhysicsManager()) {
+    physMgr->setRigidObjectPoses(objectIds, poses);
+  }
+}  // RigidObjectManager::setPoses
+
+void RigidObjectManager::getVelocities(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<float> velocities) const {
+  if (auto physMgr = this->getPhysicsManager()) {
+    physMgr->getRigidObjectVelocities(objectIds, velocities);
+  }
+}  // RigidObjectManager::getVelocities
+
+void RigidObjectManager::setVelocities(
+    const std::vector<int>& objectIds,
+    Cr::Containers::ArrayView<const float> velocities) {
+  if (auto physMgr = this->getPhysicsManager()) {
+    physMgr->setRigidObjectVelocities(objectIds, velocities);
+  }
+}  // RigidObjectManager::setVelocities
+
 }  // namespace physics
 }  // namespace esp
@@ -137,6 +137,36 @@ class RigidObjectManager
       bool deleteObjectNode = true,
       bool deleteVisualNode = true);
 
+  /**
+   * @brief Read the poses of several rigid objects into a contiguous array
+   * of 7 floats per object. See @ref PhysicsManager::getRigidObjectPoses().
+   */
+  void getPoses(const std::vector<int>& objectIds,
+                Corrade::Containers::ArrayView<float> poses) const;
+
+  /**
+   * @brief Set the poses of several rigid objects from a contiguous array
+   * of 7 floats per object. See @ref PhysicsManager::setRigidObjectPoses().
+   */
+  void setPoses(const std::vector<int>& objectIds,
+                Corrade::Containers::ArrayView<const float> poses);
+
+  /**
+   * @brief Read the velocities of several rigid objects into a contiguous
+   * array of 6 floats per object. See @ref
+   * PhysicsManager::getRigidObjectVelocities().
+   */
+  void getVelocities(const std::vector<int>& objectIds,
+                     Corrade::Containers::ArrayView<float> velocities) const;
+
+  /**
+   * @brief Set the velocities of several rigid objects from a contiguous
+   * array of 6 floats per object. See @ref
+   * PhysicsManager::setRigidObjectVelocities().
+   */
+  void setVelocities(const std::vector<int>& objectIds,
+                     Corrade::Containers::ArrayView<const float> velocities);
+
  protected:
   /**
    * @brief This method will remove rigid objects from physics manager.  The
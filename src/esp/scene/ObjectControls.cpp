@@ -9,6 +9,7 @@
 #include <utility>
 
 #include "SceneNode.h"
+#include "esp/core/Check.h"
 #include "esp/core/Esp.h"
 
 using Magnum::EigenIntegration::cast;
@@ -79,6 +80,11 @@ ObjectControls::ObjectControls() {
   moveFuncMap_["turnRight"] = &turnRight;
   moveFuncMap_["lookUp"] = &lookUp;
   moveFuncMap_["lookDown"] = &lookDown;
+
+  for (const auto& moveFunc : moveFuncMap_) {
+    moveFuncIds_[moveFunc.first] = int(moveFuncs_.size());
+    moveFuncs_.push_back(moveFunc.second);
+  }
 }
 
 ObjectControls& ObjectControls::setMoveFilterFunction(
@@ -93,18 +99,7 @@ ObjectControls& ObjectControls::action(SceneNode& object,
                                        bool applyFilter /* = true */) {
   auto moveFuncMapIter = moveFuncMap_.find(actName);
   if (moveFuncMapIter != moveFuncMap_.end()) {
-    if (applyFilter) {
-      // TODO: use magnum math for the filter func as well?
-      const auto startPosition =
-          cast<vec3f>(object.absoluteTransformation().translation());
-      moveFuncMapIter->second(object, distance);
-      const auto endPos =
-          cast<vec3f>(object.absoluteTransformation().translation());
-      const vec3f filteredEndPosition = moveFilterFunc_(startPosition, endPos);
-      object.translate(Magnum::Vector3(vec3f(filteredEndPosition - endPos)));
-    } else {
-      moveFuncMapIter->second(object, distance);
-    }
+    applyMoveFunc(moveFuncMapIter->second, object, distance, applyFilter);
   } else {
     ESP_ERROR() << "Tried to perform unknown action with name" << actName;
   }
@@ -112,5 +107,78 @@ ObjectControls& ObjectControls::action(SceneNode& object,
   return *this;
 }
 
+int ObjectControls::getActionId(const std::string& actName) const {
+  auto moveFuncIdIter = moveFuncIds_.find(actName);
+  if (moveFuncIdIter == moveFuncIds_.end()) {
+    return ID_UNDEFINED;
+  }
+  return moveFuncIdIter->second;
+}
+
+ObjectControls& ObjectControls::action(SceneNode& object,
+                                       int actionId,
+                                       float distance,
+                                       bool applyFilter /* = true */) {
+  if (actionId >= 0 && actionId < int(moveFuncs_.size())) {
+    applyMoveFunc(moveFuncs_[actionId], object, distance, applyFilter);
+  } else {
+    ESP_ERROR() << "Tried to perform unknown action with ID" << actionId;
+  }
+
+  return *this;
+}
+
+std::vector<bool> ObjectControls::actionMany(
+    const std::vector<SceneNode*>& objects,
+    const std::vector<int>& actionIds,
+    const std::vector<float>& amounts,
+    const std::vector<bool>& applyFilter) {
+  ESP_CHECK(actionIds.size() == objects.size() &&
+                amounts.size() == objects.size() &&
+                applyFilter.size() == objects.size(),
+            "ObjectControls::actionMany : Got" << objects.size() << "objects,"
+                << actionIds.size() << "action IDs," << amounts.size()
+                << "amounts and" << applyFilter.size() << "filter flags.");
+  for (size_t i = 0; i < objects.size(); ++i) {
+    ESP_CHECK(objects[i], "ObjectControls::actionMany : Object" << i
+                                                                << "is null.");
+    ESP_CHECK(actionIds[i] >= 0 && actionIds[i] < int(moveFuncs_.size()),
+              "ObjectControls::actionMany : Unknown action ID"
+                  << actionIds[i]);
+  }
+
+  std::vector<bool> collided(objects.size());
+  for (size_t i = 0; i < objects.size(); ++i) {
+    collided[i] = applyMoveFunc(moveFuncs_[actionIds[i]], *objects[i],
+                                amounts[i], applyFilter[i]);
+  }
+  return collided;
+}
+
+bool ObjectControls::applyMoveFunc(const MoveFunc& moveFunc,
+                                   SceneNode& object,
+                                   float distance,
+                                   bool applyFilter) {
+  if (!applyFilter) {
+    moveFunc(object, distance);
+    return false;
+  }
+
+  // TODO: use magnum math for the filter func as well?
+  const auto startPosition =
+      cast<vec3f>(object.absoluteTransformation().translation());
+  moveFunc(object, distance);
+  const auto endPos =
+      cast<vec3f>(object.absoluteTransformation().translation());
+  const vec3f filteredEndPosition = moveFilterFunc_(startPosition, endPos);
+  object.translate(Magnum::Vector3(vec3f(filteredEndPosition - endPos)));
+
+  // The filter can move the end without a collision, e.g. up stairs, so only
+  // count moves it shortened, the same way the python agents do
+  constexpr float EPS = 1e-5;
+  return (filteredEndPosition - startPosition).squaredNorm() + EPS <
+         (endPos - startPosition).squaredNorm();
+}
+
 }  // namespace scene
 }  // namespace esp
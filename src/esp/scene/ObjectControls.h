@@ -8,6 +8,7 @@
 #include <functional>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "esp/core/Esp.h"
 #include "esp/core/EspEigen.h"
@@ -37,14 +38,56 @@ class ObjectControls {
     return action(object, actName, distance, applyFilter);
   }
 
+  /**
+   * @brief Resolve an action name to an integer ID, to avoid looking the name
+   * up every time the action is taken.
+   *
+   * @return The ID to pass to @ref action(SceneNode&, int, float, bool), or
+   * @ref ID_UNDEFINED if there is no action named @p actName.
+   */
+  int getActionId(const std::string& actName) const;
+
+  /**
+   * @brief Take the action with ID @p actionId, see @ref getActionId.
+   */
+  ObjectControls& action(SceneNode& object,
+                         int actionId,
+                         float distance,
+                         bool applyFilter = true);
+
+  /**
+   * @brief Take one action on each of many objects in a single call.
+   *
+   * @p objects[i] takes the action with ID @p actionIds[i], see
+   * @ref getActionId, by @p amounts[i]. The move is filtered where
+   * @p applyFilter[i] is set. All arguments are validated before any action
+   * is taken.
+   *
+   * @return Whether each move collided, that is whether the filter shortened
+   * it. Always false for unfiltered moves.
+   */
+  std::vector<bool> actionMany(const std::vector<SceneNode*>& objects,
+                               const std::vector<int>& actionIds,
+                               const std::vector<float>& amounts,
+                               const std::vector<bool>& applyFilter);
+
   inline const std::map<std::string, MoveFunc>& getMoveFuncMap() const {
     return moveFuncMap_;
   }
 
  protected:
+  //! Returns whether the filter shortened the move.
+  bool applyMoveFunc(const MoveFunc& moveFunc,
+                     SceneNode& object,
+                     float distance,
+                     bool applyFilter);
+
   MoveFilterFunc moveFilterFunc_ = [](const vec3f& /*start*/,
                                       const vec3f& end) { return end; };
   std::map<std::string, MoveFunc> moveFuncMap_;
+  //! The values of moveFuncMap_, indexed by action ID.
+  std::vector<MoveFunc> moveFuncs_;
+  std::map<std::string, int> moveFuncIds_;
 
   ESP_SMART_POINTERS(ObjectControls)
 };
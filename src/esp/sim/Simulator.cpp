@@ -23,6 +23,7 @@
 #include "esp/gfx/Renderer.h"
 #include "esp/gfx/replay/Recorder.h"
 #include "esp/gfx/replay/ReplayManager.h"
+#include "esp/geo/Geo.h"
 #include "esp/metadata/MetadataMediator.h"
 #include "esp/metadata/attributes/AttributesBase.h"
 #include "esp/nav/PathFinder.h"
@@ -256,7 +257,8 @@ bool Simulator::createSceneInstance(const std::string& activeSceneName) {
                   << navmeshFileHandle;
     } else if (Cr::Utility::Path::exists(navmeshFileLoc)) {
       ESP_DEBUG() << "Loading navmesh from" << navmeshFileLoc;
-      bool pfSuccess = pathfinder_->loadNavMesh(navmeshFileLoc);
+      bool pfSuccess =
+          pathfinder_->loadNavMesh(navmeshFileLoc, config_.memoryMapNavMesh);
       ESP_DEBUG() << (pfSuccess ? "Navmesh Loaded." : "Navmesh load error.");
     } else {
       ESP_WARNING(Mn::Debug::Flag::NoSpace)
@@ -759,6 +761,36 @@ double Simulator::stepWorld(const double dt) {
   return getWorldTime();
 }
 
+std::vector<double> Simulator::stepWorlds(
+    const std::vector<Simulator*>& simulators,
+    physics::PhysicsWorldPool& pool,
+    const double dt) {
+  std::vector<physics::PhysicsManager*> worlds;
+  std::vector<size_t> worldSimulators;
+  for (size_t i = 0; i < simulators.size(); ++i) {
+    Simulator* sim = simulators[i];
+    ESP_CHECK(sim != nullptr,
+              "Simulator::stepWorlds : Simulators must not be null.");
+    if (sim->physicsManager_ == nullptr) {
+      continue;
+    }
+    // the scene graphs are modified concurrently with no chance to wait in
+    // between, so any background rendering has to be done by now
+    if (sim->renderer_) {
+      sim->renderer_->waitSceneGraph();
+    }
+    worlds.push_back(sim->physicsManager_.get());
+    worldSimulators.push_back(i);
+  }
+
+  std::vector<double> worldTimes(simulators.size(), NO_TIME);
+  const std::vector<double> steppedTimes = pool.stepWorlds(worlds, dt);
+  for (size_t i = 0; i < steppedTimes.size(); ++i) {
+    worldTimes[worldSimulators[i]] = steppedTimes[i];
+  }
+  return worldTimes;
+}  // Simulator::stepWorlds
+
 // get the simulated world time (0 if no physics enabled)
 double Simulator::getWorldTime() {
   if (physicsManager_ != nullptr) {
@@ -785,6 +817,19 @@ bool Simulator::recomputeNavMesh(nav::PathFinder& pathfinder,
   }
 
   if (&pathfinder == pathfinder_.get()) {
+    navMeshObjectBBs_.clear();
+    navMeshSourceMeshes_.clear();
+    if (navMeshSettings.includeStaticObjects) {
+      std::vector<int> objectIds = physicsManager_->getExistingObjectIDs();
+      const std::vector<int> aoIds =
+          physicsManager_->getExistingArticulatedObjectIds();
+      objectIds.insert(objectIds.end(), aoIds.begin(), aoIds.end());
+      for (const int objectId : objectIds) {
+        if (auto bb = getNavMeshObjectBB(objectId)) {
+          navMeshObjectBBs_[objectId] = *bb;
+        }
+      }
+    }
     resetNavMeshVisIfActive();
   }
 
@@ -792,6 +837,32 @@ bool Simulator::recomputeNavMesh(nav::PathFinder& pathfinder,
   return true;
 }
 
+std::vector<nav::PathFinder::ptr> Simulator::computeNavMeshVariants(
+    const std::vector<nav::NavMeshSettings>& navMeshSettings) {
+  std::vector<nav::PathFinder::ptr> variants(navMeshSettings.size());
+  // Settings only share a joined mesh if they agree on static objects
+  for (const bool includeStaticObjects : {false, true}) {
+    std::vector<size_t> groupIndices;
+    std::vector<nav::NavMeshSettings> groupSettings;
+    for (size_t i = 0; i < navMeshSettings.size(); ++i) {
+      if (navMeshSettings[i].includeStaticObjects == includeStaticObjects) {
+        groupIndices.push_back(i);
+        groupSettings.push_back(navMeshSettings[i]);
+      }
+    }
+    if (groupSettings.empty())
+      continue;
+
+    const std::vector<nav::PathFinder::ptr> groupVariants =
+        pathfinder_->buildVariants(*getJoinedMesh(includeStaticObjects),
+                                   groupSettings);
+    for (size_t k = 0; k < groupIndices.size(); ++k) {
+      variants[groupIndices[k]] = groupVariants[k];
+    }
+  }
+  return variants;
+}
+
 assets::MeshData::ptr Simulator::getJoinedMesh(
     const bool includeStaticObjects) {
   assets::MeshData::ptr joinedMesh = assets::MeshData::create();
@@ -803,67 +874,8 @@ assets::MeshData::ptr Simulator::getJoinedMesh(
 
   // add STATIC collision objects
   if (includeStaticObjects) {
-    // update nodes so SceneNode transforms are up-to-date
-    if (renderer_) {
-      renderer_->waitSceneGraph();
-    }
-
-    physicsManager_->updateNodes();
-
-    // collect mesh components from all objects and then merge them.
-    // Each mesh component could be duplicated multiple times w/ different
-    // transforms.
-    std::map<std::string,
-             std::vector<Eigen::Transform<float, 3, Eigen::Affine>>>
-        meshComponentStates;
-    auto rigidObjMgr = getRigidObjectManager();
-    // collect RigidObject mesh components
-    for (auto objectID : physicsManager_->getExistingObjectIDs()) {
-      auto objWrapper = rigidObjMgr->getObjectCopyByID(objectID);
-      if (objWrapper->getMotionType() == physics::MotionType::STATIC) {
-        auto objectTransform = Magnum::EigenIntegration::cast<
-            Eigen::Transform<float, 3, Eigen::Affine>>(
-            physicsManager_->getObjectVisualSceneNode(objectID)
-                .absoluteTransformationMatrix());
-        const metadata::attributes::ObjectAttributes::cptr
-            initializationTemplate = objWrapper->getInitializationAttributes();
-        objectTransform.scale(Magnum::EigenIntegration::cast<vec3f>(
-            initializationTemplate->getScale()));
-        std::string meshHandle =
-            initializationTemplate->getCollisionAssetHandle();
-        if (meshHandle.empty()) {
-          meshHandle = initializationTemplate->getRenderAssetHandle();
-        }
-        meshComponentStates[meshHandle].push_back(objectTransform);
-      }
-    }
-
-    // collect ArticulatedObject mesh components
-    for (auto& objectID : physicsManager_->getExistingArticulatedObjectIds()) {
-      auto articulatedObject =
-          getArticulatedObjectManager()->getObjectByID(objectID);
-      if (articulatedObject->getMotionType() == physics::MotionType::STATIC) {
-        for (int linkIx = -1; linkIx < articulatedObject->getNumLinks();
-             ++linkIx) {
-          //-1 is baseLink_
-          std::vector<std::pair<esp::scene::SceneNode*, std::string>>
-              visualAttachments =
-                  physicsManager_->getArticulatedObject(objectID)
-                      .getLink(linkIx)
-                      .visualAttachments_;
-          for (auto& visualAttachment : visualAttachments) {
-            auto objectTransform = Magnum::EigenIntegration::cast<
-                Eigen::Transform<float, 3, Eigen::Affine>>(
-                visualAttachment.first->absoluteTransformationMatrix());
-            std::string meshHandle = visualAttachment.second;
-            meshComponentStates[meshHandle].push_back(objectTransform);
-          }
-        }
-      }
-    }
-
     // merge mesh components into the final mesh
-    for (auto& meshComponent : meshComponentStates) {
+    for (auto& meshComponent : getStaticMeshComponents()) {
       assets::MeshData::uptr joinedObjectMesh =
           resourceManager_->createJoinedCollisionMesh(meshComponent.first);
       for (auto& meshTransform : meshComponent.second) {
@@ -890,6 +902,241 @@ assets::MeshData::ptr Simulator::getJoinedMesh(
   return joinedMesh;
 }
 
+std::map<std::string, std::vector<Eigen::Transform<float, 3, Eigen::Affine>>>
+Simulator::getStaticMeshComponents() {
+  // update nodes so SceneNode transforms are up-to-date
+  if (renderer_) {
+    renderer_->waitSceneGraph();
+  }
+
+  physicsManager_->updateNodes();
+
+  // collect mesh components from all objects and then merge them.
+  // Each mesh component could be duplicated multiple times w/ different
+  // transforms.
+  std::map<std::string, std::vector<Eigen::Transform<float, 3, Eigen::Affine>>>
+      meshComponentStates;
+  auto rigidObjMgr = getRigidObjectManager();
+  // collect RigidObject mesh components
+  for (auto objectID : physicsManager_->getExistingObjectIDs()) {
+    auto objWrapper = rigidObjMgr->getObjectCopyByID(objectID);
+    if (objWrapper->getMotionType() == physics::MotionType::STATIC) {
+      auto objectTransform = Magnum::EigenIntegration::cast<
+          Eigen::Transform<float, 3, Eigen::Affine>>(
+          physicsManager_->getObjectVisualSceneNode(objectID)
+              .absoluteTransformationMatrix());
+      const metadata::attributes::ObjectAttributes::cptr
+          initializationTemplate = objWrapper->getInitializationAttributes();
+      objectTransform.scale(Magnum::EigenIntegration::cast<vec3f>(
+          initializationTemplate->getScale()));
+      std::string meshHandle =
+          initializationTemplate->getCollisionAssetHandle();
+      if (meshHandle.empty()) {
+        meshHandle = initializationTemplate->getRenderAssetHandle();
+      }
+      meshComponentStates[meshHandle].push_back(objectTransform);
+    }
+  }
+
+  // collect ArticulatedObject mesh components
+  for (auto& objectID : physicsManager_->getExistingArticulatedObjectIds()) {
+    auto articulatedObject =
+        getArticulatedObjectManager()->getObjectByID(objectID);
+    if (articulatedObject->getMotionType() == physics::MotionType::STATIC) {
+      for (int linkIx = -1; linkIx < articulatedObject->getNumLinks();
+           ++linkIx) {
+        //-1 is baseLink_
+        std::vector<std::pair<esp::scene::SceneNode*, std::string>>
+            visualAttachments =
+                physicsManager_->getArticulatedObject(objectID)
+                    .getLink(linkIx)
+                    .visualAttachments_;
+        for (auto& visualAttachment : visualAttachments) {
+          auto objectTransform = Magnum::EigenIntegration::cast<
+              Eigen::Transform<float, 3, Eigen::Affine>>(
+              visualAttachment.first->absoluteTransformationMatrix());
+          std::string meshHandle = visualAttachment.second;
+          meshComponentStates[meshHandle].push_back(objectTransform);
+        }
+      }
+    }
+  }
+  return meshComponentStates;
+}
+
+namespace {
+//! Append the triangles of @p mesh transformed by @p transform whose XZ
+//! bounds overlap [regionMin, regionMax] to @p joinedMesh, with only the
+//! vertices they use.
+void appendTrianglesInRegion(
+    assets::MeshData& joinedMesh,
+    const assets::MeshData& mesh,
+    const Eigen::Transform<float, 3, Eigen::Affine>& transform,
+    const vec3f& regionMin,
+    const vec3f& regionMax) {
+  std::vector<int> joinedIndices(mesh.vbo.size(), ID_UNDEFINED);
+  std::vector<vec3f> verts(mesh.vbo.size());
+  for (size_t i = 0; i < mesh.vbo.size(); ++i) {
+    verts[i] = transform * mesh.vbo[i];
+  }
+  for (size_t i = 0; i + 2 < mesh.ibo.size(); i += 3) {
+    const vec3f& a = verts[mesh.ibo[i]];
+    const vec3f& b = verts[mesh.ibo[i + 1]];
+    const vec3f& c = verts[mesh.ibo[i + 2]];
+    const vec3f triMin = a.cwiseMin(b).cwiseMin(c);
+    const vec3f triMax = a.cwiseMax(b).cwiseMax(c);
+    if (triMax[0] < regionMin[0] || triMin[0] > regionMax[0] ||
+        triMax[2] < regionMin[2] || triMin[2] > regionMax[2])
+      continue;
+    for (size_t j = i; j < i + 3; ++j) {
+      int& joinedIndex = joinedIndices[mesh.ibo[j]];
+      if (joinedIndex == ID_UNDEFINED) {
+        joinedIndex = joinedMesh.vbo.size();
+        joinedMesh.vbo.push_back(verts[mesh.ibo[j]]);
+      }
+      joinedMesh.ibo.push_back(joinedIndex);
+    }
+  }
+}
+}  // namespace
+
+const Simulator::NavMeshSourceMesh& Simulator::getNavMeshSourceMesh(
+    const std::string& meshHandle) {
+  auto found = navMeshSourceMeshes_.find(meshHandle);
+  if (found == navMeshSourceMeshes_.end()) {
+    NavMeshSourceMesh source;
+    source.mesh = resourceManager_->createJoinedCollisionMesh(meshHandle);
+    for (const vec3f& vert : source.mesh->vbo) {
+      source.bounds.extend(vert);
+    }
+    found = navMeshSourceMeshes_.emplace(meshHandle, std::move(source)).first;
+  }
+  return found->second;
+}
+
+assets::MeshData::ptr Simulator::getJoinedMeshInRegion(
+    const vec3f& regionMin,
+    const vec3f& regionMax) {
+  assets::MeshData::ptr joinedMesh = assets::MeshData::create();
+  const auto appendMesh =
+      [&](const std::string& meshHandle,
+          const Eigen::Transform<float, 3, Eigen::Affine>& transform) {
+        const NavMeshSourceMesh& source = getNavMeshSourceMesh(meshHandle);
+        if (source.bounds.isEmpty())
+          return;
+        // Skip meshes whose transformed bounds miss the region
+        Eigen::AlignedBox3f bounds;
+        for (int i = 0; i < 8; ++i) {
+          bounds.extend(transform *
+                        source.bounds.corner(
+                            static_cast<Eigen::AlignedBox3f::CornerType>(i)));
+        }
+        if (bounds.max()[0] < regionMin[0] || bounds.min()[0] > regionMax[0] ||
+            bounds.max()[2] < regionMin[2] || bounds.min()[2] > regionMax[2])
+          return;
+        appendTrianglesInRegion(*joinedMesh, *source.mesh, transform,
+                                regionMin, regionMax);
+      };
+
+  auto stageInitAttrs = physicsManager_->getStageInitAttributes();
+  if (stageInitAttrs != nullptr) {
+    appendMesh(stageInitAttrs->getRenderAssetHandle(),
+               Eigen::Transform<float, 3, Eigen::Affine>::Identity());
+  }
+  for (auto& meshComponent : getStaticMeshComponents()) {
+    for (auto& meshTransform : meshComponent.second) {
+      appendMesh(meshComponent.first, meshTransform);
+    }
+  }
+  return joinedMesh;
+}
+
+bool Simulator::updateNavMeshForObject(const int objectId) {
+  Cr::Containers::Optional<nav::NavMeshSettings> navMeshSettings =
+      pathfinder_->getNavMeshSettings();
+  ESP_CHECK(pathfinder_->isLoaded() && navMeshSettings,
+            "::updateNavMeshForObject: No NavMesh to update, call "
+            "recomputeNavMesh first.");
+  if (!navMeshSettings->includeStaticObjects) {
+    return true;
+  }
+
+  // The object's old and new geometry both need to be re-rasterized.
+  Cr::Containers::Optional<Mn::Range3D> dirtyBB;
+  auto prevBBIter = navMeshObjectBBs_.find(objectId);
+  if (prevBBIter != navMeshObjectBBs_.end()) {
+    dirtyBB = prevBBIter->second;
+  }
+  Cr::Containers::Optional<Mn::Range3D> currentBB =
+      getNavMeshObjectBB(objectId);
+  if (currentBB) {
+    dirtyBB = dirtyBB ? Mn::Math::join(*dirtyBB, *currentBB) : *currentBB;
+  }
+  if (!dirtyBB) {
+    // neither was nor is the object part of the NavMesh
+    return true;
+  }
+
+  // A tiled NavMesh only needs the geometry around the rebuilt tiles
+  const vec3f dirtyMin = Mn::EigenIntegration::cast<vec3f>(dirtyBB->min());
+  const vec3f dirtyMax = Mn::EigenIntegration::cast<vec3f>(dirtyBB->max());
+  assets::MeshData::ptr joinedMesh;
+  if (navMeshSettings->tileSize > 0) {
+    const std::pair<vec3f, vec3f> region =
+        pathfinder_->getRebuildRegion(dirtyMin, dirtyMax);
+    joinedMesh = getJoinedMeshInRegion(region.first, region.second);
+  } else {
+    joinedMesh = getJoinedMesh(true);
+  }
+  if (!pathfinder_->rebuildTiles(*joinedMesh, dirtyMin, dirtyMax)) {
+    ESP_ERROR() << "Failed to update navmesh";
+    return false;
+  }
+
+  // Only forget the old footprint once it's gone from the NavMesh, so a retry
+  // still re-rasterizes it
+  if (currentBB) {
+    navMeshObjectBBs_[objectId] = *currentBB;
+  } else {
+    navMeshObjectBBs_.erase(objectId);
+  }
+  resetNavMeshVisIfActive();
+  return true;
+}
+
+Cr::Containers::Optional<Mn::Range3D> Simulator::getNavMeshObjectBB(
+    const int objectId) {
+  Cr::Containers::Optional<Mn::Range3D> bb;
+  auto joinNodeBB = [&bb](const scene::SceneNode& node) {
+    const Mn::Range3D nodeBB = geo::getTransformedBB(
+        node.getCumulativeBB(), node.absoluteTransformationMatrix());
+    bb = bb ? Mn::Math::join(*bb, nodeBB) : nodeBB;
+  };
+
+  if (physicsManager_->isValidRigidObjectId(objectId)) {
+    auto objWrapper = getRigidObjectManager()->getObjectCopyByID(objectId);
+    if (objWrapper->getMotionType() == physics::MotionType::STATIC) {
+      joinNodeBB(physicsManager_->getObjectVisualSceneNode(objectId));
+    }
+  } else if (physicsManager_->isValidArticulatedObjectId(objectId)) {
+    auto articulatedObject =
+        getArticulatedObjectManager()->getObjectByID(objectId);
+    if (articulatedObject->getMotionType() == physics::MotionType::STATIC) {
+      for (int linkIx = -1; linkIx < articulatedObject->getNumLinks();
+           ++linkIx) {
+        //-1 is baseLink_
+        for (auto& visualAttachment :
+             physicsManager_->getArticulatedObject(objectId)
+                 .getLink(linkIx)
+                 .visualAttachments_) {
+          joinNodeBB(*visualAttachment.first);
+        }
+      }
+    }
+  }
+  return bb;
+}
+
 assets::MeshData::ptr Simulator::getJoinedSemanticMesh(
     std::vector<std::uint16_t>& objectIds) {
   assets::MeshData::ptr joinedSemanticMesh = assets::MeshData::create();
@@ -1012,16 +1259,14 @@ agent::Agent::ptr Simulator::addAgent(
   agents_.push_back(ag);
   // TODO: just do this once
   if (pathfinder_->isLoaded()) {
-    scene::ObjectControls::MoveFilterFunc moveFilterFunction;
-    if (config_.allowSliding) {
-      moveFilterFunction = [&](const vec3f& start, const vec3f& end) {
-        return pathfinder_->tryStep(start, end);
-      };
-    } else {
-      moveFilterFunction = [&](const vec3f& start, const vec3f& end) {
-        return pathfinder_->tryStepNoSliding(start, end);
-      };
-    }
+    // Each agent remembers the navmesh polygon it ended its last step on, so
+    // the next step doesn't have to search for it again
+    auto polyRef = std::make_shared<uint64_t>(0);
+    const bool allowSliding = config_.allowSliding;
+    scene::ObjectControls::MoveFilterFunc moveFilterFunction =
+        [this, polyRef, allowSliding](const vec3f& start, const vec3f& end) {
+          return pathfinder_->tryStep(start, end, *polyRef, allowSliding);
+        };
     ag->getControls()->setMoveFilterFunction(std::move(moveFilterFunction));
   }
 
@@ -1038,6 +1283,47 @@ agent::Agent::ptr Simulator::getAgent(const int agentId) {
   return agents_[agentId];
 }
 
+void Simulator::actMany(const std::vector<int>& agentIds,
+                        const std::vector<int>& actionIds) {
+  ESP_CHECK(agentIds.size() == actionIds.size(),
+            "Simulator::actMany : Got" << agentIds.size() << "agent IDs but"
+                                        << actionIds.size() << "action IDs.");
+  // Validate the whole batch first so a bad ID doesn't leave it half-applied
+  for (size_t i = 0; i < agentIds.size(); ++i) {
+    ESP_CHECK(0 <= agentIds[i] && agentIds[i] < int(agents_.size()),
+              "Simulator::actMany : No agent with ID" << agentIds[i]);
+    ESP_CHECK(agents_[agentIds[i]]->isValidActionId(actionIds[i]),
+              "Simulator::actMany : Agent" << agentIds[i]
+                                           << "has no action with ID"
+                                           << actionIds[i]);
+  }
+  for (size_t i = 0; i < agentIds.size(); ++i) {
+    agents_[agentIds[i]]->act(actionIds[i]);
+  }
+}
+
+std::vector<bool> Simulator::actMany(
+    const std::vector<scene::SceneNode*>& nodes,
+    const std::vector<int>& actionIds,
+    const std::vector<float>& amounts,
+    const std::vector<bool>& applyFilter) {
+  if (!nodeControls_) {
+    nodeControls_ = scene::ObjectControls::create();
+    // Looks the navmesh and the sliding setting up on every move, both can
+    // change after the first call
+    nodeControls_->setMoveFilterFunction(
+        [this](const vec3f& start, const vec3f& end) {
+          if (!pathfinder_->isLoaded()) {
+            return end;
+          }
+          return config_.allowSliding
+                     ? pathfinder_->tryStep(start, end)
+                     : pathfinder_->tryStepNoSliding(start, end);
+        });
+  }
+  return nodeControls_->actionMany(nodes, actionIds, amounts, applyFilter);
+}
+
 esp::sensor::Sensor& Simulator::addSensorToObject(
     const int objectId,
     const esp::sensor::SensorSpec::ptr& sensorSpec) {
@@ -7,6 +7,7 @@
 
 #include <Corrade/Utility/Assert.h>
 
+#include <map>
 #include <utility>
 #include "esp/agent/Agent.h"
 #include "esp/assets/ResourceManager.h"
@@ -18,6 +19,7 @@
 #include "esp/gfx/replay/Player.h"
 #include "esp/nav/PathFinder.h"
 #include "esp/physics/PhysicsManager.h"
+#include "esp/physics/PhysicsWorldPool.h"
 #include "esp/scene/SceneManager.h"
 #include "esp/scene/SceneNode.h"
 #include "esp/sensor/Sensor.h"
@@ -31,6 +33,7 @@ struct NavMeshSettings;
 class ActionSpacePathFinder;
 }  // namespace nav
 namespace scene {
+class ObjectControls;
 class SemanticScene;
 }  // namespace scene
 namespace gfx {
@@ -439,6 +442,22 @@ class Simulator {
    */
   double stepWorld(double dt = 1.0 / 60.0);
 
+  /**
+   * @brief Step the physical worlds of several simulators forward in time in
+   * parallel. Each simulator ends up in the same state as after calling @ref
+   * stepWorld on it. See @ref esp::physics::PhysicsWorldPool.
+   *
+   * Any background rendering of the simulators is waited for before stepping.
+   * @param simulators The simulators to step. Each may appear only once.
+   * @param pool The threads to step the worlds on.
+   * @param dt The desired amount of time to advance each physical world.
+   * @return The new world time of each simulator after stepping.
+   */
+  static std::vector<double> stepWorlds(
+      const std::vector<Simulator*>& simulators,
+      physics::PhysicsWorldPool& pool,
+      double dt = 1.0 / 60.0);
+
   /**
    * @brief Get the current time in the simulated world. This is always 0 if no
    * @ref esp::physics::PhysicsManager is initialized. See @ref stepWorld. See
@@ -506,6 +525,17 @@ class Simulator {
   bool recomputeNavMesh(nav::PathFinder& pathfinder,
                         const nav::NavMeshSettings& navMeshSettings);
 
+  /**
+   * @brief Compute a navmesh of the simulator's current active scene per
+   * entry of @p navMeshSettings, sharing the rasterization between entries
+   * where possible. See @ref nav::PathFinder::buildVariants.
+   * @param navMeshSettings The @ref nav::NavMeshSettings of each navmesh.
+   * @return A new @ref nav::PathFinder per entry of @p navMeshSettings,
+   * nullptr where the construction failed.
+   */
+  std::vector<nav::PathFinder::ptr> computeNavMeshVariants(
+      const std::vector<nav::NavMeshSettings>& navMeshSettings);
+
   /**
    * @brief Get the joined mesh data for all objects in the scene
    * @param includeStaticObjects flag to include static objects
@@ -513,6 +543,26 @@ class Simulator {
    */
   assets::MeshData::ptr getJoinedMesh(bool includeStaticObjects = false);
 
+  /**
+   * @brief Update the NavMesh of @ref pathfinder_ after a STATIC object was
+   * added, moved, removed or changed its motion type, without recomputing all
+   * of it.
+   *
+   * Only the NavMesh tiles around the object's bounds at the last successful
+   * NavMesh computation or update and its current bounds are rebuilt, see @ref
+   * nav::PathFinder::rebuildTiles, and only the stage and object triangles
+   * around those tiles are joined for it. Collision meshes are kept between
+   * calls until the next @ref recomputeNavMesh. This is only faster than
+   * @ref recomputeNavMesh if the NavMesh was computed with a non-zero @ref
+   * nav::NavMeshSettings::tileSize. Does nothing if the NavMesh was computed
+   * without @ref nav::NavMeshSettings::includeStaticObjects.
+   *
+   * @param objectId The id of a rigid or articulated object. Can also refer
+   * to an object which was removed since the NavMesh was computed.
+   * @return Whether or not the NavMesh update succeeded.
+   */
+  bool updateNavMeshForObject(int objectId);
+
   /**
    * @brief Get the joined semantic mesh data for all objects in the scene
    * @param[out] objectIds will be populated with the object ids for the
@@ -614,6 +664,36 @@ class Simulator {
                              scene::SceneNode& agentParentNode);
   agent::Agent::ptr addAgent(const agent::AgentConfiguration& agentConfig);
 
+  /**
+   * @brief Take one action for each of many agents in a single call.
+   *
+   * Agent @p agentIds[i] takes the action with handle @p actionIds[i], as
+   * returned by its @ref agent::Agent::getActionId. Body actions are filtered
+   * by the navmesh like @ref agent::Agent::act does. An agent can appear
+   * several times, its actions are then taken in order. All IDs are
+   * validated before any action is taken.
+   *
+   * @param agentIds IDs of the agents, as passed to @ref getAgent
+   * @param actionIds Action handles, one per entry of @p agentIds
+   */
+  void actMany(const std::vector<int>& agentIds,
+               const std::vector<int>& actionIds);
+
+  /**
+   * @brief Take one action on each of many scene nodes in a single call, for
+   * agents that aren't managed by the simulator such as the python ones.
+   *
+   * Same as @ref scene::ObjectControls::actionMany, with the move filtered by
+   * the navmesh if one is loaded, sliding as set in
+   * @ref SimulatorConfiguration::allowSliding.
+   *
+   * @return Whether each move collided.
+   */
+  std::vector<bool> actMany(const std::vector<scene::SceneNode*>& nodes,
+                            const std::vector<int>& actionIds,
+                            const std::vector<float>& amounts,
+                            const std::vector<bool>& applyFilter);
+
   /**
    * @brief Initialize sensor and attach to sceneNode of a particular object
    * @param objectId    Id of the object to which a sensor will be initialized
@@ -866,6 +946,44 @@ class Simulator {
     }
   }
 
+  /**
+   * @brief Get the world space bounds of an object's contribution to @ref
+   * getJoinedMesh, computed from its visual scene nodes. Empty if the object
+   * doesn't exist or isn't STATIC.
+   */
+  Corrade::Containers::Optional<Magnum::Range3D> getNavMeshObjectBB(
+      int objectId);
+
+  /**
+   * @brief The world transforms of the collision meshes of all STATIC rigid
+   * and articulated objects, by mesh asset handle, as joined by @ref
+   * getJoinedMesh.
+   */
+  std::map<std::string, std::vector<Eigen::Transform<float, 3, Eigen::Affine>>>
+  getStaticMeshComponents();
+
+  /**
+   * @brief Like @ref getJoinedMesh with STATIC objects, but only with the
+   * triangles whose XZ bounds overlap a region. Used by @ref
+   * updateNavMeshForObject to rebuild NavMesh tiles.
+   * @param regionMin Min corner of the region, Y is ignored.
+   * @param regionMax Max corner of the region, Y is ignored.
+   */
+  assets::MeshData::ptr getJoinedMeshInRegion(const vec3f& regionMin,
+                                              const vec3f& regionMax);
+
+  //! A collision mesh in @ref navMeshSourceMeshes_ and its local bounds.
+  struct NavMeshSourceMesh {
+    assets::MeshData::ptr mesh;
+    Eigen::AlignedBox3f bounds;
+  };
+
+  /**
+   * @brief The collision mesh of an asset and its bounds, created on first
+   * use and kept in @ref navMeshSourceMeshes_.
+   */
+  const NavMeshSourceMesh& getNavMeshSourceMesh(const std::string& meshHandle);
+
   /**
    * @brief Builds a scene instance and populates it with initial object
    * layout, if appropriate, based on @ref
@@ -1005,6 +1123,9 @@ class Simulator {
   SimulatorConfiguration config_;
 
   std::vector<agent::Agent::ptr> agents_;
+  //! Controls of the nodes passed to @ref actMany, filtered by pathfinder_.
+  //! Created on first use.
+  std::shared_ptr<scene::ObjectControls> nodeControls_;
 
   nav::PathFinder::ptr pathfinder_;
   // state indicating frustum culling is enabled or not
@@ -1022,6 +1143,16 @@ class Simulator {
   int navMeshVisPrimID_ = esp::ID_UNDEFINED;
   esp::scene::SceneNode* navMeshVisNode_ = nullptr;
 
+  //! Bounds of the STATIC objects at the last NavMesh computation of @ref
+  //! pathfinder_, used to find the tiles to update in @ref
+  //! updateNavMeshForObject. Keyed by object id.
+  std::unordered_map<int, Magnum::Range3D> navMeshObjectBBs_;
+
+  //! Collision meshes of the stage and the STATIC objects by asset handle,
+  //! so @ref updateNavMeshForObject doesn't have to join them again. Cleared
+  //! with @ref navMeshObjectBBs_.
+  std::unordered_map<std::string, NavMeshSourceMesh> navMeshSourceMeshes_;
+
   /**
    * @brief Tracks whether or not the simulator was initialized
    * to load textures.  Because we cache mesh loading, this should
@@ -23,6 +23,7 @@ bool operator==(const SimulatorConfiguration& a,
          a.leaveContextWithBackgroundRenderer ==
              b.leaveContextWithBackgroundRenderer &&
          a.useSemanticTexturesIfFound == b.useSemanticTexturesIfFound &&
+         a.memoryMapNavMesh == b.memoryMapNavMesh &&
          a.sceneDatasetConfigFile == b.sceneDatasetConfigFile &&
          a.physicsConfigFile == b.physicsConfigFile &&
          a.overrideSceneLightDefaults == b.overrideSceneLightDefaults &&
@@ -95,6 +95,13 @@ struct SimulatorConfiguration {
    */
   bool useSemanticTexturesIfFound = true;
 
+  /**
+   * @brief Memory map the scene's navmesh instead of reading it, see
+   * @ref nav::PathFinder::loadNavMesh. Saves memory when many simulators load
+   * the same scene.
+   */
+  bool memoryMapNavMesh = false;
+
   /**
    * @brief Optionally provide a pre-configured NavMeshSettings. If provided,
    * the NavMesh will be recomputed with the provided settings if A. no NavMesh
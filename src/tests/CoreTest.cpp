@@ -3,8 +3,11 @@
 // LICENSE file in the root directory of this source tree.
 
 #include <Corrade/TestSuite/Tester.h>
+#include <algorithm>
+#include <stdexcept>
 #include "esp/core/Configuration.h"
 #include "esp/core/Esp.h"
+#include "esp/core/ThreadPool.h"
 
 using namespace esp::core::config;
 
@@ -15,11 +18,13 @@ struct CoreTest : Cr::TestSuite::Tester {
 
   void TestConfiguration();
 
+  void TestThreadPool();
+
   esp::logging::LoggingContext loggingContext_;
 };  // struct CoreTest
 
 CoreTest::CoreTest() {
-  addTests({&CoreTest::TestConfiguration});
+  addTests({&CoreTest::TestConfiguration, &CoreTest::TestThreadPool});
 }
 
 void CoreTest::TestConfiguration() {
@@ -40,6 +45,54 @@ void CoreTest::TestConfiguration() {
   CORRADE_COMPARE(cfg.get<std::string>("myString"), "test");
 }
 
+void CoreTest::TestThreadPool() {
+  esp::core::ThreadPool pool{4};
+  CORRADE_COMPARE(pool.numThreads(), 4);
+
+  // every index is visited exactly once and by a valid thread
+  std::vector<int> visits(1000, 0);
+  std::vector<int> threadIndices(visits.size(), -1);
+  pool.parallelFor(visits.size(), [&](size_t i, int threadIndex) {
+    ++visits[i];
+    threadIndices[i] = threadIndex;
+  });
+  for (size_t i = 0; i < visits.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(visits[i], 1);
+    CORRADE_VERIFY(threadIndices[i] >= 0 && threadIndices[i] < 4);
+  }
+
+  // exceptions are propagated to the calling thread
+  bool caught = false;
+  try {
+    pool.parallelFor(100, [](size_t i, int) {
+      if (i == 50) {
+        throw std::runtime_error("expected");
+      }
+    });
+  } catch (const std::runtime_error&) {
+    caught = true;
+  }
+  CORRADE_VERIFY(caught);
+
+  // the pool is still usable afterwards
+  std::fill(visits.begin(), visits.end(), 0);
+  pool.parallelFor(visits.size(), [&](size_t i, int) { ++visits[i]; });
+  for (size_t i = 0; i < visits.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(visits[i], 1);
+  }
+
+  // a single-thread pool runs everything inline on the calling thread
+  int sum = 0;
+  esp::core::ThreadPool inlinePool{1};
+  inlinePool.parallelFor(10, [&](size_t i, int threadIndex) {
+    CORRADE_COMPARE(threadIndex, 0);
+    sum += i;
+  });
+  CORRADE_COMPARE(sum, 45);
+}
+
 }  // namespace
 
 CORRADE_TEST_MAIN(CoreTest)
@@ -2,6 +2,8 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/Path.h>
@@ -34,13 +36,15 @@ struct NavTest : Cr::TestSuite::Tester {
   void PathFinderTestSeed();
 
   void PathFinderTestMeshData();
+  void PathFinderTestMeshGeometry();
   esp::logging::LoggingContext loggingContext;
 };
 
 NavTest::NavTest() {
   addTests({&NavTest::PathFinderLoadTest, &NavTest::PathFinderTestCases,
             &NavTest::PathFinderTestNonNavigable, &NavTest::PathFinderTestSeed,
-            &NavTest::PathFinderTestMeshData});
+            &NavTest::PathFinderTestMeshData,
+            &NavTest::PathFinderTestMeshGeometry});
 }  // namespace Test
 
 void NavTest::PathFinderLoadTest() {
@@ -187,6 +191,68 @@ void NavTest::PathFinderTestMeshData() {
   CORRADE_COMPARE(meshData->vbo.size(), 63);
   CORRADE_COMPARE(meshData->ibo.size(), 63);
 }
+
+void NavTest::PathFinderTestMeshGeometry() {
+  esp::nav::PathFinder pf;
+  CORRADE_VERIFY(!pf.getNavMeshGeometry());
+  pf.loadNavMesh(Cr::Utility::Path::join(
+      SCENE_DATASETS, "habitat-test-scenes/skokloster-castle.navmesh"));
+
+  const auto geometry = pf.getNavMeshGeometry();
+  CORRADE_VERIFY(geometry);
+  // Same triangles as the triangle soup, with shared vertices
+  CORRADE_COMPARE(geometry->indices.size(), 1155);
+  CORRADE_COMPARE_AS(geometry->vertices.size(), 1155,
+                     Cr::TestSuite::Compare::Less);
+  CORRADE_COMPARE(geometry->islandIndexOffsets.size(), pf.numIslands() + 1);
+  CORRADE_COMPARE(geometry->islandIndexOffsets.front(), 0);
+  for (int i = 0; i < pf.numIslands(); ++i) {
+    CORRADE_ITERATION(i);
+    // Island ranges expand to the same triangle soup
+    const esp::assets::MeshData::ptr meshData = pf.getNavMeshData(i);
+    CORRADE_COMPARE(geometry->islandIndexOffsets[i + 1] -
+                        geometry->islandIndexOffsets[i],
+                    meshData->ibo.size());
+    for (size_t j = 0; j < meshData->vbo.size(); ++j) {
+      const uint32_t index =
+          geometry->indices[geometry->islandIndexOffsets[i] + j];
+      CORRADE_VERIFY(geometry->vertices[index].isApprox(meshData->vbo[j]));
+    }
+  }
+  for (const uint32_t index : geometry->indices) {
+    CORRADE_COMPARE_AS(index, geometry->vertices.size(),
+                       Cr::TestSuite::Compare::Less);
+  }
+  // Cached until the navmesh changes
+  CORRADE_COMPARE(pf.getNavMeshGeometry(), geometry);
+
+  const std::string plyFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "test_navmesh_export.ply");
+  CORRADE_VERIFY(pf.exportNavMeshGeometry(plyFile));
+  const Cr::Containers::Optional<Cr::Containers::String> ply =
+      Cr::Utility::Path::readString(plyFile);
+  CORRADE_VERIFY(ply);
+  CORRADE_VERIFY(ply->hasPrefix("ply\nformat binary_little_endian 1.0\n"));
+  CORRADE_VERIFY(Cr::Utility::Path::remove(plyFile));
+
+  const std::string glbFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "test_navmesh_export.glb");
+  CORRADE_VERIFY(pf.exportNavMeshGeometry(glbFile, 0));
+  const Cr::Containers::Optional<Cr::Containers::String> glb =
+      Cr::Utility::Path::readString(glbFile);
+  CORRADE_VERIFY(glb);
+  CORRADE_VERIFY(glb->hasPrefix("glTF"));
+  CORRADE_COMPARE(glb->size() % 4, 0);
+  CORRADE_VERIFY(Cr::Utility::Path::remove(glbFile));
+
+  CORRADE_VERIFY(!pf.exportNavMeshGeometry(
+      Cr::Utility::Path::join(TEST_ASSETS, "test_navmesh_export.obj")));
+
+  pf.loadNavMesh(Cr::Utility::Path::join(
+      SCENE_DATASETS, "habitat-test-scenes/van-gogh-room.navmesh"));
+  CORRADE_VERIFY(pf.getNavMeshGeometry() != geometry);
+  CORRADE_COMPARE(pf.getNavMeshGeometry()->indices.size(), 63);
+}
 }  // namespace
 
 CORRADE_TEST_MAIN(NavTest)
@@ -0,0 +1,289 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/Path.h>
+
+#include <esp/nav/PathFinder.h>
+
+#include "configure.h"
+
+namespace Cr = Corrade;
+
+namespace {
+
+// Allocations made through operator new, counted by the allocation
+// benchmarks. Detour allocates with malloc and isn't included, but it only
+// does so when loading a navmesh or creating a query.
+std::atomic<std::uint64_t> allocationCount{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocationCount;
+  if (void* ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+constexpr struct {
+  const char* name;
+  const char* navmesh;
+} SceneData[]{
+    {"skokloster-castle", "habitat-test-scenes/skokloster-castle.navmesh"},
+    {"van-gogh-room", "habitat-test-scenes/van-gogh-room.navmesh"},
+    {"apartment_1", "habitat-test-scenes/apartment_1.navmesh"},
+};
+
+//! Number of precomputed query inputs the benchmarks cycle through.
+constexpr int NumQueries = 256;
+
+struct PathFinderBenchmark : Cr::TestSuite::Tester {
+  explicit PathFinderBenchmark();
+
+  void findPath();
+  void multiGoalPath();
+  void tryStep();
+  void tryStepFromPoly();
+  void snapPoint();
+  void randomNavigablePoint();
+  void randomNavigablePointIsland();
+  void distanceToClosestObstacle();
+  void topDownView();
+  void loadNavMesh();
+
+  void allocationsBegin();
+  std::uint64_t allocationsEnd();
+
+  //! The navmesh of the current instance, skipping the test case if the
+  //! scene isn't downloaded.
+  std::string navmeshFile();
+  void loadScene(esp::nav::PathFinder& pathFinder);
+  std::vector<esp::vec3f> randomPoints(esp::nav::PathFinder& pathFinder,
+                                       int islandIndex = esp::ID_UNDEFINED);
+
+  std::uint64_t allocationCountBegin_ = 0;
+};
+
+PathFinderBenchmark::PathFinderBenchmark() {
+  const std::initializer_list<void (PathFinderBenchmark::*)()> benchmarks{
+      &PathFinderBenchmark::findPath,
+      &PathFinderBenchmark::multiGoalPath,
+      &PathFinderBenchmark::tryStep,
+      &PathFinderBenchmark::tryStepFromPoly,
+      &PathFinderBenchmark::snapPoint,
+      &PathFinderBenchmark::randomNavigablePoint,
+      &PathFinderBenchmark::randomNavigablePointIsland,
+      &PathFinderBenchmark::distanceToClosestObstacle,
+      &PathFinderBenchmark::topDownView,
+      &PathFinderBenchmark::loadNavMesh};
+
+  // Time per operation, then allocations per operation
+  addInstancedBenchmarks(benchmarks, 10,
+                         Cr::Containers::arraySize(SceneData));
+  addCustomInstancedBenchmarks(
+      benchmarks, 1, Cr::Containers::arraySize(SceneData),
+      &PathFinderBenchmark::allocationsBegin,
+      &PathFinderBenchmark::allocationsEnd, BenchmarkUnits::Count);
+}
+
+void PathFinderBenchmark::allocationsBegin() {
+  setBenchmarkName("allocations");
+  allocationCountBegin_ = allocationCount;
+}
+
+std::uint64_t PathFinderBenchmark::allocationsEnd() {
+  return allocationCount - allocationCountBegin_;
+}
+
+std::string PathFinderBenchmark::navmeshFile() {
+  auto&& data = SceneData[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  const std::string file =
+      Cr::Utility::Path::join(SCENE_DATASETS, data.navmesh);
+  if (!Cr::Utility::Path::exists(file))
+    CORRADE_SKIP(file << "not found");
+  return file;
+}
+
+void PathFinderBenchmark::loadScene(esp::nav::PathFinder& pathFinder) {
+  CORRADE_VERIFY(pathFinder.loadNavMesh(navmeshFile()));
+  pathFinder.seed(0);
+}
+
+std::vector<esp::vec3f> PathFinderBenchmark::randomPoints(
+    esp::nav::PathFinder& pathFinder,
+    const int islandIndex) {
+  std::vector<esp::vec3f> points;
+  points.reserve(NumQueries);
+  for (int i = 0; i < NumQueries; ++i) {
+    points.push_back(pathFinder.getRandomNavigablePoint(10, islandIndex));
+  }
+  return points;
+}
+
+void PathFinderBenchmark::findPath() {
+  esp::nav::PathFinder pathFinder;
+  loadScene(pathFinder);
+  const std::vector<esp::vec3f> starts = randomPoints(pathFinder);
+  const std::vector<esp::vec3f> ends = randomPoints(pathFinder);
+
+  esp::nav::ShortestPath path;
+  int i = 0, numFound = 0;
+  CORRADE_BENCHMARK(NumQueries) {
+    path.requestedStart = starts[i];
+    path.requestedEnd = ends[i];
+    numFound += pathFinder.findPath(path);
+    i = (i + 1) % NumQueries;
+  }
+  CORRADE_VERIFY(numFound > 0);
+}
+
+void PathFinderBenchmark::multiGoalPath() {
+  esp::nav::PathFinder pathFinder;
+  loadScene(pathFinder);
+  const std::vector<esp::vec3f> starts = randomPoints(pathFinder);
+
+  esp::nav::MultiGoalShortestPath path;
+  path.setRequestedEnds(randomPoints(pathFinder));
+  int i = 0, numFound = 0;
+  CORRADE_BENCHMARK(10) {
+    path.requestedStart = starts[i];
+    numFound += pathFinder.findPath(path);
+    i = (i + 1) % NumQueries;
+  }
+  CORRADE_VERIFY(numFound > 0);
+}
+
+void PathFinderBenchmark::tryStep() {
+  esp::nav::PathFinder pathFinder;
+  loadScene(pathFinder);
+  const std::vector<esp::vec3f> starts = randomPoints(pathFinder);
+
+  const esp::vec3f step{0.25f, 0.0f, 0.0f};
+  esp::vec3f sum = esp::vec3f::Zero();
+  int i = 0;
+  CORRADE_BENCHMARK(NumQueries) {
+    sum += pathFinder.tryStep(starts[i], esp::vec3f{starts[i] + step});
+    i = (i + 1) % NumQueries;
+  }
+  CORRADE_VERIFY(sum.allFinite());
+}
+
+void PathFinderBenchmark::tryStepFromPoly() {
+  esp::nav::PathFinder pathFinder;
+  loadScene(pathFinder);
+
+  // An agent walking back and forth, keeping the polygon it ended on
+  esp::vec3f pos = pathFinder.getRandomNavigablePoint();
+  const esp::vec3f steps[]{{0.25f, 0.0f, 0.0f}, {-0.25f, 0.0f, 0.0f}};
+  uint64_t polyRef = 0;
+  int i = 0;
+  CORRADE_BENCHMARK(NumQueries) {
+    pos = pathFinder.tryStep(pos, esp::vec3f{pos + steps[(i++ / 8) % 2]},
+                             polyRef);
+  }
+  CORRADE_VERIFY(polyRef != 0);
+}
+
+void PathFinderBenchmark::snapPoint() {
+  esp::nav::PathFinder pathFinder;
+  loadScene(pathFinder);
+  std::vector<esp::vec3f> points = randomPoints(pathFinder);
+  for (esp::vec3f& point : points) {
+    point += esp::vec3f{0.1f, 0.5f, 0.1f};
+  }
+
+  esp::vec3f sum = esp::vec3f::Zero();
+  int i = 0;
+  CORRADE_BENCHMARK(NumQueries) {
+    sum += pathFinder.snapPoint(points[i]);
+    i = (i + 1) % NumQueries;
+  }
+  CORRADE_VERIFY(sum.allFinite());
+}
+
+void PathFinderBenchmark::randomNavigablePoint() {
+  esp::nav::PathFinder pathFinder;
+  loadScene(pathFinder);
+
+  esp::vec3f sum = esp::vec3f::Zero();
+  CORRADE_BENCHMARK(NumQueries) {
+    sum += pathFinder.getRandomNavigablePoint();
+  }
+  CORRADE_VERIFY(sum.allFinite());
+}
+
+void PathFinderBenchmark::randomNavigablePointIsland() {
+  esp::nav::PathFinder pathFinder;
+  loadScene(pathFinder);
+
+  int largestIsland = 0;
+  for (int island = 1; island < pathFinder.numIslands(); ++island) {
+    if (pathFinder.islandRadius(island) >
+        pathFinder.islandRadius(largestIsland))
+      largestIsland = island;
+  }
+
+  esp::vec3f sum = esp::vec3f::Zero();
+  CORRADE_BENCHMARK(NumQueries) {
+    sum += pathFinder.getRandomNavigablePoint(10, largestIsland);
+  }
+  CORRADE_VERIFY(sum.allFinite());
+}
+
+void PathFinderBenchmark::distanceToClosestObstacle() {
+  esp::nav::PathFinder pathFinder;
+  loadScene(pathFinder);
+  const std::vector<esp::vec3f> points = randomPoints(pathFinder);
+
+  float sum = 0.0f;
+  int i = 0;
+  CORRADE_BENCHMARK(NumQueries) {
+    sum += pathFinder.distanceToClosestObstacle(points[i]);
+    i = (i + 1) % NumQueries;
+  }
+  CORRADE_VERIFY(sum > 0.0f);
+}
+
+void PathFinderBenchmark::topDownView() {
+  esp::nav::PathFinder pathFinder;
+  loadScene(pathFinder);
+  const float height = pathFinder.getRandomNavigablePoint()[1];
+
+  Eigen::Index numNavigable = 0;
+  CORRADE_BENCHMARK(1) {
+    numNavigable += pathFinder.getTopDownView(0.1f, height).count();
+  }
+  CORRADE_VERIFY(numNavigable > 0);
+}
+
+void PathFinderBenchmark::loadNavMesh() {
+  const std::string file = navmeshFile();
+
+  esp::nav::PathFinder pathFinder;
+  bool loaded = true;
+  CORRADE_BENCHMARK(1) { loaded = loaded && pathFinder.loadNavMesh(file); }
+  CORRADE_VERIFY(loaded);
+}
+
+}  // namespace
+
+CORRADE_TEST_MAIN(PathFinderBenchmark)
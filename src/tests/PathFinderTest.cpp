@@ -2,10 +2,14 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <thread>
+
 #include <Corrade/Containers/ArrayView.h>
+#include <Corrade/TestSuite/Compare/File.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 
+#include <esp/assets/MeshData.h>
 #include <esp/nav/PathFinder.h>
 
 #include <Corrade/Utility/Path.h>
@@ -25,6 +29,36 @@ const std::string skokloster =
     Cr::Utility::Path::join(SCENE_DATASETS,
                             "habitat-test-scenes/skokloster-castle.navmesh");
 
+// Add an upward facing XZ-plane rectangle at height max[1]
+void addFloor(esp::assets::MeshData& mesh,
+              const esp::vec3f& min,
+              const esp::vec3f& max) {
+  const uint32_t base = mesh.vbo.size();
+  mesh.vbo.emplace_back(min[0], max[1], min[2]);
+  mesh.vbo.emplace_back(min[0], max[1], max[2]);
+  mesh.vbo.emplace_back(max[0], max[1], max[2]);
+  mesh.vbo.emplace_back(max[0], max[1], min[2]);
+  for (uint32_t i : {0, 1, 2, 0, 2, 3}) {
+    mesh.ibo.push_back(base + i);
+  }
+}
+
+// Add the top and the side faces of an axis-aligned box
+void addBox(esp::assets::MeshData& mesh,
+            const esp::vec3f& min,
+            const esp::vec3f& max) {
+  addFloor(mesh, min, max);
+  const uint32_t base = mesh.vbo.size();
+  for (int i = 0; i < 8; ++i) {
+    mesh.vbo.emplace_back(i & 1 ? max[0] : min[0], i & 2 ? max[1] : min[1],
+                          i & 4 ? max[2] : min[2]);
+  }
+  for (uint32_t i : {0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 2, 6, 0, 6, 4,
+                     1, 5, 7, 1, 7, 3}) {
+    mesh.ibo.push_back(base + i);
+  }
+}
+
 constexpr struct {
   const char* name;
   bool cache;
@@ -36,7 +70,23 @@ struct PathFinderTest : Cr::TestSuite::Tester {
 
   void bounds();
   void tryStepNoSliding();
+  void tryStepFromPoly();
   void multiGoalPath();
+  void multiGoalDistanceField();
+  void findPathsBatch();
+  void distanceField();
+  void rebuildTiles();
+  void rebuildTilesPartialMesh();
+  void parallelTiledBuild();
+  void buildVariants();
+  void topDownView();
+  void memoryMappedLoad();
+  void islandSampling();
+  void batchedPointQueries();
+  void obstacleDistanceField();
+  void queryContexts();
+  void pathHierarchy();
+  void pathHierarchyLongCorridor();
 
   void benchmarkSingleGoal();
   void benchmarkMultiGoal();
@@ -50,7 +100,20 @@ struct PathFinderTest : Cr::TestSuite::Tester {
 
 PathFinderTest::PathFinderTest() {
   addTests({&PathFinderTest::bounds, &PathFinderTest::tryStepNoSliding,
-            &PathFinderTest::multiGoalPath, &PathFinderTest::testCaching,
+            &PathFinderTest::tryStepFromPoly,
+            &PathFinderTest::multiGoalPath,
+            &PathFinderTest::multiGoalDistanceField,
+            &PathFinderTest::findPathsBatch,
+            &PathFinderTest::distanceField, &PathFinderTest::rebuildTiles,
+            &PathFinderTest::rebuildTilesPartialMesh,
+            &PathFinderTest::parallelTiledBuild, &PathFinderTest::buildVariants,
+            &PathFinderTest::topDownView,
+            &PathFinderTest::memoryMappedLoad, &PathFinderTest::islandSampling,
+            &PathFinderTest::batchedPointQueries,
+            &PathFinderTest::obstacleDistanceField,
+            &PathFinderTest::queryContexts, &PathFinderTest::pathHierarchy,
+            &PathFinderTest::pathHierarchyLongCorridor,
+            &PathFinderTest::testCaching,
             &PathFinderTest::navMeshSettingsTestJSON});
 
   addBenchmarks({&PathFinderTest::benchmarkSingleGoal}, 1000);
@@ -101,6 +164,56 @@ void PathFinderTest::tryStepNoSliding() {
   }
 }
 
+void PathFinderTest::tryStepFromPoly() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  pathFinder.seed(0);
+  pathFinder.setNumThreads(4);
+
+  // Walking with and without the cached polygon gives the same results,
+  // including the nudge off of thin walls, which alone moves points by 1e-4
+  const Mn::Vector3 stepDirs[]{{0, 0, -0.25f}, {0.25f, 0, 0}};
+  Eigen::RowMatrixX3f starts(100, 3), ends(100, 3);
+  Eigen::Matrix<uint64_t, Eigen::Dynamic, 1> polyRefs(100);
+  for (int i = 0; i < 100; ++i) {
+    CORRADE_ITERATION(i);
+    Mn::Vector3 pos{pathFinder.getRandomNavigablePoint()};
+    Mn::Vector3 cachedPos = pos;
+    uint64_t polyRef = 0;
+    for (int j = 0; j < 20; ++j) {
+      const Mn::Vector3 stepDir = stepDirs[j / 10];
+      pos = pathFinder.tryStep(pos, pos + stepDir);
+      cachedPos = pathFinder.tryStep(cachedPos, cachedPos + stepDir, polyRef);
+      CORRADE_VERIFY(polyRef != 0);
+      CORRADE_COMPARE_AS((pos - cachedPos).length(), 1e-5f,
+                         Cr::TestSuite::Compare::Less);
+    }
+
+    starts.row(i) = Mn::EigenIntegration::cast<esp::vec3f>(cachedPos);
+    ends.row(i) = Mn::EigenIntegration::cast<esp::vec3f>(cachedPos +
+                                                        stepDirs[i % 2]);
+    // Every other cached polygon is stale, which must be detected
+    polyRefs[i] = i % 2 ? polyRefs[i - 1] : polyRef;
+  }
+
+  // The batch matches the serial steps and updates the cached polygons
+  Eigen::Matrix<uint64_t, Eigen::Dynamic, 1> batchPolyRefs = polyRefs;
+  const Eigen::RowMatrixX3f stepped =
+      pathFinder.tryStepBatch(starts, ends, batchPolyRefs);
+  for (int i = 0; i < starts.rows(); ++i) {
+    CORRADE_ITERATION(i);
+    uint64_t polyRef = polyRefs[i];
+    const esp::vec3f expected = pathFinder.tryStep(
+        esp::vec3f{starts.row(i)}, esp::vec3f{ends.row(i)}, polyRef);
+    CORRADE_VERIFY(esp::vec3f{stepped.row(i)}.isApprox(expected));
+    CORRADE_COMPARE(batchPolyRefs[i], polyRef);
+    const esp::vec3f uncached = pathFinder.tryStep(esp::vec3f{starts.row(i)},
+                                                   esp::vec3f{ends.row(i)});
+    CORRADE_COMPARE_AS((expected - uncached).norm(), 1e-5f,
+                       Cr::TestSuite::Compare::Less);
+  }
+}
+
 void PathFinderTest::multiGoalPath() {
   esp::nav::PathFinder pathFinder;
   pathFinder.loadNavMesh(skokloster);
@@ -135,6 +248,824 @@ void PathFinderTest::multiGoalPath() {
   }
 }
 
+void PathFinderTest::multiGoalDistanceField() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  std::vector<esp::vec3f> goals;
+  for (int i = 0; i < 100; ++i) {
+    goals.emplace_back(pathFinder.getRandomNavigablePoint());
+  }
+  esp::nav::MultiGoalShortestPath fieldPath;
+  fieldPath.useDistanceField = true;
+  fieldPath.setRequestedEnds(goals);
+  esp::nav::MultiGoalShortestPath path;
+  path.setRequestedEnds(goals);
+
+  // The same ends are reused for every start
+  for (int i = 0; i < 200; ++i) {
+    CORRADE_ITERATION(i);
+    path.requestedStart = fieldPath.requestedStart =
+        pathFinder.getRandomNavigablePoint();
+    const bool found = pathFinder.findPath(path);
+    CORRADE_COMPARE(pathFinder.findPath(fieldPath), found);
+    if (!found)
+      continue;
+
+    // A string-pulled path to one of the ends, close to the shortest one
+    CORRADE_VERIFY(fieldPath.closestEndPointIndex >= 0);
+    CORRADE_COMPARE_AS(fieldPath.geodesicDistance,
+                       1.1f * path.geodesicDistance + 0.25f,
+                       Cr::TestSuite::Compare::LessOrEqual);
+    CORRADE_COMPARE_AS(fieldPath.geodesicDistance,
+                       0.9f * path.geodesicDistance - 0.25f,
+                       Cr::TestSuite::Compare::GreaterOrEqual);
+    CORRADE_VERIFY(fieldPath.points.front().isApprox(fieldPath.requestedStart));
+    CORRADE_VERIFY(fieldPath.points.back().isApprox(
+        fieldPath.getRequestedEnds()[fieldPath.closestEndPointIndex]));
+  }
+}
+
+void PathFinderTest::findPathsBatch() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+  pathFinder.setNumThreads(4);
+  CORRADE_COMPARE(pathFinder.getNumThreads(), 4);
+
+  std::vector<esp::vec3f> starts, ends;
+  std::vector<esp::nav::ShortestPath> paths(500);
+  for (auto& path : paths) {
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    path.requestedEnd = pathFinder.getRandomNavigablePoint();
+    starts.push_back(path.requestedStart);
+    ends.push_back(path.requestedEnd);
+  }
+  // one query that can't be snapped to the navmesh
+  paths.back().requestedStart = starts.back() = esp::vec3f{1e5, 1e5, 1e5};
+
+  const std::vector<bool> found = pathFinder.findPaths(paths);
+  const std::vector<float> distances =
+      pathFinder.geodesicDistances(starts, ends);
+  CORRADE_COMPARE(found.size(), paths.size());
+  CORRADE_COMPARE(distances.size(), paths.size());
+
+  // results must match the serial API and be in input order
+  for (size_t i = 0; i < paths.size(); ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::ShortestPath serialPath;
+    serialPath.requestedStart = starts[i];
+    serialPath.requestedEnd = ends[i];
+    CORRADE_COMPARE(found[i], pathFinder.findPath(serialPath));
+    CORRADE_COMPARE(paths[i].geodesicDistance, serialPath.geodesicDistance);
+    CORRADE_COMPARE(distances[i], serialPath.geodesicDistance);
+    CORRADE_COMPARE(paths[i].points.size(), serialPath.points.size());
+  }
+  CORRADE_VERIFY(!found.back());
+}
+
+void PathFinderTest::distanceField() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  std::vector<esp::vec3f> goals;
+  for (int i = 0; i < 5; ++i) {
+    goals.emplace_back(pathFinder.getRandomNavigablePoint());
+  }
+  esp::nav::GeodesicDistanceField::ptr field =
+      pathFinder.computeDistanceField(goals);
+  CORRADE_VERIFY(field);
+  CORRADE_COMPARE(field->getGoals().size(), goals.size());
+
+  esp::nav::MultiGoalShortestPath path;
+  path.setRequestedEnds(goals);
+  for (int i = 0; i < 200; ++i) {
+    CORRADE_ITERATION(i);
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    const bool found = pathFinder.findPath(path);
+    const float fieldDist = field->distanceTo(path.requestedStart);
+    if (!found) {
+      CORRADE_COMPARE(fieldDist, std::numeric_limits<float>::infinity());
+      continue;
+    }
+    // The field never underestimates and stays close to the exact distance
+    CORRADE_COMPARE_AS(fieldDist, path.geodesicDistance - 1e-3f,
+                       Cr::TestSuite::Compare::GreaterOrEqual);
+    CORRADE_COMPARE_AS(fieldDist, 1.1f * path.geodesicDistance + 0.25f,
+                       Cr::TestSuite::Compare::LessOrEqual);
+  }
+
+  // the goals themselves are at distance 0
+  for (const esp::vec3f& goal : goals) {
+    CORRADE_COMPARE_AS(field->distanceTo(goal), 1e-3f,
+                       Cr::TestSuite::Compare::Less);
+  }
+}
+
+void PathFinderTest::rebuildTiles() {
+  esp::nav::NavMeshSettings settings;
+  settings.setDefaults();
+  settings.tileSize = 32;
+
+  esp::assets::MeshData floor;
+  addFloor(floor, {-5, 0, -5}, {5, 0, 5});
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.build(settings, floor));
+  CORRADE_COMPARE(pathFinder.numIslands(), 1);
+
+  const esp::vec3f start{0, 0, 1};
+  const esp::vec3f end{2, 0, 1};
+  const esp::vec3f boxMin{0.5, 0, 0.5};
+  const esp::vec3f boxMax{1.5, 2, 1.5};
+  const esp::vec3f insideBox{1, 0, 1};
+  CORRADE_VERIFY(pathFinder.isNavigable(insideBox));
+
+  // Put a box between start and end and only update the tiles around it
+  esp::assets::MeshData floorWithBox = floor;
+  addBox(floorWithBox, boxMin, boxMax);
+  CORRADE_VERIFY(pathFinder.rebuildTiles(floorWithBox, boxMin, boxMax));
+  CORRADE_VERIFY(!pathFinder.isNavigable(insideBox));
+
+  esp::nav::ShortestPath path;
+  path.requestedStart = start;
+  path.requestedEnd = end;
+  CORRADE_VERIFY(pathFinder.findPath(path));
+  CORRADE_COMPARE_AS(path.geodesicDistance, 2.5f,
+                     Cr::TestSuite::Compare::Greater);
+
+  // The result matches building everything from scratch
+  esp::nav::PathFinder fullPathFinder;
+  CORRADE_VERIFY(fullPathFinder.build(settings, floorWithBox));
+  CORRADE_COMPARE_WITH(pathFinder.getNavigableArea(),
+                       fullPathFinder.getNavigableArea(),
+                       Cr::TestSuite::Compare::around(0.01f));
+  esp::nav::ShortestPath fullPath;
+  fullPath.requestedStart = start;
+  fullPath.requestedEnd = end;
+  CORRADE_VERIFY(fullPathFinder.findPath(fullPath));
+  CORRADE_COMPARE_WITH(path.geodesicDistance, fullPath.geodesicDistance,
+                       Cr::TestSuite::Compare::around(0.01f));
+
+  // Removing the box again restores the direct path
+  CORRADE_VERIFY(pathFinder.rebuildTiles(floor, boxMin, boxMax));
+  CORRADE_VERIFY(pathFinder.isNavigable(insideBox));
+  CORRADE_VERIFY(pathFinder.findPath(path));
+  CORRADE_COMPARE_WITH(path.geodesicDistance, 2.0f,
+                       Cr::TestSuite::Compare::around(0.01f));
+}
+
+void PathFinderTest::rebuildTilesPartialMesh() {
+  esp::nav::NavMeshSettings settings;
+  settings.setDefaults();
+  settings.tileSize = 32;
+
+  // Two floors far apart are separate islands
+  esp::assets::MeshData floors;
+  addFloor(floors, {-5, 0, -5}, {5, 0, 5});
+  addFloor(floors, {20, 0, -5}, {25, 0, 5});
+  const esp::vec3f boxMin{0.5, 0, 0.5};
+  const esp::vec3f boxMax{1.5, 2, 1.5};
+  esp::assets::MeshData floorsWithBox = floors;
+  addBox(floorsWithBox, boxMin, boxMax);
+
+  esp::nav::PathFinder fullMeshPathFinder;
+  esp::nav::PathFinder partialMeshPathFinder;
+  for (esp::nav::PathFinder* pathFinder :
+       {&fullMeshPathFinder, &partialMeshPathFinder}) {
+    CORRADE_VERIFY(pathFinder->build(settings, floors));
+    CORRADE_VERIFY(pathFinder->buildPathHierarchy(8));
+    CORRADE_VERIFY(pathFinder->buildObstacleDistanceField(0.1f, 1.0f));
+  }
+  CORRADE_COMPARE(partialMeshPathFinder.numIslands(), 2);
+
+  // Only the triangles around the rebuilt tiles are needed
+  const std::pair<esp::vec3f, esp::vec3f> region =
+      partialMeshPathFinder.getRebuildRegion(boxMin, boxMax);
+  CORRADE_VERIFY(region.first[0] < boxMin[0] && region.second[0] > boxMax[0]);
+  CORRADE_VERIFY(region.second[0] < 20.0f);
+  esp::assets::MeshData partialMesh;
+  for (size_t i = 0; i < floorsWithBox.ibo.size(); i += 3) {
+    esp::vec3f triMin = floorsWithBox.vbo[floorsWithBox.ibo[i]];
+    esp::vec3f triMax = triMin;
+    for (size_t j = i + 1; j < i + 3; ++j) {
+      triMin = triMin.cwiseMin(floorsWithBox.vbo[floorsWithBox.ibo[j]]);
+      triMax = triMax.cwiseMax(floorsWithBox.vbo[floorsWithBox.ibo[j]]);
+    }
+    if (triMax[0] < region.first[0] || triMin[0] > region.second[0] ||
+        triMax[2] < region.first[2] || triMin[2] > region.second[2])
+      continue;
+    for (size_t j = i; j < i + 3; ++j) {
+      partialMesh.ibo.push_back(partialMesh.vbo.size());
+      partialMesh.vbo.push_back(floorsWithBox.vbo[floorsWithBox.ibo[j]]);
+    }
+  }
+  CORRADE_COMPARE_AS(partialMesh.ibo.size(), floorsWithBox.ibo.size(),
+                     Cr::TestSuite::Compare::Less);
+
+  CORRADE_VERIFY(
+      fullMeshPathFinder.rebuildTiles(floorsWithBox, boxMin, boxMax));
+  CORRADE_VERIFY(
+      partialMeshPathFinder.rebuildTiles(partialMesh, boxMin, boxMax));
+  const std::string fullMeshFile = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "rebuiltFullMesh.navmesh");
+  const std::string partialMeshFile = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "rebuiltPartialMesh.navmesh");
+  CORRADE_VERIFY(fullMeshPathFinder.saveNavMesh(fullMeshFile));
+  CORRADE_VERIFY(partialMeshPathFinder.saveNavMesh(partialMeshFile));
+  CORRADE_COMPARE_AS(partialMeshFile, fullMeshFile,
+                     Cr::TestSuite::Compare::File);
+
+  // The updated islands are numbered like when built from scratch
+  esp::nav::PathFinder scratchPathFinder;
+  CORRADE_VERIFY(scratchPathFinder.build(settings, floorsWithBox));
+  CORRADE_COMPARE(partialMeshPathFinder.numIslands(),
+                  scratchPathFinder.numIslands());
+  const esp::vec3f floorPoints[]{{-4, 0, -4}, {24, 0, 4}};
+  for (size_t i = 0; i < Cr::Containers::arraySize(floorPoints); ++i) {
+    CORRADE_ITERATION(i);
+    const int island = partialMeshPathFinder.getIsland(floorPoints[i]);
+    CORRADE_COMPARE(island, scratchPathFinder.getIsland(floorPoints[i]));
+    CORRADE_COMPARE_WITH(partialMeshPathFinder.getNavigableArea(island),
+                         scratchPathFinder.getNavigableArea(island),
+                         Cr::TestSuite::Compare::around(0.01f));
+  }
+
+  // The path hierarchy still finds the exact shortest paths
+  CORRADE_VERIFY(partialMeshPathFinder.hasPathHierarchy());
+  esp::nav::ShortestPath path;
+  path.requestedStart = {0, 0, 1};
+  path.requestedEnd = {2, 0, 1};
+  CORRADE_VERIFY(partialMeshPathFinder.findPath(path));
+  esp::nav::ShortestPath hierarchyPath = path;
+  hierarchyPath.usePathHierarchy = true;
+  CORRADE_VERIFY(partialMeshPathFinder.findPath(hierarchyPath));
+  CORRADE_COMPARE(hierarchyPath.geodesicDistance, path.geodesicDistance);
+
+  // The updated obstacle distances are the same as computed from scratch
+  std::vector<esp::vec3f> points;
+  for (float x = -4.5f; x < 5.0f; x += 0.37f) {
+    points.emplace_back(x, 0, 1.0f);
+  }
+  std::vector<float> distances;
+  for (const esp::vec3f& pt : points) {
+    distances.push_back(partialMeshPathFinder.distanceToClosestObstacle(pt));
+  }
+  CORRADE_VERIFY(partialMeshPathFinder.buildObstacleDistanceField(0.1f, 1.0f));
+  for (size_t i = 0; i < points.size(); ++i) {
+    CORRADE_ITERATION(i);
+    const float distance =
+        partialMeshPathFinder.distanceToClosestObstacle(points[i]);
+    if (std::isnan(distance)) {
+      CORRADE_VERIFY(std::isnan(distances[i]));
+    } else {
+      CORRADE_COMPARE(distances[i], distance);
+    }
+  }
+
+  // Without any geometry the tiles are just emptied, and a navmesh that
+  // isn't tiled can't be rebuilt from nothing
+  CORRADE_VERIFY(partialMeshPathFinder.rebuildTiles(esp::assets::MeshData{},
+                                                    boxMin, boxMax));
+  CORRADE_VERIFY(!partialMeshPathFinder.isNavigable({1, 0, 1}));
+  CORRADE_VERIFY(partialMeshPathFinder.isNavigable({24, 0, 4}));
+  settings.tileSize = 0;
+  esp::nav::PathFinder soloPathFinder;
+  CORRADE_VERIFY(soloPathFinder.build(settings, floors));
+  CORRADE_VERIFY(
+      !soloPathFinder.rebuildTiles(esp::assets::MeshData{}, boxMin, boxMax));
+}
+
+void PathFinderTest::parallelTiledBuild() {
+  esp::nav::NavMeshSettings settings;
+  settings.setDefaults();
+  settings.tileSize = 32;
+
+  // a floor cluttered with boxes spread over many tiles
+  esp::assets::MeshData mesh;
+  addFloor(mesh, {-10, 0, -10}, {10, 0, 10});
+  for (int i = 0; i < 20; ++i) {
+    const esp::vec3f corner{-9.0f + (i % 5) * 4.0f, 0, -9.0f + (i / 5) * 4.5f};
+    addBox(mesh, corner, corner + esp::vec3f{1.0f + 0.1f * i, 0.5f, 1.5f});
+  }
+
+  // The tiles are built concurrently but the result must be the same as with
+  // a single thread
+  const std::string serialFile =
+      Cr::Utility::Path::join(MAGNUMRENDERERTEST_OUTPUT_DIR, "serial.navmesh");
+  const std::string parallelFile = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "parallel.navmesh");
+  esp::nav::PathFinder serialPathFinder;
+  serialPathFinder.setNumThreads(1);
+  CORRADE_VERIFY(serialPathFinder.build(settings, mesh));
+  CORRADE_VERIFY(serialPathFinder.saveNavMesh(serialFile));
+
+  esp::nav::PathFinder parallelPathFinder;
+  parallelPathFinder.setNumThreads(4);
+  CORRADE_VERIFY(parallelPathFinder.build(settings, mesh));
+  CORRADE_VERIFY(parallelPathFinder.saveNavMesh(parallelFile));
+
+  CORRADE_COMPARE_AS(parallelFile, serialFile, Cr::TestSuite::Compare::File);
+}
+
+void PathFinderTest::buildVariants() {
+  esp::assets::MeshData mesh;
+  addFloor(mesh, {-10, 0, -10}, {10, 0, 10});
+  for (int i = 0; i < 20; ++i) {
+    const esp::vec3f corner{-9.0f + (i % 5) * 4.0f, 0, -9.0f + (i / 5) * 4.5f};
+    addBox(mesh, corner, corner + esp::vec3f{1.0f + 0.1f * i, 0.5f, 1.5f});
+  }
+
+  // Three variants sharing a heightfield, one with its own cell size, a tiled
+  // one and one that can't be built
+  std::vector<esp::nav::NavMeshSettings> settings(6);
+  for (esp::nav::NavMeshSettings& s : settings) {
+    s.setDefaults();
+  }
+  settings[1].agentRadius = 0.3f;
+  settings[2].agentHeight = 1.0f;
+  settings[2].filterLedgeSpans = false;
+  settings[3].cellSize = 0.1f;
+  settings[4].tileSize = 32;
+  settings[5].vertsPerPoly = 100;
+
+  esp::nav::PathFinder pathFinder;
+  pathFinder.setNumThreads(4);
+  const std::vector<esp::nav::PathFinder::ptr> variants =
+      pathFinder.buildVariants(mesh, settings);
+  CORRADE_VERIFY(!pathFinder.isLoaded());
+  CORRADE_COMPARE(variants.size(), settings.size());
+  CORRADE_VERIFY(!variants[5]);
+
+  // Each variant is the same as building it on its own
+  for (size_t i = 0; i < 5; ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_VERIFY(variants[i]);
+    CORRADE_VERIFY(*variants[i]->getNavMeshSettings() == settings[i]);
+    const std::string variantFile = Cr::Utility::Path::join(
+        MAGNUMRENDERERTEST_OUTPUT_DIR, "variant.navmesh");
+    const std::string singleFile = Cr::Utility::Path::join(
+        MAGNUMRENDERERTEST_OUTPUT_DIR, "single.navmesh");
+    esp::nav::PathFinder single;
+    CORRADE_VERIFY(single.build(settings[i], mesh));
+    CORRADE_VERIFY(single.saveNavMesh(singleFile));
+    CORRADE_VERIFY(variants[i]->saveNavMesh(variantFile));
+    CORRADE_COMPARE_AS(variantFile, singleFile, Cr::TestSuite::Compare::File);
+  }
+  CORRADE_COMPARE_AS(variants[1]->getNavigableArea(),
+                     variants[0]->getNavigableArea(),
+                     Cr::TestSuite::Compare::Less);
+}
+
+void PathFinderTest::topDownView() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.setNumThreads(4);
+
+  const float metersPerPixel = 0.1f;
+  const float height = pathFinder.bounds().first[1];
+  const float eps = 0.5f;
+  const Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> islands =
+      pathFinder.getTopDownIslandView(metersPerPixel, height, eps);
+  const Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> navigable =
+      pathFinder.getTopDownView(metersPerPixel, height, eps);
+  CORRADE_COMPARE(navigable.rows(), islands.rows());
+  CORRADE_COMPARE(navigable.cols(), islands.cols());
+  CORRADE_VERIFY(navigable.count() > 0);
+
+  // the rasterized view must match querying every pixel on its own
+  const float startx = pathFinder.bounds().first[0];
+  float curz = pathFinder.bounds().first[2];
+  for (int h = 0; h < islands.rows(); ++h) {
+    float curx = startx;
+    for (int w = 0; w < islands.cols(); ++w) {
+      CORRADE_ITERATION(h << " " << w);
+      const esp::vec3f point{curx, height, curz};
+      const bool isNavigable = pathFinder.isNavigable(point, eps);
+      CORRADE_COMPARE(navigable(h, w), isNavigable);
+      CORRADE_COMPARE(islands(h, w),
+                      isNavigable ? pathFinder.getIsland(point) : -1);
+      curx = curx + metersPerPixel;
+    }
+    curz = curz + metersPerPixel;
+  }
+}
+
+void PathFinderTest::memoryMappedLoad() {
+  // Resave the test scene so that it has persisted islands
+  const std::string file =
+      Cr::Utility::Path::join(MAGNUMRENDERERTEST_OUTPUT_DIR, "islands.navmesh");
+  {
+    esp::nav::PathFinder pathFinder;
+    CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+    CORRADE_VERIFY(pathFinder.saveNavMesh(file));
+  }
+
+  esp::nav::PathFinder readPathFinder;
+  CORRADE_VERIFY(readPathFinder.loadNavMesh(file));
+  esp::nav::PathFinder mappedPathFinder;
+  CORRADE_VERIFY(mappedPathFinder.loadNavMesh(file, /*memoryMap=*/true));
+  CORRADE_VERIFY(mappedPathFinder.isLoaded());
+
+  CORRADE_COMPARE(mappedPathFinder.numIslands(), readPathFinder.numIslands());
+  CORRADE_COMPARE(mappedPathFinder.getNavigableArea(),
+                  readPathFinder.getNavigableArea());
+  for (int i = 0; i < readPathFinder.numIslands(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(mappedPathFinder.islandRadius(i),
+                    readPathFinder.islandRadius(i));
+    CORRADE_COMPARE(mappedPathFinder.getNavigableArea(i),
+                    readPathFinder.getNavigableArea(i));
+  }
+
+  readPathFinder.seed(0);
+  for (int i = 0; i < 100; ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::ShortestPath readPath;
+    readPath.requestedStart = readPathFinder.getRandomNavigablePoint();
+    readPath.requestedEnd = readPathFinder.getRandomNavigablePoint();
+    esp::nav::ShortestPath mappedPath;
+    mappedPath.requestedStart = readPath.requestedStart;
+    mappedPath.requestedEnd = readPath.requestedEnd;
+    CORRADE_COMPARE(mappedPathFinder.findPath(mappedPath),
+                    readPathFinder.findPath(readPath));
+    CORRADE_COMPARE(mappedPath.geodesicDistance, readPath.geodesicDistance);
+    CORRADE_COMPARE(mappedPathFinder.getIsland(readPath.requestedStart),
+                    readPathFinder.getIsland(readPath.requestedStart));
+  }
+
+  // Loading persisted islands and saving them again is lossless
+  const std::string mappedFile = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "islands-mapped.navmesh");
+  CORRADE_VERIFY(mappedPathFinder.saveNavMesh(mappedFile));
+  CORRADE_COMPARE_AS(mappedFile, file, Cr::TestSuite::Compare::File);
+
+  // Sections the reader doesn't know about are skipped, including their
+  // padding, and not saved again
+  const std::string unknownSectionFile = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "islands-unknown-section.navmesh");
+  const int unknownSection[]{'T' << 24 | 'E' << 16 | 'S' << 8 | 'T', 5, 0, 0};
+  CORRADE_VERIFY(Cr::Utility::Path::copy(file, unknownSectionFile));
+  CORRADE_VERIFY(Cr::Utility::Path::appendString(
+      unknownSectionFile,
+      {reinterpret_cast<const char*>(unknownSection), sizeof(unknownSection)}));
+  esp::nav::PathFinder unknownSectionPathFinder;
+  CORRADE_VERIFY(unknownSectionPathFinder.loadNavMesh(unknownSectionFile));
+  CORRADE_COMPARE(unknownSectionPathFinder.numIslands(),
+                  readPathFinder.numIslands());
+  CORRADE_VERIFY(unknownSectionPathFinder.saveNavMesh(unknownSectionFile));
+  CORRADE_COMPARE_AS(unknownSectionFile, file, Cr::TestSuite::Compare::File);
+}
+
+void PathFinderTest::islandSampling() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  int island = 0;
+  for (int i = 1; i < pathFinder.numIslands(); ++i) {
+    if (pathFinder.getNavigableArea(i) > pathFinder.getNavigableArea(island)) {
+      island = i;
+    }
+  }
+
+  // The same seed gives the same points on the seeding thread
+  pathFinder.seed(3);
+  const esp::vec3f first = pathFinder.getRandomNavigablePoint(10, island);
+  pathFinder.seed(3);
+  CORRADE_VERIFY(pathFinder.getRandomNavigablePoint(10, island) == first);
+  // Also when sampling the whole navmesh
+  pathFinder.seed(3);
+  const esp::vec3f firstAnywhere = pathFinder.getRandomNavigablePoint();
+  pathFinder.seed(3);
+  CORRADE_VERIFY(pathFinder.getRandomNavigablePoint() == firstAnywhere);
+
+  // Sampling doesn't modify the navmesh, so it can run concurrently
+  std::vector<std::vector<esp::vec3f>> points(4);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < points.size(); ++t) {
+    // Half of the threads sample the whole navmesh
+    const int threadIsland = t % 2 ? island : esp::ID_UNDEFINED;
+    threads.emplace_back([&pathFinder, &threadPoints = points[t],
+                          threadIsland]() {
+      for (int i = 0; i < 250; ++i) {
+        threadPoints.push_back(
+            pathFinder.getRandomNavigablePoint(10, threadIsland));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t t = 0; t < points.size(); ++t) {
+    for (size_t i = 0; i < points[t].size(); ++i) {
+      CORRADE_ITERATION(t << i);
+      const esp::vec3f& pt = points[t][i];
+      CORRADE_VERIFY(pathFinder.isNavigable(pt));
+      if (t % 2) {
+        CORRADE_COMPARE(pathFinder.getIsland(pt), island);
+      }
+    }
+  }
+  // Threads have separate random states
+  CORRADE_VERIFY(points[0] != points[2]);
+  CORRADE_VERIFY(points[1] != points[3]);
+}
+
+void PathFinderTest::batchedPointQueries() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  pathFinder.seed(0);
+  pathFinder.setNumThreads(4);
+
+  // navigable points, points above them and one far off the navmesh
+  Eigen::RowMatrixX3f points(301, 3);
+  for (int i = 0; i < 150; ++i) {
+    const esp::vec3f pt = pathFinder.getRandomNavigablePoint();
+    points.row(2 * i) = pt.transpose();
+    points.row(2 * i + 1) = (pt + esp::vec3f{0.1f, 0.7f, 0.1f}).transpose();
+  }
+  points.row(300) << 1e5f, 1e5f, 1e5f;
+
+  const int island = pathFinder.getIsland(esp::vec3f{points.row(0)});
+  const Eigen::RowMatrixX3f snapped = pathFinder.snapPoints(points);
+  const Eigen::RowMatrixX3f islandSnapped =
+      pathFinder.snapPoints(points, island);
+  const Eigen::VectorXi islands = pathFinder.getIslands(points);
+  const Eigen::Matrix<bool, Eigen::Dynamic, 1> navigable =
+      pathFinder.isNavigableBatch(points);
+
+  // results must match the serial API and be in input order
+  for (int i = 0; i < points.rows(); ++i) {
+    CORRADE_ITERATION(i);
+    const esp::vec3f pt{points.row(i)};
+    const esp::vec3f snappedPt = pathFinder.snapPoint(pt);
+    const esp::vec3f islandSnappedPt = pathFinder.snapPoint(pt, island);
+    for (int j = 0; j < 3; ++j) {
+      if (std::isnan(snappedPt[j])) {
+        CORRADE_VERIFY(std::isnan(snapped(i, j)));
+      } else {
+        CORRADE_COMPARE(snapped(i, j), snappedPt[j]);
+      }
+      if (std::isnan(islandSnappedPt[j])) {
+        CORRADE_VERIFY(std::isnan(islandSnapped(i, j)));
+      } else {
+        CORRADE_COMPARE(islandSnapped(i, j), islandSnappedPt[j]);
+      }
+    }
+    CORRADE_COMPARE(islands[i], pathFinder.getIsland(pt));
+    CORRADE_COMPARE(navigable[i], pathFinder.isNavigable(pt));
+  }
+  CORRADE_VERIFY(!navigable[300]);
+
+  // Sampled points only depend on the seed, not on the number of threads
+  pathFinder.seed(1);
+  const Eigen::RowMatrixX3f sampled =
+      pathFinder.sampleNavigablePoints(1000, island);
+  pathFinder.setNumThreads(1);
+  pathFinder.seed(1);
+  CORRADE_VERIFY(pathFinder.sampleNavigablePoints(1000, island) == sampled);
+
+  const Eigen::VectorXi sampledIslands = pathFinder.getIslands(sampled);
+  CORRADE_VERIFY(pathFinder.isNavigableBatch(sampled).all());
+  CORRADE_VERIFY((sampledIslands.array() == island).all());
+  CORRADE_VERIFY(
+      pathFinder.isNavigableBatch(pathFinder.sampleNavigablePoints(1000))
+          .all());
+}
+
+void PathFinderTest::obstacleDistanceField() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  pathFinder.seed(0);
+  std::vector<esp::vec3f> points;
+  for (int i = 0; i < 1000; ++i) {
+    points.push_back(pathFinder.getRandomNavigablePoint());
+  }
+  std::vector<float> exact;
+  for (const esp::vec3f& pt : points) {
+    exact.push_back(pathFinder.distanceToClosestObstacle(pt));
+  }
+
+  const float cellSize = 0.1f;
+  CORRADE_VERIFY(!pathFinder.hasObstacleDistanceField());
+  pathFinder.setNumThreads(4);
+  CORRADE_VERIFY(pathFinder.buildObstacleDistanceField(cellSize, 2.0f));
+  CORRADE_VERIFY(pathFinder.hasObstacleDistanceField());
+
+  // The distance is 1-Lipschitz, so interpolating between nodes a cell apart
+  // is off by at most a cell diagonal
+  for (size_t i = 0; i < points.size(); ++i) {
+    CORRADE_ITERATION(i);
+    const float distance = pathFinder.distanceToClosestObstacle(points[i]);
+    CORRADE_COMPARE_WITH(distance, exact[i],
+                         Cr::TestSuite::Compare::around(cellSize * 1.5f));
+    CORRADE_VERIFY(distance <= 2.0f);
+    // Larger radii than the field was built with are always exact
+    CORRADE_COMPARE(pathFinder.distanceToClosestObstacle(points[i], 3.0f),
+                    pathFinder.closestObstacleSurfacePoint(points[i], 3.0f)
+                        .hitDist);
+  }
+
+  pathFinder.clearObstacleDistanceField();
+  CORRADE_VERIFY(!pathFinder.hasObstacleDistanceField());
+  CORRADE_COMPARE(pathFinder.distanceToClosestObstacle(points[0]), exact[0]);
+}
+
+void PathFinderTest::queryContexts() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(!pathFinder.createQueryContext());
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  pathFinder.seed(0);
+
+  std::vector<esp::nav::ShortestPath> paths(400);
+  for (auto& path : paths) {
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    path.requestedEnd = pathFinder.getRandomNavigablePoint();
+  }
+  const int island = pathFinder.getIsland(paths[0].requestedStart);
+
+  // Each thread queries the shared navmesh through its own context
+  constexpr int numThreads = 4;
+  std::vector<std::vector<float>> distances(numThreads);
+  std::vector<std::vector<esp::vec3f>> snapped(numThreads);
+  std::vector<std::vector<esp::vec3f>> sampled(numThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; ++t) {
+    esp::nav::PathFinderQueryContext::ptr context =
+        pathFinder.createQueryContext();
+    CORRADE_VERIFY(context);
+    CORRADE_VERIFY(context->isLoaded());
+    threads.emplace_back([&, t, context]() {
+      for (esp::nav::ShortestPath path : paths) {
+        context->findPath(path);
+        distances[t].push_back(path.geodesicDistance);
+        snapped[t].push_back(
+            context->snapPoint(path.requestedEnd + esp::vec3f{0, 0.5f, 0},
+                               island));
+        sampled[t].push_back(context->getRandomNavigablePoint(island));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // Results match the PathFinder's own queries
+  for (int t = 0; t < numThreads; ++t) {
+    for (size_t i = 0; i < paths.size(); ++i) {
+      CORRADE_ITERATION(t << i);
+      esp::nav::ShortestPath path = paths[i];
+      pathFinder.findPath(path);
+      CORRADE_COMPARE(distances[t][i], path.geodesicDistance);
+      const esp::vec3f snappedPt = pathFinder.snapPoint(
+          paths[i].requestedEnd + esp::vec3f{0, 0.5f, 0}, island);
+      if (std::isnan(snappedPt[0])) {
+        CORRADE_VERIFY(std::isnan(snapped[t][i][0]));
+      } else {
+        CORRADE_VERIFY(snapped[t][i].isApprox(snappedPt));
+      }
+      CORRADE_VERIFY(pathFinder.isNavigable(sampled[t][i]));
+      CORRADE_COMPARE(pathFinder.getIsland(sampled[t][i]), island);
+    }
+  }
+  // Contexts have separate random states
+  CORRADE_VERIFY(sampled[0] != sampled[1]);
+
+  // A context keeps the navmesh it was created on
+  esp::nav::PathFinderQueryContext::ptr context =
+      pathFinder.createQueryContext();
+  esp::nav::PathFinder other;
+  esp::nav::NavMeshSettings settings;
+  esp::assets::MeshData mesh;
+  addFloor(mesh, {-1, 0, -1}, {1, 0, 1});
+  CORRADE_VERIFY(other.build(settings, mesh));
+  esp::nav::PathFinderQueryContext::ptr otherContext =
+      other.createQueryContext();
+  CORRADE_VERIFY(pathFinder.build(settings, mesh));
+  esp::nav::ShortestPath path = paths[0];
+  CORRADE_VERIFY(context->findPath(path));
+  CORRADE_COMPARE(path.geodesicDistance, distances[0][0]);
+  CORRADE_VERIFY(otherContext->isNavigable(esp::vec3f{0, 0, 0}));
+}
+
+void PathFinderTest::pathHierarchy() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  esp::nav::PathFinder hierarchical;
+  CORRADE_VERIFY(hierarchical.loadNavMesh(skokloster));
+  CORRADE_VERIFY(!hierarchical.hasPathHierarchy());
+  // Small clusters so that most paths cross several of them
+  CORRADE_VERIFY(hierarchical.buildPathHierarchy(8));
+  CORRADE_VERIFY(hierarchical.hasPathHierarchy());
+
+  // Persisted with the navmesh, but only used when loaded into a PathFinder
+  // that already has a hierarchy
+  const std::string file = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "path-hierarchy.navmesh");
+  CORRADE_VERIFY(hierarchical.saveNavMesh(file));
+  esp::nav::PathFinder loaded;
+  CORRADE_VERIFY(loaded.loadNavMesh(file));
+  CORRADE_VERIFY(!loaded.hasPathHierarchy());
+  CORRADE_VERIFY(loaded.buildPathHierarchy(8));
+  CORRADE_VERIFY(loaded.loadNavMesh(file));
+  CORRADE_VERIFY(loaded.hasPathHierarchy());
+
+  pathFinder.seed(0);
+  for (int i = 0; i < 200; ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::ShortestPath path;
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    path.requestedEnd = pathFinder.getRandomNavigablePoint();
+    esp::nav::ShortestPath hierarchicalPath = path;
+    hierarchicalPath.usePathHierarchy = true;
+    esp::nav::ShortestPath loadedPath = hierarchicalPath;
+    const bool found = hierarchical.findPath(hierarchicalPath);
+    CORRADE_COMPARE(loaded.findPath(loadedPath), found);
+    CORRADE_COMPARE(loadedPath.geodesicDistance,
+                    hierarchicalPath.geodesicDistance);
+
+    // Paths Detour finds are unchanged
+    if (pathFinder.findPath(path)) {
+      CORRADE_VERIFY(found);
+      CORRADE_COMPARE(hierarchicalPath.geodesicDistance,
+                      path.geodesicDistance);
+      CORRADE_COMPARE(hierarchicalPath.points.size(), path.points.size());
+      for (size_t j = 0; j < path.points.size(); ++j) {
+        CORRADE_ITERATION(j);
+        CORRADE_VERIFY(hierarchicalPath.points[j] == path.points[j]);
+      }
+    } else if (found) {
+      // Others are found through the hierarchy, on the navmesh
+      CORRADE_COMPARE_AS(hierarchicalPath.geodesicDistance,
+                         (path.requestedEnd - path.requestedStart).norm() -
+                             1e-3f,
+                         Cr::TestSuite::Compare::GreaterOrEqual);
+    }
+  }
+
+  // The hierarchy is opt-in per query
+  esp::nav::ShortestPath path;
+  path.requestedStart = pathFinder.getRandomNavigablePoint();
+  path.requestedEnd = pathFinder.getRandomNavigablePoint();
+  esp::nav::ShortestPath hierarchicalPath = path;
+  CORRADE_COMPARE(hierarchical.findPath(hierarchicalPath),
+                  pathFinder.findPath(path));
+  CORRADE_COMPARE(hierarchicalPath.geodesicDistance, path.geodesicDistance);
+
+  hierarchical.clearPathHierarchy();
+  CORRADE_VERIFY(!hierarchical.hasPathHierarchy());
+}
+
+void PathFinderTest::pathHierarchyLongCorridor() {
+  // A serpentine corridor through 20 lanes of a 20x20m floor, each wall
+  // leaving a 1m gap at alternating ends
+  esp::assets::MeshData mesh;
+  addFloor(mesh, {0, 0, 0}, {20, 0, 20});
+  for (int i = 1; i < 20; ++i) {
+    const float gapX = i % 2 ? 19.0f : 1.0f;
+    addBox(mesh, {i % 2 ? 0.0f : gapX, 0, i - 0.1f},
+           {i % 2 ? gapX : 20.0f, 2, i + 0.1f});
+  }
+
+  // Small tiles split the corridor into more polygons than a Detour query
+  // can return
+  esp::nav::NavMeshSettings settings;
+  settings.setDefaults();
+  settings.tileSize = 16;
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.build(settings, mesh));
+
+  esp::nav::ShortestPath path;
+  path.requestedStart = {10, 0, 0.5};
+  path.requestedEnd = {10, 0, 19.5};
+  CORRADE_VERIFY(!pathFinder.findPath(path));
+  path.usePathHierarchy = true;
+  CORRADE_VERIFY(!pathFinder.findPath(path));
+
+  CORRADE_VERIFY(pathFinder.buildPathHierarchy());
+  CORRADE_VERIFY(pathFinder.findPath(path));
+  CORRADE_COMPARE_AS(path.geodesicDistance, 18 * 18.0f,
+                     Cr::TestSuite::Compare::Greater);
+
+  // The walls are aligned to the cell grid, so a navmesh built as a single
+  // tile covers the same area with few enough polygons for Detour to find
+  // the shortest path
+  settings.tileSize = 0;
+  esp::nav::PathFinder singleTile;
+  CORRADE_VERIFY(singleTile.build(settings, mesh));
+  esp::nav::ShortestPath singleTilePath;
+  singleTilePath.requestedStart = path.requestedStart;
+  singleTilePath.requestedEnd = path.requestedEnd;
+  CORRADE_VERIFY(singleTile.findPath(singleTilePath));
+  CORRADE_COMPARE_WITH(path.geodesicDistance, singleTilePath.geodesicDistance,
+                       Cr::TestSuite::Compare::around(0.01f));
+}
+
 void PathFinderTest::testCaching() {
   esp::nav::PathFinder pathFinder;
   pathFinder.loadNavMesh(skokloster);
@@ -2,6 +2,10 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/Path.h>
@@ -16,6 +20,7 @@
 #include "esp/physics/PhysicsManager.h"
 #include "esp/physics/objectManagers/RigidObjectManager.h"
 #ifdef ESP_BUILD_WITH_BULLET
+#include "esp/physics/bullet/BulletCollisionHulls.h"
 #include "esp/physics/bullet/BulletPhysicsManager.h"
 #include "esp/physics/bullet/objectWrappers/ManagedBulletRigidObject.h"
 #endif
@@ -74,7 +79,8 @@ struct PhysicsTest : Cr::TestSuite::Tester {
     sceneID_ = sceneManager_->initSceneGraph();
   }
 
-  void initStage(const std::string& stageFile) {
+  void initStage(const std::string& stageFile,
+                 const std::string& bvhCacheDirectory = "") {
     auto& sceneGraph = sceneManager_->getSceneGraph(sceneID_);
     auto& rootNode = sceneGraph.getRootNode();
 
@@ -83,6 +89,7 @@ struct PhysicsTest : Cr::TestSuite::Tester {
         physicsAttributesManager_->createObject(physicsConfigFile, true);
     auto stageAttributesMgr = metadataMediator_->getStageAttributesManager();
     if (physicsManagerAttributes != nullptr) {
+      physicsManagerAttributes->setBvhCacheDirectory(bvhCacheDirectory);
       stageAttributesMgr->setCurrPhysicsManagerAttributesHandle(
           physicsManagerAttributes->getHandle());
     }
@@ -146,12 +153,16 @@ struct PhysicsTest : Cr::TestSuite::Tester {
   void testCollisionBoundingBox();
   void testDiscreteContactTest();
   void testBulletCompoundShapeMargins();
+  void testBulletSharedCollisionShapes();
+  void testBulletStageBvhCache();
+  void testBulletCollisionHulls();
   void testConfigurableScaling();
   void testVelocityControl();
   void testSceneNodeAttachment();
   void testMotionTypes();
   void testNumActiveContactPoints();
   void testRemoveSleepingSupport();
+  void testBatchedRigidObjectState();
   /////
 
   esp::logging::LoggingContext loggingContext_;
@@ -181,11 +192,15 @@ PhysicsTest::PhysicsTest() {
        &PhysicsTest::testCollisionBoundingBox,
        &PhysicsTest::testDiscreteContactTest,
        &PhysicsTest::testBulletCompoundShapeMargins,
+       &PhysicsTest::testBulletSharedCollisionShapes,
+       &PhysicsTest::testBulletStageBvhCache,
+       &PhysicsTest::testBulletCollisionHulls,
 #endif
        &PhysicsTest::testConfigurableScaling, &PhysicsTest::testVelocityControl,
        &PhysicsTest::testSceneNodeAttachment, &PhysicsTest::testMotionTypes,
        &PhysicsTest::testNumActiveContactPoints,
-       &PhysicsTest::testRemoveSleepingSupport},
+       &PhysicsTest::testRemoveSleepingSupport,
+       &PhysicsTest::testBatchedRigidObjectState},
       Cr::Containers::arraySize(RendererEnabledData));
 }
 
@@ -490,6 +505,222 @@ void PhysicsTest::testBulletCompoundShapeMargins() {
     CORRADE_COMPARE(AabbOb2, objectGroundTruth);
   }
 }  // PhysicsTest::testBulletCompoundShapeMargins
+
+void PhysicsTest::testBulletSharedCollisionShapes() {
+  // test that copies of an object share their convex hulls without affecting
+  // each other
+
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() ==
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    auto* bPhysManager =
+        static_cast<esp::physics::BulletPhysicsManager*>(physicsManager_.get());
+    CORRADE_COMPARE(bPhysManager->getCollisionShapeCacheSize(), 0);
+
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    ObjectAttributes->setMargin(0.0);
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+    objectAttributesManager->registerObject(ObjectAttributes, objectFile);
+    ObjectAttributes::ptr objectTemplate =
+        objectAttributesManager->getObjectCopyByHandle(objectFile);
+    auto* drawables = &sceneManager_->getSceneGraph(sceneID_).getDrawables();
+
+    // copies at the same scale build the hulls once
+    std::vector<esp::physics::ManagedBulletRigidObject::ptr> copies;
+    for (int i = 0; i < 3; ++i) {
+      copies.push_back(makeObjectGetWrapper(objectFile, drawables));
+      CORRADE_VERIFY(copies.back());
+    }
+    CORRADE_COMPARE(bPhysManager->getCollisionShapeCacheSize(), 1);
+    const Magnum::Range3D unitBounds({-1.0, -1.0, -1.0}, {1.0, 1.0, 1.0});
+    for (const auto& copy : copies) {
+      CORRADE_COMPARE(copy->getCollisionShapeAabb(), unitBounds);
+    }
+
+    // a different scale or joining the meshes builds new hulls
+    objectTemplate->setScale({2.0, 1.0, 3.0});
+    objectAttributesManager->registerObject(objectTemplate);
+    auto scaled = makeObjectGetWrapper(objectFile, drawables);
+    CORRADE_VERIFY(scaled);
+    CORRADE_COMPARE(scaled->getCollisionShapeAabb(),
+                    Magnum::Range3D({-2.0, -1.0, -3.0}, {2.0, 1.0, 3.0}));
+    objectTemplate->setJoinCollisionMeshes(true);
+    objectAttributesManager->registerObject(objectTemplate);
+    auto joined = makeObjectGetWrapper(objectFile, drawables);
+    CORRADE_VERIFY(joined);
+    CORRADE_COMPARE(joined->getCollisionShapeAabb(),
+                    Magnum::Range3D({-2.0, -1.0, -3.0}, {2.0, 1.0, 3.0}));
+    CORRADE_COMPARE(bPhysManager->getCollisionShapeCacheSize(), 3);
+    CORRADE_COMPARE(copies[0]->getCollisionShapeAabb(), unitBounds);
+
+    // changing the margin of one copy doesn't change the others
+    copies[0]->setMargin(0.1);
+    CORRADE_COMPARE_AS(copies[0]->getCollisionShapeAabb().max().x(), 1.05f,
+                       Cr::TestSuite::Compare::Greater);
+    CORRADE_COMPARE(copies[1]->getCollisionShapeAabb(), unitBounds);
+
+    // removed objects keep the hulls cached for new copies
+    for (const auto& copy : copies) {
+      rigidObjectManager_->removePhysObjectByID(copy->getID());
+    }
+    CORRADE_COMPARE(bPhysManager->getCollisionShapeCacheSize(), 3);
+    bPhysManager->clearCollisionShapeCache();
+    CORRADE_COMPARE(bPhysManager->getCollisionShapeCacheSize(), 0);
+    CORRADE_COMPARE(scaled->getCollisionShapeAabb(),
+                    Magnum::Range3D({-2.0, -1.0, -3.0}, {2.0, 1.0, 3.0}));
+  }
+}  // PhysicsTest::testBulletSharedCollisionShapes
+
+void PhysicsTest::testBulletStageBvhCache() {
+  // test that the stage collision BVH is cached on the first load and loaded
+  // from the cache afterwards
+
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/plane.glb");
+  const std::string cacheDir =
+      Cr::Utility::Path::join(dataDir, "test_assets/bvh_cache");
+  const auto removeCache = [&cacheDir]() {
+    if (const auto files = Cr::Utility::Path::list(
+            cacheDir, Cr::Utility::Path::ListFlag::SkipDotAndDotDot)) {
+      for (const auto& file : *files) {
+        Cr::Utility::Path::remove(Cr::Utility::Path::join(cacheDir, file));
+      }
+      Cr::Utility::Path::remove(cacheDir);
+    }
+  };
+  removeCache();
+
+  const esp::geo::Ray ray{{0.0, 1.0, 0.0}, {0.0, -1.0, 0.0}};
+  double hitDistance[2]{};
+  for (int load = 0; load < 2; ++load) {
+    CORRADE_ITERATION(load);
+    resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+    initStage(stageFile, cacheDir);
+    if (physicsManager_->getPhysicsSimulationLibrary() !=
+        PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+      CORRADE_SKIP("Bullet physics not enabled");
+    }
+    auto* bPhysManager =
+        static_cast<esp::physics::BulletPhysicsManager*>(physicsManager_.get());
+
+    const auto files = Cr::Utility::Path::list(
+        cacheDir, Cr::Utility::Path::ListFlag::SkipDotAndDotDot);
+    CORRADE_VERIFY(files);
+    CORRADE_VERIFY(!files->isEmpty());
+    for (const auto& file : *files) {
+      CORRADE_VERIFY(file.hasSuffix(".bvh"));
+    }
+    if (load == 0) {
+      CORRADE_COMPARE(bPhysManager->getNumStageBvhsLoadedFromCache(), 0);
+    } else {
+      CORRADE_COMPARE_AS(bPhysManager->getNumStageBvhsLoadedFromCache(), 0,
+                         Cr::TestSuite::Compare::Greater);
+    }
+
+    // the cached BVH collides the same as a built one
+    esp::physics::RaycastResults results = physicsManager_->castRay(ray);
+    CORRADE_VERIFY(results.hasHits());
+    hitDistance[load] = results.hits[0].rayDistance;
+  }
+  CORRADE_COMPARE(hitDistance[1], hitDistance[0]);
+
+  close();
+  removeCache();
+}  // PhysicsTest::testBulletStageBvhCache
+
+void PhysicsTest::testBulletCollisionHulls() {
+  // test that collision hulls are simplified and decomposed as configured and
+  // cached next to the asset
+
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/donut.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() ==
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    ObjectAttributes->setMargin(0.0);
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+    objectAttributesManager->registerObject(ObjectAttributes, objectFile);
+    auto* drawables = &sceneManager_->getSceneGraph(sceneID_).getDrawables();
+
+    // by default every mesh is a hull of all its vertices
+    auto raw = makeObjectGetWrapper(objectFile, drawables);
+    CORRADE_VERIFY(raw);
+    const Magnum::Range3D rawBounds = raw->getCollisionShapeAabb();
+
+    ObjectAttributes::ptr objectTemplate =
+        objectAttributesManager->getObjectCopyByHandle(objectFile);
+    const std::string collisionAssetFile =
+        objectTemplate->getCollisionAssetHandle();
+    const std::vector<esp::assets::CollisionMeshData>& meshGroup =
+        resourceManager_->getCollisionMesh(collisionAssetFile);
+    esp::physics::CollisionHullSettings settings;
+    settings.maxHullVertices = 16;
+    const std::string cacheFile =
+        esp::physics::collisionHullCacheFile(collisionAssetFile, settings);
+    if (Cr::Utility::Path::exists(cacheFile)) {
+      Cr::Utility::Path::remove(cacheFile);
+    }
+
+    // simplified hulls are cached and stay within the full ones
+    objectTemplate->setCollisionHullMaxVertices(settings.maxHullVertices);
+    objectAttributesManager->registerObject(objectTemplate);
+    auto simplified = makeObjectGetWrapper(objectFile, drawables);
+    CORRADE_VERIFY(simplified);
+    CORRADE_VERIFY(rawBounds.padded(Magnum::Vector3{1.0e-4f})
+                       .contains(simplified->getCollisionShapeAabb()));
+    CORRADE_VERIFY(Cr::Utility::Path::exists(cacheFile));
+
+    std::vector<esp::physics::CollisionMeshHulls> hulls;
+    CORRADE_VERIFY(esp::physics::loadCollisionHulls(cacheFile, meshGroup,
+                                                    settings, hulls));
+    CORRADE_COMPARE(hulls.size(), meshGroup.size());
+    for (const auto& meshHulls : hulls) {
+      CORRADE_COMPARE(meshHulls.size(), 1);
+      CORRADE_COMPARE_AS(meshHulls[0].size(), std::size_t{16},
+                         Cr::TestSuite::Compare::LessOrEqual);
+    }
+    // hulls cached with other settings aren't used
+    esp::physics::CollisionHullSettings otherSettings = settings;
+    otherSettings.maxHullVertices = 32;
+    CORRADE_VERIFY(!esp::physics::loadCollisionHulls(cacheFile, meshGroup,
+                                                     otherSettings, hulls));
+    Cr::Utility::Path::remove(cacheFile);
+
+    // decomposition carves out the hole of the donut
+    settings.decompose = true;
+    const std::vector<esp::physics::CollisionMeshHulls> parts =
+        esp::physics::computeCollisionHulls(meshGroup, settings);
+    CORRADE_COMPARE(parts.size(), meshGroup.size());
+    std::size_t numParts = 0;
+    for (const auto& meshParts : parts) {
+      numParts += meshParts.size();
+      for (const auto& part : meshParts) {
+        CORRADE_VERIFY(!part.empty());
+        CORRADE_COMPARE_AS(part.size(), std::size_t{16},
+                           Cr::TestSuite::Compare::LessOrEqual);
+      }
+    }
+    CORRADE_COMPARE_AS(numParts, meshGroup.size(),
+                       Cr::TestSuite::Compare::Greater);
+  }
+}  // PhysicsTest::testBulletCollisionHulls
 #endif
 
 void PhysicsTest::testConfigurableScaling() {
@@ -1036,6 +1267,87 @@ void PhysicsTest::testRemoveSleepingSupport() {
   }
 }  // PhysicsTest::testRemoveSleepingSupport
 
+void PhysicsTest::testBatchedRigidObjectState() {
+  // test reading and writing the state of several objects in a single call
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+
+  std::string stageFile = "NONE";
+
+  initStage(stageFile);
+  auto& drawables = sceneManager_->getSceneGraph(sceneID_).getDrawables();
+
+  auto objectAttributesManager =
+      metadataMediator_->getObjectAttributesManager();
+  std::string cubeHandle =
+      objectAttributesManager->getObjectHandlesBySubstring("cubeSolid")[0];
+
+  std::vector<esp::physics::ManagedRigidObject::ptr> cubes;
+  std::vector<int> cubeIds;
+  for (int i = 0; i < 3; ++i) {
+    auto cubeWrapper = makeObjectGetWrapper(cubeHandle, &drawables);
+    cubeWrapper->setTranslation(Mn::Vector3(i, 2.0f * i, -1.0f));
+    cubeWrapper->setRotation(Mn::Quaternion::rotation(
+        Mn::Deg(30.0f * i), Mn::Vector3::yAxis()));
+    cubes.push_back(cubeWrapper);
+    cubeIds.push_back(cubeWrapper->getID());
+  }
+  // read in a different order than the objects were created
+  std::swap(cubeIds[0], cubeIds[2]);
+  std::swap(cubes[0], cubes[2]);
+
+  // batched poses match the per-object getters
+  std::vector<float> poses(cubeIds.size() * 7);
+  rigidObjectManager_->getPoses(cubeIds, poses);
+  for (std::size_t i = 0; i < cubes.size(); ++i) {
+    const float* pose = poses.data() + i * 7;
+    CORRADE_COMPARE(Mn::Vector3::from(pose), cubes[i]->getTranslation());
+    CORRADE_COMPARE(
+        Mn::Quaternion(Mn::Vector3::from(pose + 3), pose[6]),
+        cubes[i]->getRotation());
+  }
+
+  // batched poses are applied to each object
+  for (std::size_t i = 0; i < cubes.size(); ++i) {
+    float* pose = poses.data() + i * 7;
+    pose[0] += 1.0f;
+    const Mn::Quaternion rotation =
+        Mn::Quaternion::rotation(Mn::Deg(45.0f), Mn::Vector3::xAxis());
+    Mn::Vector3::from(pose + 3) = rotation.vector();
+    pose[6] = rotation.scalar();
+  }
+  rigidObjectManager_->setPoses(cubeIds, poses);
+  for (std::size_t i = 0; i < cubes.size(); ++i) {
+    const float* pose = poses.data() + i * 7;
+    CORRADE_COMPARE(cubes[i]->getTranslation(), Mn::Vector3::from(pose));
+    CORRADE_COMPARE(
+        cubes[i]->getRotation(),
+        Mn::Quaternion::rotation(Mn::Deg(45.0f), Mn::Vector3::xAxis()));
+  }
+
+  // velocities need dynamics
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::NoPhysics) {
+    std::vector<float> velocities(cubeIds.size() * 6);
+    for (std::size_t i = 0; i < velocities.size(); ++i) {
+      velocities[i] = 0.1f * i;
+    }
+    rigidObjectManager_->setVelocities(cubeIds, velocities);
+    for (std::size_t i = 0; i < cubes.size(); ++i) {
+      const float* velocity = velocities.data() + i * 6;
+      CORRADE_COMPARE(cubes[i]->getLinearVelocity(),
+                      Mn::Vector3::from(velocity));
+      CORRADE_COMPARE(cubes[i]->getAngularVelocity(),
+                      Mn::Vector3::from(velocity + 3));
+    }
+
+    std::vector<float> readVelocities(cubeIds.size() * 6);
+    rigidObjectManager_->getVelocities(cubeIds, readVelocities);
+    for (std::size_t i = 0; i < velocities.size(); ++i) {
+      CORRADE_COMPARE(readVelocities[i], velocities[i]);
+    }
+  }
+}  // PhysicsTest::testBatchedRigidObjectState
+
 }  // namespace
 
 CORRADE_TEST_MAIN(PhysicsTest)
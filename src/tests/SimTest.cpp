@@ -12,11 +12,14 @@
 #include <Magnum/ImageView.h>
 #include <Magnum/Magnum.h>
 #include <Magnum/PixelFormat.h>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "esp/assets/Asset.h"
 #include "esp/assets/ResourceManager.h"
+#include "esp/core/Check.h"
 #include "esp/metadata/MetadataMediator.h"
 #include "esp/physics/RigidObject.h"
 #include "esp/physics/objectManagers/ArticulatedObjectManager.h"
@@ -126,6 +129,7 @@ struct SimTest : Cr::TestSuite::Tester {
   void basic();
   void reconfigure();
   void reset();
+  void actMany();
   void getSceneRGBAObservation();
   void getSceneWithLightingRGBAObservation();
   void getDefaultLightingRGBAObservation();
@@ -134,6 +138,7 @@ struct SimTest : Cr::TestSuite::Tester {
   void updateObjectLightSetupRGBAObservation();
   void multipleLightingSetupsRGBAObservation();
   void recomputeNavmeshWithStaticObjects();
+  void updateNavmeshForObject();
   void loadingObjectTemplates();
   void buildingPrimAssetObjectTemplates();
   void addObjectByHandle();
@@ -142,6 +147,7 @@ struct SimTest : Cr::TestSuite::Tester {
   void createMagnumRenderingOff();
   void getRuntimePerfStats();
   void testArticulatedObjectSkinned();
+  void stepWorldsInParallel();
 
   esp::logging::LoggingContext loggingContext_;
   // TODO: remove outlier pixels from image and lower maxThreshold
@@ -172,6 +178,7 @@ SimTest::SimTest() {
             &SimTest::basic,
             &SimTest::reconfigure,
             &SimTest::reset,
+            &SimTest::actMany,
             &SimTest::getSceneRGBAObservation,
             &SimTest::getSceneWithLightingRGBAObservation,
             &SimTest::getDefaultLightingRGBAObservation,
@@ -180,6 +187,7 @@ SimTest::SimTest() {
             &SimTest::updateObjectLightSetupRGBAObservation,
             &SimTest::multipleLightingSetupsRGBAObservation,
             &SimTest::recomputeNavmeshWithStaticObjects,
+            &SimTest::updateNavmeshForObject,
             &SimTest::loadingObjectTemplates,
             &SimTest::buildingPrimAssetObjectTemplates,
             &SimTest::addObjectByHandle,
@@ -189,7 +197,8 @@ SimTest::SimTest() {
     &SimTest::createMagnumRenderingOff,
     &SimTest::getRuntimePerfStats});
 #ifdef ESP_BUILD_WITH_BULLET
-  addTests({&SimTest::testArticulatedObjectSkinned});
+  addTests({&SimTest::testArticulatedObjectSkinned,
+            &SimTest::stepWorldsInParallel});
 #endif
   // clang-format on
 }
@@ -243,6 +252,78 @@ void SimTest::reset() {
   CORRADE_COMPARE(pathfinder, simulator->getPathFinder());
 }
 
+void SimTest::actMany() {
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, vangogh, esp::NO_LIGHT_KEY);
+  CORRADE_VERIFY(simulator->getPathFinder()->isLoaded());
+
+  AgentConfiguration agentConfig{};
+  auto agent = simulator->addAgent(agentConfig);
+  auto batchedAgent = simulator->addAgent(agentConfig);
+  agent->setInitialState(AgentState{});
+  batchedAgent->setInitialState(AgentState{});
+
+  const int forwardId = batchedAgent->getActionId("moveForward");
+  const int turnId = batchedAgent->getActionId("turnLeft");
+  CORRADE_VERIFY(forwardId != esp::ID_UNDEFINED);
+  CORRADE_VERIFY(turnId != esp::ID_UNDEFINED);
+  CORRADE_COMPARE(batchedAgent->getActionId("moveForward"), forwardId);
+  CORRADE_COMPARE(batchedAgent->getActionId("unknown"), esp::ID_UNDEFINED);
+  CORRADE_VERIFY(!batchedAgent->act(esp::ID_UNDEFINED));
+
+  // Walk far enough to be stopped by the navmesh
+  const std::vector<std::string> actions{"turnLeft", "moveForward",
+                                         "moveForward", "turnLeft"};
+  std::vector<int> agentIds, actionIds;
+  for (int i = 0; i < 20; ++i) {
+    for (const std::string& action : actions) {
+      CORRADE_VERIFY(agent->act(action));
+      agentIds.push_back(1);
+      actionIds.push_back(action == "turnLeft" ? turnId : forwardId);
+    }
+  }
+  simulator->actMany(agentIds, actionIds);
+
+  auto state = AgentState::create();
+  auto batchedState = AgentState::create();
+  agent->getState(state);
+  batchedAgent->getState(batchedState);
+  CORRADE_VERIFY(state->position != esp::vec3f::Zero());
+  CORRADE_VERIFY(state->position.isApprox(batchedState->position));
+  CORRADE_VERIFY(state->rotation.isApprox(batchedState->rotation));
+
+  // A bad ID anywhere in the batch leaves every agent untouched. Make
+  // ESP_CHECK throw like it does in python instead of aborting.
+  esp::core::throwInPython = [](const char* message) {
+    throw std::runtime_error{message};
+  };
+  const int agentForwardId = agent->getActionId("moveForward");
+  const std::vector<std::pair<std::vector<int>, std::vector<int>>> badBatches{
+      {{0, 1, 1}, {agentForwardId, forwardId, esp::ID_UNDEFINED}},
+      {{0, 1, 2}, {agentForwardId, forwardId, forwardId}}};
+  for (size_t i = 0; i < badBatches.size(); ++i) {
+    CORRADE_ITERATION(i);
+    bool caught = false;
+    try {
+      simulator->actMany(badBatches[i].first, badBatches[i].second);
+    } catch (const std::runtime_error&) {
+      caught = true;
+    }
+    CORRADE_VERIFY(caught);
+
+    auto stateAfter = AgentState::create();
+    auto batchedStateAfter = AgentState::create();
+    agent->getState(stateAfter);
+    batchedAgent->getState(batchedStateAfter);
+    CORRADE_VERIFY(stateAfter->position == state->position);
+    CORRADE_VERIFY(stateAfter->rotation == state->rotation);
+    CORRADE_VERIFY(batchedStateAfter->position == batchedState->position);
+    CORRADE_VERIFY(batchedStateAfter->rotation == batchedState->rotation);
+  }
+  esp::core::throwInPython = nullptr;
+}
+
 void SimTest::checkPinholeCameraRGBAObservation(
     Simulator& simulator,
     const std::string& groundTruthImageFile,
@@ -509,6 +590,54 @@ void SimTest::recomputeNavmeshWithStaticObjects() {
       simulator->getPathFinder()->isNavigable(randomNavPoint + offset, 0.2));
 }
 
+void SimTest::updateNavmeshForObject() {
+  ESP_DEBUG() << "Starting Test : updateNavmeshForObject";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, skokloster, esp::NO_LIGHT_KEY);
+  auto objectAttribsMgr = simulator->getObjectAttributesManager();
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+  auto pathfinder = simulator->getPathFinder();
+
+  esp::nav::NavMeshSettings navMeshSettings;
+  navMeshSettings.setDefaults();
+  navMeshSettings.includeStaticObjects = true;
+  navMeshSettings.tileSize = 64;
+  simulator->recomputeNavMesh(*pathfinder, navMeshSettings);
+
+  // two navigable points with enough clearance for the object
+  pathfinder->seed(0);
+  std::vector<esp::vec3f> points;
+  while (points.size() < 2) {
+    esp::vec3f point = pathfinder->getRandomNavigablePoint();
+    if (pathfinder->distanceToClosestObstacle(point) >= 1.0 && point[1] < 1.0 &&
+        (points.empty() || (point - points[0]).norm() > 3.0)) {
+      points.push_back(point);
+    }
+  }
+
+  // adding the object only blocks its own surroundings
+  auto objs = objectAttribsMgr->getObjectHandlesBySubstring("nested_box");
+  auto obj = rigidObjMgr->addObjectByHandle(objs[0]);
+  obj->setTranslation(Magnum::Vector3{points[0]});
+  obj->setMotionType(esp::physics::MotionType::STATIC);
+  CORRADE_VERIFY(simulator->updateNavMeshForObject(obj->getID()));
+  CORRADE_VERIFY(!pathfinder->isNavigable(points[0], 0.1));
+  CORRADE_VERIFY(pathfinder->isNavigable(points[1], 0.1));
+
+  // moving it frees the old location
+  obj->setTranslation(Magnum::Vector3{points[1]});
+  CORRADE_VERIFY(simulator->updateNavMeshForObject(obj->getID()));
+  CORRADE_VERIFY(pathfinder->isNavigable(points[0], 0.1));
+  CORRADE_VERIFY(!pathfinder->isNavigable(points[1], 0.1));
+
+  // so does removing it
+  const int objectId = obj->getID();
+  rigidObjMgr->removePhysObjectByHandle(obj->getHandle());
+  CORRADE_VERIFY(simulator->updateNavMeshForObject(objectId));
+  CORRADE_VERIFY(pathfinder->isNavigable(points[1], 0.1));
+}
+
 void SimTest::loadingObjectTemplates() {
   ESP_DEBUG() << "Starting Test : loadingObjectTemplates";
   auto&& data = SimulatorBuilder[testCaseInstanceId()];
@@ -1140,4 +1269,61 @@ void SimTest::testArticulatedObjectSkinned() {
 
 }  // SimTest::testArticulatedObjectSkinned
 
+void SimTest::stepWorldsInParallel() {
+  ESP_DEBUG() << "Starting Test : stepWorldsInParallel";
+
+  // each world gets a slightly different stack of cubes, and two copies of
+  // each world are made, one stepped in parallel and one on its own
+  constexpr int numWorlds = 4;
+  std::vector<Simulator::uptr> sims[2];
+  std::vector<esp::physics::ManagedRigidObject::ptr> cubes[2];
+  for (int copy = 0; copy < 2; ++copy) {
+    for (int i = 0; i < numWorlds; ++i) {
+      SimulatorConfiguration simConfig{};
+      simConfig.activeSceneName = planeStage;
+      simConfig.enablePhysics = true;
+      simConfig.physicsConfigFile = physicsConfigFile;
+      simConfig.createRenderer = false;
+      auto simulator = Simulator::create_unique(simConfig);
+      auto rigidObjMgr = simulator->getRigidObjectManager();
+      for (int j = 0; j < 3; ++j) {
+        auto obj = rigidObjMgr->addObjectByHandle("cubeSolid");
+        obj->setTranslation({0.05f * i * j, 0.5f + 0.3f * j, 0.0f});
+        obj->setRotation(Mn::Quaternion::rotation(Mn::Deg(10.0f * i),
+                                                  Mn::Vector3::yAxis()));
+        cubes[copy].push_back(obj);
+      }
+      sims[copy].push_back(std::move(simulator));
+    }
+  }
+
+  std::vector<Simulator*> parallelSims;
+  for (auto& sim : sims[0]) {
+    parallelSims.push_back(sim.get());
+  }
+  esp::physics::PhysicsWorldPool pool{3};
+  CORRADE_COMPARE(pool.getNumThreads(), 3);
+  for (int step = 0; step < 60; ++step) {
+    std::vector<double> worldTimes = Simulator::stepWorlds(parallelSims, pool);
+    CORRADE_COMPARE(worldTimes.size(), std::size_t{numWorlds});
+    for (int i = 0; i < numWorlds; ++i) {
+      CORRADE_COMPARE(worldTimes[i], sims[1][i]->stepWorld());
+    }
+  }
+
+  // parallel stepping gives the same result as stepping each world alone
+  for (std::size_t i = 0; i < cubes[0].size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(cubes[0][i]->getTranslation(),
+                    cubes[1][i]->getTranslation());
+    CORRADE_COMPARE(cubes[0][i]->getRotation(), cubes[1][i]->getRotation());
+    // scene nodes are updated after the step
+    CORRADE_COMPARE(cubes[0][i]->getSceneNode()->translation(),
+                    cubes[1][i]->getSceneNode()->translation());
+  }
+  // the cubes have actually been simulated
+  CORRADE_COMPARE_AS(cubes[0].back()->getTranslation().y(), 1.1f,
+                     Cr::TestSuite::Compare::Less);
+}  // SimTest::stepWorldsInParallel
+
 CORRADE_TEST_MAIN(SimTest)
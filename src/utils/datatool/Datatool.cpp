@@ -2,6 +2,9 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <unordered_map>
@@ -12,9 +15,15 @@
 #include <tiny_obj_loader.h>
 
 #include "Mp3dInstanceMeshData.h"
+#include "esp/assets/ResourceManager.h"
 #include "esp/core/Esp.h"
+#include "esp/metadata/MetadataMediator.h"
 #include "esp/nav/PathFinder.h"
 #include "esp/scene/SemanticScene.h"
+#include "esp/sim/SimulatorConfiguration.h"
+#ifdef ESP_BUILD_WITH_BULLET
+#include "esp/physics/bullet/BulletCollisionHulls.h"
+#endif
 
 using esp::assets::AssetInfo;
 using esp::assets::MeshData;
@@ -24,12 +33,29 @@ using esp::nav::NavMeshSettings;
 using esp::nav::PathFinder;
 using esp::scene::SemanticScene;
 
-int createNavMesh(const std::string& meshFile, const std::string& navmeshFile) {
+// Parses a whole argument as a non-negative int, rejecting trailing garbage
+// and out of range values
+bool parseNonNegativeInt(const char* arg, int& value) {
+  char* end = nullptr;
+  errno = 0;
+  const long parsed = std::strtol(arg, &end, 10);
+  if (end == arg || *end != '\0' || errno == ERANGE || parsed < 0 ||
+      parsed > INT_MAX) {
+    return false;
+  }
+  value = static_cast<int>(parsed);
+  return true;
+}
+
+int createNavMesh(const std::string& meshFile,
+                  const std::string& navmeshFile,
+                  int tileSize) {
   SceneLoader loader;
   const AssetInfo info = AssetInfo::fromPath(meshFile);
   const MeshData mesh = loader.load(info);
   NavMeshSettings bs;
   bs.setDefaults();
+  bs.tileSize = tileSize;
   PathFinder pf;
   if (!pf.build(bs, mesh)) {
     ESP_ERROR() << "Failed to build navmesh";
@@ -154,14 +180,65 @@ int createMp3dSemanticMesh(const std::string& plyFile,
   return 0;
 }
 
+#ifdef ESP_BUILD_WITH_BULLET
+int createCollisionHulls(const std::string& assetFile,
+                         int maxHullVertices,
+                         bool decompose) {
+  // Load the collision meshes exactly like objects do at runtime, so the
+  // cached hulls match them
+  esp::sim::SimulatorConfiguration cfg;
+  cfg.createRenderer = false;
+  auto metadataMediator = esp::metadata::MetadataMediator::create(cfg);
+  esp::assets::ResourceManager resourceManager{metadataMediator};
+  auto objectAttributes =
+      metadataMediator->getObjectAttributesManager()->createObject(assetFile,
+                                                                   true);
+  if (!objectAttributes ||
+      !resourceManager.instantiateAssetsOnDemand(objectAttributes)) {
+    ESP_ERROR() << "Failed to load" << assetFile;
+    return 1;
+  }
+  const std::string collisionAssetFile =
+      objectAttributes->getCollisionAssetHandle();
+  const std::vector<esp::assets::CollisionMeshData>& meshGroup =
+      resourceManager.getCollisionMesh(collisionAssetFile);
+
+  esp::physics::CollisionHullSettings settings;
+  settings.maxHullVertices = maxHullVertices;
+  settings.decompose = decompose;
+  const std::string cacheFile =
+      esp::physics::collisionHullCacheFile(collisionAssetFile, settings);
+  if (!esp::physics::saveCollisionHulls(
+          cacheFile, meshGroup, settings,
+          esp::physics::computeCollisionHulls(meshGroup, settings))) {
+    ESP_ERROR() << "Failed to save collision hulls to" << cacheFile;
+    return 2;
+  }
+  return 0;
+}
+#endif
+
 int main(int argc, char** argv) {
   if (argc < 4) {
-    std::cout << "Usage: Datatool task input_file output_file" << std::endl;
+    std::cout << "Usage: Datatool task input_file output_file [args...]"
+              << std::endl;
     return 64;
   }
   const std::string task = argv[1];
   if (task == "create_navmesh") {
-    createNavMesh(argv[2], argv[3]);
+    // optional tile size in voxels, 0 builds a single tile
+    int tileSize = 0;
+    if (argc > 5 || (argc == 5 && !parseNonNegativeInt(argv[4], tileSize))) {
+      std::cout << "Usage: Datatool create_navmesh input_mesh output_navmesh "
+                   "[tile_size]\n  tile_size: tile edge length in voxels, "
+                   "0 (default) builds a single tile"
+                << std::endl;
+      return 64;
+    }
+    const int result = createNavMesh(argv[2], argv[3], tileSize);
+    if (result != 0) {
+      return result;
+    }
   } else if (task == "create_mp3d_semantic_mesh") {
     if (argc < 5) {
       std::cout << "Usage: Datatool create_mp3d_semantic_mesh input_ply "
@@ -178,6 +255,29 @@ int main(int argc, char** argv) {
       return 64;
     }
     createGibsonSemanticMesh(argv[2], argv[3], argv[4]);
+  } else if (task == "create_collision_hulls") {
+#ifdef ESP_BUILD_WITH_BULLET
+    // optional "decompose" for an approximate convex decomposition
+    int maxHullVertices = 0;
+    if (argc > 5 || !parseNonNegativeInt(argv[3], maxHullVertices) ||
+        (argc == 5 && std::string{argv[4]} != "decompose")) {
+      std::cout << "Usage: Datatool create_collision_hulls input_asset "
+                   "max_hull_vertices [decompose]\n  max_hull_vertices: "
+                   "vertex limit of each simplified hull, 0 doesn't "
+                   "limit it\n  decompose: approximate convex decomposition "
+                   "instead of a single hull per mesh"
+                << std::endl;
+      return 64;
+    }
+    const int result =
+        createCollisionHulls(argv[2], maxHullVertices, argc == 5);
+    if (result != 0) {
+      return result;
+    }
+#else
+    ESP_ERROR() << "Collision hulls require building with Bullet";
+    return 1;
+#endif
   } else {
     ESP_ERROR() << "Unrecognized task" << task;
     return 1;
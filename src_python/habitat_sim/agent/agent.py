@@ -4,7 +4,7 @@
 # This source code is licensed under the MIT license found in the
 # LICENSE file in the root directory of this source tree.
 
-from typing import Any, Dict, List, Optional, Union
+from typing import Any, Dict, List, Optional, Tuple, Union
 
 import attr
 import magnum as mn
@@ -198,6 +198,39 @@ class Agent:
 
         return did_collide
 
+    def native_actions(
+        self, action_id: Any
+    ) -> Optional[List[Tuple[SceneNode, int, float, bool]]]:
+        r"""Get the moves :ref:`act` would make for action_id as native actions,
+        so a simulator can take them in a single call
+
+        :param action_id: ID of the action. Retreives the action from
+            `agent_config.action_space <AgentConfiguration.action_space>`
+        :return: A ``(node, native action ID, amount, apply filter)`` tuple for
+            each node the action moves, or :py:`None` if it can only be taken
+            with :ref:`act`
+        """
+
+        habitat_sim.errors.assert_obj_valid(self.body)
+        assert (
+            action_id in self.agent_config.action_space
+        ), f"No action {action_id} in action space"
+        action = self.agent_config.action_space[action_id]
+
+        native_id = self.controls.native_action_id(action.name, action.actuation)
+        if native_id is None:
+            return None
+
+        amount = action.actuation.amount
+        if self.controls.is_body_action(action.name):
+            return [(self.scene_node, native_id, amount, True)]
+
+        moves = []
+        for _, v in self._sensors.items():
+            habitat_sim.errors.assert_obj_valid(v)
+            moves.append((v.object, native_id, amount, False))
+        return moves
+
     @NoAttrValidationContext()
     def get_state(self) -> AgentState:
         habitat_sim.errors.assert_obj_valid(self.body)
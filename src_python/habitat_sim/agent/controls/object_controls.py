@@ -4,7 +4,7 @@
 # This source code is licensed under the MIT license found in the
 # LICENSE file in the root directory of this source tree.
 
-from typing import Callable, Tuple, Union
+from typing import Callable, Optional, Tuple, Union
 
 import attr
 import magnum as mn
@@ -12,6 +12,10 @@ import numpy as np
 import quaternion  # noqa: F401
 
 from habitat_sim import bindings as hsim
+from habitat_sim._ext.habitat_sim_bindings import (
+    ObjectControls as _NativeObjectControls,
+)
+from habitat_sim.agent.controls import default_controls
 from habitat_sim.agent.controls.controls import ActuationSpec
 from habitat_sim.registry import registry
 
@@ -19,6 +23,24 @@ from habitat_sim.registry import registry
 EPS = 1e-5
 _3d_point = Union[np.ndarray, mn.Vector3, Tuple[float, float, float]]
 
+# Default controls that the native ObjectControls implements the same way when
+# they aren't constrained. MoveUp and MoveDown aren't here, the native ones move
+# along the parent's up axis rather than the node's own.
+_native_controls = _NativeObjectControls()
+_NATIVE_ACTION_IDS = {
+    control: _native_controls.get_action_id(name)
+    for control, name in (
+        (default_controls.MoveForward, "moveForward"),
+        (default_controls.MoveBackward, "moveBackward"),
+        (default_controls.MoveRight, "moveRight"),
+        (default_controls.MoveLeft, "moveLeft"),
+        (default_controls.LookLeft, "turnLeft"),
+        (default_controls.LookRight, "turnRight"),
+        (default_controls.LookUp, "lookUp"),
+        (default_controls.LookDown, "lookDown"),
+    )
+}
+
 
 def _noop_filter(start: _3d_point, end: _3d_point) -> _3d_point:
     return end
@@ -47,6 +69,28 @@ class ObjectControls:
 
         return move_fn.body_action
 
+    def native_action_id(
+        self, action_name: str, actuation_spec: ActuationSpec
+    ) -> Optional[int]:
+        r"""Gets the ID of the native ``ObjectControls`` action that does the same
+        as :p:`action_name` with :p:`actuation_spec`, to take it with
+        `Simulator.act_many`
+
+        :param action_name: Name of the action
+        :param actuation_spec: Specifies the parameters needed by the function
+        :return: The ID, or :py:`None` if the action has no native equivalent or
+            this class changes how actions are taken
+        """
+        if (
+            type(self) is not ObjectControls
+            or type(actuation_spec) is not ActuationSpec
+            or actuation_spec.constraint is not None
+        ):
+            return None
+
+        move_fn = registry.get_move_fn(action_name)
+        return _NATIVE_ACTION_IDS.get(type(move_fn))
+
     def action(
         self,
         obj: hsim.SceneNode,
@@ -8,6 +8,7 @@ import attr
 import numpy as np
 
 from habitat_sim import errors, scene
+from habitat_sim._ext.habitat_sim_bindings import RigidState
 from habitat_sim.agent.agent import Agent
 from habitat_sim.agent.controls.controls import ActuationSpec
 from habitat_sim.nav import GreedyFollowerCodes, GreedyGeodesicFollowerImpl, PathFinder
@@ -50,6 +51,7 @@ class GreedyGeodesicFollower:
         right_key: Optional[Any] = None,
         fix_thrashing: bool = True,
         thrashing_threshold: int = 16,
+        use_lattice: bool = False,
     ) -> None:
         r"""Constructor
 
@@ -79,6 +81,10 @@ class GreedyGeodesicFollower:
         :param fix_thrashing: Whether or not to attempt to fix thrashing
         :param thrashing_threshold: The number of actions in a left -> right -> left -> ..
                                        sequence needed to be considered thrashing
+        :param use_lattice: Whether to memoize the outcome of actions and the
+            geodesic distances of the visited poses across queries. Only use
+            this if the agent's actions are deterministic. Call
+            :py:`impl.clear_lattice()` if the navmesh changes
         """
 
         self.pathfinder = pathfinder
@@ -121,6 +127,7 @@ class GreedyGeodesicFollower:
             fix_thrashing,
             thrashing_threshold,
         )
+        self.impl.lattice_enabled = use_lattice
 
     def _find_action(self, name: str) -> Tuple[str, ActuationSpec]:
         candidates = list(
@@ -195,6 +202,43 @@ class GreedyGeodesicFollower:
 
         return path
 
+    def find_paths(
+        self,
+        start_states: List[Any],
+        goal_positions: List[np.ndarray],
+        allow_sliding: bool = True,
+        num_threads: int = 0,
+    ) -> List[Optional[List[Any]]]:
+        r"""Finds the paths of many start states and goals in parallel
+
+        :param start_states: The start state of each path. Anything with
+            ``rotation`` and ``position`` attributes, such as an agent state
+        :param goal_positions: The position of the goal of each path
+        :param allow_sliding: Whether moves slide along obstacles
+        :param num_threads: Number of threads to use, including the calling
+            one. Values :py:`<= 0` use all hardware threads
+        :return: The list of actions of each path, as returned by
+            :ref:`find_path`, or :py:`None` where no path was found.
+
+        The agent's controls are simulated natively instead of being called,
+        so this assumes the default ``move_forward``, ``turn_left`` and
+        ``turn_right`` actuations. The paths are then identical to those of
+        :ref:`find_path`. The threads and their state are kept for later
+        calls with the same ``num_threads`` and ``allow_sliding``.
+        """
+        starts = [
+            RigidState(quat_to_magnum(state.rotation), state.position)
+            for state in start_states
+        ]
+        paths = self.impl.find_paths(
+            starts, goal_positions, allow_sliding, num_threads
+        )
+
+        return [
+            [self.action_mapping[v] for v in path] if len(path) > 0 else None
+            for path in paths
+        ]
+
     def reset(self) -> None:
         self.impl.reset()
         self.last_goal = None
@@ -16,6 +16,7 @@ from habitat_sim._ext.habitat_sim_bindings import (
     ManagedRigidObject,
     MotionType,
     PhysicsSimulationLibrary,
+    PhysicsWorldPool,
     RaycastResults,
     RayHitInfo,
     RigidConstraintSettings,
@@ -32,6 +33,7 @@ __all__ = [
     "RigidObjectManager",
     "ArticulatedObjectManager",
     "PhysicsSimulationLibrary",
+    "PhysicsWorldPool",
     "MotionType",
     "VelocityControl",
     "RayHitInfo",
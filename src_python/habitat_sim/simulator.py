@@ -9,7 +9,7 @@ from collections import OrderedDict
 from collections.abc import MutableMapping
 from typing import Any, Dict, List
 from typing import MutableMapping as MutableMapping_T
-from typing import Optional, Union, cast, overload
+from typing import Optional, Tuple, Union, cast, overload
 
 import attr
 import magnum as mn
@@ -31,6 +31,7 @@ from habitat_sim.bindings import cuda_enabled
 from habitat_sim.logging import LoggingContext, logger
 from habitat_sim.metadata import MetadataMediator
 from habitat_sim.nav import GreedyGeodesicFollower
+from habitat_sim.scene import SceneNode
 from habitat_sim.sensor import SensorSpec, SensorType
 from habitat_sim.sensors.noise_models import make_sensor_noise_model
 from habitat_sim.sim import SimulatorBackend, SimulatorConfiguration
@@ -466,10 +467,36 @@ class Simulator(SimulatorBackend):
             action = cast(Dict[int, Union[str, int]], {self._default_agent_id: action})
             return_single = True
         collided_dict: Dict[int, bool] = {}
+        # Default actions of agents filtered by this simulator are taken in a
+        # single native call, the others one by one in python
+        native_moves: Dict[int, List[Tuple[SceneNode, int, float, bool]]] = {}
         for agent_id, agent_act in action.items():
             agent = self.get_agent(agent_id)
-            collided_dict[agent_id] = agent.act(agent_act)
-            self.__last_state[agent_id] = agent.get_state()
+            moves = None
+            if agent.controls.move_filter_fn == self.step_filter:
+                moves = agent.native_actions(agent_act)
+            if moves is None:
+                collided_dict[agent_id] = agent.act(agent_act)
+            else:
+                native_moves[agent_id] = moves
+
+        all_moves = [move for moves in native_moves.values() for move in moves]
+        collided: List[bool] = []
+        if len(all_moves) > 0:
+            collided = self.act_many(
+                [move[0] for move in all_moves],
+                [move[1] for move in all_moves],
+                [move[2] for move in all_moves],
+                [move[3] for move in all_moves],
+            )
+        start = 0
+        for agent_id, moves in native_moves.items():
+            # unfiltered moves never collide
+            collided_dict[agent_id] = any(collided[start : start + len(moves)])
+            start += len(moves)
+
+        for agent_id in action.keys():
+            self.__last_state[agent_id] = self.get_agent(agent_id).get_state()
 
         # step physics by dt
         step_start_Time = time.time()
@@ -189,5 +189,9 @@ def test_physics_object_attributes():
     assert object_template.bounding_box_collisions == True
     object_template.join_collision_meshes = False
     assert object_template.join_collision_meshes == False
+    object_template.collision_hull_max_vertices = 32
+    assert object_template.collision_hull_max_vertices == 32
+    object_template.collision_convex_decomposition = True
+    assert object_template.collision_convex_decomposition == True
     object_template.force_flat_shading = True
     assert object_template.force_flat_shading == True
@@ -188,3 +188,123 @@ def test_greedy_follower(test_navmesh, move_filter_fn, action_noise, pbar):
 
     if not test_all:
         assert test_spl / NUM_TESTS >= ACCEPTABLE_SPLS[(move_filter_fn, action_noise)]
+
+
+@pytest.mark.parametrize("test_navmesh", test_navmeshes)
+@pytest.mark.parametrize("move_filter_fn", ["try_step", "try_step_no_sliding"])
+def test_greedy_follower_find_paths(test_navmesh, move_filter_fn):
+    if not osp.exists(test_navmesh):
+        pytest.skip(f"{test_navmesh} not found")
+
+    pathfinder = habitat_sim.PathFinder()
+    pathfinder.load_nav_mesh(test_navmesh)
+    assert pathfinder.is_loaded
+    pathfinder.seed(0)
+
+    scene_graph = habitat_sim.SceneGraph()
+    agent = habitat_sim.Agent(scene_graph.get_root_node().create_child())
+    agent.controls.move_filter_fn = getattr(pathfinder, move_filter_fn)
+
+    agent.agent_config.action_space["turn_left"].actuation.amount = TURN_DEGREE
+    agent.agent_config.action_space["turn_right"].actuation.amount = TURN_DEGREE
+
+    follower = habitat_sim.GreedyGeodesicFollower(pathfinder, agent)
+
+    start_states = []
+    goal_positions = []
+    for _ in range(NUM_TESTS // 4):
+        state = habitat_sim.AgentState()
+        state.position = pathfinder.get_random_navigable_point()
+        start_states.append(state)
+        goal_positions.append(pathfinder.get_random_navigable_point())
+
+    batched = follower.find_paths(
+        start_states,
+        goal_positions,
+        allow_sliding=move_filter_fn == "try_step",
+        num_threads=4,
+    )
+    assert len(batched) == len(start_states)
+
+    # The threads and their followers are reused by later calls, also after
+    # the navmesh was reloaded
+    for reload in (False, True):
+        if reload:
+            pathfinder.load_nav_mesh(test_navmesh)
+        assert (
+            follower.find_paths(
+                start_states,
+                goal_positions,
+                allow_sliding=move_filter_fn == "try_step",
+                num_threads=4,
+            )
+            == batched
+        )
+
+    # The batched planner has to fit exactly the same actions as the
+    # single-agent one
+    for state, goal_pos, batched_path in zip(start_states, goal_positions, batched):
+        agent.state = state
+        try:
+            path = follower.find_path(goal_pos)
+        except habitat_sim.errors.GreedyFollowerError:
+            path = None
+
+        assert batched_path == path
+
+
+@pytest.mark.parametrize("test_navmesh", test_navmeshes)
+def test_greedy_follower_lattice(test_navmesh):
+    if not osp.exists(test_navmesh):
+        pytest.skip(f"{test_navmesh} not found")
+
+    pathfinder = habitat_sim.PathFinder()
+    pathfinder.load_nav_mesh(test_navmesh)
+    assert pathfinder.is_loaded
+    pathfinder.seed(0)
+
+    scene_graph = habitat_sim.SceneGraph()
+    agent = habitat_sim.Agent(scene_graph.get_root_node().create_child())
+    agent.controls.move_filter_fn = pathfinder.try_step
+
+    agent.agent_config.action_space["turn_left"].actuation.amount = TURN_DEGREE
+    agent.agent_config.action_space["turn_right"].actuation.amount = TURN_DEGREE
+
+    follower = habitat_sim.GreedyGeodesicFollower(pathfinder, agent)
+    lattice_follower = habitat_sim.GreedyGeodesicFollower(
+        pathfinder, agent, use_lattice=True
+    )
+
+    def find_path(follower, start_pos, goal_pos):
+        state = habitat_sim.AgentState()
+        state.position = start_pos
+        agent.state = state
+        try:
+            return follower.find_path(goal_pos)
+        except habitat_sim.errors.GreedyFollowerError:
+            return None
+
+    starts = [pathfinder.get_random_navigable_point() for _ in range(20)]
+    goals = [pathfinder.get_random_navigable_point() for _ in range(20)]
+
+    # Poses are rounded when hashed, so a path may rarely differ from the
+    # unmemoized one by an action
+    lattice_paths = [
+        find_path(lattice_follower, start_pos, goal_pos)
+        for start_pos, goal_pos in zip(starts, goals)
+    ]
+    num_same = sum(
+        find_path(follower, start_pos, goal_pos) == lattice_path
+        for start_pos, goal_pos, lattice_path in zip(starts, goals, lattice_paths)
+    )
+    assert num_same >= 0.9 * len(starts)
+
+    # Repeated queries only revisit explored poses
+    lattice_size = lattice_follower.impl.lattice_size
+    assert lattice_size > 0
+    for start_pos, goal_pos, lattice_path in zip(starts, goals, lattice_paths):
+        assert find_path(lattice_follower, start_pos, goal_pos) == lattice_path
+    assert lattice_follower.impl.lattice_size == lattice_size
+
+    lattice_follower.impl.clear_lattice()
+    assert lattice_follower.impl.lattice_size == 0
@@ -838,6 +838,100 @@ def test_articulated_object_add_remove():
         assert art_obj_mgr.get_num_objects() == 0
 
 
+@pytest.mark.skipif(
+    not habitat_sim.built_with_bullet,
+    reason="ArticulatedObject API requires Bullet physics.",
+)
+def test_batched_object_state():
+    cfg_settings = habitat_sim.utils.settings.default_sim_settings.copy()
+    cfg_settings["scene"] = "NONE"
+    cfg_settings["enable_physics"] = True
+
+    hab_cfg = habitat_sim.utils.settings.make_cfg(cfg_settings)
+
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        obj_template_mgr = sim.get_object_template_manager()
+        rigid_obj_mgr = sim.get_rigid_object_manager()
+        art_obj_mgr = sim.get_articulated_object_manager()
+
+        # rigid objects
+        cube_prim_handle = obj_template_mgr.get_template_handles("cube")[0]
+        cubes = [
+            rigid_obj_mgr.add_object_by_template_handle(cube_prim_handle)
+            for _i in range(4)
+        ]
+        for i, cube in enumerate(cubes):
+            cube.translation = [float(i), 1.0, -2.0 * i]
+            cube.rotation = mn.Quaternion.rotation(
+                mn.Deg(20.0 * i), mn.Vector3.y_axis()
+            )
+        cube_ids = [cube.object_id for cube in reversed(cubes)]
+
+        poses = rigid_obj_mgr.get_poses(cube_ids)
+        assert poses.shape == (4, 7)
+        assert poses.dtype == np.float32
+        for pose, cube in zip(poses, reversed(cubes)):
+            assert np.allclose(pose[:3], cube.translation)
+            assert np.allclose(pose[3:6], cube.rotation.vector)
+            assert np.isclose(pose[6], cube.rotation.scalar)
+
+        poses[:, 1] += 1.0
+        rigid_obj_mgr.set_poses(cube_ids, poses)
+        for pose, cube in zip(poses, reversed(cubes)):
+            assert np.allclose(cube.translation, pose[:3])
+
+        velocities = np.arange(24, dtype=np.float32).reshape(4, 6) * 0.1
+        rigid_obj_mgr.set_velocities(cube_ids, velocities)
+        for velocity, cube in zip(velocities, reversed(cubes)):
+            assert np.allclose(cube.linear_velocity, velocity[:3])
+            assert np.allclose(cube.angular_velocity, velocity[3:])
+        assert np.allclose(rigid_obj_mgr.get_velocities(cube_ids), velocities)
+
+        # mismatched sizes and unknown ids are rejected
+        with pytest.raises(AssertionError):
+            rigid_obj_mgr.set_poses(cube_ids, poses[:2])
+        with pytest.raises(AssertionError):
+            rigid_obj_mgr.get_poses([cube_ids[0], 1000])
+        # a bad id anywhere in the batch leaves every object untouched
+        shifted = poses[:2].copy()
+        shifted[:, 1] += 1.0
+        with pytest.raises(AssertionError):
+            rigid_obj_mgr.set_poses([cube_ids[0], 1000], shifted)
+        assert np.allclose(cubes[-1].translation, poses[0, :3])
+
+        # articulated objects
+        robot_file = "data/test_assets/urdf/kuka_iiwa/model_free_base.urdf"
+        robots = [
+            art_obj_mgr.add_articulated_object_from_urdf(filepath=robot_file)
+            for _i in range(3)
+        ]
+        robot_ids = [robot.object_id for robot in robots]
+        num_positions = len(robots[0].joint_positions)
+        num_dofs = len(robots[0].joint_velocities)
+
+        target_positions = np.random.uniform(
+            -0.5, 0.5, num_positions * len(robots)
+        ).astype(np.float32)
+        art_obj_mgr.set_joint_positions(robot_ids, target_positions)
+        positions = art_obj_mgr.get_joint_positions(robot_ids)
+        assert positions.dtype == np.float32
+        assert np.allclose(positions, target_positions)
+        for i, robot in enumerate(robots):
+            assert np.allclose(
+                robot.joint_positions,
+                target_positions[i * num_positions : (i + 1) * num_positions],
+            )
+
+        target_velocities = np.random.uniform(-1.0, 1.0, num_dofs * len(robots))
+        art_obj_mgr.set_joint_velocities(robot_ids, target_velocities)
+        assert np.allclose(
+            art_obj_mgr.get_joint_velocities(robot_ids), target_velocities
+        )
+
+        with pytest.raises(AssertionError):
+            art_obj_mgr.set_joint_positions(robot_ids, target_positions[1:])
+
+
 @pytest.mark.skipif(
     not habitat_sim.built_with_bullet,
     reason="ArticulatedObject API requires Bullet physics.",
@@ -1985,3 +2079,57 @@ def test_bullet_collision_helper():
             sim.get_physics_step_collision_summary()
             == "(no active collision manifolds)\n"
         )
+
+
+@pytest.mark.skipif(
+    not habitat_sim.built_with_bullet,
+    reason="Parallel stepping is only deterministic with Bullet physics.",
+)
+def test_step_worlds_in_parallel():
+    cfg_settings = habitat_sim.utils.settings.default_sim_settings.copy()
+    cfg_settings["scene"] = "NONE"
+    cfg_settings["enable_physics"] = True
+    hab_cfg = habitat_sim.utils.settings.make_cfg(cfg_settings)
+    # headless worlds, no sensors means no renderer
+    hab_cfg.agents[0].sensor_specifications = []
+
+    num_worlds = 3
+    # one copy of each world is stepped in parallel, the other on its own
+    parallel_sims = [habitat_sim.Simulator(hab_cfg) for _i in range(num_worlds)]
+    serial_sims = [habitat_sim.Simulator(hab_cfg) for _i in range(num_worlds)]
+    try:
+        for sims in (parallel_sims, serial_sims):
+            for world_ix, sim in enumerate(sims):
+                obj_template_mgr = sim.get_object_template_manager()
+                rigid_obj_mgr = sim.get_rigid_object_manager()
+                cube_handle = obj_template_mgr.get_template_handles("cubeSolid")[0]
+                for j in range(3):
+                    cube = rigid_obj_mgr.add_object_by_template_handle(cube_handle)
+                    cube.translation = [0.05 * world_ix * j, 0.3 * j, 0.0]
+                    cube.angular_velocity = [0.0, float(world_ix), 0.0]
+
+        pool = habitat_sim.physics.PhysicsWorldPool(num_threads=2)
+        assert pool.num_threads == 2
+        for _step in range(30):
+            world_times = habitat_sim.Simulator.step_worlds(parallel_sims, pool)
+            for world_time, serial_sim in zip(world_times, serial_sims):
+                assert world_time == serial_sim.step_world()
+
+        # same results as stepping each world alone
+        for parallel_sim, serial_sim in zip(parallel_sims, serial_sims):
+            parallel_obj_mgr = parallel_sim.get_rigid_object_manager()
+            serial_obj_mgr = serial_sim.get_rigid_object_manager()
+            for handle in parallel_obj_mgr.get_object_handles():
+                parallel_obj = parallel_obj_mgr.get_object_by_handle(handle)
+                serial_obj = serial_obj_mgr.get_object_by_handle(handle)
+                assert parallel_obj.translation == serial_obj.translation
+                assert parallel_obj.rotation == serial_obj.rotation
+
+        # a world can't be stepped twice at once
+        with pytest.raises(AssertionError):
+            habitat_sim.Simulator.step_worlds(
+                [parallel_sims[0], parallel_sims[0]], pool
+            )
+    finally:
+        for sim in parallel_sims + serial_sims:
+            sim.close()
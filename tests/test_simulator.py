@@ -142,6 +142,47 @@ def test_sim_multiagent_move_and_reset(make_cfg_settings, num_agents=10):
             )
 
 
+def test_step_native_actions_match_python(make_cfg_settings):
+    hab_cfg = habitat_sim.utils.settings.make_cfg(make_cfg_settings)
+    hab_cfg.agents[0].action_space["look_up"] = habitat_sim.ActionSpec(
+        "look_up", habitat_sim.ActuationSpec(amount=10.0)
+    )
+    hab_cfg.agents.append(copy(hab_cfg.agents[0]))
+
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        sim.initialize_agent(0)
+        sim.initialize_agent(1, sim.get_agent(0).state)
+        # A filter the simulator doesn't know makes agent 1 act in python
+        sim.get_agent(1).controls.move_filter_fn = lambda start, end: sim.step_filter(
+            start, end
+        )
+        assert sim.get_agent(0).native_actions("move_forward") is not None
+        assert sim.get_agent(1).native_actions("look_up") is not None
+
+        random.seed(0)
+        action_names = list(hab_cfg.agents[0].action_space.keys())
+        for _ in range(50):
+            action = random.choice(action_names)
+            observations = sim.step({0: action, 1: action})
+            assert observations[0]["collided"] == observations[1]["collided"]
+
+            native_state = sim.get_agent(0).state
+            python_state = sim.get_agent(1).state
+            assert np.allclose(native_state.position, python_state.position, atol=1e-5)
+            assert np.isclose(native_state.rotation, python_state.rotation, rtol=1e-4)
+            for uuid, sensor_state in native_state.sensor_states.items():
+                assert np.allclose(
+                    sensor_state.position,
+                    python_state.sensor_states[uuid].position,
+                    atol=1e-5,
+                )
+                assert np.isclose(
+                    sensor_state.rotation,
+                    python_state.sensor_states[uuid].rotation,
+                    rtol=1e-4,
+                )
+
+
 # Make sure you can keep a reference to an agent alive without crashing
 def test_keep_agent():
     sim_cfg = habitat_sim.SimulatorConfiguration()